@@ -0,0 +1,423 @@
+/*
+ * acceptor.c
+ * Yeni bağlantıları non-blocking kabul eder ve handshake satırı gelene kadar
+ * poll() ile bekletir. Handshake'i tamamlanan bağlantı ilgili handler thread'ine verilir.
+ */
+#ifdef __linux__
+#define _GNU_SOURCE // accept4
+#endif
+#include "headers/acceptor.h"
+#include "headers/connection_handling.h"
+#include "headers/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include <json.h>
+
+#define HANDSHAKE_BUFFER_SIZE 1024
+
+typedef struct pending_handshake {
+    int fd;
+    long long deadline_ms;
+    size_t len;
+    char buf[HANDSHAKE_BUFFER_SIZE];
+} PendingHandshake;
+
+typedef struct acceptor {
+    pthread_t thread;
+    int listen_fd;
+    int unix_listen_fd;           /* Sadece ilk acceptor'da; yoksa -1 */
+    PendingHandshake **pending;
+    int num_pending, pending_capacity;
+    struct pollfd *pfds;
+} Acceptor;
+
+static Acceptor acceptors[ACCEPTOR_MAX_THREADS];
+static int num_acceptors = 0;
+static int handshake_timeout = ACCEPTOR_DEFAULT_HANDSHAKE_TIMEOUT_MS;
+static volatile int acceptors_running = 0;
+static char unix_socket_path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+
+static long long monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int open_listen_socket(int port, int reuse_port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+            perror("setsockopt SO_REUSEPORT");
+            close(fd);
+            return -1;
+        }
+#else
+        fprintf(stderr, "SO_REUSEPORT is not supported on this platform.\n");
+        close(fd);
+        return -1;
+#endif
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("fcntl listen socket");
+        close(fd);
+        return -1;
+    }
+
+    struct sockaddr_in server_address;
+    memset(&server_address, 0, sizeof(server_address));
+    server_address.sin_family = AF_INET;
+    server_address.sin_addr.s_addr = htonl(INADDR_ANY);
+    server_address.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&server_address, sizeof(server_address)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, SOMAXCONN) < 0) {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Opens a non-blocking AF_UNIX listening socket at path.
+ *        A socket file left behind by a crashed server is removed, but a live one is not.
+ * @return listening fd, or -1 on error.
+ */
+static int open_unix_listen_socket(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Unix socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("unix socket");
+        return -1;
+    }
+    int rc = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    if (rc < 0 && errno == EADDRINUSE) {
+        // Dosyayı dinleyen biri yoksa önceki çalışmadan kalmıştır
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        int alive = probe >= 0 && connect(probe, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+        if (probe >= 0) close(probe);
+        if (alive) {
+            fprintf(stderr, "Another server is already listening on %s.\n", path);
+            close(fd);
+            return -1;
+        }
+        unlink(path);
+        rc = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    }
+    if (rc < 0) {
+        perror("unix bind");
+        close(fd);
+        return -1;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 || listen(fd, SOMAXCONN) < 0) {
+        perror("unix listen");
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+    return fd;
+}
+
+static int accept_nonblocking(int listen_fd) {
+#ifdef __linux__
+    return accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) return fd;
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        close(fd);
+        errno = ECONNABORTED;
+        return -1;
+    }
+    return fd;
+#endif
+}
+
+static void drop_pending(Acceptor *a, int index, int close_fd) {
+    PendingHandshake *p = a->pending[index];
+    if (close_fd) close(p->fd);
+    free(p);
+    a->pending[index] = a->pending[--a->num_pending];
+}
+
+/* Listen soketi hazır olduğunda bekleyen tüm bağlantıları kabul eder */
+static void accept_ready(Acceptor *a, int listen_fd) {
+    while (a->num_pending < ACCEPTOR_MAX_PENDING) {
+        int fd = accept_nonblocking(listen_fd);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) LOG_RATELIMITED(LOG_LEVEL_ERROR, 5, "accept: %s\n", strerror(errno));
+            return;
+        }
+        if (a->num_pending == a->pending_capacity) {
+            int new_capacity = a->pending_capacity ? a->pending_capacity * 2 : 64;
+            PendingHandshake **grown_pending = realloc(a->pending, new_capacity * sizeof(*grown_pending));
+            if (grown_pending) a->pending = grown_pending;
+            struct pollfd *grown_pfds = realloc(a->pfds, (new_capacity + 2) * sizeof(*grown_pfds));
+            if (grown_pfds) a->pfds = grown_pfds;
+            if (!grown_pending || !grown_pfds) {
+                perror("Failed to grow pending handshake table");
+                close(fd);
+                return;
+            }
+            a->pending_capacity = new_capacity;
+        }
+        PendingHandshake *p = malloc(sizeof(PendingHandshake));
+        if (!p) {
+            perror("Failed to allocate pending handshake");
+            close(fd);
+            return;
+        }
+        p->fd = fd;
+        p->len = 0;
+        p->deadline_ms = monotonic_ms() + handshake_timeout;
+        a->pending[a->num_pending++] = p;
+    }
+}
+
+/**
+ * @brief Classifies a complete handshake line and starts the matching handler thread.
+ *        Bytes after the line are handed over so the handler does not lose them.
+ * @return 1 if the connection was handed off, 0 if it should be closed.
+ */
+static int dispatch_handshake(PendingHandshake *p, size_t line_len) {
+    p->buf[line_len] = '\0';
+    struct json_object *initial_json = json_tokener_parse(p->buf);
+    if (!initial_json) {
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "Acceptor: Invalid handshake JSON on socket %d.\n", p->fd);
+        return 0;
+    }
+
+    void *(*handler)(void*) = NULL;
+    const char *kind = NULL;
+    struct json_object *type_obj;
+    // "type": null veya sayı gibi değerler string değildir; bilinmeyen tip olarak reddedilir
+    if (json_object_object_get_ex(initial_json, "type", &type_obj) && json_object_is_type(type_obj, json_type_string)) {
+        const char *type = json_object_get_string(type_obj);
+        if (strcmp(type, "HANDSHAKE") == 0 || strcmp(type, "RESUME") == 0) {
+            handler = handle_drone_connection;
+            kind = "drone";
+        } else if (strcmp(type, "VIEWER_HANDSHAKE") == 0) {
+            handler = handle_viewer_connection;
+            kind = "viewer";
+        }
+    }
+    json_object_put(initial_json);
+    if (!handler) {
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "Acceptor: Unknown handshake type on socket %d.\n", p->fd);
+        return 0;
+    }
+
+    struct handler_args *args = malloc(sizeof(*args));
+    if (!args) {
+        perror("Failed to allocate handler args");
+        return 0;
+    }
+    args->client_fd = p->fd;
+    memcpy(args->initial_msg, p->buf, line_len + 1);
+    args->leftover_len = (int)(p->len - line_len - 1);
+    memcpy(args->leftover, p->buf + line_len + 1, args->leftover_len);
+
+    pthread_t handler_thread;
+    if (pthread_create(&handler_thread, NULL, handler, args) != 0) {
+        perror("Failed to create handler thread");
+        free(args);
+        return 0;
+    }
+    pthread_detach(handler_thread);
+    LOG_INFO("Server: Dispatched %s handler for socket %d.\n", kind, p->fd);
+    return 1;
+}
+
+/* Handshake bekleyen bağlantıdan okur. 1: bağlantı listeden çıkarılmalı */
+static int read_handshake(PendingHandshake *p) {
+    for (;;) {
+        ssize_t n = recv(p->fd, p->buf + p->len, sizeof(p->buf) - p->len - 1, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            close(p->fd);
+            return 1;
+        }
+        if (n == 0) {
+            close(p->fd);
+            return 1;
+        }
+        char *newline = memchr(p->buf + p->len, '\n', n);
+        p->len += n;
+        if (newline) {
+            if (!dispatch_handshake(p, newline - p->buf)) close(p->fd);
+            return 1;
+        }
+        if (p->len >= sizeof(p->buf) - 1) {
+            LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "Acceptor: Handshake too long on socket %d, closing.\n", p->fd);
+            close(p->fd);
+            return 1;
+        }
+    }
+}
+
+static void *acceptor_thread(void *arg) {
+    Acceptor *a = (Acceptor*)arg;
+    a->pfds = malloc(2 * sizeof(struct pollfd));   // TCP ve (varsa) Unix listen soketleri
+    if (!a->pfds) {
+        perror("Failed to allocate acceptor poll set");
+        return NULL;
+    }
+
+    while (acceptors_running) {
+        // Tablo doluysa yeni bağlantılar kernel backlog'unda bekler
+        int listen_slots = 0;
+        if (a->num_pending < ACCEPTOR_MAX_PENDING) {
+            a->pfds[listen_slots].fd = a->listen_fd;
+            a->pfds[listen_slots].events = POLLIN;
+            a->pfds[listen_slots].revents = 0;
+            listen_slots++;
+            if (a->unix_listen_fd >= 0) {
+                a->pfds[listen_slots].fd = a->unix_listen_fd;
+                a->pfds[listen_slots].events = POLLIN;
+                a->pfds[listen_slots].revents = 0;
+                listen_slots++;
+            }
+        }
+        int nfds = listen_slots;
+        long long now = monotonic_ms();
+        int timeout = ACCEPTOR_POLL_INTERVAL_MS;
+        for (int i = 0; i < a->num_pending; i++) {
+            a->pfds[nfds].fd = a->pending[i]->fd;
+            a->pfds[nfds].events = POLLIN;
+            a->pfds[nfds].revents = 0;
+            nfds++;
+            long long remaining = a->pending[i]->deadline_ms - now;
+            if (remaining < timeout) timeout = remaining > 0 ? (int)remaining : 0;
+        }
+
+        int ready = poll(a->pfds, nfds, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+
+        // Bekleyen bağlantılar sondan başa işlenir; drop_pending son elemanı boşalan yere taşır
+        int base = listen_slots;
+        int pending_before = a->num_pending;
+        now = monotonic_ms();
+        for (int i = pending_before - 1; i >= 0; i--) {
+            PendingHandshake *p = a->pending[i];
+            short revents = a->pfds[base + i].revents;
+            if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                if (read_handshake(p)) {
+                    drop_pending(a, i, 0);
+                    continue;
+                }
+            }
+            if (now >= p->deadline_ms) {
+                LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "Acceptor: Handshake timeout on socket %d, closing.\n", p->fd);
+                drop_pending(a, i, 1);
+            }
+        }
+
+        int unix_ready = listen_slots > 1 && (a->pfds[1].revents & POLLIN);
+        if (listen_slots > 0 && (a->pfds[0].revents & POLLIN)) accept_ready(a, a->listen_fd);
+        if (unix_ready) accept_ready(a, a->unix_listen_fd);
+    }
+
+    while (a->num_pending > 0) drop_pending(a, a->num_pending - 1, 1);
+    free(a->pending);
+    free(a->pfds);
+    a->pending = NULL;
+    a->pfds = NULL;
+    a->pending_capacity = 0;
+    return NULL;
+}
+
+int acceptor_start(int port, const char *unix_path, int num_threads, int handshake_timeout_ms) {
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > ACCEPTOR_MAX_THREADS) num_threads = ACCEPTOR_MAX_THREADS;
+    handshake_timeout = handshake_timeout_ms > 0 ? handshake_timeout_ms : ACCEPTOR_DEFAULT_HANDSHAKE_TIMEOUT_MS;
+
+    // Birden fazla acceptor varsa her biri kendi soketini açar, kernel bağlantıları dağıtır
+    for (int i = 0; i < num_threads; i++) {
+        memset(&acceptors[i], 0, sizeof(Acceptor));
+        acceptors[i].unix_listen_fd = -1;
+        acceptors[i].listen_fd = open_listen_socket(port, num_threads > 1);
+        if (acceptors[i].listen_fd < 0) {
+            for (int j = 0; j < i; j++) close(acceptors[j].listen_fd);
+            return 1;
+        }
+    }
+
+    // Aynı makinedeki istemciler için Unix soketi; açılamazsa TCP ile devam edilir
+    unix_socket_path[0] = '\0';
+    if (unix_path && unix_path[0]) {
+        acceptors[0].unix_listen_fd = open_unix_listen_socket(unix_path);
+        if (acceptors[0].unix_listen_fd >= 0) {
+            strncpy(unix_socket_path, unix_path, sizeof(unix_socket_path) - 1);
+            unix_socket_path[sizeof(unix_socket_path) - 1] = '\0';
+        } else {
+            fprintf(stderr, "Unix domain socket disabled.\n");
+        }
+    }
+
+    acceptors_running = 1;
+    for (num_acceptors = 0; num_acceptors < num_threads; num_acceptors++) {
+        if (pthread_create(&acceptors[num_acceptors].thread, NULL, acceptor_thread, &acceptors[num_acceptors]) != 0) {
+            perror("Failed to create acceptor thread");
+            for (int j = num_acceptors; j < num_threads; j++) close(acceptors[j].listen_fd);
+            if (num_acceptors == 0 && acceptors[0].unix_listen_fd >= 0) {
+                close(acceptors[0].unix_listen_fd);
+                unlink(unix_socket_path);
+            }
+            acceptor_shutdown();
+            return 1;
+        }
+    }
+    printf("Server listening on port %d with %d acceptor thread(s), handshake timeout %d ms.\n",
+           port, num_acceptors, handshake_timeout);
+    if (unix_socket_path[0]) printf("Server also listening on unix socket %s.\n", unix_socket_path);
+    return 0;
+}
+
+void acceptor_shutdown() {
+    acceptors_running = 0;
+    for (int i = 0; i < num_acceptors; i++) {
+        pthread_join(acceptors[i].thread, NULL);
+        close(acceptors[i].listen_fd);
+        if (acceptors[i].unix_listen_fd >= 0) close(acceptors[i].unix_listen_fd);
+    }
+    if (num_acceptors > 0 && unix_socket_path[0]) unlink(unix_socket_path);
+    unix_socket_path[0] = '\0';
+    num_acceptors = 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * admin_http.c
+ * /metrics ve yönetim uçları için yerel HTTP dinleyicisi.
+ */
+#include "headers/admin_http.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS: SO_NOSIGPIPE ile sağlanıyor
+#endif
+
+#define ADMIN_HTTP_REQUEST_MAX 4096
+#define ADMIN_HTTP_POLL_INTERVAL_MS 250
+
+typedef struct admin_route {
+    const char *path;
+    const char *content_type;
+    admin_http_handler handler;
+} AdminRoute;
+
+static AdminRoute routes[ADMIN_HTTP_MAX_ROUTES];
+static int num_routes = 0;
+static int admin_listen_fd = -1;
+static pthread_t admin_thread;
+static volatile int admin_running = 0;
+
+int admin_http_register(const char *path, const char *content_type, admin_http_handler handler) {
+    if (num_routes >= ADMIN_HTTP_MAX_ROUTES) {
+        fprintf(stderr, "Admin HTTP route table full, %s not registered.\n", path);
+        return 1;
+    }
+    routes[num_routes].path = path;
+    routes[num_routes].content_type = content_type;
+    routes[num_routes].handler = handler;
+    num_routes++;
+    return 0;
+}
+
+static const char *status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        default: return "Internal Server Error";
+    }
+}
+
+static void send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static void send_response(int fd, int status, const char *content_type, const char *body, size_t body_len) {
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                              status, status_text(status), content_type, body_len);
+    send_all(fd, header, (size_t)header_len);
+    send_all(fd, body, body_len);
+}
+
+/* İstek satırı gelene kadar okur; "GET /path?query HTTP/1.x" dışındaki her şey hata yanıtı alır */
+static void serve_client(int fd) {
+    struct timeval tv = {ADMIN_HTTP_REQUEST_TIMEOUT_MS / 1000, (ADMIN_HTTP_REQUEST_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    char request[ADMIN_HTTP_REQUEST_MAX];
+    size_t len = 0;
+    while (len < sizeof(request) - 1) {
+        ssize_t n = recv(fd, request + len, sizeof(request) - 1 - len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        len += (size_t)n;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) break;
+    }
+    request[len] = '\0';
+    char *line_end = strpbrk(request, "\r\n");
+    if (!line_end) {
+        static const char msg[] = "bad request\n";
+        send_response(fd, 400, "text/plain", msg, sizeof(msg) - 1);
+        return;
+    }
+    *line_end = '\0';
+
+    char *method = request;
+    char *target = strchr(method, ' ');
+    if (!target) {
+        static const char msg[] = "bad request\n";
+        send_response(fd, 400, "text/plain", msg, sizeof(msg) - 1);
+        return;
+    }
+    *target++ = '\0';
+    char *version = strchr(target, ' ');
+    if (version) *version = '\0';
+    if (strcmp(method, "GET") != 0) {
+        static const char msg[] = "only GET is supported\n";
+        send_response(fd, 405, "text/plain", msg, sizeof(msg) - 1);
+        return;
+    }
+    char *query = strchr(target, '?');
+    if (query) *query++ = '\0';
+
+    for (int i = 0; i < num_routes; i++) {
+        if (strcmp(routes[i].path, target) != 0) continue;
+        char *body = NULL;
+        size_t body_len = 0;
+        FILE *out = open_memstream(&body, &body_len);
+        if (!out) {
+            perror("open_memstream");
+            send_response(fd, 500, "text/plain", "", 0);
+            return;
+        }
+        int status = routes[i].handler(out, query ? query : "");
+        fclose(out);
+        send_response(fd, status, routes[i].content_type, body, body_len);
+        free(body);
+        return;
+    }
+    static const char msg[] = "not found\n";
+    send_response(fd, 404, "text/plain", msg, sizeof(msg) - 1);
+}
+
+static void *admin_http_thread(void *args) {
+    (void)args;
+    struct pollfd pfd = {admin_listen_fd, POLLIN, 0};
+    while (admin_running) {
+        int ready = poll(&pfd, 1, ADMIN_HTTP_POLL_INTERVAL_MS);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("admin poll");
+            break;
+        }
+        if (ready == 0) continue;
+        int fd = accept(admin_listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED) perror("admin accept");
+            continue;
+        }
+        serve_client(fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+int admin_http_start(int port) {
+    admin_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (admin_listen_fd < 0) {
+        perror("admin socket");
+        return 1;
+    }
+    int opt = 1;
+    setsockopt(admin_listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // Yönetim uçları sadece aynı makineden erişilebilir
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(admin_listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(admin_listen_fd, 16) < 0) {
+        perror("admin bind/listen");
+        close(admin_listen_fd);
+        admin_listen_fd = -1;
+        return 1;
+    }
+
+    admin_running = 1;
+    if (pthread_create(&admin_thread, NULL, admin_http_thread, NULL) != 0) {
+        perror("Failed to create admin HTTP thread");
+        admin_running = 0;
+        close(admin_listen_fd);
+        admin_listen_fd = -1;
+        return 1;
+    }
+    printf("Admin HTTP endpoint on http://127.0.0.1:%d/\n", port);
+    return 0;
+}
+
+void admin_http_shutdown() {
+    if (!admin_running) return;
+    admin_running = 0;
+    pthread_join(admin_thread, NULL);
+    close(admin_listen_fd);
+    admin_listen_fd = -1;
+}
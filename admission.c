@@ -0,0 +1,184 @@
+/*
+ * admission.c
+ * Drone filosu ve viewer sayısı için kabul sınırları; CPU baskısında önce viewer'lar bırakılır.
+ */
+#include "headers/admission.h"
+#include "headers/metrics.h"
+#include "headers/tick.h"
+#include "headers/simclock.h"
+#include "headers/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+static int max_drones = ADMISSION_DEFAULT_MAX_DRONES;
+static int max_viewers = ADMISSION_DEFAULT_MAX_VIEWERS;
+static int shed_cpu_percent = ADMISSION_DEFAULT_SHED_CPU_PERCENT;
+static atomic_int admitted_drones = 0;
+static atomic_int cpu_pressure = 0;
+
+// Kabul edilmiş viewer'lar, en yeni başta
+static pthread_mutex_t viewers_lock = PTHREAD_MUTEX_INITIALIZER;
+static AdmissionTicket *viewers = NULL;
+static int admitted_viewers = 0;
+static unsigned long long next_viewer_seq = 1;
+
+static long long last_sample_ms = 0;
+static long long last_cpu_ns = 0;
+static unsigned long long last_ticks_skipped = 0;
+static int num_cpus = 1;
+
+static MetricCounter rejected_drones;
+static MetricCounter rejected_viewers;
+static MetricCounter shed_viewers;
+static MetricGauge cpu_percent_gauge;
+
+static long long clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static long long pressure_gauge(void *arg) {
+    (void)arg;
+    return atomic_load(&cpu_pressure);
+}
+
+int admission_init(int drones, int viewers_max, int cpu_percent) {
+    if (drones < 1 || viewers_max < 0 || cpu_percent < 0 || cpu_percent > 100) {
+        fprintf(stderr, "Invalid admission limits (drones >= 1, viewers >= 0, CPU percent 0-100).\n");
+        return 1;
+    }
+    max_drones = drones;
+    max_viewers = viewers_max;
+    shed_cpu_percent = cpu_percent;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    num_cpus = cpus > 0 ? (int)cpus : 1;
+    last_sample_ms = clock_ns(CLOCK_MONOTONIC) / 1000000;
+    last_cpu_ns = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+
+    metrics_register_counter(&rejected_drones, "drone_server_admission_rejected_total", "kind=\"drone\"",
+                             "Handshakes rejected with ERROR_OVERLOADED.");
+    metrics_register_counter(&rejected_viewers, "drone_server_admission_rejected_total", "kind=\"viewer\"",
+                             "Handshakes rejected with ERROR_OVERLOADED.");
+    metrics_register_counter(&shed_viewers, "drone_server_viewers_shed_total", NULL,
+                             "Connected viewers disconnected to relieve CPU pressure.");
+    metrics_register_gauge(&cpu_percent_gauge, "drone_server_cpu_utilization_percent", NULL,
+                           "Process CPU time over the last sample, as a percentage of all online CPUs.");
+    metrics_register_gauge_fn(pressure_gauge, NULL, "drone_server_overloaded", NULL,
+                              "1 while new viewers are refused because of CPU pressure.");
+    printf("Admission: up to %d drones and %d viewers, shedding viewers above %d%% CPU.\n",
+           max_drones, max_viewers, shed_cpu_percent);
+    return 0;
+}
+
+int admission_max_drones() {
+    return max_drones;
+}
+
+int admission_max_viewers() {
+    return max_viewers;
+}
+
+AdmissionResult admission_admit_drone() {
+    int current = atomic_load(&admitted_drones);
+    do {
+        if (current >= max_drones) {
+            metric_counter_add(&rejected_drones, 1);
+            return ADMISSION_FLEET_FULL;
+        }
+    } while (!atomic_compare_exchange_weak(&admitted_drones, &current, current + 1));
+    return ADMISSION_OK;
+}
+
+void admission_release_drone() {
+    atomic_fetch_sub(&admitted_drones, 1);
+}
+
+AdmissionResult admission_admit_viewer(AdmissionTicket *ticket) {
+    AdmissionResult result = ADMISSION_OK;
+    pthread_mutex_lock(&viewers_lock);
+    if (atomic_load(&cpu_pressure)) {
+        result = ADMISSION_CPU_PRESSURE;
+    } else if (admitted_viewers >= max_viewers) {
+        result = ADMISSION_VIEWERS_FULL;
+    } else {
+        ticket->seq = next_viewer_seq++;
+        atomic_init(&ticket->shed, 0);
+        ticket->next = viewers;
+        viewers = ticket;
+        admitted_viewers++;
+    }
+    pthread_mutex_unlock(&viewers_lock);
+    if (result != ADMISSION_OK) metric_counter_add(&rejected_viewers, 1);
+    return result;
+}
+
+void admission_release_viewer(AdmissionTicket *ticket) {
+    pthread_mutex_lock(&viewers_lock);
+    for (AdmissionTicket **link = &viewers; *link; link = &(*link)->next) {
+        if (*link == ticket) {
+            *link = ticket->next;
+            admitted_viewers--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&viewers_lock);
+}
+
+int admission_viewer_shed(AdmissionTicket *ticket) {
+    return atomic_load_explicit(&ticket->shed, memory_order_relaxed);
+}
+
+/* En son kabul edilen ve henüz atılmamış viewer'ı işaretler */
+static void shed_newest_viewer() {
+    pthread_mutex_lock(&viewers_lock);
+    for (AdmissionTicket *t = viewers; t; t = t->next) {
+        if (!atomic_load(&t->shed)) {
+            atomic_store(&t->shed, 1);
+            metric_counter_add(&shed_viewers, 1);
+            LOG_WARN("Admission: CPU pressure, shedding viewer #%llu.\n", t->seq);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&viewers_lock);
+}
+
+void admission_update() {
+    long long now_ms = clock_ns(CLOCK_MONOTONIC) / 1000000;
+    if (now_ms - last_sample_ms < ADMISSION_SAMPLE_INTERVAL_MS) return;
+
+    long long cpu_ns = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+    long long percent = (cpu_ns - last_cpu_ns) / 10000 / ((now_ms - last_sample_ms) * num_cpus);
+    unsigned long long skipped = tick_skipped_total();
+    // Tek tük atlanan tick değil, ölçüm aralığındaki tick'lerin %10'undan fazlası kaybolduysa
+    int falling_behind = (skipped - last_ticks_skipped) * 10 >
+                         (unsigned long long)tick_rate_hz() * (unsigned long long)(now_ms - last_sample_ms) / 1000;
+    last_sample_ms = now_ms;
+    last_cpu_ns = cpu_ns;
+    last_ticks_skipped = skipped;
+    metric_gauge_set(&cpu_percent_gauge, percent);
+
+    int pressure = shed_cpu_percent > 0 && (percent >= shed_cpu_percent || falling_behind);
+    if (pressure != atomic_exchange(&cpu_pressure, pressure)) {
+        LOG_WARN("Admission: %s (CPU %lld%%%s).\n", pressure ? "overloaded, refusing new viewers" : "load back to normal",
+                 percent, falling_behind ? ", ticks skipped" : "");
+    }
+    if (pressure) shed_newest_viewer();
+}
+
+const char *admission_reason(AdmissionResult result) {
+    switch (result) {
+        case ADMISSION_FLEET_FULL: return "fleet_full";
+        case ADMISSION_VIEWERS_FULL: return "viewers_full";
+        case ADMISSION_CPU_PRESSURE: return "cpu_pressure";
+        default: return "ok";
+    }
+}
+
+int admission_retry_after_ms(AdmissionResult result) {
+    int base = result == ADMISSION_FLEET_FULL ? ADMISSION_DRONE_RETRY_MS : ADMISSION_VIEWER_RETRY_MS;
+    return base / 2 + sim_rand() % base;
+}
@@ -1,9 +1,18 @@
+
 #include "headers/globals.h"
 #include "headers/ai.h"
 #include "headers/drone.h"
 #include "headers/survivor.h"
 #include "headers/list.h"
+#include "headers/lock_prof.h"
 #include "headers/coord.h"
+#include "headers/client_conn.h"
+#include "headers/json_writer.h"
+#include "headers/metrics.h"
+#include "headers/trace.h"
+#include "headers/journal.h"
+#include "headers/simclock.h"
+#include "headers/log.h"
 
 #include <limits.h>
 #include <stdio.h>
@@ -14,19 +23,20 @@
 #include <sys/socket.h> // send için (doğrudan kullanılıyorsa)
 #include <json.h> // JSON işlemleri için
 
-// find_closest_idle_drone fonksiyonu önceki mesajdaki gibi kalacak.
+/* Bağlı ve boştaki en yakın drone'u drone->lock tutulmuş olarak döner (yoksa NULL) */
 static Drone *find_closest_idle_drone(Coord target_survivor_coord) {
     Drone *closest_drone_found = NULL;
     int min_distance = INT_MAX;
 
-    pthread_mutex_lock(&drones->lock);
+    PROFILED_LOCK(&drones->lock);
 
     Node *current_node = drones->head;
     while (current_node != NULL) {
         Drone *current_drone = *(Drone**)current_node->data;
         if (current_drone) {
-            pthread_mutex_lock(&current_drone->lock);
-            if (current_drone->status == IDLE) {
+            PROFILED_LOCK(&current_drone->lock);
+            // Bağlantısı kopmuş (RESUME bekleyen) drone'a görev verilmez
+            if (current_drone->status == IDLE && current_drone->session == DRONE_SESSION_ATTACHED) {
                 int dist = abs(current_drone->coord.x - target_survivor_coord.x) +
                            abs(current_drone->coord.y - target_survivor_coord.y);
                 if (dist < min_distance) {
@@ -34,117 +44,160 @@ static Drone *find_closest_idle_drone(Coord target_survivor_coord) {
                     closest_drone_found = current_drone;
                 }
             }
-            pthread_mutex_unlock(&current_drone->lock);
+            PROFILED_UNLOCK(&current_drone->lock);
         }
         current_node = current_node->next;
     }
-    pthread_mutex_unlock(&drones->lock);
+    // Kilit listeden çıkarılmadan alınır: finish_drone_session drone'u serbest bırakmadan önce bu kilidi bekler.
+    // Aradaki sürede oturum kapanmış veya drone görev almış olabilir
+    if (closest_drone_found) {
+        PROFILED_LOCK(&closest_drone_found->lock);
+        if (closest_drone_found->status != IDLE || closest_drone_found->session != DRONE_SESSION_ATTACHED) {
+            PROFILED_UNLOCK(&closest_drone_found->lock);
+            closest_drone_found = NULL;
+        }
+    }
+    PROFILED_UNLOCK(&drones->lock);
 
     return closest_drone_found;
 }
 
 
-void *ai_controller(void *arg) {
-    (void)arg;
-    printf("AI controller thread started.\n");
+/*
+ * Atanamayan survivor'ı tekrar WAITING yapar. Slot bu arada serbest bırakılmışsa
+ * handle artık çözülmez ve dokunulacak bir şey kalmaz.
+ */
+static void release_unassigned_survivor(SurvivorHandle handle) {
+    PROFILED_LOCK(&survivors->lock);
+    Survivor *s = survivor_get(handle);
+    if (s && s->status == ASSIGNED) s->status = WAITING;
+    PROFILED_UNLOCK(&survivors->lock);
+}
 
-    while (1) {
-        Survivor *survivor_to_help = NULL;
-
-        pthread_mutex_lock(&survivors->lock); 
-        Node *current_survivor_node = survivors->tail; 
-        while (current_survivor_node != NULL) {
-            Survivor *s = *(Survivor**)current_survivor_node->data; 
-            if (s && s->status == WAITING) {
-                survivor_to_help = s;
-                survivor_to_help->status = ASSIGNED; 
-                printf("[AI] Oldest Survivor %s at (%d,%d) status set to ASSIGNED.\n",
-                       survivor_to_help->info, survivor_to_help->coord.x, survivor_to_help->coord.y);
-                break; 
-            }
-            current_survivor_node = current_survivor_node->prev; 
+/* En eski bekleyen survivor'a en yakın boştaki drone'u atar; tur başına en fazla bir atama */
+static void ai_dispatch_pass() {
+    // survivors->lock bırakıldıktan sonra işaretçi değil handle ve alanların kopyası kullanılır
+    SurvivorHandle target_handle = SURVIVOR_HANDLE_NONE;
+    int target_id = 0;
+    Coord target_coord = {0, 0};
+    char target_info[sizeof(((Survivor*)0)->info)];
+    long long pass_start = metrics_now_us();
+    long long pass_span = trace_begin();
+
+    PROFILED_LOCK(&survivors->lock); 
+    Node *current_survivor_node = survivors->tail; 
+    while (current_survivor_node != NULL) {
+        Survivor *s = survivor_get(*(SurvivorHandle*)current_survivor_node->data);
+        if (s && s->status == WAITING) {
+            s->status = ASSIGNED; 
+            target_handle = s->handle;
+            target_id = s->id;
+            target_coord = s->coord;
+            memcpy(target_info, s->info, sizeof(target_info));
+            LOG_DEBUG("[AI] Oldest Survivor %s at (%d,%d) status set to ASSIGNED.\n",
+                   target_info, target_coord.x, target_coord.y);
+            break; 
         }
-        pthread_mutex_unlock(&survivors->lock);
-
-        if (survivor_to_help) {
-            Drone *assigned_drone = find_closest_idle_drone(survivor_to_help->coord);
-
-            if (assigned_drone) {
-                pthread_mutex_lock(&assigned_drone->lock);
-
-                assigned_drone->target = survivor_to_help->coord;
-                assigned_drone->status = ON_MISSION; 
-                assigned_drone->current_survivor_target = survivor_to_help;
-
-                printf("[AI] Assigning Drone %d to Survivor %s at (%d,%d). Sending ASSIGN_MISSION msg.\n",
-                       assigned_drone->id, survivor_to_help->info,
-                       survivor_to_help->coord.x, survivor_to_help->coord.y);
-
-                struct json_object *mission_msg = json_object_new_object();
-                json_object_object_add(mission_msg, "type", json_object_new_string("ASSIGN_MISSION"));
-                char mission_id_str[32]; 
-                snprintf(mission_id_str, sizeof(mission_id_str), "M%d-%ldS%s", assigned_drone->id, time(NULL) % 10000, survivor_to_help->info);
-                json_object_object_add(mission_msg, "mission_id", json_object_new_string(mission_id_str));
-                json_object_object_add(mission_msg, "priority", json_object_new_string("high")); 
-                
-                struct json_object *target_coord_obj = json_object_new_object();
-                json_object_object_add(target_coord_obj, "x", json_object_new_int(survivor_to_help->coord.x));
-                json_object_object_add(target_coord_obj, "y", json_object_new_int(survivor_to_help->coord.y));
-                json_object_object_add(mission_msg, "target", target_coord_obj);
-                
-                if (assigned_drone->socket_fd > 0) { 
-                    const char *json_string = json_object_to_json_string_ext(mission_msg, JSON_C_TO_STRING_PLAIN);
-                    if (json_string) {
-                        {
-                            /* Append newline so drone client can parse ASSIGN_MISSION */
-                            char msg_nl[strlen(json_string) + 2];
-                            snprintf(msg_nl, sizeof(msg_nl), "%s\n", json_string);
-                            if (send(assigned_drone->socket_fd, msg_nl, strlen(msg_nl), 0) < 0) {
-                                perror("[AI] Failed to send ASSIGN_MISSION to drone");
-                                // Görev iptal, survivor'ı WAITING yap, drone'u IDLE yap.
-                                // Bu işlemler için ilgili lock'lar alınmalı.
-                                // Şimdilik basitleştirilmiş:
-                                assigned_drone->status = IDLE; 
-                                assigned_drone->current_survivor_target = NULL;
-                                // Survivor'ın durumunu da WAITING'e geri almak lazım (survivors->lock altında)
-                                pthread_mutex_lock(&survivors->lock);
-                                if(survivor_to_help->status == ASSIGNED) survivor_to_help->status = WAITING;
-                                pthread_mutex_unlock(&survivors->lock);
-                            } else {
-                                 printf("[AI] ASSIGN_MISSION sent to Drone %d for survivor %s.\n", assigned_drone->id, survivor_to_help->info);
-                            }
-                        }
-                    } else {
-                        fprintf(stderr, "[AI] Failed to stringify ASSIGN_MISSION JSON for Drone %d\n", assigned_drone->id);
+        current_survivor_node = current_survivor_node->prev; 
+    }
+    PROFILED_UNLOCK(&survivors->lock);
+
+    if (!survivor_handle_is_none(target_handle)) {
+        long long search_span = trace_begin();
+        Drone *assigned_drone = find_closest_idle_drone(target_coord);
+        trace_end("find_closest_idle_drone", search_span);
+
+        if (assigned_drone) {
+            assigned_drone->target = target_coord;
+            assigned_drone->status = ON_MISSION; 
+            assigned_drone->current_survivor_target = target_handle;
+
+            LOG_INFO("[AI] Assigning Drone %d to Survivor %s at (%d,%d). Sending ASSIGN_MISSION msg.\n",
+                   assigned_drone->id, target_info, target_coord.x, target_coord.y);
+
+            char mission_id_str[32]; 
+            snprintf(mission_id_str, sizeof(mission_id_str), "M%d-%ldS%s", assigned_drone->id, (long)(sim_time() % 10000), target_info);
+
+            // ASSIGN_MISSION doğrudan stack tamponuna yazılır (json-c nesnesi kurulmaz)
+            char mission_storage[256];
+            JsonWriter mission_msg;
+            json_writer_init_fixed(&mission_msg, mission_storage, sizeof(mission_storage));
+            jw_object_begin(&mission_msg);
+            jw_kv_string(&mission_msg, "type", "ASSIGN_MISSION");
+            jw_kv_string(&mission_msg, "mission_id", mission_id_str);
+            jw_kv_string(&mission_msg, "priority", "high");
+            jw_key(&mission_msg, "target");
+            jw_object_begin(&mission_msg);
+            jw_kv_int(&mission_msg, "x", target_coord.x);
+            jw_kv_int(&mission_msg, "y", target_coord.y);
+            jw_object_end(&mission_msg);
+            jw_object_end(&mission_msg);
+            /* Append newline so drone client can parse ASSIGN_MISSION */
+            jw_newline(&mission_msg);
+            
+            if (assigned_drone->conn) { 
+                if (!mission_msg.error) {
+                    if (conn_send_control(assigned_drone->conn, mission_msg.buf, mission_msg.len) < 0) {
+                        LOG_RATELIMITED(LOG_LEVEL_WARN, 5, "[AI] Failed to send ASSIGN_MISSION to drone %d\n", assigned_drone->id);
+                        // Görev iptal: drone IDLE'a, survivor WAITING'e döner (drone->lock tutuluyor)
                         assigned_drone->status = IDLE; 
-                        assigned_drone->current_survivor_target = NULL;
-                        pthread_mutex_lock(&survivors->lock);
-                        if(survivor_to_help->status == ASSIGNED) survivor_to_help->status = WAITING;
-                        pthread_mutex_unlock(&survivors->lock);
+                        assigned_drone->current_survivor_target = SURVIVOR_HANDLE_NONE;
+                        release_unassigned_survivor(target_handle);
+                    } else {
+                         LOG_DEBUG("[AI] ASSIGN_MISSION sent to Drone %d for survivor %s.\n", assigned_drone->id, target_info);
+                         metric_counter_add(&server_metrics.messages_out[METRIC_MSG_ASSIGN_MISSION], 1);
+                         journal_log(JOURNAL_SURVIVOR_ASSIGNED, assigned_drone->id_str, target_id,
+                                     target_coord.x, target_coord.y, ON_MISSION, 0);
+                         // Drone görevi bu sürede tamamlamazsa survivor tekrar atanır
+                         strncpy(assigned_drone->mission_id, mission_id_str, sizeof(assigned_drone->mission_id) - 1);
+                         assigned_drone->mission_id[sizeof(assigned_drone->mission_id) - 1] = '\0';
+                         timer_schedule(&assigned_drone->mission_timer, mission_timeout_ms);
                     }
                 } else {
-                    fprintf(stderr, "[AI] Drone %d has invalid socket_fd, cannot send ASSIGN_MISSION.\n", assigned_drone->id);
+                    LOG_ERROR("[AI] Failed to serialize ASSIGN_MISSION JSON for Drone %d\n", assigned_drone->id);
                     assigned_drone->status = IDLE; 
-                    assigned_drone->current_survivor_target = NULL;
-                    pthread_mutex_lock(&survivors->lock);
-                    if(survivor_to_help->status == ASSIGNED) survivor_to_help->status = WAITING;
-                    pthread_mutex_unlock(&survivors->lock);
+                    assigned_drone->current_survivor_target = SURVIVOR_HANDLE_NONE;
+                    release_unassigned_survivor(target_handle);
                 }
-                json_object_put(mission_msg); 
-                
-                // pthread_cond_signal(&assigned_drone->cond); // Client mesajla uyarıldı, bu gereksiz olabilir.
-                
-                pthread_mutex_unlock(&assigned_drone->lock);
+            } else if (assigned_drone->simulated) {
+                // Simüle drone'a mesaj gönderilmez; virtual_drone fazı onu hedefe yürütür
+                strncpy(assigned_drone->mission_id, mission_id_str, sizeof(assigned_drone->mission_id) - 1);
+                assigned_drone->mission_id[sizeof(assigned_drone->mission_id) - 1] = '\0';
+                journal_log(JOURNAL_SURVIVOR_ASSIGNED, assigned_drone->id_str, target_id,
+                            target_coord.x, target_coord.y, ON_MISSION, 0);
             } else {
-                printf("[AI] No idle drone found for survivor %s. Setting status back to WAITING.\n", survivor_to_help->info);
-                pthread_mutex_lock(&survivors->lock); 
-                if(survivor_to_help->status == ASSIGNED) { 
-                    survivor_to_help->status = WAITING;
-                }
-                pthread_mutex_unlock(&survivors->lock);
+                LOG_RATELIMITED(LOG_LEVEL_WARN, 5, "[AI] Drone %d has no connection, cannot send ASSIGN_MISSION.\n", assigned_drone->id);
+                assigned_drone->status = IDLE; 
+                assigned_drone->current_survivor_target = SURVIVOR_HANDLE_NONE;
+                release_unassigned_survivor(target_handle);
             }
+            
+            // pthread_cond_signal(&assigned_drone->cond); // Client mesajla uyarıldı, bu gereksiz olabilir.
+            
+            PROFILED_UNLOCK(&assigned_drone->lock);
+        } else {
+            LOG_DEBUG("[AI] No idle drone found for survivor %s. Setting status back to WAITING.\n", target_info);
+            release_unassigned_survivor(target_handle);
         }
-        sleep(1); 
+    }
+    metric_histogram_record(&server_metrics.ai_pass_us, metrics_now_us() - pass_start);
+    trace_end("ai_pass", pass_span);
+}
+
+/* Sunucu: TICK_PHASE_DISPATCH, AI_DISPATCH_INTERVAL_MS'de bir çalışır */
+void ai_dispatch_tick(unsigned long long tick) {
+    (void)tick;
+    ai_dispatch_pass();
+}
+
+void *ai_controller(void *arg) {
+    (void)arg;
+    printf("AI controller thread started.\n");
+    trace_set_thread_name("ai controller");
+
+    while (1) {
+        ai_dispatch_pass();
+        sim_sleep_ms(AI_DISPATCH_INTERVAL_MS);
     }
     return NULL;
 }
\ No newline at end of file
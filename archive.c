@@ -0,0 +1,192 @@
+/*
+ * archive.c
+ * Kurtarılan survivor'ların sabit kayıtlı dosyaya akıtılması: üreticiler kilitsiz halkaya yazar,
+ * writer thread'i kayıtları toplu olarak dosyanın sonuna ekler ve periyodik fdatasync yapar.
+ */
+#include "headers/archive.h"
+#include "headers/metrics.h"
+#include "headers/mpsc_ring.h"
+#include "headers/simclock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARCHIVE_IDLE_WAIT_MS 10
+
+static MpscRing ring;
+static MpscWriter writer;
+static atomic_int enabled = 0;
+
+static char archive_path[256];
+static int archive_fd = -1;
+static atomic_llong helped_total = 0;
+
+static MetricCounter records_written;
+static MetricCounter records_dropped;
+static MetricCounter write_errors;
+
+/* Boş dosyaya başlık yazar; dolu dosyanın başlığını doğrular ve yarım kalmış son kaydı keser */
+static int prepare_file(int fd, long long *records) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "Archive: cannot stat %s: %s\n", archive_path, strerror(errno));
+        return -1;
+    }
+    if (st.st_size == 0) {
+        ArchiveHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, ARCHIVE_MAGIC, sizeof(hdr.magic));
+        hdr.version = ARCHIVE_VERSION;
+        hdr.record_size = sizeof(ArchiveRecord);
+        hdr.created_ns = sim_realtime_ns();
+        *records = 0;
+        if (mpsc_write_all(fd, &hdr, sizeof(hdr)) != 0) {
+            fprintf(stderr, "Archive: cannot write header of %s: %s\n", archive_path, strerror(errno));
+            return -1;
+        }
+        return 0;
+    }
+
+    ArchiveHeader hdr;
+    if (st.st_size < (off_t)sizeof(hdr) || pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+        memcmp(hdr.magic, ARCHIVE_MAGIC, sizeof(hdr.magic)) != 0 || hdr.version != ARCHIVE_VERSION ||
+        hdr.record_size != sizeof(ArchiveRecord)) {
+        fprintf(stderr, "Archive: %s is not a version %d survivor archive.\n", archive_path, ARCHIVE_VERSION);
+        return -1;
+    }
+    long long payload = (long long)st.st_size - (long long)sizeof(hdr);
+    *records = payload / (long long)sizeof(ArchiveRecord);
+    if (payload % (long long)sizeof(ArchiveRecord) != 0) {
+        off_t whole = (off_t)sizeof(hdr) + (off_t)(*records * (long long)sizeof(ArchiveRecord));
+        fprintf(stderr, "Archive: dropping a torn record at the end of %s.\n", archive_path);
+        if (ftruncate(fd, whole) != 0) {
+            fprintf(stderr, "Archive: cannot truncate %s: %s\n", archive_path, strerror(errno));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int write_batch(const void *batch, int count) {
+    if (mpsc_write_all(archive_fd, batch, (size_t)count * sizeof(ArchiveRecord)) != 0) {
+        perror("Archive write failed");
+        metric_counter_add(&write_errors, 1);
+        metric_counter_add(&records_dropped, (unsigned long long)count);
+        return 1;
+    }
+    metric_counter_add(&records_written, (unsigned long long)count);
+    return 0;
+}
+
+static void sync_file() {
+    if (fdatasync(archive_fd) != 0) {
+        perror("Archive fdatasync failed");
+        metric_counter_add(&write_errors, 1);
+    }
+}
+
+static void finish_writer() {
+    if (fdatasync(archive_fd) != 0) perror("Archive fdatasync failed");
+    close(archive_fd);
+    archive_fd = -1;
+}
+
+static const MpscWriterOps writer_ops = {
+    .thread_name = "archive writer",
+    .batch_max = ARCHIVE_WRITE_BATCH,
+    .sync_interval_ms = ARCHIVE_SYNC_INTERVAL_MS,
+    .idle_wait_ms = ARCHIVE_IDLE_WAIT_MS,
+    .write_batch = write_batch,
+    .sync = sync_file,
+    .finish = finish_writer,
+};
+
+int archive_open(const char *path) {
+    if (strlen(path) >= sizeof(archive_path)) {
+        fprintf(stderr, "Archive path is too long.\n");
+        return 1;
+    }
+    strcpy(archive_path, path);
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Archive: cannot open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    long long existing = 0;
+    if (prepare_file(fd, &existing) != 0) {
+        close(fd);
+        return 1;
+    }
+    archive_fd = fd;
+
+    if (mpsc_ring_init(&ring, ARCHIVE_RING_CAPACITY, sizeof(ArchiveRecord)) != 0) {
+        close(fd);
+        archive_fd = -1;
+        return 1;
+    }
+
+    metrics_register_counter(&records_written, "drone_server_archive_records_total", "result=\"written\"",
+                             "Helped survivor records handed to the archive.");
+    metrics_register_counter(&records_dropped, "drone_server_archive_records_total", "result=\"dropped\"",
+                             "Helped survivor records handed to the archive.");
+    metrics_register_counter(&write_errors, "drone_server_archive_write_errors_total", NULL,
+                             "Failed survivor archive writes and syncs.");
+
+    if (mpsc_writer_start(&writer, &ring, &writer_ops) != 0) {
+        close(fd);
+        archive_fd = -1;
+        free(ring.slots);
+        ring.slots = NULL;
+        return 1;
+    }
+    atomic_store(&enabled, 1);
+    printf("Archive: appending helped survivors to %s (%lld record(s) so far).\n", path, existing);
+    return 0;
+}
+
+void archive_shutdown() {
+    if (!atomic_exchange(&enabled, 0)) return;
+    mpsc_writer_stop(&writer);
+}
+
+int archive_enabled() {
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+long long archive_helped_total() {
+    return atomic_load_explicit(&helped_total, memory_order_relaxed);
+}
+
+void archive_set_helped_total(long long total) {
+    atomic_store(&helped_total, total);
+}
+
+void archive_survivor(const Survivor *s, const char *drone_id, const char *mission_id) {
+    atomic_fetch_add_explicit(&helped_total, 1, memory_order_relaxed);
+    if (!atomic_load_explicit(&enabled, memory_order_relaxed)) return;
+
+    unsigned long long pos;
+    ArchiveRecord *rec = mpsc_ring_reserve(&ring, &pos);
+    if (!rec) {
+        // Writer bir tur geride (disk takıldı): görev tamamlama beklemez, kayıt atılır
+        metric_counter_add(&records_dropped, 1);
+        return;
+    }
+    memset(rec, 0, sizeof(*rec));
+    rec->survivor_id = s->id;
+    rec->x = s->coord.x;
+    rec->y = s->coord.y;
+    rec->discovery_time = s->discovery_time;
+    rec->helped_time = s->helped_time;
+    rec->wait_sec = rec->discovery_time && rec->helped_time ? (int32_t)(rec->helped_time - rec->discovery_time) : 0;
+    rec->helped_ns = sim_realtime_ns();
+    if (drone_id) strncpy(rec->drone_id, drone_id, sizeof(rec->drone_id) - 1);
+    memcpy(rec->info, s->info, sizeof(s->info));
+    if (mission_id) strncpy(rec->mission_id, mission_id, sizeof(rec->mission_id) - 1);
+    mpsc_ring_publish(&ring, rec, pos);
+}
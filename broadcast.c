@@ -0,0 +1,722 @@
+/*
+ * broadcast.c
+ * Simülasyon durumunu tick başına bir kez serialize eder ve tüm viewer'lara
+ * referans sayımlı tek bir tampon olarak dağıtır. Değişen varlıklar delta
+ * olarak, tam durum ise periyodik keyframe'ler halinde yayınlanır.
+ */
+#include "headers/broadcast.h"
+#include "headers/globals.h"
+#include "headers/list.h"
+#include "headers/lock_prof.h"
+#include "headers/drone.h"
+#include "headers/survivor.h"
+#include "headers/map.h"
+#include "headers/shm_world.h"
+#include "headers/metrics.h"
+#include "headers/trace.h"
+#include "headers/simclock.h"
+#include "headers/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+static pthread_mutex_t frame_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t frame_cond;
+static BroadcastFrame current_frame;        /* En son yayınlanan frame */
+static volatile int broadcaster_running = 0;
+
+static int keyframe_interval = BROADCAST_DEFAULT_KEYFRAME_INTERVAL;
+static atomic_int keyframe_requested = 0;
+static atomic_int full_frame_subscriber_count = 0;
+static atomic_int viewport_subscriber_count = 0;
+
+/* Viewer'ların bıraktığı frame tamponları; kararlı durumda tick başına malloc yapılmaz */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static SharedBuffer *buffer_pool[SHARED_BUFFER_POOL_SIZE];
+static int buffer_pool_count = 0;
+
+/* Yayın fazının tick'ler arasında taşıdığı durum; sadece tick scheduler thread'i dokunur */
+static WorldSnapshot snapshots[2];
+static WorldSnapshot *bcast_prev = &snapshots[0], *bcast_cur = &snapshots[1];
+static unsigned long bcast_version = 0;
+static unsigned long bcast_tick = 0;
+// Tick'ler arasında tekrar kullanılan serialize tamponları
+static JsonWriter delta_writer, keyframe_writer;
+
+SharedBuffer *shared_buffer_alloc(size_t capacity, unsigned long version) {
+    SharedBuffer *buf = malloc(sizeof(SharedBuffer) + capacity + 1);
+    if (!buf) {
+        perror("Failed to allocate shared buffer");
+        return NULL;
+    }
+    atomic_init(&buf->refcount, 1);
+    buf->version = version;
+    buf->len = 0;
+    buf->capacity = capacity;
+    buf->pooled = 0;
+    buf->data[0] = '\0';
+    return buf;
+}
+
+/**
+ * @brief Copies a finished writer into a pooled frame buffer, reusing a released one if it fits.
+ * @return Buffer with refcount 1, or NULL on failure.
+ */
+static SharedBuffer *frame_buffer_from_writer(const JsonWriter *w, unsigned long version) {
+    if (w->error) return NULL;
+
+    // Sığan en küçük tamponu seç ki keyframe boyutundakiler delta'lara harcanmasın
+    SharedBuffer *buf = NULL;
+    int best = -1;
+    pthread_mutex_lock(&pool_lock);
+    for (int i = 0; i < buffer_pool_count; i++) {
+        if (buffer_pool[i]->capacity >= w->len &&
+            (best < 0 || buffer_pool[i]->capacity < buffer_pool[best]->capacity)) {
+            best = i;
+        }
+    }
+    if (best >= 0) {
+        buf = buffer_pool[best];
+        buffer_pool[best] = buffer_pool[--buffer_pool_count];
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    if (buf) {
+        atomic_store(&buf->refcount, 1);
+        buf->version = version;
+    } else {
+        // Durum büyüdükçe tekrar kullanılabilmesi için biraz pay bırak
+        buf = shared_buffer_alloc(w->len + w->len / 4 + 1024, version);
+        if (!buf) return NULL;
+        buf->pooled = 1;
+    }
+    memcpy(buf->data, w->buf, w->len);
+    buf->data[w->len] = '\0';
+    buf->len = w->len;
+    return buf;
+}
+
+SharedBuffer *shared_buffer_retain(SharedBuffer *buf) {
+    if (buf) atomic_fetch_add_explicit(&buf->refcount, 1, memory_order_relaxed);
+    return buf;
+}
+
+void shared_buffer_release(SharedBuffer *buf) {
+    if (!buf) return;
+    if (atomic_fetch_sub_explicit(&buf->refcount, 1, memory_order_acq_rel) == 1) {
+        if (buf->pooled) {
+            pthread_mutex_lock(&pool_lock);
+            if (buffer_pool_count < SHARED_BUFFER_POOL_SIZE) {
+                buffer_pool[buffer_pool_count++] = buf;
+                buf = NULL;
+            }
+            pthread_mutex_unlock(&pool_lock);
+        }
+        free(buf);
+    }
+}
+
+void broadcast_frame_release(BroadcastFrame *frame) {
+    if (!frame) return;
+    shared_buffer_release(frame->delta);
+    shared_buffer_release(frame->keyframe);
+    shared_world_release(frame->world);
+    frame->delta = NULL;
+    frame->keyframe = NULL;
+    frame->world = NULL;
+}
+
+static const char *drone_status_str(DroneState status) {
+    return status == IDLE ? "IDLE" : "ON_MISSION";
+}
+
+static const char *survivor_status_str(SurvivorState status) {
+    if (status == WAITING) return "WAITING";
+    if (status == ASSIGNED) return "ASSIGNED";
+    if (status == HELPED) return "HELPED";
+    return "UNKNOWN";
+}
+
+/* Aynı ID'li kopyalarda bağlı oturum (ATTACHED) öne gelir */
+static int compare_drone_snapshots(const void *a, const void *b) {
+    const DroneSnapshot *da = a, *db = b;
+    int cmp = strcmp(da->id_str, db->id_str);
+    if (cmp != 0) return cmp;
+    return (da->session > db->session) - (da->session < db->session);
+}
+
+static int compare_survivor_snapshots(const void *a, const void *b) {
+    int ia = ((const SurvivorSnapshot*)a)->id, ib = ((const SurvivorSnapshot*)b)->id;
+    return (ia > ib) - (ia < ib);
+}
+
+static int ensure_capacity(void **array, int *capacity, int needed, size_t elem_size) {
+    if (needed <= *capacity) return 0;
+    int new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed) new_capacity *= 2;
+    void *grown = realloc(*array, new_capacity * elem_size);
+    if (!grown) {
+        perror("Failed to grow world snapshot");
+        return 1;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * @brief Copies drones and survivors into snap under their list locks.
+ *        The snapshot arrays are reused between ticks and sorted by stable ID.
+ * @return 0 on success, 1 on allocation failure.
+ */
+static int capture_world_snapshot(WorldSnapshot *snap) {
+    snap->map_width = map.width;
+    snap->map_height = map.height;
+    snap->num_drones = 0;
+    snap->num_survivors = 0;
+
+    if (drones) {
+        PROFILED_LOCK(&drones->lock);
+        if (ensure_capacity((void**)&snap->drones, &snap->drones_capacity,
+                            drones->number_of_elements, sizeof(DroneSnapshot)) != 0) {
+            PROFILED_UNLOCK(&drones->lock);
+            return 1;
+        }
+        for (Node *d_node = drones->head; d_node != NULL; d_node = d_node->next) {
+            Drone *d = *(Drone**)d_node->data;
+            if (!d) continue;
+            DroneSnapshot *ds = &snap->drones[snap->num_drones++];
+            PROFILED_LOCK(&d->lock);
+            memcpy(ds->id_str, d->id_str, sizeof(ds->id_str));
+            ds->coord = d->coord;
+            ds->target = d->target;
+            ds->status = d->status;
+            ds->session = d->session;
+            PROFILED_UNLOCK(&d->lock);
+        }
+        PROFILED_UNLOCK(&drones->lock);
+    }
+
+    if (survivors) {
+        PROFILED_LOCK(&survivors->lock);
+        if (ensure_capacity((void**)&snap->survivors, &snap->survivors_capacity,
+                            survivors->number_of_elements, sizeof(SurvivorSnapshot)) != 0) {
+            PROFILED_UNLOCK(&survivors->lock);
+            return 1;
+        }
+        for (Node *s_node = survivors->head; s_node != NULL; s_node = s_node->next) {
+            Survivor *s = survivor_get(*(SurvivorHandle*)s_node->data);
+            if (!s) continue;
+            SurvivorSnapshot *ss = &snap->survivors[snap->num_survivors++];
+            ss->id = s->id;
+            memcpy(ss->info, s->info, sizeof(ss->info));
+            ss->coord = s->coord;
+            ss->status = s->status;
+        }
+        PROFILED_UNLOCK(&survivors->lock);
+    }
+
+    world_snapshot_sort(snap);
+    return 0;
+}
+
+void world_snapshot_sort(WorldSnapshot *snap) {
+    qsort(snap->drones, snap->num_drones, sizeof(DroneSnapshot), compare_drone_snapshots);
+    qsort(snap->survivors, snap->num_survivors, sizeof(SurvivorSnapshot), compare_survivor_snapshots);
+    // Takeover veya ayrılmış oturumun yerine gelen handshake'te eski drone, handler'ı ya da
+    // grace timer'ı onu çıkarana kadar listede kalır; ID başına sadece ilk (bağlı) kopya tutulur
+    int kept = 0;
+    for (int i = 0; i < snap->num_drones; i++) {
+        if (kept > 0 && strcmp(snap->drones[kept - 1].id_str, snap->drones[i].id_str) == 0) continue;
+        if (kept != i) snap->drones[kept] = snap->drones[i];
+        kept++;
+    }
+    snap->num_drones = kept;
+}
+
+static void free_world_snapshot(WorldSnapshot *snap) {
+    free(snap->drones);
+    free(snap->survivors);
+    memset(snap, 0, sizeof(*snap));
+}
+
+/* Broadcaster'ın dizileri tick'ler arasında yeniden kullanıldığı için viewer'lara ayrı bir kopya verilir */
+static SharedWorld *shared_world_copy(const WorldSnapshot *snap) {
+    SharedWorld *world = calloc(1, sizeof(SharedWorld));
+    if (!world) {
+        perror("Failed to allocate shared world");
+        return NULL;
+    }
+    atomic_init(&world->refcount, 1);
+    world->snap.map_width = snap->map_width;
+    world->snap.map_height = snap->map_height;
+    if (ensure_capacity((void**)&world->snap.drones, &world->snap.drones_capacity,
+                        snap->num_drones, sizeof(DroneSnapshot)) != 0 ||
+        ensure_capacity((void**)&world->snap.survivors, &world->snap.survivors_capacity,
+                        snap->num_survivors, sizeof(SurvivorSnapshot)) != 0) {
+        free_world_snapshot(&world->snap);
+        free(world);
+        return NULL;
+    }
+    memcpy(world->snap.drones, snap->drones, snap->num_drones * sizeof(DroneSnapshot));
+    memcpy(world->snap.survivors, snap->survivors, snap->num_survivors * sizeof(SurvivorSnapshot));
+    world->snap.num_drones = snap->num_drones;
+    world->snap.num_survivors = snap->num_survivors;
+    return world;
+}
+
+SharedWorld *shared_world_retain(SharedWorld *world) {
+    if (world) atomic_fetch_add_explicit(&world->refcount, 1, memory_order_relaxed);
+    return world;
+}
+
+void shared_world_release(SharedWorld *world) {
+    if (!world) return;
+    if (atomic_fetch_sub_explicit(&world->refcount, 1, memory_order_acq_rel) == 1) {
+        free_world_snapshot(&world->snap);
+        free(world);
+    }
+}
+
+static void write_coord(JsonWriter *w, const char *key, Coord c) {
+    jw_key(w, key);
+    jw_object_begin(w);
+    jw_kv_int(w, "x", c.x);
+    jw_kv_int(w, "y", c.y);
+    jw_object_end(w);
+}
+
+static void write_drone(JsonWriter *w, const DroneSnapshot *d) {
+    jw_object_begin(w);
+    jw_kv_string(w, "id_str", d->id_str);
+    write_coord(w, "coord", d->coord);
+    write_coord(w, "target", d->target);
+    jw_kv_string(w, "status", drone_status_str(d->status));
+    jw_object_end(w);
+}
+
+static void write_survivor(JsonWriter *w, const SurvivorSnapshot *s) {
+    jw_object_begin(w);
+    jw_kv_int(w, "id", s->id);
+    jw_kv_string(w, "info", s->info);
+    write_coord(w, "coord", s->coord);
+    // Always include survivors; viewer handles HELPED drawing
+    jw_kv_string(w, "status", survivor_status_str(s->status));
+    jw_object_end(w);
+}
+
+/* Viewport akışında mesajın sonuna abone olunan dikdörtgen ve dışarıda kalan varlık sayıları eklenir */
+static void write_viewport_info(JsonWriter *w, const ViewportStream *vs) {
+    jw_key(w, "viewport");
+    jw_object_begin(w);
+    jw_kv_int(w, "x_min", vs->view.x_min);
+    jw_kv_int(w, "y_min", vs->view.y_min);
+    jw_kv_int(w, "x_max", vs->view.x_max);
+    jw_kv_int(w, "y_max", vs->view.y_max);
+    jw_kv_int(w, "zoom", vs->view.zoom);
+    jw_object_end(w);
+    jw_key(w, "outside");
+    jw_object_begin(w);
+    jw_kv_int(w, "drones", vs->outside_drones);
+    jw_kv_int(w, "survivors", vs->outside_survivors);
+    jw_object_end(w);
+}
+
+static void write_keyframe(JsonWriter *w, const WorldSnapshot *snap, unsigned long version, long long timestamp,
+                           const ViewportStream *vs) {
+    jw_object_begin(w);
+    jw_kv_string(w, "type", "SIMULATION_STATE_UPDATE");
+    jw_kv_int(w, "version", (long long)version);
+    jw_kv_int(w, "timestamp", timestamp);
+
+    // Map boyutu
+    jw_key(w, "map_dimensions");
+    jw_object_begin(w);
+    jw_kv_int(w, "width", snap->map_width);
+    jw_kv_int(w, "height", snap->map_height);
+    jw_object_end(w);
+
+    // Droneları ekle
+    jw_key(w, "drones");
+    jw_array_begin(w);
+    for (int i = 0; i < snap->num_drones; i++) write_drone(w, &snap->drones[i]);
+    jw_array_end(w);
+
+    // Survivorları ekle
+    jw_key(w, "survivors");
+    jw_array_begin(w);
+    for (int i = 0; i < snap->num_survivors; i++) write_survivor(w, &snap->survivors[i]);
+    jw_array_end(w);
+
+    if (vs) write_viewport_info(w, vs);
+    jw_object_end(w);
+    jw_newline(w);
+}
+
+void write_simulation_state_update(JsonWriter *w, const WorldSnapshot *snap, unsigned long version, long long timestamp) {
+    write_keyframe(w, snap, version, timestamp, NULL);
+}
+
+static int drone_snapshot_changed(const DroneSnapshot *a, const DroneSnapshot *b) {
+    return a->coord.x != b->coord.x || a->coord.y != b->coord.y ||
+           a->target.x != b->target.x || a->target.y != b->target.y ||
+           a->status != b->status;
+}
+
+static int survivor_snapshot_changed(const SurvivorSnapshot *a, const SurvivorSnapshot *b) {
+    return a->coord.x != b->coord.x || a->coord.y != b->coord.y || a->status != b->status;
+}
+
+/**
+ * @brief Merge pass over two ID-sorted drone arrays. Writes either the changed/new
+ *        drones (removals == 0) or the ids of the vanished ones (removals == 1).
+ * @return Number of entries written.
+ */
+static int write_drone_changes(JsonWriter *w, const WorldSnapshot *prev, const WorldSnapshot *cur, int removals) {
+    int written = 0, i = 0, j = 0;
+    while (i < prev->num_drones || j < cur->num_drones) {
+        int cmp = (i >= prev->num_drones) ? 1 : (j >= cur->num_drones) ? -1
+                : strcmp(prev->drones[i].id_str, cur->drones[j].id_str);
+        if (cmp < 0) {
+            if (removals) { jw_string(w, prev->drones[i].id_str); written++; }
+            i++;
+        } else if (cmp > 0) {
+            if (!removals) { write_drone(w, &cur->drones[j]); written++; }
+            j++;
+        } else {
+            if (!removals && drone_snapshot_changed(&prev->drones[i], &cur->drones[j])) {
+                write_drone(w, &cur->drones[j]);
+                written++;
+            }
+            i++; j++;
+        }
+    }
+    return written;
+}
+
+static int write_survivor_changes(JsonWriter *w, const WorldSnapshot *prev, const WorldSnapshot *cur, int removals) {
+    int written = 0, i = 0, j = 0;
+    while (i < prev->num_survivors || j < cur->num_survivors) {
+        int cmp = (i >= prev->num_survivors) ? 1 : (j >= cur->num_survivors) ? -1
+                : compare_survivor_snapshots(&prev->survivors[i], &cur->survivors[j]);
+        if (cmp < 0) {
+            if (removals) { jw_int(w, prev->survivors[i].id); written++; }
+            i++;
+        } else if (cmp > 0) {
+            if (!removals) { write_survivor(w, &cur->survivors[j]); written++; }
+            j++;
+        } else {
+            if (!removals && survivor_snapshot_changed(&prev->survivors[i], &cur->survivors[j])) {
+                write_survivor(w, &cur->survivors[j]);
+                written++;
+            }
+            i++; j++;
+        }
+    }
+    return written;
+}
+
+/**
+ * @brief Writes the delta between two ID-sorted snapshots as a newline-terminated message.
+ * @return Number of upsert/remove events in the delta.
+ */
+static int write_delta(JsonWriter *w, const WorldSnapshot *prev, const WorldSnapshot *cur,
+                       unsigned long base_version, unsigned long version, long long timestamp,
+                       const ViewportStream *vs) {
+    int changes = 0;
+    jw_object_begin(w);
+    jw_kv_string(w, "type", "SIMULATION_STATE_DELTA");
+    jw_kv_int(w, "version", (long long)version);
+    jw_kv_int(w, "base_version", (long long)base_version);
+    jw_kv_int(w, "timestamp", timestamp);
+
+    jw_key(w, "drones");
+    jw_object_begin(w);
+    jw_key(w, "upsert");
+    jw_array_begin(w);
+    changes += write_drone_changes(w, prev, cur, 0);
+    jw_array_end(w);
+    jw_key(w, "remove");
+    jw_array_begin(w);
+    changes += write_drone_changes(w, prev, cur, 1);
+    jw_array_end(w);
+    jw_object_end(w);
+
+    jw_key(w, "survivors");
+    jw_object_begin(w);
+    jw_key(w, "upsert");
+    jw_array_begin(w);
+    changes += write_survivor_changes(w, prev, cur, 0);
+    jw_array_end(w);
+    jw_key(w, "remove");
+    jw_array_begin(w);
+    changes += write_survivor_changes(w, prev, cur, 1);
+    jw_array_end(w);
+    jw_object_end(w);
+
+    if (vs) write_viewport_info(w, vs);
+    jw_object_end(w);
+    jw_newline(w);
+    return changes;
+}
+
+int broadcaster_init() {
+    // Viewer'lar CLOCK_MONOTONIC ile timeout'lu bekleyecek
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#ifndef __APPLE__
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    int rc = pthread_cond_init(&frame_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (rc != 0) {
+        perror("Failed to initialize broadcaster condition variable");
+        return 1;
+    }
+    memset(&current_frame, 0, sizeof(current_frame));
+    memset(snapshots, 0, sizeof(snapshots));
+    bcast_prev = &snapshots[0];
+    bcast_cur = &snapshots[1];
+    bcast_version = 0;
+    bcast_tick = 0;
+    json_writer_init(&delta_writer, 16 * 1024);
+    json_writer_init(&keyframe_writer, 64 * 1024);
+    broadcaster_running = 1;
+    printf("State broadcaster ready (keyframe every %d broadcasts).\n", keyframe_interval);
+    return 0;
+}
+
+void broadcaster_shutdown() {
+    pthread_mutex_lock(&frame_lock);
+    broadcaster_running = 0;
+    pthread_cond_broadcast(&frame_cond);
+    BroadcastFrame last = current_frame;
+    memset(&current_frame, 0, sizeof(current_frame));
+    pthread_mutex_unlock(&frame_lock);
+    broadcast_frame_release(&last);
+
+    pthread_mutex_lock(&pool_lock);
+    while (buffer_pool_count > 0) free(buffer_pool[--buffer_pool_count]);
+    pthread_mutex_unlock(&pool_lock);
+
+    // Tick scheduler durdurulduktan sonra çağrılır
+    free_world_snapshot(&snapshots[0]);
+    free_world_snapshot(&snapshots[1]);
+    json_writer_free(&delta_writer);
+    json_writer_free(&keyframe_writer);
+}
+
+void broadcaster_set_keyframe_interval(int ticks) {
+    keyframe_interval = ticks > 0 ? ticks : BROADCAST_DEFAULT_KEYFRAME_INTERVAL;
+}
+
+void broadcaster_request_keyframe() {
+    atomic_store(&keyframe_requested, 1);
+}
+
+void broadcaster_full_frame_subscribers(int delta) {
+    atomic_fetch_add(&full_frame_subscriber_count, delta);
+}
+
+void broadcaster_viewport_subscribers(int delta) {
+    atomic_fetch_add(&viewport_subscriber_count, delta);
+}
+
+void broadcaster_tick(unsigned long long sim_tick) {
+    (void)sim_tick;
+    WorldSnapshot *prev = bcast_prev, *cur = bcast_cur;
+
+    long long capture_span = trace_begin();
+    int captured = capture_world_snapshot(cur);
+    trace_end("capture_world_snapshot", capture_span);
+    if (captured != 0) {
+        LOG_RATELIMITED(LOG_LEVEL_ERROR, 5, "[Broadcaster] Failed to capture world snapshot.\n");
+        return;
+    }
+
+    bcast_tick++;
+    int periodic = (bcast_tick % keyframe_interval) == 0;
+    int need_keyframe = periodic || atomic_exchange(&keyframe_requested, 0) ||
+                        atomic_load(&full_frame_subscriber_count) > 0 || bcast_version == 0;
+
+    long long now = (long long)sim_time();
+    json_writer_reset(&delta_writer);
+    long long serialize_start = metrics_now_us();
+    long long serialize_span = trace_begin();
+    int changes = write_delta(&delta_writer, prev, cur, bcast_version, bcast_version + 1, now, NULL);
+    metric_histogram_record(&server_metrics.serialize_delta_us, metrics_now_us() - serialize_start);
+    trace_end("state_delta_build", serialize_span);
+
+    // Hiçbir şey değişmediyse ve keyframe gerekmiyorsa yeni versiyon yayınlanmaz
+    if (changes == 0 && !need_keyframe) return;
+
+    BroadcastFrame frame;
+    frame.version = bcast_version + 1;
+    frame.periodic_keyframe = periodic;
+    frame.delta = frame_buffer_from_writer(&delta_writer, frame.version);
+    frame.keyframe = NULL;
+    frame.world = NULL;
+    if (atomic_load(&viewport_subscriber_count) > 0) frame.world = shared_world_copy(cur);
+    if (need_keyframe) {
+        json_writer_reset(&keyframe_writer);
+        serialize_start = metrics_now_us();
+        serialize_span = trace_begin();
+        write_keyframe(&keyframe_writer, cur, frame.version, now, NULL);
+        metric_histogram_record(&server_metrics.serialize_keyframe_us, metrics_now_us() - serialize_start);
+        trace_end("state_keyframe_build", serialize_span);
+        frame.keyframe = frame_buffer_from_writer(&keyframe_writer, frame.version);
+    }
+
+    if (!frame.delta || (need_keyframe && !frame.keyframe)) {
+        LOG_RATELIMITED(LOG_LEVEL_ERROR, 5, "[Broadcaster] Failed to build state frame.\n");
+        broadcast_frame_release(&frame);
+        if (need_keyframe) atomic_store(&keyframe_requested, 1);
+        return;
+    }
+
+    pthread_mutex_lock(&frame_lock);
+    BroadcastFrame old = current_frame;
+    current_frame = frame;
+    pthread_cond_broadcast(&frame_cond);
+    pthread_mutex_unlock(&frame_lock);
+    broadcast_frame_release(&old);
+
+    bcast_version = frame.version;
+    // Aynı makinedeki --shm viewer'ları için aynı versiyon paylaşımlı belleğe de yazılır
+    shm_world_publish(cur, bcast_version, now);
+    bcast_prev = cur;
+    bcast_cur = prev;
+}
+
+int broadcaster_wait_frame(unsigned long last_version, int timeout_ms, BroadcastFrame *out) {
+    struct timespec deadline;
+#ifndef __APPLE__
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+#else
+    clock_gettime(CLOCK_REALTIME, &deadline);
+#endif
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    int got_frame = 0;
+    pthread_mutex_lock(&frame_lock);
+    while (broadcaster_running && current_frame.version <= last_version) {
+        if (pthread_cond_timedwait(&frame_cond, &frame_lock, &deadline) == ETIMEDOUT) break;
+    }
+    if (broadcaster_running && current_frame.version > last_version) {
+        *out = current_frame;
+        shared_buffer_retain(out->delta);
+        shared_buffer_retain(out->keyframe);
+        shared_world_retain(out->world);
+        got_frame = 1;
+    }
+    pthread_mutex_unlock(&frame_lock);
+    return got_frame;
+}
+
+void viewport_stream_init(ViewportStream *vs, const Viewport *view) {
+    memset(vs, 0, sizeof(*vs));
+    vs->view = *view;
+    json_writer_init(&vs->writer, 4 * 1024);
+}
+
+void viewport_stream_free(ViewportStream *vs) {
+    free_world_snapshot(&vs->sent);
+    free_world_snapshot(&vs->next);
+    json_writer_free(&vs->writer);
+}
+
+void viewport_stream_set_view(ViewportStream *vs, const Viewport *view) {
+    vs->view = *view;
+}
+
+static int viewport_contains(const Viewport *view, Coord c) {
+    return c.x >= view->x_min && c.x <= view->x_max && c.y >= view->y_min && c.y <= view->y_max;
+}
+
+/* Uzak zoom'da aynı z x z bloğundaki küçük hareketler delta üretmez */
+static Coord viewport_quantize(const Viewport *view, Coord c) {
+    if (view->zoom <= 1) return c;
+    return (Coord){c.x - c.x % view->zoom, c.y - c.y % view->zoom};
+}
+
+/**
+ * @brief Copies the entities inside the viewport into vs->next, keeping the ID order
+ *        that the merge-based delta relies on, and counts the ones left outside.
+ * @return 0 on success, 1 on allocation failure.
+ */
+static int viewport_filter(ViewportStream *vs, const WorldSnapshot *world) {
+    WorldSnapshot *out = &vs->next;
+    out->map_width = world->map_width;
+    out->map_height = world->map_height;
+    out->num_drones = 0;
+    out->num_survivors = 0;
+    vs->outside_drones = 0;
+    vs->outside_survivors = 0;
+    if (ensure_capacity((void**)&out->drones, &out->drones_capacity, world->num_drones, sizeof(DroneSnapshot)) != 0 ||
+        ensure_capacity((void**)&out->survivors, &out->survivors_capacity, world->num_survivors, sizeof(SurvivorSnapshot)) != 0) {
+        return 1;
+    }
+    for (int i = 0; i < world->num_drones; i++) {
+        const DroneSnapshot *d = &world->drones[i];
+        if (!viewport_contains(&vs->view, d->coord)) {
+            vs->outside_drones++;
+            continue;
+        }
+        DroneSnapshot *kept = &out->drones[out->num_drones++];
+        *kept = *d;
+        kept->coord = viewport_quantize(&vs->view, d->coord);
+        kept->target = viewport_quantize(&vs->view, d->target);
+    }
+    for (int i = 0; i < world->num_survivors; i++) {
+        const SurvivorSnapshot *s = &world->survivors[i];
+        if (!viewport_contains(&vs->view, s->coord)) {
+            vs->outside_survivors++;
+            continue;
+        }
+        SurvivorSnapshot *kept = &out->survivors[out->num_survivors++];
+        *kept = *s;
+        kept->coord = viewport_quantize(&vs->view, s->coord);
+    }
+    return 0;
+}
+
+int viewport_stream_build(ViewportStream *vs, const WorldSnapshot *world, unsigned long version,
+                          int keyframe, long long timestamp, SharedBuffer **out) {
+    *out = NULL;
+    long long span = trace_begin();
+    if (viewport_filter(vs, world) != 0) {
+        trace_end("viewport_frame_build", span);
+        return -1;
+    }
+    keyframe = keyframe || vs->sent_version == 0;
+
+    json_writer_reset(&vs->writer);
+    if (keyframe) {
+        write_keyframe(&vs->writer, &vs->next, version, timestamp, vs);
+    } else {
+        int changes = write_delta(&vs->writer, &vs->sent, &vs->next, vs->sent_version, version, timestamp, vs);
+        // Sayılar da değişmediyse gönderilecek bir şey yok; viewer'ın zinciri sent_version'da kalır
+        if (changes == 0 && vs->outside_drones == vs->sent_outside_drones &&
+            vs->outside_survivors == vs->sent_outside_survivors) {
+            trace_end("viewport_frame_build", span);
+            return 0;
+        }
+    }
+    *out = frame_buffer_from_writer(&vs->writer, version);
+    trace_end("viewport_frame_build", span);
+    if (!*out) return -1;
+
+    WorldSnapshot tmp = vs->sent; vs->sent = vs->next; vs->next = tmp;
+    vs->sent_outside_drones = vs->outside_drones;
+    vs->sent_outside_survivors = vs->outside_survivors;
+    vs->sent_version = version;
+    return 1;
+}
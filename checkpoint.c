@@ -0,0 +1,417 @@
+/*
+ * checkpoint.c
+ * Dünya durumunun periyodik/talep üzerine atomik olarak diske yazılması ve açılışta mmap ile geri yüklenmesi.
+ */
+#include "headers/checkpoint.h"
+#include "headers/archive.h"
+#include "headers/globals.h"
+#include "headers/lock_prof.h"
+#include "headers/metrics.h"
+#include "headers/simclock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+static char checkpoint_path[256];
+static char checkpoint_tmp_path[sizeof(checkpoint_path) + sizeof(CHECKPOINT_TMP_SUFFIX)];
+static int checkpoint_interval_ms = 0;
+static int enabled = 0;
+static long long last_write_ms = 0;
+
+/* Periyodik yazım (ana thread) ile /checkpoint isteği (admin thread'i) aynı tamponları kullanır */
+static pthread_mutex_t write_lock = PTHREAD_MUTEX_INITIALIZER;
+static CheckpointSurvivor *survivor_recs = NULL;
+static int survivor_recs_capacity = 0;
+static CheckpointDrone *drone_recs = NULL;
+static int drone_recs_capacity = 0;
+
+static MetricCounter checkpoints_written;
+static MetricCounter checkpoints_failed;
+static MetricHistogram checkpoint_us;
+
+static long long wall_monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int ensure_capacity(void **array, int *capacity, int needed, size_t elem_size) {
+    if (needed <= *capacity) return 0;
+    int new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+    void *grown = realloc(*array, new_capacity * elem_size);
+    if (!grown) {
+        perror("Failed to grow checkpoint buffer");
+        return 1;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+int checkpoint_init(const char *path, int interval_sec) {
+    if (strlen(path) >= sizeof(checkpoint_path)) {
+        fprintf(stderr, "Checkpoint path is too long.\n");
+        return 1;
+    }
+    if (interval_sec < 0) {
+        fprintf(stderr, "Checkpoint interval cannot be negative.\n");
+        return 1;
+    }
+    strcpy(checkpoint_path, path);
+    snprintf(checkpoint_tmp_path, sizeof(checkpoint_tmp_path), "%s%s", path, CHECKPOINT_TMP_SUFFIX);
+    checkpoint_interval_ms = interval_sec * 1000;
+    last_write_ms = wall_monotonic_ms();
+
+    metrics_register_counter(&checkpoints_written, "drone_server_checkpoints_total", "result=\"written\"",
+                             "World checkpoints written to disk.");
+    metrics_register_counter(&checkpoints_failed, "drone_server_checkpoints_total", "result=\"failed\"",
+                             "World checkpoints written to disk.");
+    metrics_register_histogram(&checkpoint_us, "drone_server_checkpoint_duration_seconds", NULL,
+                               "Time to copy, write, sync and rename a checkpoint.");
+    enabled = 1;
+    return 0;
+}
+
+int checkpoint_enabled() {
+    return enabled;
+}
+
+static void copy_survivor(CheckpointSurvivor *rec, const Survivor *s) {
+    memset(rec, 0, sizeof(*rec));
+    rec->id = s->id;
+    rec->status = s->status;
+    rec->x = s->coord.x;
+    rec->y = s->coord.y;
+    rec->discovery_time = s->discovery_time;
+    rec->helped_time = s->helped_time;
+    memcpy(rec->info, s->info, sizeof(s->info));
+}
+
+/* Listenin survivor'larını recs'e kopyalar; kopyalanan sayıyı veya -1 döner */
+static int capture_survivors(List *list, CheckpointSurvivor **recs, int *capacity) {
+    if (!list) return 0;
+    PROFILED_LOCK(&list->lock);
+    if (ensure_capacity((void**)recs, capacity, list->number_of_elements, sizeof(CheckpointSurvivor)) != 0) {
+        PROFILED_UNLOCK(&list->lock);
+        return -1;
+    }
+    int n = 0;
+    for (Node *node = list->head; node != NULL; node = node->next) {
+        Survivor *s = survivor_get(*(SurvivorHandle*)node->data);
+        if (s) copy_survivor(&(*recs)[n++], s);
+    }
+    PROFILED_UNLOCK(&list->lock);
+    return n;
+}
+
+/* broadcast.c'deki dünya kopyasıyla aynı kilit sırası: drones->lock, sonra drone->lock */
+static int capture_drones() {
+    if (!drones) return 0;
+    PROFILED_LOCK(&drones->lock);
+    if (ensure_capacity((void**)&drone_recs, &drone_recs_capacity, drones->number_of_elements,
+                        sizeof(CheckpointDrone)) != 0) {
+        PROFILED_UNLOCK(&drones->lock);
+        return -1;
+    }
+    int n = 0;
+    for (Node *node = drones->head; node != NULL; node = node->next) {
+        Drone *d = *(Drone**)node->data;
+        if (!d) continue;
+        PROFILED_LOCK(&d->lock);
+        // Simüle drone'lar --virtual-drones ile yeniden oluşturulur; kapanmış oturum geri gelmez
+        if (d->simulated || d->session == DRONE_SESSION_CLOSED) {
+            PROFILED_UNLOCK(&d->lock);
+            continue;
+        }
+        CheckpointDrone *rec = &drone_recs[n++];
+        memset(rec, 0, sizeof(*rec));
+        memcpy(rec->id_str, d->id_str, sizeof(rec->id_str));
+        rec->id = d->id;
+        rec->status = d->status;
+        rec->x = d->coord.x;
+        rec->y = d->coord.y;
+        rec->target_x = d->target.x;
+        rec->target_y = d->target.y;
+        Survivor *target = survivor_get(d->current_survivor_target);
+        rec->survivor_id = target ? target->id : -1;
+        rec->telemetry_udp = d->telemetry_udp;
+        rec->session_token = d->session_token;
+        rec->telemetry_token = d->telemetry_token;
+        memcpy(rec->mission_id, d->mission_id, sizeof(rec->mission_id));
+        PROFILED_UNLOCK(&d->lock);
+    }
+    PROFILED_UNLOCK(&drones->lock);
+    return n;
+}
+
+static int write_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/* rename'in kalıcı olması için dosyanın bulunduğu dizin de sync edilir */
+static void sync_parent_dir() {
+    char dir_buf[sizeof(checkpoint_path)];
+    strcpy(dir_buf, checkpoint_path);
+    int dfd = open(dirname(dir_buf), O_RDONLY | O_DIRECTORY);
+    if (dfd < 0) return;
+    fsync(dfd);
+    close(dfd);
+}
+
+static int write_file(const CheckpointHeader *hdr) {
+    int fd = open(checkpoint_tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Checkpoint: cannot create %s: %s\n", checkpoint_tmp_path, strerror(errno));
+        return 1;
+    }
+    int failed = write_all(fd, hdr, sizeof(*hdr)) != 0 ||
+                 write_all(fd, survivor_recs, hdr->survivor_count * sizeof(CheckpointSurvivor)) != 0 ||
+                 write_all(fd, drone_recs, hdr->drone_count * sizeof(CheckpointDrone)) != 0 ||
+                 fsync(fd) != 0;
+    if (failed) {
+        fprintf(stderr, "Checkpoint: cannot write %s: %s\n", checkpoint_tmp_path, strerror(errno));
+        close(fd);
+        unlink(checkpoint_tmp_path);
+        return 1;
+    }
+    close(fd);
+    if (rename(checkpoint_tmp_path, checkpoint_path) != 0) {
+        fprintf(stderr, "Checkpoint: cannot rename to %s: %s\n", checkpoint_path, strerror(errno));
+        unlink(checkpoint_tmp_path);
+        return 1;
+    }
+    sync_parent_dir();
+    return 0;
+}
+
+int checkpoint_write(CheckpointStats *stats) {
+    if (!enabled) return 1;
+    pthread_mutex_lock(&write_lock);
+    long long start = metrics_now_us();
+
+    // Drone'lar önce kopyalanır: arada kurtarılan survivor'ın drone'u açılışta boşta başlar
+    int num_drones = capture_drones();
+    int num_survivors = capture_survivors(survivors, &survivor_recs, &survivor_recs_capacity);
+    int num_helped = (int)archive_helped_total();
+    if (num_drones < 0 || num_survivors < 0) {
+        metric_counter_add(&checkpoints_failed, 1);
+        pthread_mutex_unlock(&write_lock);
+        return 1;
+    }
+
+    CheckpointHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, CHECKPOINT_MAGIC, sizeof(hdr.magic));
+    hdr.version = CHECKPOINT_VERSION;
+    hdr.header_size = sizeof(CheckpointHeader);
+    hdr.survivor_record_size = sizeof(CheckpointSurvivor);
+    hdr.drone_record_size = sizeof(CheckpointDrone);
+    hdr.created_ns = sim_realtime_ns();
+    hdr.map_height = map.height;
+    hdr.map_width = map.width;
+    hdr.next_survivor_id = survivor_next_id();
+    hdr.survivor_count = (uint32_t)num_survivors;
+    hdr.helped_total = (uint32_t)num_helped;
+    hdr.drone_count = (uint32_t)num_drones;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (const Bytef*)survivor_recs, num_survivors * sizeof(CheckpointSurvivor));
+    crc = crc32(crc, (const Bytef*)drone_recs, num_drones * sizeof(CheckpointDrone));
+    hdr.payload_crc32 = (uint32_t)crc;
+
+    int failed = write_file(&hdr);
+    long long elapsed = metrics_now_us() - start;
+    pthread_mutex_unlock(&write_lock);
+
+    metric_counter_add(failed ? &checkpoints_failed : &checkpoints_written, 1);
+    metric_histogram_record(&checkpoint_us, elapsed);
+    if (stats) {
+        stats->survivors = num_survivors;
+        stats->helped = num_helped;
+        stats->drones = num_drones;
+        stats->bytes = (long long)sizeof(hdr) + (long long)num_survivors * sizeof(CheckpointSurvivor) +
+                       (long long)num_drones * sizeof(CheckpointDrone);
+        stats->duration_us = elapsed;
+    }
+    return failed;
+}
+
+void checkpoint_periodic() {
+    if (!enabled || checkpoint_interval_ms <= 0) return;
+    long long now = wall_monotonic_ms();
+    if (now - last_write_ms < checkpoint_interval_ms) return;
+    last_write_ms = now;
+    checkpoint_write(NULL);
+}
+
+/* Kayıttan Survivor oluşturur; ID ve zamanlar kayıttakiyle aynıdır */
+static Survivor *survivor_from_record(const CheckpointSurvivor *rec) {
+    Coord coord = { rec->x, rec->y };
+    char info[sizeof(((Survivor*)0)->info)];
+    snprintf(info, sizeof(info), "%.*s", (int)sizeof(info) - 1, rec->info);
+    SurvivorHandle handle = survivor_create(coord, info, rec->discovery_time);
+    if (survivor_handle_is_none(handle)) return NULL;
+    Survivor *s = survivor_get(handle);
+    s->id = rec->id;
+    s->status = (SurvivorState)rec->status;
+    s->helped_time = rec->helped_time;
+    return s;
+}
+
+static int valid_coord(int x, int y) {
+    return x >= 0 && x < map.height && y >= 0 && y < map.width;
+}
+
+/* Liste doluysa add() bekleyeceği için kapasiteyi aşan kayıtlar atlanır; out[i] geri yüklenen survivor veya NULL */
+static int restore_survivors(const CheckpointSurvivor *recs, uint32_t count, Survivor **out) {
+    int restored = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = NULL;
+        if (survivors->number_of_elements >= survivors->capacity) {
+            fprintf(stderr, "Checkpoint: list full, %u survivor(s) not restored.\n", count - i);
+            break;
+        }
+        if (!valid_coord(recs[i].x, recs[i].y)) continue;
+        Survivor *s = survivor_from_record(&recs[i]);
+        if (!s) continue;
+        MapCell *cell = &map.cells[s->coord.x][s->coord.y];
+        if (!cell->survivors || cell->survivors->number_of_elements >= cell->survivors->capacity) {
+            survivor_free(s->handle);
+            continue;
+        }
+        survivors->add(survivors, &s->handle);
+        cell->survivors->add(cell->survivors, &s->handle);
+        out[i] = s;
+        restored++;
+    }
+    return restored;
+}
+
+int checkpoint_restore(checkpoint_drone_restore_fn restore_drone) {
+    if (!enabled) return 0;
+    int fd = open(checkpoint_path, O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            printf("Checkpoint: %s not found, starting with an empty world.\n", checkpoint_path);
+            return 0;
+        }
+        fprintf(stderr, "Checkpoint: cannot open %s: %s\n", checkpoint_path, strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CheckpointHeader)) {
+        fprintf(stderr, "Checkpoint: %s is truncated.\n", checkpoint_path);
+        close(fd);
+        return 1;
+    }
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Checkpoint: mmap %s failed: %s\n", checkpoint_path, strerror(errno));
+        return 1;
+    }
+    long long start = metrics_now_us();
+
+    const CheckpointHeader *hdr = (const CheckpointHeader*)base;
+    const char *payload = (const char*)base + sizeof(CheckpointHeader);
+    // Sürüm 1 kurtarılanları da kaydediyordu; onlar artık bellekte tutulmadığı için atlanır
+    uint32_t helped_records = hdr->version == 1 ? hdr->helped_total : 0;
+    // Sayılar toplanmadan önce genişletilir ki uint32 toplamı sarmasın; dosyaya sığmayan sayılar
+    // çarpılmadan reddedilir
+    size_t survivor_records = (size_t)hdr->survivor_count + helped_records;
+    int counts_fit = survivor_records <= size / sizeof(CheckpointSurvivor) &&
+                     hdr->drone_count <= size / sizeof(CheckpointDrone);
+    size_t payload_size = counts_fit ? survivor_records * sizeof(CheckpointSurvivor) +
+                                       (size_t)hdr->drone_count * sizeof(CheckpointDrone) : 0;
+    const char *error = NULL;
+    if (memcmp(hdr->magic, CHECKPOINT_MAGIC, sizeof(hdr->magic)) != 0 ||
+        (hdr->version != 1 && hdr->version != CHECKPOINT_VERSION) ||
+        hdr->header_size != sizeof(CheckpointHeader) || hdr->survivor_record_size != sizeof(CheckpointSurvivor) ||
+        hdr->drone_record_size != sizeof(CheckpointDrone)) {
+        error = "not a version 1 or 2 checkpoint";
+    } else if (!counts_fit || size != sizeof(CheckpointHeader) + payload_size) {
+        error = "size does not match its record counts";
+    } else if (crc32(crc32(0L, Z_NULL, 0), (const Bytef*)payload, payload_size) != hdr->payload_crc32) {
+        error = "checksum mismatch";
+    } else if (hdr->map_height != map.height || hdr->map_width != map.width) {
+        error = "map size differs from this server";
+    }
+    if (error) {
+        fprintf(stderr, "Checkpoint: %s: %s.\n", checkpoint_path, error);
+        munmap(base, size);
+        return 1;
+    }
+
+    const CheckpointSurvivor *waiting = (const CheckpointSurvivor*)payload;
+    const CheckpointSurvivor *helped = waiting + hdr->survivor_count;
+    const CheckpointDrone *drone_records = (const CheckpointDrone*)(helped + helped_records);
+    size_t table_len = hdr->survivor_count ? hdr->survivor_count : 1;
+    Survivor **restored = calloc(table_len, sizeof(Survivor*));
+    unsigned char *owned = calloc(table_len, 1);   // Görevi bir drone oturumuyla geri gelen survivor'lar
+    if (!restored || !owned) {
+        perror("Failed to allocate checkpoint restore table");
+        free(restored);
+        free(owned);
+        munmap(base, size);
+        return 1;
+    }
+
+    int num_survivors = restore_survivors(waiting, hdr->survivor_count, restored);
+    archive_set_helped_total(hdr->helped_total);
+    int max_id = hdr->next_survivor_id - 1;
+    for (uint32_t i = 0; i < hdr->survivor_count; i++) {
+        if (waiting[i].id > max_id) max_id = waiting[i].id;
+    }
+    for (uint32_t i = 0; i < helped_records; i++) {
+        if (helped[i].id > max_id) max_id = helped[i].id;
+    }
+    survivor_set_next_id(max_id + 1);
+
+    int num_drones = 0;
+    for (uint32_t i = 0; i < hdr->drone_count; i++) {
+        const CheckpointDrone *rec = &drone_records[i];
+        int target_idx = -1;
+        for (uint32_t j = 0; rec->survivor_id >= 0 && j < hdr->survivor_count; j++) {
+            if (restored[j] && restored[j]->id == rec->survivor_id && restored[j]->status == ASSIGNED && !owned[j]) {
+                target_idx = (int)j;
+                break;
+            }
+        }
+        if (restore_drone(rec, target_idx >= 0 ? restored[target_idx] : NULL) == 0) {
+            num_drones++;
+            if (target_idx >= 0) owned[target_idx] = 1;
+        }
+    }
+    // Drone'u geri gelmeyen atanmış survivor'lar AI tarafından tekrar atanabilir
+    for (uint32_t j = 0; j < hdr->survivor_count; j++) {
+        if (restored[j] && restored[j]->status == ASSIGNED && !owned[j]) restored[j]->status = WAITING;
+    }
+    free(restored);
+    free(owned);
+
+    long long elapsed = metrics_now_us() - start;
+    printf("Checkpoint: restored %d survivor(s), %u helped so far and %d drone session(s) from %s in %lld us.\n",
+           num_survivors, hdr->helped_total, num_drones, checkpoint_path, elapsed);
+    munmap(base, size);
+    return 0;
+}
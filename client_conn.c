@@ -0,0 +1,325 @@
+/*
+ * client_conn.c
+ * Bağlantı başına non-blocking çıkış tamponu: kısmi yazmalarda mesaj sınırları
+ * korunur, yavaş viewer'lar handler thread'lerini bloklamaz.
+ */
+#include "headers/client_conn.h"
+#include "headers/metrics.h"
+#include "headers/stream_deflate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <json.h>
+#include <zlib.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS: SO_NOSIGPIPE ile sağlanıyor
+#endif
+
+ClientConn *conn_create(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("Failed to set client socket non-blocking");
+        return NULL;
+    }
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    ClientConn *conn = calloc(1, sizeof(ClientConn));
+    if (!conn) {
+        perror("Failed to allocate client connection");
+        return NULL;
+    }
+    if (pthread_mutex_init(&conn->lock, NULL) != 0) {
+        perror("Failed to initialize client connection mutex");
+        free(conn);
+        return NULL;
+    }
+    conn->fd = fd;
+    return conn;
+}
+
+void conn_destroy(ClientConn *conn) {
+    if (!conn) return;
+    ConnChunk *chunk = conn->head;
+    while (chunk) {
+        ConnChunk *next = chunk->next;
+        shared_buffer_release(chunk->buf);
+        free(chunk);
+        chunk = next;
+    }
+    if (conn->deflate) {
+        deflateEnd(conn->deflate);
+        free(conn->deflate);
+    }
+    free(conn->zbuf);
+    pthread_mutex_destroy(&conn->lock);
+    free(conn);
+}
+
+int conn_enable_deflate(ClientConn *conn) {
+    if (!conn) return -1;
+    z_stream *zs = calloc(1, sizeof(z_stream));
+    if (!zs) {
+        perror("Failed to allocate deflate stream");
+        return -1;
+    }
+    if (deflateInit2(zs, STREAM_DEFLATE_LEVEL, Z_DEFLATED, STREAM_DEFLATE_WINDOW_BITS,
+                     STREAM_DEFLATE_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+        fprintf(stderr, "Failed to initialize deflate stream.\n");
+        free(zs);
+        return -1;
+    }
+    static const char dictionary[] = STREAM_DEFLATE_DICTIONARY;
+    if (deflateSetDictionary(zs, (const Bytef*)dictionary, sizeof(dictionary) - 1) != Z_OK) {
+        fprintf(stderr, "Failed to set deflate dictionary.\n");
+        deflateEnd(zs);
+        free(zs);
+        return -1;
+    }
+    pthread_mutex_lock(&conn->lock);
+    conn->deflate = zs;
+    pthread_mutex_unlock(&conn->lock);
+    return 0;
+}
+
+/*
+ * Baştaki sıkıştırılacak parçaları tek seferde zbuf'a sıkıştırır ve kuyruktan çıkarır.
+ * Son parçada Z_SYNC_FLUSH yapılır: viewer aldığı her byte grubunu hemen açabilir.
+ * conn->lock tutulurken ve zbuf boşken çağrılır.
+ */
+static int deflate_chunks_locked(ClientConn *conn) {
+    z_stream *zs = conn->deflate;
+    size_t raw_total = 0;
+    conn->zbuf_len = conn->zbuf_off = 0;
+    for (int batched = 0; conn->head && conn->head->compress && batched < CONN_MAX_IOV; batched++) {
+        ConnChunk *c = conn->head;
+        int last = !c->next || !c->next->compress || batched + 1 == CONN_MAX_IOV;
+        zs->next_in = (Bytef*)c->buf->data;
+        zs->avail_in = (uInt)c->buf->len;
+        do {
+            if (conn->zbuf_cap - conn->zbuf_len < 256) {
+                size_t new_cap = conn->zbuf_cap ? conn->zbuf_cap * 2 : 16 * 1024;
+                unsigned char *grown = realloc(conn->zbuf, new_cap);
+                if (!grown) {
+                    perror("Failed to grow deflate buffer");
+                    return -1;
+                }
+                conn->zbuf = grown;
+                conn->zbuf_cap = new_cap;
+            }
+            zs->next_out = conn->zbuf + conn->zbuf_len;
+            zs->avail_out = (uInt)(conn->zbuf_cap - conn->zbuf_len);
+            if (deflate(zs, last ? Z_SYNC_FLUSH : Z_NO_FLUSH) == Z_STREAM_ERROR) return -1;
+            conn->zbuf_len = conn->zbuf_cap - zs->avail_out;
+        } while (zs->avail_in > 0 || zs->avail_out == 0);
+
+        raw_total += c->buf->len;
+        conn->queued_bytes -= c->buf->len;
+        conn->head = c->next;
+        if (!conn->head) conn->tail = NULL;
+        shared_buffer_release(c->buf);
+        free(c);
+    }
+    conn->queued_bytes += conn->zbuf_len;
+    metric_counter_add(&server_metrics.viewer_stream_raw_bytes, raw_total);
+    metric_counter_add(&server_metrics.viewer_stream_compressed_bytes, conn->zbuf_len);
+    return 0;
+}
+
+/* 1: zbuf tamamen gönderildi, 0: soket dolu, -1: bağlantı hatası. conn->lock tutulurken çağrılır */
+static int send_deflated_locked(ClientConn *conn) {
+    while (conn->zbuf_off < conn->zbuf_len) {
+        ssize_t sent = send(conn->fd, conn->zbuf + conn->zbuf_off, conn->zbuf_len - conn->zbuf_off, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            conn->error = 1;
+            return -1;
+        }
+        conn->zbuf_off += sent;
+        conn->queued_bytes -= sent;
+        metric_counter_add(&server_metrics.bytes_out, (unsigned long long)sent);
+    }
+    conn->zbuf_len = conn->zbuf_off = 0;
+    return 1;
+}
+
+/* conn->lock tutulurken çağrılır */
+static int flush_locked(ClientConn *conn) {
+    if (conn->error) return -1;
+
+    // Sıkıştırılmış byte'lar bitmeden yeni parça sıkıştırılmaz; kuyrukta bekleyen frame'ler düşürülebilir kalır
+    while (conn->head || conn->zbuf_off < conn->zbuf_len) {
+        if (conn->zbuf_off < conn->zbuf_len) {
+            int rc = send_deflated_locked(conn);
+            if (rc <= 0) return rc;
+            continue;
+        }
+        if (conn->head->compress) {
+            if (deflate_chunks_locked(conn) != 0) {
+                conn->error = 1;
+                return -1;
+            }
+            continue;
+        }
+
+        struct iovec iov[CONN_MAX_IOV];
+        int iov_count = 0;
+        for (ConnChunk *c = conn->head; c && !c->compress && iov_count < CONN_MAX_IOV; c = c->next) {
+            iov[iov_count].iov_base = c->buf->data + c->offset;
+            iov[iov_count].iov_len = c->buf->len - c->offset;
+            iov_count++;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_count;
+        ssize_t sent = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0; // Soket dolu, sonra devam
+            conn->error = 1;
+            return -1;
+        }
+
+        conn->queued_bytes -= sent;
+        metric_counter_add(&server_metrics.bytes_out, (unsigned long long)sent);
+        size_t remaining = (size_t)sent;
+        while (remaining > 0 && conn->head) {
+            ConnChunk *c = conn->head;
+            size_t left = c->buf->len - c->offset;
+            if (remaining < left) {
+                c->offset += remaining;
+                remaining = 0;
+                break;
+            }
+            remaining -= left;
+            conn->head = c->next;
+            if (!conn->head) conn->tail = NULL;
+            shared_buffer_release(c->buf);
+            free(c);
+        }
+    }
+    return 0;
+}
+
+/* conn->lock tutulurken çağrılır; buf referansının sahipliği kuyruğa geçer */
+static int enqueue_locked(ClientConn *conn, SharedBuffer *buf, int droppable) {
+    ConnChunk *chunk = malloc(sizeof(ConnChunk));
+    if (!chunk) {
+        perror("Failed to allocate connection chunk");
+        shared_buffer_release(buf);
+        return -1;
+    }
+    chunk->next = NULL;
+    chunk->buf = buf;
+    chunk->offset = 0;
+    chunk->droppable = droppable;
+    chunk->compress = conn->deflate != NULL;
+    if (conn->tail) conn->tail->next = chunk;
+    else conn->head = chunk;
+    conn->tail = chunk;
+    conn->queued_bytes += buf->len;
+    return 0;
+}
+
+/* Kontrol mesajını kuyruğa ekler ve hemen göndermeyi dener; buf'ın sahipliğini alır */
+static int queue_control(ClientConn *conn, SharedBuffer *buf) {
+    pthread_mutex_lock(&conn->lock);
+    int rc = -1;
+    if (!conn->error) {
+        rc = enqueue_locked(conn, buf, 0);
+        if (rc == 0) rc = flush_locked(conn);
+    } else {
+        shared_buffer_release(buf);
+    }
+    pthread_mutex_unlock(&conn->lock);
+    return rc;
+}
+
+int conn_send_control(ClientConn *conn, const char *data, size_t len) {
+    if (!conn) return -1;
+    SharedBuffer *buf = shared_buffer_alloc(len, 0);
+    if (!buf) return -1;
+    memcpy(buf->data, data, len);
+    buf->data[len] = '\0';
+    buf->len = len;
+    return queue_control(conn, buf);
+}
+
+int conn_send_json(ClientConn *conn, struct json_object *json_obj) {
+    if (!conn || !json_obj) return -1;
+    const char *json_str_raw = json_object_to_json_string_ext(json_obj, JSON_C_TO_STRING_PLAIN);
+    if (!json_str_raw) return -1;
+
+    size_t raw_len = strlen(json_str_raw);
+    SharedBuffer *buf = shared_buffer_alloc(raw_len + 1, 0);
+    if (!buf) return -1;
+    memcpy(buf->data, json_str_raw, raw_len);
+    buf->data[raw_len] = '\n';
+    buf->data[raw_len + 1] = '\0';
+    buf->len = raw_len + 1;
+    return queue_control(conn, buf);
+}
+
+int conn_send_frame(ClientConn *conn, SharedBuffer *frame) {
+    if (!conn || !frame) return -1;
+
+    pthread_mutex_lock(&conn->lock);
+    if (conn->error) {
+        pthread_mutex_unlock(&conn->lock);
+        return -1;
+    }
+
+    int dropped = 0;
+    if (conn->queued_bytes + frame->len > CONN_HIGH_WATER_MARK) {
+        // Gönderimine başlanmamış eski frame'leri at; kısmen gönderilmiş olan mesaj sınırı için kalmalı
+        ConnChunk **link = &conn->head;
+        ConnChunk *prev = NULL;
+        while (*link) {
+            ConnChunk *c = *link;
+            if (c->droppable && c->offset == 0) {
+                *link = c->next;
+                conn->queued_bytes -= c->buf->len;
+                shared_buffer_release(c->buf);
+                free(c);
+                dropped++;
+            } else {
+                prev = c;
+                link = &c->next;
+            }
+        }
+        conn->tail = prev;
+        conn->dropped_frames += dropped;
+    }
+
+    int rc = enqueue_locked(conn, shared_buffer_retain(frame), 1);
+    if (rc == 0) rc = flush_locked(conn);
+    pthread_mutex_unlock(&conn->lock);
+    return rc < 0 ? -1 : dropped;
+}
+
+int conn_flush(ClientConn *conn) {
+    if (!conn) return -1;
+    pthread_mutex_lock(&conn->lock);
+    int rc = flush_locked(conn);
+    pthread_mutex_unlock(&conn->lock);
+    return rc;
+}
+
+size_t conn_pending_bytes(ClientConn *conn) {
+    if (!conn) return 0;
+    pthread_mutex_lock(&conn->lock);
+    size_t pending = conn->queued_bytes;
+    pthread_mutex_unlock(&conn->lock);
+    return pending;
+}
@@ -1,5 +1,9 @@
 #include "headers/drone.h"
 #include "headers/globals.h" 
+#include "headers/lock_prof.h"
+#include "headers/simclock.h"
+#include "headers/archive.h"
+#include "headers/log.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h> 
@@ -12,6 +16,9 @@
  * @param socket_fd The socket file descriptor for communication with this drone.
  * @return Pointer to the newly created Drone object, or NULL on failure.
  */
+int mission_timeout_ms = DRONE_DEFAULT_MISSION_TIMEOUT_MS;
+int session_grace_ms = DRONE_DEFAULT_SESSION_GRACE_MS;
+
 Drone* server_create_drone_instance(int drone_id_numeric, const char* drone_id_string, int socket_fd) {
     Drone *d = (Drone*)malloc(sizeof(Drone));
     if (!d) {
@@ -24,17 +31,26 @@ Drone* server_create_drone_instance(int drone_id_numeric, const char* drone_id_s
     d->id_str[sizeof(d->id_str) - 1] = '\0'; // Null terminate
 
     d->socket_fd = socket_fd;
+    d->conn = NULL;
     d->status = IDLE; 
 
     if (map.height > 0 && map.width > 0) {
-         d->coord = (Coord){ rand() % map.height, rand() % map.width };
+         d->coord = (Coord){ sim_rand() % map.height, sim_rand() % map.width };
     } else {
          d->coord = (Coord){0,0}; 
     }
     d->target = d->coord; 
-    d->current_survivor_target = NULL;
-    d->last_heartbeat_time = time(NULL); 
+    d->current_survivor_target = SURVIVOR_HANDLE_NONE;
+    d->last_heartbeat_time = sim_time();
     memset(d->drone_capabilities, 0, sizeof(d->drone_capabilities));
+    memset(d->mission_id, 0, sizeof(d->mission_id));
+    d->telemetry_udp = 0;
+    d->telemetry_token = 0;
+    d->telemetry_seq = -1;
+    d->registry_next = NULL;
+    d->session = DRONE_SESSION_ATTACHED;
+    d->session_token = 0;
+    d->simulated = 0;
 
     if (pthread_mutex_init(&d->lock, NULL) != 0) {
         perror("Failed to initialize drone instance mutex");
@@ -48,15 +64,66 @@ Drone* server_create_drone_instance(int drone_id_numeric, const char* drone_id_s
         return NULL;
     }
 
-    printf("Server: Created new drone instance for ID %s (Numeric: %d) on socket %d.\n",
-           d->id_str, d->id, socket_fd);
+    LOG_INFO("Server: Created new drone instance for ID %s (Numeric: %d) on socket %d.\n",
+             d->id_str, d->id, socket_fd);
     return d;
 }
 
 void server_cleanup_drone_instance(Drone *d) {
     if (!d) return;
-    printf("Server: Cleaning up drone instance for ID %s (socket %d).\n", d->id_str, d->socket_fd);
+    LOG_INFO("Server: Cleaning up drone instance for ID %s (socket %d).\n", d->id_str, d->socket_fd);
     pthread_cond_destroy(&d->cond);
     pthread_mutex_destroy(&d->lock);
     free(d);
-}
\ No newline at end of file
+}
+
+void drone_release_mission_locked(Drone *drone, JournalReleaseReason reason) {
+    Survivor *s = survivor_get(drone->current_survivor_target);
+    if (s) {
+        journal_log(JOURNAL_SURVIVOR_RELEASED, drone->id_str, s->id, s->coord.x, s->coord.y, WAITING, reason);
+        PROFILED_LOCK(&survivors->lock);
+        if (s->status == ASSIGNED) s->status = WAITING;
+        PROFILED_UNLOCK(&survivors->lock);
+    }
+    drone->status = IDLE;
+    drone->current_survivor_target = SURVIVOR_HANDLE_NONE;
+    drone->mission_id[0] = '\0';
+}
+
+void drone_complete_mission_locked(Drone *drone, int success, const char *mission_id, const char *log_prefix) {
+    if (!success) {
+        // Başarısız görevin survivor'ı ASSIGNED'da kalmasın: AI tarafından tekrar atanır
+        if (!survivor_handle_is_none(drone->current_survivor_target)) {
+            LOG_INFO("%s: Mission %s failed, survivor returned for reassignment.\n", log_prefix,
+                     mission_id ? mission_id : "N/A");
+        }
+        drone_release_mission_locked(drone, JOURNAL_RELEASE_MISSION_FAILED);
+        return;
+    }
+    Survivor *helped_survivor = survivor_get(drone->current_survivor_target);
+    if (helped_survivor) {
+        if (helped_survivor->status != HELPED) {
+            helped_survivor->status = HELPED;
+            helped_survivor->helped_time = (int64_t)sim_time();
+            LOG_INFO("%s: Survivor %s helped. Mission: %s\n", log_prefix,
+                     helped_survivor->info, mission_id ? mission_id : "N/A");
+            journal_log(JOURNAL_SURVIVOR_HELPED, drone->id_str, helped_survivor->id,
+                        helped_survivor->coord.x, helped_survivor->coord.y, HELPED, 0);
+
+            // Remove survivor immediately once helped
+            SurvivorHandle handle = helped_survivor->handle;
+            survivors->removedata(survivors, &handle);
+            Coord sc = helped_survivor->coord;
+            if (sc.x >= 0 && sc.x < map.height && sc.y >= 0 && sc.y < map.width) {
+                if (map.cells[sc.x][sc.y].survivors)
+                    map.cells[sc.x][sc.y].survivors->removedata(map.cells[sc.x][sc.y].survivors, &handle);
+            }
+            // Kurtarılan survivor bellekte tutulmaz: kaydı arşive kopyalanır ve slotu serbest bırakılır
+            archive_survivor(helped_survivor, drone->id_str, drone->mission_id);
+            survivor_free(handle);
+        }
+    }
+    drone->status = IDLE;
+    drone->current_survivor_target = SURVIVOR_HANDLE_NONE;
+    drone->mission_id[0] = '\0';
+}
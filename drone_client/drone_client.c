@@ -7,6 +7,7 @@
 #include <netinet/in.h>
 #include <netinet/tcp.h> // TCP_NODELAY için
 #include <arpa/inet.h>
+#include <sys/un.h>
 #include <time.h>
 #include <pthread.h> 
 #include <json.h>
@@ -18,6 +19,7 @@
 
 #define SERVER_IP "127.0.0.1" 
 #define SERVER_PORT 8080      
+#define SERVER_UNIX_PATH "/tmp/drone_server.sock" // Sunucunun varsayılan Unix soketi
 #define BUFFER_SIZE 1024
 #define RECV_AGGREGATE_BUFFER_SIZE_CLIENT (BUFFER_SIZE * 4)
 #define DRONE_ID_PREFIX "D"  
@@ -36,6 +38,11 @@ typedef struct {
     char current_mission_id[64]; 
     int visible; // 0: görünmez, 1: görünür
     time_t mission_start_time; // Her drone için görev başlama zamanı
+    int telemetry_fd;          // UDP telemetry soketi, -1: STATUS_UPDATE TCP'den gider
+    long long telemetry_token; // HANDSHAKE_ACK'te sunucunun verdiği anahtar
+    long long telemetry_seq;   // Her UDP STATUS_UPDATE'te artar
+    long long session_token;   // Bağlantı koparsa RESUME ile sunulur, 0: oturum yok
+    int session_grace;         // Sunucunun oturumu sakladığı süre (saniye)
 } ClientDroneState;
 
 
@@ -57,6 +64,60 @@ void send_json_to_server(int sock_fd, struct json_object *json_obj, const char*
     }
 }
 
+/* STATUS_UPDATE'i UDP anlaşıldıysa datagram olarak, değilse TCP'den gönderir */
+void send_status_update(ClientDroneState *drone_state, int sock_fd) {
+    struct json_object *status_update_msg = json_object_new_object();
+    json_object_object_add(status_update_msg, "type", json_object_new_string("STATUS_UPDATE"));
+    json_object_object_add(status_update_msg, "drone_id", json_object_new_string(drone_state->drone_id_str));
+    json_object_object_add(status_update_msg, "timestamp", json_object_new_int64(time(NULL)));
+    struct json_object *loc = json_object_new_object();
+    json_object_object_add(loc, "x", json_object_new_int(drone_state->current_pos.x));
+    json_object_object_add(loc, "y", json_object_new_int(drone_state->current_pos.y));
+    json_object_object_add(status_update_msg, "location", loc);
+    json_object_object_add(status_update_msg, "status", json_object_new_string(drone_state->status == IDLE ? "idle" : (drone_state->status == ON_MISSION ? "busy" : "unknown")));
+    json_object_object_add(status_update_msg, "battery", json_object_new_int(drone_state->battery_level));
+    json_object_object_add(status_update_msg, "speed", json_object_new_int(1));
+
+    if (drone_state->telemetry_fd >= 0) {
+        json_object_object_add(status_update_msg, "seq", json_object_new_int64(++drone_state->telemetry_seq));
+        json_object_object_add(status_update_msg, "token", json_object_new_int64(drone_state->telemetry_token));
+        const char *json_str = json_object_to_json_string_ext(status_update_msg, JSON_C_TO_STRING_PLAIN);
+        // Kaybolan datagram önemli değil; bir sonraki güncelleme yerini alır
+        if (send(drone_state->telemetry_fd, json_str, strlen(json_str), 0) < 0 && errno != ECONNREFUSED) {
+            perror("Client: UDP telemetry send failed");
+        }
+    } else {
+        send_json_to_server(sock_fd, status_update_msg, drone_state->drone_id_str);
+    }
+    json_object_put(status_update_msg);
+}
+
+/* HANDSHAKE_ACK'teki config.telemetry'ye göre UDP soketini açar */
+void setup_udp_telemetry(ClientDroneState *drone_state, struct json_object *telemetry_obj) {
+    struct json_object *port_obj, *token_obj;
+    if (!json_object_object_get_ex(telemetry_obj, "port", &port_obj) ||
+        !json_object_object_get_ex(telemetry_obj, "token", &token_obj)) {
+        return;
+    }
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) { perror("Client: UDP socket creation failed"); return; }
+
+    struct sockaddr_in udp_addr;
+    memset(&udp_addr, 0, sizeof(udp_addr));
+    udp_addr.sin_family = AF_INET;
+    udp_addr.sin_port = htons(json_object_get_int(port_obj));
+    inet_pton(AF_INET, SERVER_IP, &udp_addr.sin_addr);
+    if (connect(fd, (struct sockaddr*)&udp_addr, sizeof(udp_addr)) < 0) {
+        perror("Client: UDP connect failed");
+        close(fd);
+        return;
+    }
+    drone_state->telemetry_fd = fd;
+    drone_state->telemetry_token = json_object_get_int64(token_obj);
+    drone_state->telemetry_seq = 0;
+    printf("Drone %s: Sending STATUS_UPDATE over UDP port %d.\n", drone_state->drone_id_str, json_object_get_int(port_obj));
+}
+
 // Düzenli hareket ve doğru zamanlama için glob simulated_time ve timing_factor
 #define MAX_MOVE_SPEED 1      // Her güncellemede maksimum birim hareket
 #define MOVE_INTERVAL_MS 200  // Hareketler arası minimum süre (ms)
@@ -166,19 +227,7 @@ void simulate_movement(ClientDroneState *drone_state, int sock_fd) {
             }
 
             // Her adımda STATUS_UPDATE mesajı gönder
-            struct json_object *status_update_msg = json_object_new_object();
-            json_object_object_add(status_update_msg, "type", json_object_new_string("STATUS_UPDATE"));
-            json_object_object_add(status_update_msg, "drone_id", json_object_new_string(drone_state->drone_id_str));
-            json_object_object_add(status_update_msg, "timestamp", json_object_new_int64(time(NULL)));
-            struct json_object *loc = json_object_new_object();
-            json_object_object_add(loc, "x", json_object_new_int(drone_state->current_pos.x));
-            json_object_object_add(loc, "y", json_object_new_int(drone_state->current_pos.y));
-            json_object_object_add(status_update_msg, "location", loc);
-            json_object_object_add(status_update_msg, "status", json_object_new_string(drone_state->status == IDLE ? "idle" : (drone_state->status == ON_MISSION ? "busy" : "unknown")));
-            json_object_object_add(status_update_msg, "battery", json_object_new_int(drone_state->battery_level));
-            json_object_object_add(status_update_msg, "speed", json_object_new_int(1));
-            send_json_to_server(sock_fd, status_update_msg, drone_state->drone_id_str);
-            json_object_put(status_update_msg);
+            send_status_update(drone_state, sock_fd);
 
             // Hedefe ulaştık mı kontrol et
             if (drone_state->current_pos.x == drone_state->target_pos.x &&
@@ -211,9 +260,104 @@ void simulate_movement(ClientDroneState *drone_state, int sock_fd) {
 }
 
 
+/* Sunucuya TCP veya Unix soketiyle bağlanır; hata durumunda -1 döner */
+static int connect_to_server(const char *drone_id_str, const char *unix_path) {
+    int sock_fd;
+    if (unix_path) {
+        sock_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (sock_fd < 0) { perror("Client: socket creation failed"); return -1; }
+
+        struct sockaddr_un unix_addr;
+        memset(&unix_addr, 0, sizeof(unix_addr));
+        unix_addr.sun_family = AF_UNIX;
+        strncpy(unix_addr.sun_path, unix_path, sizeof(unix_addr.sun_path) - 1);
+
+        printf("Drone %s: Connecting to server at %s...\n", drone_id_str, unix_path);
+        if (connect(sock_fd, (struct sockaddr*)&unix_addr, sizeof(unix_addr)) < 0) {
+            perror("Client: connect failed"); close(sock_fd); return -1;
+        }
+    } else {
+        sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock_fd < 0) { perror("Client: socket creation failed"); return -1; }
+        
+        // Socket ayarlarını optimize et
+        int yes = 1;
+        if (setsockopt(sock_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0) {
+            perror("Client: setsockopt SO_REUSEADDR failed");
+        }
+        
+        // TCP_NODELAY: Nagle algoritmasını devre dışı bırak (küçük paketlerin hemen gönderilmesi için)
+        if (setsockopt(sock_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)) < 0) {
+            perror("Client: setsockopt TCP_NODELAY failed");
+        }
+
+        struct sockaddr_in server_addr;
+        memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(SERVER_PORT);
+        if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
+            perror("Client: inet_pton failed"); close(sock_fd); return -1;
+        }
+
+        printf("Drone %s: Connecting to server %s:%d...\n", drone_id_str, SERVER_IP, SERVER_PORT);
+        if (connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            perror("Client: connect failed"); close(sock_fd); return -1;
+        }
+    }
+    return sock_fd;
+}
+
+static void send_handshake(int sock_fd, const char *drone_id_str, int want_udp_telemetry) {
+    struct json_object *handshake_msg = json_object_new_object();
+    json_object_object_add(handshake_msg, "type", json_object_new_string("HANDSHAKE"));
+    json_object_object_add(handshake_msg, "drone_id", json_object_new_string(drone_id_str));
+    struct json_object *caps = json_object_new_object();
+    json_object_object_add(caps, "max_speed", json_object_new_int(1)); 
+    json_object_object_add(caps, "battery_capacity", json_object_new_int(1000)); 
+    json_object_object_add(caps, "payload", json_object_new_string("aid_package_v2"));
+    json_object_object_add(handshake_msg, "capabilities", caps);
+    if (want_udp_telemetry) {
+        json_object_object_add(handshake_msg, "telemetry", json_object_new_string("udp"));
+    }
+    send_json_to_server(sock_fd, handshake_msg, drone_id_str);
+    json_object_put(handshake_msg); 
+}
+
+/*
+ * Bağlantı koptuğunda sunucunun oturumu sakladığı süre boyunca saniyede bir yeniden bağlanmayı
+ * dener ve RESUME gönderir. Yeni soketi, süre dolarsa -1 döner.
+ */
+static int reconnect_and_resume(ClientDroneState *drone_state, const char *unix_path, int want_udp_telemetry) {
+    if (drone_state->telemetry_fd >= 0) {
+        close(drone_state->telemetry_fd);
+        drone_state->telemetry_fd = -1;   // Yeni HANDSHAKE_ACK telemetry kanalını tekrar kurar
+    }
+    time_t deadline = time(NULL) + drone_state->session_grace;
+    while (time(NULL) < deadline) {
+        sleep(1);
+        int sock_fd = connect_to_server(drone_state->drone_id_str, unix_path);
+        if (sock_fd < 0) continue;
+
+        struct json_object *resume_msg = json_object_new_object();
+        json_object_object_add(resume_msg, "type", json_object_new_string("RESUME"));
+        json_object_object_add(resume_msg, "drone_id", json_object_new_string(drone_state->drone_id_str));
+        json_object_object_add(resume_msg, "session_token", json_object_new_int64(drone_state->session_token));
+        if (want_udp_telemetry) {
+            json_object_object_add(resume_msg, "telemetry", json_object_new_string("udp"));
+        }
+        send_json_to_server(sock_fd, resume_msg, drone_state->drone_id_str);
+        json_object_put(resume_msg);
+        printf("Drone %s: Reconnected, RESUME sent.\n", drone_state->drone_id_str);
+        return sock_fd;
+    }
+    fprintf(stderr, "Drone %s: Could not reconnect within the %d s session grace period.\n",
+            drone_state->drone_id_str, drone_state->session_grace);
+    return -1;
+}
+
 int main(int argc, char *argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <numeric_drone_id>\nExample: %s 1\n", argv[0], argv[0]);
+        fprintf(stderr, "Usage: %s <numeric_drone_id> [--udp] [--unix[=path]]\nExample: %s 1 --udp\n", argv[0], argv[0]);
         return 1;
     }
 
@@ -231,45 +375,33 @@ int main(int argc, char *argv[]) {
     my_drone.target_pos = my_drone.current_pos;
     my_drone.battery_level = 100; 
     memset(my_drone.current_mission_id, 0, sizeof(my_drone.current_mission_id));
-
-    int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock_fd < 0) { perror("Client: socket creation failed"); return 1; }
-    
-    // Socket ayarlarını optimize et
-    int yes = 1;
-    if (setsockopt(sock_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0) {
-        perror("Client: setsockopt SO_REUSEADDR failed");
-    }
-    
-    // TCP_NODELAY: Nagle algoritmasını devre dışı bırak (küçük paketlerin hemen gönderilmesi için)
-    if (setsockopt(sock_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)) < 0) {
-        perror("Client: setsockopt TCP_NODELAY failed");
-    }
-
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(SERVER_PORT);
-    if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
-        perror("Client: inet_pton failed"); close(sock_fd); return 1;
+    my_drone.telemetry_fd = -1;
+    my_drone.telemetry_token = 0;
+    my_drone.telemetry_seq = 0;
+    my_drone.session_token = 0;
+    my_drone.session_grace = 0;
+    // --udp: konum güncellemelerini UDP telemetry kanalından göndermeyi iste
+    // --unix: aynı makinedeki sunucuya loopback TCP yerine Unix soketinden bağlan
+    int want_udp_telemetry = 0;
+    const char *unix_path = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--udp") == 0) {
+            want_udp_telemetry = 1;
+        } else if (strcmp(argv[i], "--unix") == 0) {
+            unix_path = SERVER_UNIX_PATH;
+        } else if (strncmp(argv[i], "--unix=", 7) == 0) {
+            unix_path = argv[i] + 7;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
     }
 
-    printf("Drone %s: Connecting to server %s:%d...\n", my_drone.drone_id_str, SERVER_IP, SERVER_PORT);
-    if (connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("Client: connect failed"); close(sock_fd); return 1;
-    }
+    int sock_fd = connect_to_server(my_drone.drone_id_str, unix_path);
+    if (sock_fd < 0) return 1;
     printf("Drone %s: Connected to server.\n", my_drone.drone_id_str);
 
-    struct json_object *handshake_msg = json_object_new_object();
-    json_object_object_add(handshake_msg, "type", json_object_new_string("HANDSHAKE"));
-    json_object_object_add(handshake_msg, "drone_id", json_object_new_string(my_drone.drone_id_str));
-    struct json_object *caps = json_object_new_object();
-    json_object_object_add(caps, "max_speed", json_object_new_int(1)); 
-    json_object_object_add(caps, "battery_capacity", json_object_new_int(1000)); 
-    json_object_object_add(caps, "payload", json_object_new_string("aid_package_v2"));
-    json_object_object_add(handshake_msg, "capabilities", caps);
-    send_json_to_server(sock_fd, handshake_msg, my_drone.drone_id_str);
-    json_object_put(handshake_msg); 
+    send_handshake(sock_fd, my_drone.drone_id_str, want_udp_telemetry);
 
     time_t last_status_update_time = 0;
     int status_update_interval_secs = 5; 
@@ -282,6 +414,7 @@ int main(int argc, char *argv[]) {
     struct timeval tv;
     int running = 1;
     int handshake_ack_received = 0;
+    int overload_retry_ms = 0; // ERROR_OVERLOADED: sunucunun önerdiği süre kadar bekleyip handshake tekrarlanır
 
     while (running) {
         FD_ZERO(&read_fds);
@@ -308,7 +441,19 @@ int main(int argc, char *argv[]) {
             if (bytes_received <= 0) {
                 if (bytes_received == 0) printf("Drone %s: Server closed connection.\n", my_drone.drone_id_str);
                 else perror("Client: recv error from server");
-                running = 0; continue;
+                close(sock_fd);
+                sock_fd = -1;
+                // Sunucu oturumu saklıyorsa görev kaybolmadan kaldığı yerden devam edilir
+                if (my_drone.session_token != 0 && my_drone.session_grace > 0) {
+                    sock_fd = reconnect_and_resume(&my_drone, unix_path, want_udp_telemetry);
+                }
+                if (sock_fd < 0) {
+                    running = 0; continue;
+                }
+                aggregate_len_client = 0;
+                aggregate_buffer_client[0] = '\0';
+                handshake_ack_received = 0;
+                continue;
             }
             aggregate_len_client += bytes_received;
             aggregate_buffer_client[aggregate_len_client] = '\0';
@@ -333,12 +478,38 @@ int main(int argc, char *argv[]) {
                         if (strcmp(msg_type, "HANDSHAKE_ACK") == 0) {
                             printf("Drone %s: HANDSHAKE_ACK received.\n", my_drone.drone_id_str);
                             handshake_ack_received = 1;
-                            struct json_object *config_obj, *status_interval_obj;
+                            struct json_object *config_obj = NULL, *status_interval_obj;
                             if (json_object_object_get_ex(parsed_json, "config", &config_obj) &&
                                 json_object_object_get_ex(config_obj, "status_update_interval", &status_interval_obj)) {
                                 status_update_interval_secs = json_object_get_int(status_interval_obj);
                                 printf("Drone %s: Status update interval set to %d seconds by server.\n", my_drone.drone_id_str, status_update_interval_secs);
                             }
+                            struct json_object *telemetry_obj;
+                            if (config_obj && json_object_object_get_ex(config_obj, "telemetry", &telemetry_obj)) {
+                                setup_udp_telemetry(&my_drone, telemetry_obj);
+                            }
+                            struct json_object *session_obj, *field_obj;
+                            if (config_obj && json_object_object_get_ex(config_obj, "session", &session_obj)) {
+                                if (json_object_object_get_ex(session_obj, "token", &field_obj))
+                                    my_drone.session_token = json_object_get_int64(field_obj);
+                                if (json_object_object_get_ex(session_obj, "grace_period", &field_obj))
+                                    my_drone.session_grace = json_object_get_int(field_obj);
+                                int resumed = json_object_object_get_ex(session_obj, "resumed", &field_obj) &&
+                                              json_object_get_boolean(field_obj);
+                                const char *kept_mission = json_object_object_get_ex(session_obj, "mission_id", &field_obj) ?
+                                                           json_object_get_string(field_obj) : "";
+                                // Sunucu görevi bıraktıysa (oturum yeni ya da görev zaman aşımına uğradı) drone boşa çıkar
+                                if (my_drone.status == ON_MISSION &&
+                                    (!resumed || strcmp(kept_mission, my_drone.current_mission_id) != 0)) {
+                                    printf("Drone %s: Mission %s was not kept by the server, returning to IDLE.\n",
+                                           my_drone.drone_id_str, my_drone.current_mission_id);
+                                    my_drone.status = IDLE;
+                                    my_drone.target_pos = my_drone.current_pos;
+                                    memset(my_drone.current_mission_id, 0, sizeof(my_drone.current_mission_id));
+                                } else if (resumed) {
+                                    printf("Drone %s: Session resumed.\n", my_drone.drone_id_str);
+                                }
+                            }
                         } else if (strcmp(msg_type, "ASSIGN_MISSION") == 0) {
                             // printf("Drone %s: ASSIGN_MISSION received (raw: %s)\n", my_drone.drone_id_str, single_json_str_client);
                             struct json_object *target_obj, *x_obj, *y_obj, *mission_id_obj_recv;
@@ -379,6 +550,11 @@ int main(int argc, char *argv[]) {
                             fprintf(stderr, "Drone %s: Received ERROR from server: %s (type: %d)\n", my_drone.drone_id_str, err_str ? err_str : "(no msg)", err_type);
                             if (err_type == 1 || err_type == 2) { // handshake veya JSON hatası
                                 running = 0;
+                            } else if (err_type == 5) { // ERROR_OVERLOADED: filo dolu
+                                struct json_object *retry_obj;
+                                overload_retry_ms = json_object_object_get_ex(parsed_json, "retry_after_ms", &retry_obj) ?
+                                                    json_object_get_int(retry_obj) : 5000;
+                                if (overload_retry_ms <= 0) overload_retry_ms = 5000;
                             }
                         }
                     }
@@ -388,6 +564,23 @@ int main(int argc, char *argv[]) {
                 }
                 if(strlen(aggregate_buffer_client) == 0) break; // İşlenecek başka mesaj yoksa iç döngüden çık
             } 
+
+            if (overload_retry_ms > 0 && running) {
+                printf("Drone %s: Server overloaded, retrying handshake in %d ms.\n", my_drone.drone_id_str, overload_retry_ms);
+                close(sock_fd);
+                struct timespec retry_wait = {overload_retry_ms / 1000, (overload_retry_ms % 1000) * 1000000L};
+                nanosleep(&retry_wait, NULL);
+                overload_retry_ms = 0;
+                sock_fd = connect_to_server(my_drone.drone_id_str, unix_path);
+                if (sock_fd < 0) {
+                    running = 0; continue;
+                }
+                send_handshake(sock_fd, my_drone.drone_id_str, want_udp_telemetry);
+                aggregate_len_client = 0;
+                aggregate_buffer_client[0] = '\0';
+                handshake_ack_received = 0;
+                continue;
+            }
         } 
 
         // --- Sadece handshake_ack_received == 1 ise ana drone işlemlerini yap ---
@@ -412,19 +605,7 @@ int main(int argc, char *argv[]) {
         }
 
         if (current_time - last_status_update_time >= status_update_interval_secs && running) {
-            struct json_object *status_update_msg = json_object_new_object();
-            json_object_object_add(status_update_msg, "type", json_object_new_string("STATUS_UPDATE"));
-            json_object_object_add(status_update_msg, "drone_id", json_object_new_string(my_drone.drone_id_str));
-            json_object_object_add(status_update_msg, "timestamp", json_object_new_int64(current_time));
-            struct json_object *loc = json_object_new_object();
-            json_object_object_add(loc, "x", json_object_new_int(my_drone.current_pos.x));
-            json_object_object_add(loc, "y", json_object_new_int(my_drone.current_pos.y));
-            json_object_object_add(status_update_msg, "location", loc);
-            json_object_object_add(status_update_msg, "status", json_object_new_string(my_drone.status == IDLE ? "idle" : (my_drone.status == ON_MISSION ? "busy" : "unknown")));
-            json_object_object_add(status_update_msg, "battery", json_object_new_int(my_drone.battery_level)); 
-            json_object_object_add(status_update_msg, "speed", json_object_new_int(1)); 
-            send_json_to_server(sock_fd, status_update_msg, my_drone.drone_id_str);
-            json_object_put(status_update_msg);
+            send_status_update(&my_drone, sock_fd);
             last_status_update_time = current_time;
         }
         // Check battery depletion
@@ -447,6 +628,7 @@ int main(int argc, char *argv[]) {
     } // while(running)
 
     printf("Drone %s: Disconnecting.\n", my_drone.drone_id_str);
+    if (my_drone.telemetry_fd >= 0) close(my_drone.telemetry_fd);
     close(sock_fd);
     return 0;
 }
\ No newline at end of file
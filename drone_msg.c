@@ -0,0 +1,238 @@
+/*
+ * drone_msg.c
+ * Drone'dan gelen bilinen mesaj şekilleri için şemaya özel hızlı ayrıştırıcı.
+ * json-c nesne ağacı kurmadan byte'lar üzerinde tek geçiş yapar.
+ */
+#include "headers/drone_msg.h"
+#include "headers/journal.h"
+#include <string.h>
+#include <limits.h>
+#include <json.h>
+
+typedef struct {
+    const char *p;
+    const char *end;
+} Cursor;
+
+static void skip_ws(Cursor *c) {
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\r' || *c->p == '\n')) c->p++;
+}
+
+static int expect(Cursor *c, char ch) {
+    skip_ws(c);
+    if (c->p >= c->end || *c->p != ch) return 0;
+    c->p++;
+    return 1;
+}
+
+/* Escape içermeyen string'i yerinde döndürür (tırnaklar hariç). Escape görürse 0. */
+static int read_plain_string(Cursor *c, const char **str, size_t *len) {
+    if (!expect(c, '"')) return 0;
+    const char *start = c->p;
+    while (c->p < c->end && *c->p != '"') {
+        if (*c->p == '\\' || (unsigned char)*c->p < 0x20) return 0;
+        c->p++;
+    }
+    if (c->p >= c->end) return 0;
+    *str = start;
+    *len = c->p - start;
+    c->p++;
+    return 1;
+}
+
+/* Sadece tam sayı kabul edilir; ondalık/üs veya 18 haneden uzun sayılar 0 döner */
+static int read_ll(Cursor *c, long long *value) {
+    skip_ws(c);
+    int negative = 0;
+    if (c->p < c->end && *c->p == '-') { negative = 1; c->p++; }
+    if (c->p >= c->end || *c->p < '0' || *c->p > '9') return 0;
+    long long v = 0;
+    int digits = 0;
+    while (c->p < c->end && *c->p >= '0' && *c->p <= '9') {
+        if (++digits > 18) return 0;
+        v = v * 10 + (*c->p - '0');
+        c->p++;
+    }
+    if (c->p < c->end && (*c->p == '.' || *c->p == 'e' || *c->p == 'E')) return 0;
+    *value = negative ? -v : v;
+    return 1;
+}
+
+static int read_int(Cursor *c, int *value) {
+    long long v;
+    if (!read_ll(c, &v) || v > INT_MAX || v < INT_MIN) return 0;
+    *value = (int)v;
+    return 1;
+}
+
+/* Bilinmeyen alanların skaler değerlerini atlar; nesne/dizi değerlerde 0 döner */
+static int skip_scalar(Cursor *c) {
+    skip_ws(c);
+    if (c->p >= c->end) return 0;
+    char ch = *c->p;
+    if (ch == '"') {
+        c->p++;
+        while (c->p < c->end && *c->p != '"') {
+            if (*c->p == '\\') c->p++;
+            c->p++;
+        }
+        if (c->p >= c->end) return 0;
+        c->p++;
+        return 1;
+    }
+    if (ch == '-' || (ch >= '0' && ch <= '9')) {
+        c->p++;
+        while (c->p < c->end && ((*c->p >= '0' && *c->p <= '9') || *c->p == '.' ||
+                                 *c->p == 'e' || *c->p == 'E' || *c->p == '+' || *c->p == '-')) c->p++;
+        return 1;
+    }
+    static const char *literals[] = {"true", "false", "null"};
+    for (size_t i = 0; i < sizeof(literals) / sizeof(literals[0]); i++) {
+        size_t n = strlen(literals[i]);
+        if ((size_t)(c->end - c->p) >= n && memcmp(c->p, literals[i], n) == 0) {
+            c->p += n;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#define KEY_IS(k, klen, lit) ((klen) == sizeof(lit) - 1 && memcmp((k), (lit), sizeof(lit) - 1) == 0)
+
+static void set_status(DroneMessage *out, const char *s, size_t len) {
+    if (KEY_IS(s, len, "idle")) {
+        out->status = IDLE;
+        out->has_status = 1;
+    } else if (KEY_IS(s, len, "busy") || KEY_IS(s, len, "on_mission")) {
+        out->status = ON_MISSION;
+        out->has_status = 1;
+    }
+}
+
+static int read_location(Cursor *c, DroneMessage *out) {
+    if (!expect(c, '{')) return 0;
+    skip_ws(c);
+    if (c->p < c->end && *c->p == '}') { c->p++; return 1; }
+    for (;;) {
+        const char *key; size_t klen;
+        if (!read_plain_string(c, &key, &klen) || !expect(c, ':')) return 0;
+        if (KEY_IS(key, klen, "x")) {
+            if (!read_int(c, &out->location.x)) return 0;
+            out->has_location_x = 1;
+        } else if (KEY_IS(key, klen, "y")) {
+            if (!read_int(c, &out->location.y)) return 0;
+            out->has_location_y = 1;
+        } else if (!skip_scalar(c)) {
+            return 0;
+        }
+        skip_ws(c);
+        if (c->p < c->end && *c->p == ',') { c->p++; continue; }
+        return expect(c, '}');
+    }
+}
+
+int drone_msg_parse_fast(const char *json, size_t len, DroneMessage *out) {
+    Cursor c = {json, json + len};
+    memset(out, 0, sizeof(*out));
+
+    if (!expect(&c, '{')) return 0;
+    skip_ws(&c);
+    if (c.p < c.end && *c.p == '}') return 0; // Tipsiz mesaj: yavaş yol hata mesajını versin
+    for (;;) {
+        const char *key; size_t klen;
+        if (!read_plain_string(&c, &key, &klen) || !expect(&c, ':')) return 0;
+
+        if (KEY_IS(key, klen, "type")) {
+            const char *v; size_t vlen;
+            if (!read_plain_string(&c, &v, &vlen)) return 0;
+            if (KEY_IS(v, vlen, "STATUS_UPDATE")) out->type = DRONE_MSG_STATUS_UPDATE;
+            else if (KEY_IS(v, vlen, "HEARTBEAT_RESPONSE")) out->type = DRONE_MSG_HEARTBEAT_RESPONSE;
+            else return 0;
+        } else if (KEY_IS(key, klen, "drone_id")) {
+            const char *v; size_t vlen;
+            if (!read_plain_string(&c, &v, &vlen) || vlen >= sizeof(out->drone_id)) return 0;
+            memcpy(out->drone_id, v, vlen);
+            out->drone_id[vlen] = '\0';
+            out->has_drone_id = 1;
+        } else if (KEY_IS(key, klen, "location")) {
+            if (!read_location(&c, out)) return 0;
+        } else if (KEY_IS(key, klen, "status")) {
+            const char *v; size_t vlen;
+            if (!read_plain_string(&c, &v, &vlen)) return 0;
+            out->has_status = 0;
+            set_status(out, v, vlen);
+        } else if (KEY_IS(key, klen, "battery")) {
+            if (!read_int(&c, &out->battery)) return 0;
+            out->has_battery = 1;
+        } else if (KEY_IS(key, klen, "seq")) {
+            if (!read_ll(&c, &out->seq)) return 0;
+            out->has_seq = 1;
+        } else if (KEY_IS(key, klen, "token")) {
+            if (!read_ll(&c, &out->token)) return 0;
+            out->has_token = 1;
+        } else if (!skip_scalar(&c)) {
+            return 0;
+        }
+
+        skip_ws(&c);
+        if (c.p < c.end && *c.p == ',') { c.p++; continue; }
+        if (!expect(&c, '}')) return 0;
+        break;
+    }
+    skip_ws(&c);
+    return c.p == c.end && out->type != DRONE_MSG_OTHER;
+}
+
+void drone_msg_from_json(struct json_object *parsed_json, DroneMessage *out) {
+    memset(out, 0, sizeof(*out));
+    struct json_object *obj;
+    if (json_object_object_get_ex(parsed_json, "type", &obj)) {
+        const char *type = json_object_get_string(obj);
+        if (type && strcmp(type, "STATUS_UPDATE") == 0) out->type = DRONE_MSG_STATUS_UPDATE;
+        else if (type && strcmp(type, "HEARTBEAT_RESPONSE") == 0) out->type = DRONE_MSG_HEARTBEAT_RESPONSE;
+    }
+    if (json_object_object_get_ex(parsed_json, "drone_id", &obj)) {
+        const char *id = json_object_get_string(obj);
+        // Sığmayan ID kesilip yanlışlıkla eşleşmesin diye hiç alınmaz
+        if (id && strlen(id) < sizeof(out->drone_id)) {
+            strcpy(out->drone_id, id);
+            out->has_drone_id = 1;
+        }
+    }
+    if (json_object_object_get_ex(parsed_json, "location", &obj)) {
+        struct json_object *x_obj, *y_obj;
+        if (json_object_object_get_ex(obj, "x", &x_obj)) {
+            out->location.x = json_object_get_int(x_obj);
+            out->has_location_x = 1;
+        }
+        if (json_object_object_get_ex(obj, "y", &y_obj)) {
+            out->location.y = json_object_get_int(y_obj);
+            out->has_location_y = 1;
+        }
+    }
+    if (json_object_object_get_ex(parsed_json, "status", &obj)) {
+        const char *status = json_object_get_string(obj);
+        if (status) set_status(out, status, strlen(status));
+    }
+    if (json_object_object_get_ex(parsed_json, "battery", &obj)) {
+        out->battery = json_object_get_int(obj);
+        out->has_battery = 1;
+    }
+    if (json_object_object_get_ex(parsed_json, "seq", &obj)) {
+        out->seq = json_object_get_int64(obj);
+        out->has_seq = 1;
+    }
+    if (json_object_object_get_ex(parsed_json, "token", &obj)) {
+        out->token = json_object_get_int64(obj);
+        out->has_token = 1;
+    }
+}
+
+void drone_msg_apply_status(Drone *drone, const DroneMessage *msg) {
+    if (msg->has_location_x) drone->coord.x = msg->location.x;
+    if (msg->has_location_y) drone->coord.y = msg->location.y;
+    if (msg->has_status && msg->status != drone->status) {
+        journal_log(JOURNAL_DRONE_STATUS, drone->id_str, -1, drone->coord.x, drone->coord.y, msg->status, drone->status);
+        drone->status = msg->status;
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * drone_registry.c
+ * drone_id ile sabit zamanlı drone araması; kova grupları ayrı kilitlerle korunur.
+ */
+#include "headers/drone_registry.h"
+#include "headers/lock_prof.h"
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+
+static Drone *buckets[DRONE_REGISTRY_BUCKETS];
+static pthread_mutex_t stripes[DRONE_REGISTRY_STRIPES];
+static pthread_once_t stripes_once = PTHREAD_ONCE_INIT;
+static atomic_int registered_count = 0;
+
+static void init_stripes() {
+    for (int i = 0; i < DRONE_REGISTRY_STRIPES; i++) pthread_mutex_init(&stripes[i], NULL);
+}
+
+/* FNV-1a */
+static unsigned int bucket_of(const char *id_str) {
+    unsigned int hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char*)id_str; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash & (DRONE_REGISTRY_BUCKETS - 1);
+}
+
+static pthread_mutex_t *stripe_of(unsigned int bucket) {
+    pthread_once(&stripes_once, init_stripes);
+    return &stripes[bucket % DRONE_REGISTRY_STRIPES];
+}
+
+DroneRegistryResult drone_registry_insert(Drone *drone, int takeover, long long session_token) {
+    unsigned int b = bucket_of(drone->id_str);
+    pthread_mutex_t *stripe = stripe_of(b);
+    DroneRegistryResult result = DRONE_REGISTRY_INSERTED;
+
+    PROFILED_LOCK(stripe);
+    Drone **link = &buckets[b];
+    while (*link && strcmp((*link)->id_str, drone->id_str) != 0) link = &(*link)->registry_next;
+    if (*link) {
+        // Eski drone kayıtta olduğu sürece serbest bırakılamaz; kilidi burada güvenle alınır
+        Drone *old = *link;
+        PROFILED_LOCK(&old->lock);
+        int attached = old->session == DRONE_SESSION_ATTACHED;
+        if (attached && !takeover) {
+            PROFILED_UNLOCK(&old->lock);
+            PROFILED_UNLOCK(stripe);
+            return DRONE_REGISTRY_DUPLICATE;
+        }
+        if (attached && old->session_token != session_token) {
+            // Token'ı bilmeyen istemci canlı oturumu düşüremez
+            PROFILED_UNLOCK(&old->lock);
+            PROFILED_UNLOCK(stripe);
+            return DRONE_REGISTRY_TAKEOVER_DENIED;
+        }
+        if (attached) {
+            // Handler soketi kapanınca oturumu ayırmak yerine drone'u tamamen temizler
+            old->session = DRONE_SESSION_CLOSED;
+            shutdown(old->socket_fd, SHUT_RDWR);
+            result = DRONE_REGISTRY_TOOK_OVER;
+        } else if (old->session == DRONE_SESSION_DETACHED) {
+            // RESUME yerine yeni HANDSHAKE geldi: ayrılmış oturum beklemeden kapatılır
+            timer_schedule(&old->grace_timer, 0);
+            result = DRONE_REGISTRY_REPLACED_DETACHED;
+        }
+        PROFILED_UNLOCK(&old->lock);
+        *link = old->registry_next;
+        old->registry_next = NULL;
+        atomic_fetch_sub(&registered_count, 1);
+    }
+    drone->registry_next = buckets[b];
+    buckets[b] = drone;
+    atomic_fetch_add(&registered_count, 1);
+    PROFILED_UNLOCK(stripe);
+    return result;
+}
+
+void drone_registry_remove(Drone *drone) {
+    unsigned int b = bucket_of(drone->id_str);
+    pthread_mutex_t *stripe = stripe_of(b);
+
+    PROFILED_LOCK(stripe);
+    for (Drone **link = &buckets[b]; *link; link = &(*link)->registry_next) {
+        if (*link == drone) {
+            *link = drone->registry_next;
+            drone->registry_next = NULL;
+            atomic_fetch_sub(&registered_count, 1);
+            break;
+        }
+    }
+    PROFILED_UNLOCK(stripe);
+}
+
+Drone *drone_registry_acquire(const char *id_str) {
+    unsigned int b = bucket_of(id_str);
+    pthread_mutex_t *stripe = stripe_of(b);
+
+    PROFILED_LOCK(stripe);
+    Drone *d = buckets[b];
+    while (d && strcmp(d->id_str, id_str) != 0) d = d->registry_next;
+    // Kova kilidi bırakılmadan drone kilitlenir: remove + drone->lock sırası free'yi bekletir
+    if (d) PROFILED_LOCK(&d->lock);
+    PROFILED_UNLOCK(stripe);
+    return d;
+}
+
+int drone_registry_count() {
+    return atomic_load(&registered_count);
+}
@@ -0,0 +1,21 @@
+#ifndef ACCEPTOR_H
+#define ACCEPTOR_H
+
+#define ACCEPTOR_DEFAULT_HANDSHAKE_TIMEOUT_MS 5000 // Bu sürede handshake satırı gelmezse bağlantı kapatılır
+#define ACCEPTOR_MAX_THREADS 16
+#define ACCEPTOR_MAX_PENDING 4096                  // Thread başına handshake bekleyen en fazla bağlantı
+#define ACCEPTOR_POLL_INTERVAL_MS 250              // Kapanış ve timeout kontrol aralığı
+#define ACCEPTOR_DEFAULT_UNIX_PATH "/tmp/drone_server.sock" // Aynı makinedeki istemciler için
+
+/*
+ * Non-blocking accept + handshake hattı. Her acceptor thread kendi dinleme soketini
+ * (birden fazla thread varsa SO_REUSEPORT ile) ve handshake'ini henüz göndermemiş
+ * bağlantıları tek bir poll() döngüsünde yönetir. İlk satır geldiğinde mesaj tipine göre
+ * drone veya viewer handler thread'i başlatılır; yavaş bir istemci diğerlerini bekletmez.
+ * unix_path verilirse ilk acceptor aynı protokolü bir AF_UNIX stream soketinde de dinler.
+ */
+int acceptor_start(int port, const char *unix_path, int num_threads, int handshake_timeout_ms);
+/* Acceptor thread'lerini durdurur, dinleme soketlerini ve bekleyen bağlantıları kapatır */
+void acceptor_shutdown();
+
+#endif
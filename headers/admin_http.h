@@ -0,0 +1,22 @@
+#ifndef ADMIN_HTTP_H
+#define ADMIN_HTTP_H
+
+#include <stdio.h>
+
+#define ADMIN_HTTP_DEFAULT_PORT 9100
+#define ADMIN_HTTP_MAX_ROUTES 16
+#define ADMIN_HTTP_REQUEST_TIMEOUT_MS 1000   // İsteğini bu sürede tamamlamayan bağlantı kapatılır
+
+/*
+ * Sadece 127.0.0.1'de dinleyen küçük HTTP/1.0 sunucusu (GET, Connection: close).
+ * Metrik toplama ve yönetim komutları içindir; istekler tek thread'de sırayla işlenir.
+ * Handler yanıt gövdesini out'a yazar ve HTTP durum kodunu döner.
+ */
+typedef int (*admin_http_handler)(FILE *out, const char *query);
+
+/* admin_http_start'tan önce çağrılmalıdır */
+int admin_http_register(const char *path, const char *content_type, admin_http_handler handler);
+int admin_http_start(int port);
+void admin_http_shutdown();
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stdatomic.h>
+
+#define ADMISSION_DEFAULT_MAX_DRONES 50
+#define ADMISSION_DEFAULT_MAX_VIEWERS 10
+#define ADMISSION_DEFAULT_SHED_CPU_PERCENT 90   // 0: CPU baskısında viewer atılmaz
+#define ADMISSION_SAMPLE_INTERVAL_MS 1000       // Yük ölçümü ve en fazla bir viewer atma aralığı
+#define ADMISSION_DRONE_RETRY_MS 5000           // Filo doluyken önerilen bekleme (±%50 rastgele)
+#define ADMISSION_VIEWER_RETRY_MS 10000         // Viewer reddi/atılmasında önerilen bekleme (±%50 rastgele)
+
+/*
+ * Bağlantı kabul sınırları. Drone'lar öncelikli: sadece filo boyutuyla sınırlanır.
+ * Viewer'lar hem sayıyla sınırlanır hem de CPU baskısında (süreç CPU kullanımı eşiği
+ * aşarsa veya tick'lerin %10'undan fazlası geride kalındığı için atlanırsa) önce reddedilir, sonra en son
+ * bağlanandan başlayarak ölçüm başına bir tane atılır. Reddedilen istemciye ERROR_OVERLOADED
+ * ile retry_after_ms önerisi gönderilir; öneri aynı anda dönen istemciler yığılmasın diye rastgeledir.
+ */
+typedef enum {
+    ADMISSION_OK = 0,
+    ADMISSION_FLEET_FULL,      /* Drone sayısı --max-drones'a ulaştı */
+    ADMISSION_VIEWERS_FULL,    /* Viewer sayısı --max-viewers'a ulaştı */
+    ADMISSION_CPU_PRESSURE,    /* Yük eşiğin üstünde, yeni viewer alınmıyor */
+} AdmissionResult;
+
+/* Viewer handler'ının yığınında durur; shed işaretlenince viewer ERROR gönderip çıkar */
+typedef struct admission_ticket {
+    struct admission_ticket *next;
+    unsigned long long seq;    /* Kabul sırası; en büyüğü ilk atılır */
+    atomic_int shed;
+} AdmissionTicket;
+
+int admission_init(int max_drones, int max_viewers, int shed_cpu_percent);
+int admission_max_drones();
+int admission_max_viewers();
+
+/* Yeni drone oturumu (RESUME hariç) için yer ayırır; oturum tamamen kapanınca release çağrılır */
+AdmissionResult admission_admit_drone();
+void admission_release_drone();
+
+AdmissionResult admission_admit_viewer(AdmissionTicket *ticket);
+void admission_release_viewer(AdmissionTicket *ticket);
+int admission_viewer_shed(AdmissionTicket *ticket);
+
+/* Ana thread periyodik çağırır; ADMISSION_SAMPLE_INTERVAL_MS'de bir yükü ölçer ve gerekirse viewer atar */
+void admission_update();
+
+const char *admission_reason(AdmissionResult result);
+int admission_retry_after_ms(AdmissionResult result);
+
+#endif
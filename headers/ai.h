@@ -8,8 +8,12 @@
 // #include "drone.h"
 // #include "survivor.h"
 
+#define AI_DISPATCH_INTERVAL_MS 1000 // Görev atama turları arası süre
+
 // AI Mission Assignment
 void* ai_controller(void *args);
+// Tick scheduler'ın görev atama fazı (sunucu ai_controller thread'i yerine bunu kullanır)
+void ai_dispatch_tick(unsigned long long tick);
 // Drone* find_closest_idle_drone(Coord target_coord); // Prototipi eklenebilir, ai.c içinde static değilse.
 // void assign_mission(Drone *drone, Survivor *survivor); // Prototipi eklenebilir.
 
@@ -0,0 +1,59 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdint.h>
+#include "survivor.h"
+
+#define ARCHIVE_MAGIC "DRNARCV"                   // Dosyanın ilk 8 byte'ı (NUL dahil)
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_SYNC_INTERVAL_MS 1000             // Yazılmış kayıtlar en geç bu sürede fdatasync ile diske iner
+#define ARCHIVE_RING_CAPACITY 4096                // 2'nin kuvveti; doluysa kayıt atılır ve sayılır
+#define ARCHIVE_WRITE_BATCH 128                   // Writer'ın tek write() ile yazdığı en fazla kayıt
+
+/*
+ * Kurtarılan survivor'ların kalıcı geçmişi. Görev tamamlanınca survivor'ın kaydı kilitsiz
+ * bir halkaya kopyalanır ve Survivor nesnesi hemen serbest bırakılır; sunucu kurtarılanları
+ * bellekte tutmaz. Dosyaya toplu yazma ve periyodik fdatasync ayrı writer thread'inde yapılır.
+ * Arşiv kapalıyken (--archive verilmezse) kayıtlar sadece sayılır.
+ *
+ * Dosya biçimi: ArchiveHeader, ardından sabit boyutlu ArchiveRecord'lar, host byte sırasında.
+ * Yeniden başlatmada aynı dosyanın sonuna eklenir; çökme sonrası yarım kalan son kayıt
+ * açılışta kesilip atılır.
+ */
+typedef struct archive_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    int64_t created_ns;           /* sim_realtime_ns */
+    uint8_t reserved[40];
+} ArchiveHeader;
+
+typedef struct archive_record {
+    int32_t survivor_id;
+    int32_t x, y;
+    int32_t wait_sec;             /* helped_time - discovery_time */
+    int64_t discovery_time;       /* Unix epoch saniye (sim_time) */
+    int64_t helped_time;
+    int64_t helped_ns;            /* sim_realtime_ns; journal kayıtlarıyla aynı saat */
+    char drone_id[16];
+    char info[32];
+    char mission_id[32];
+    uint8_t reserved[8];
+} ArchiveRecord;
+
+_Static_assert(sizeof(ArchiveHeader) == 64, "archive header must stay 64 bytes");
+_Static_assert(sizeof(ArchiveRecord) == 128, "archive record must stay 128 bytes");
+
+/* Dosyayı açar (yoksa oluşturur, varsa doğrulayıp sonuna ekler) ve writer thread'ini başlatır */
+int archive_open(const char *path);
+/* Kalan kayıtları yazar, fdatasync yapar ve dosyayı kapatır */
+void archive_shutdown();
+int archive_enabled();
+
+/* Kilitsiz; kurtarılan survivor'ın kaydını kuyruğa bırakır. Çağıran s'yi ardından serbest bırakır */
+void archive_survivor(const Survivor *s, const char *drone_id, const char *mission_id);
+/* Sunucu ömrü boyunca (checkpoint'ten devam ederek) kurtarılan survivor sayısı */
+long long archive_helped_total();
+void archive_set_helped_total(long long total);
+
+#endif
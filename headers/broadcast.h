@@ -0,0 +1,144 @@
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "coord.h"
+#include "drone.h"
+#include "survivor.h"
+#include "json_writer.h"
+
+#define BROADCAST_INTERVAL_MS 40 // 25 fps ≃ 40 ms
+#define BROADCAST_DEFAULT_KEYFRAME_INTERVAL 50 // tick cinsinden (~2 sn)
+#define SHARED_BUFFER_POOL_SIZE 8              // Tekrar kullanılmak üzere tutulan boş frame tamponu sayısı
+
+/*
+ * Bir kez üretilip birden fazla viewer soketine gönderilen değişmez (immutable) mesaj.
+ * Son referans bırakıldığında serbest bırakılır.
+ */
+typedef struct shared_buffer {
+    atomic_int refcount;
+    unsigned long version;   /* Üretildiği durum versiyonu */
+    size_t len;              /* data uzunluğu (sondaki '\n' dahil) */
+    size_t capacity;         /* data için ayrılan byte ('\0' hariç) */
+    int pooled;              /* Son referansta free yerine frame havuzuna döner */
+    char data[];
+} SharedBuffer;
+
+/* capacity byte'lık boş bir tampon ayırır (refcount 1, len 0); doldurmak çağırana kalır */
+SharedBuffer *shared_buffer_alloc(size_t capacity, unsigned long version);
+SharedBuffer *shared_buffer_retain(SharedBuffer *buf);
+void shared_buffer_release(SharedBuffer *buf);
+
+/* Kilitler altında alınan, sonrasında kilitsiz okunabilen dünya kopyası */
+typedef struct drone_snapshot {
+    char id_str[16];
+    Coord coord;
+    Coord target;
+    DroneState status;
+    DroneSessionState session;   /* Aynı ID'li kopyalardan bağlı olanı seçmek için; yayınlanmaz */
+} DroneSnapshot;
+
+typedef struct survivor_snapshot {
+    int id;
+    char info[25];
+    Coord coord;
+    SurvivorState status;
+} SurvivorSnapshot;
+
+typedef struct world_snapshot {
+    int map_width, map_height;
+    DroneSnapshot *drones;          /* id_str'ye göre sıralı */
+    int num_drones, drones_capacity;
+    SurvivorSnapshot *survivors;    /* id'ye göre sıralı */
+    int num_survivors, survivors_capacity;
+} WorldSnapshot;
+
+/*
+ * Drone'ları id_str'ye, survivor'ları id'ye göre sıralar. Aynı ID'li drone'lardan sadece
+ * bağlı oturumunki kalır (yerini yenisine bırakmış drone listeden henüz çıkmamış olabilir).
+ */
+void world_snapshot_sort(WorldSnapshot *snap);
+
+/* Viewport abonesi varken her frame'e eklenen, viewer thread'lerinin paylaştığı değişmez dünya kopyası */
+typedef struct shared_world {
+    atomic_int refcount;
+    WorldSnapshot snap;
+} SharedWorld;
+
+SharedWorld *shared_world_retain(SharedWorld *world);
+void shared_world_release(SharedWorld *world);
+
+/* Keyframe: tüm dünya durumunu (drone'lar + survivor'lar) w'ye '\n' ile sonlanan tek bir mesaj olarak yazar */
+void write_simulation_state_update(JsonWriter *w, const WorldSnapshot *snap, unsigned long version, long long timestamp);
+
+/*
+ * Bir tick'te yayınlanan frame'ler. delta her zaman version-1 üzerine kuruludur.
+ * keyframe sadece periyodik tick'lerde veya talep edildiğinde bu versiyon için üretilir.
+ */
+typedef struct broadcast_frame {
+    unsigned long version;
+    SharedBuffer *delta;
+    SharedBuffer *keyframe;
+    int periodic_keyframe;   /* keyframe senkron viewer'lara da gönderilmeli mi */
+    SharedWorld *world;      /* Sadece viewport abonesi varken dolu, aksi halde NULL */
+} BroadcastFrame;
+
+/*
+ * Yayın fazı: tick scheduler her BROADCAST_INTERVAL_MS'de bir broadcaster_tick çağırır;
+ * durum bir kez serialize edilip yayınlanır. keyframe aralığı yayın sayısı cinsindendir.
+ * broadcaster_shutdown scheduler thread'i durduktan sonra çağrılmalıdır.
+ */
+int broadcaster_init();
+void broadcaster_shutdown();
+void broadcaster_set_keyframe_interval(int ticks);
+void broadcaster_tick(unsigned long long tick);
+
+/* Bir sonraki tick'te (delta olmayan) tam keyframe üretilmesini ister */
+void broadcaster_request_keyframe();
+/* Her tick keyframe isteyen (delta desteklemeyen) viewer sayısını günceller */
+void broadcaster_full_frame_subscribers(int delta);
+/* Frame'lere dünya kopyası eklenmesini gerektiren viewport abonesi sayısını günceller */
+void broadcaster_viewport_subscribers(int delta);
+
+/*
+ * last_version'dan daha yeni bir frame yayınlanana kadar (en fazla timeout_ms) bekler.
+ * Başarılı olursa 1 döner ve out içindeki tamponların referansı çağırana aittir
+ * (broadcast_frame_release ile bırakılmalı). Timeout veya kapanışta 0 döner.
+ */
+int broadcaster_wait_frame(unsigned long last_version, int timeout_ms, BroadcastFrame *out);
+void broadcast_frame_release(BroadcastFrame *frame);
+
+/* Viewer'ın abone olduğu harita dikdörtgeni (uçlar dahil, map koordinatlarında) */
+typedef struct viewport {
+    int x_min, y_min, x_max, y_max;
+    int zoom;   /* 1: tam çözünürlük; z > 1 ise koordinatlar z'nin katlarına yuvarlanır */
+} Viewport;
+
+/*
+ * VIEWER_SUBSCRIBE göndermiş viewer'ın akışı. Paylaşılan frame yerine dünya kopyası
+ * viewport'a göre süzülür ve bu viewer'a en son gönderilen süzülmüş duruma göre delta
+ * üretilir; serialize maliyeti ve bant genişliği görünen alanla orantılıdır. Viewport
+ * değişince giren/çıkan varlıklar bir sonraki delta'da upsert/remove olarak gider.
+ */
+typedef struct viewport_stream {
+    Viewport view;
+    WorldSnapshot sent;              /* Viewer'a en son gönderilen süzülmüş dünya */
+    WorldSnapshot next;              /* Süzme çalışma alanı; gönderimde sent ile yer değiştirir */
+    int outside_drones, outside_survivors, sent_outside_drones, sent_outside_survivors;
+    unsigned long sent_version;      /* 0: henüz keyframe gönderilmedi */
+    JsonWriter writer;
+} ViewportStream;
+
+void viewport_stream_init(ViewportStream *vs, const Viewport *view);
+void viewport_stream_free(ViewportStream *vs);
+void viewport_stream_set_view(ViewportStream *vs, const Viewport *view);
+
+/*
+ * world'ü süzer ve keyframe (ya da zincir kopuksa) tam durumu, aksi halde delta'yı yazar.
+ * 1: *out dolu (refcount 1), 0: viewer için değişen bir şey yok, -1: hata.
+ */
+int viewport_stream_build(ViewportStream *vs, const WorldSnapshot *world, unsigned long version,
+                          int keyframe, long long timestamp, SharedBuffer **out);
+
+#endif
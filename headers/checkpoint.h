@@ -0,0 +1,88 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "survivor.h"
+
+#define CHECKPOINT_MAGIC "DRNCKPT"                // Dosyanın ilk 8 byte'ı (NUL dahil)
+#define CHECKPOINT_VERSION 2                      // 1: kurtarılan survivor kayıtlarını da içerir; hâlâ okunur
+#define CHECKPOINT_DEFAULT_INTERVAL_SEC 10        // Periyodik checkpoint aralığı; 0: sadece talep ve kapanışta
+#define CHECKPOINT_TMP_SUFFIX ".tmp"              // Yazım bu dosyaya yapılır, bitince rename ile yerine geçer
+
+/*
+ * Sunucunun yeniden başlatılabilir durumu: bekleyen/atanmış survivor'lar, kurtarılanların
+ * sayısı ve drone oturumları (konum, görev, RESUME token'ı). Dünya kilitler altında kısa sürede
+ * kopyalanır; dosya geçici isme yazılıp fsync edilir ve rename ile atomik olarak eskisinin
+ * yerine geçer, bu yüzden çökme anında diskte her zaman tam bir checkpoint bulunur.
+ *
+ * Dosya biçimi: CheckpointHeader, ardından survivor_count bekleyen/atanmış survivor kaydı ve
+ * drone_count drone kaydı. Kurtarılanların kendisi arşivdedir (archive.h); sürüm 1 dosyalarda
+ * aradaki helped_total kurtarılmış kaydı okunurken atlanır. Kayıtlar sabit boyutlu ve host
+ * byte sırasındadır; açılışta dosya mmap'lenir, başlık ve CRC32 doğrulanır ve kayıtlar
+ * ayrıştırılmadan doğrudan okunur. Simüle drone'lar (--virtual-drones) kaydedilmez.
+ */
+typedef struct checkpoint_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t survivor_record_size;
+    uint32_t drone_record_size;
+    int64_t created_ns;           /* sim_realtime_ns */
+    int32_t map_height, map_width;
+    int32_t next_survivor_id;     /* Açılışta survivor ID'leri buradan devam eder */
+    uint32_t survivor_count;
+    uint32_t helped_total;        /* Şimdiye kadar kurtarılan survivor sayısı */
+    uint32_t drone_count;
+    uint32_t payload_crc32;       /* Başlıktan sonraki tüm kayıtların zlib crc32'si */
+    uint8_t reserved[4];
+} CheckpointHeader;
+
+typedef struct checkpoint_survivor {
+    int32_t id;
+    int32_t status;               /* SurvivorState */
+    int32_t x, y;
+    int64_t discovery_time;       /* Unix epoch saniye */
+    int64_t helped_time;          /* Sadece sürüm 1 kurtarılmış kayıtlarında dolu */
+    char info[32];
+} CheckpointSurvivor;
+
+typedef struct checkpoint_drone {
+    char id_str[16];
+    int32_t id;
+    int32_t status;               /* DroneState */
+    int32_t x, y;
+    int32_t target_x, target_y;
+    int32_t survivor_id;          /* Görevdeki survivor, yoksa -1 */
+    int32_t telemetry_udp;
+    int64_t session_token;
+    int64_t telemetry_token;
+    char mission_id[32];
+} CheckpointDrone;
+
+_Static_assert(sizeof(CheckpointHeader) == 64, "checkpoint header must stay 64 bytes");
+_Static_assert(sizeof(CheckpointSurvivor) == 64, "checkpoint survivor record must stay 64 bytes");
+_Static_assert(sizeof(CheckpointDrone) == 96, "checkpoint drone record must stay 96 bytes");
+
+typedef struct checkpoint_stats {
+    int survivors, helped, drones;  /* helped: şimdiye kadar kurtarılan */
+    long long bytes;
+    long long duration_us;        /* Kopyalama + yazma + fsync + rename */
+} CheckpointStats;
+
+/*
+ * Açılışta her drone kaydı için çağrılır; target görevdeki survivor'dır (yoksa NULL).
+ * 0 dönerse drone oturumu kurulmuş sayılır, aksi halde survivor tekrar WAITING olur.
+ */
+typedef int (*checkpoint_drone_restore_fn)(const CheckpointDrone *rec, Survivor *target);
+
+/* interval_sec: periyodik yazım aralığı, 0 kapalı */
+int checkpoint_init(const char *path, int interval_sec);
+int checkpoint_enabled();
+/* Dosya yoksa boş dünyayla devam edilir (0); bozuk veya uyumsuz dosyada 1 döner */
+int checkpoint_restore(checkpoint_drone_restore_fn restore_drone);
+/* Dünyayı kopyalayıp dosyaya atomik olarak yazar; stats NULL olabilir. Thread-safe */
+int checkpoint_write(CheckpointStats *stats);
+/* Ana döngüden çağrılır; aralık dolduysa checkpoint yazar */
+void checkpoint_periodic();
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef CLIENT_CONN_H
+#define CLIENT_CONN_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "broadcast.h"
+
+#define CONN_HIGH_WATER_MARK (256 * 1024) // Bunun üstünde bekleyen viewer frame'leri en yenisiyle değiştirilir
+#define CONN_MAX_IOV 16                   // Tek sendmsg çağrısında birleştirilen parça sayısı
+
+struct json_object;
+struct z_stream_s;
+
+typedef struct conn_chunk {
+    struct conn_chunk *next;
+    SharedBuffer *buf;
+    size_t offset;      /* Bu parçadan gönderilmiş byte sayısı */
+    int droppable;      /* Viewer state frame'i (yenisiyle değiştirilebilir) */
+    int compress;       /* Gönderilirken bağlantının deflate akışından geçecek */
+} ConnChunk;
+
+/*
+ * Non-blocking soket üzerine kurulu, bağlantı başına çıkış kuyruğu.
+ * Herhangi bir thread mesaj ekleyebilir; ekleyen thread hemen göndermeyi dener,
+ * kalan kısım soketin sahibi olan handler thread tarafından yazılabilir olunca gönderilir.
+ */
+typedef struct client_conn {
+    int fd;
+    pthread_mutex_t lock;
+    ConnChunk *head, *tail;
+    size_t queued_bytes;          /* Henüz gönderilmemiş toplam byte */
+    unsigned long dropped_frames; /* Yavaş viewer yüzünden atlanan frame sayısı */
+    int error;                    /* Yazma hatası oluştu, bağlantı kapatılmalı */
+    struct z_stream_s *deflate;   /* NULL: sıkıştırma yok */
+    unsigned char *zbuf;          /* Sıkıştırılmış, soketin henüz almadığı byte'lar */
+    size_t zbuf_len, zbuf_off, zbuf_cap;
+} ClientConn;
+
+/* fd'yi non-blocking yapar ve bağlantı nesnesini oluşturur. fd'nin sahipliği çağıranda kalır. */
+ClientConn *conn_create(int fd);
+void conn_destroy(ClientConn *conn);
+
+/* Kontrol mesajı: asla düşürülmez. Hata durumunda -1 döner. */
+int conn_send_control(ClientConn *conn, const char *data, size_t len);
+/* json_obj'yi '\n' ile sonlandırıp kontrol mesajı olarak kuyruğa ekler */
+int conn_send_json(ClientConn *conn, struct json_object *json_obj);
+/*
+ * Viewer frame'i: kuyruk yüksek su seviyesini aşmışsa henüz gönderilmeye başlanmamış
+ * eski frame'ler atılır ve yerine bu frame eklenir. Atılan frame sayısını, hata durumunda -1 döner.
+ */
+int conn_send_frame(ClientConn *conn, SharedBuffer *frame);
+
+/*
+ * Bundan sonra kuyruğa eklenen mesajlar bağlantı başına tek bir deflate akışından
+ * (headers/stream_deflate.h) geçirilir; önceden eklenenler düz gider. Frame'ler
+ * gönderim sırasında sıkıştırıldığından yavaş viewer'da eski frame düşürme aynen çalışır.
+ * Hata durumunda -1 döner ve bağlantı düz kalır.
+ */
+int conn_enable_deflate(ClientConn *conn);
+
+/* Kuyruğu soket kabul ettiği kadar gönderir. 0: tamam/beklemede, -1: bağlantı hatası */
+int conn_flush(ClientConn *conn);
+size_t conn_pending_bytes(ClientConn *conn);
+
+#endif
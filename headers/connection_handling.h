@@ -6,6 +6,8 @@
 struct handler_args {
     int client_fd;
     char initial_msg[1024]; // BUFFER_SIZE ile uyumlu olmalı
+    char leftover[1024];    // Handshake satırıyla birlikte okunmuş sonraki byte'lar
+    int leftover_len;
 };
 
 void* handle_drone_connection(void* arg);
@@ -4,29 +4,71 @@
 #include "coord.h"
 #include <pthread.h>
 #include "survivor.h" 
+#include "timer_wheel.h"
+#include "journal.h"
+
+#define DRONE_HEARTBEAT_INTERVAL_MS 10000       // Sunucunun HEARTBEAT gönderme aralığı
+#define DRONE_LIVENESS_TIMEOUT_MS 30000         // Bu kadar sessiz kalan drone bağlantısı kapatılır
+#define DRONE_DEFAULT_MISSION_TIMEOUT_MS 150000 // İstemcinin 120 sn'lik kendi sınırından sonra
+#define DRONE_DEFAULT_SESSION_GRACE_MS 30000    // Bağlantısı kopan drone'un RESUME için beklendiği süre
+
+struct client_conn; // client_conn.h: bağlantının çıkış kuyruğu
 
 typedef enum {
     IDLE = 0,
     ON_MISSION = 1,
 } DroneState;
 
+/* Bağlantı oturumu: kopan drone grace süresi boyunca görevini koruyarak RESUME bekler */
+typedef enum {
+    DRONE_SESSION_ATTACHED = 0,  // Handler thread'i ve soketi var
+    DRONE_SESSION_DETACHED,      // Bağlantı koptu, grace timer çalışıyor
+    DRONE_SESSION_CLOSED,        // Süresi doldu veya takeover ile devralındı; handler/timer temizler
+} DroneSessionState;
+
 typedef struct drone {
     int id;                     
     char id_str[16];            // Drone ID'sinin string hali (örn: "D1") -> YENİ
     int socket_fd;              
+    struct client_conn *conn;   // Drone'a giden mesajlar bu kuyruk üzerinden gönderilir
     DroneState status;          
     Coord coord;                
     Coord target;               
     pthread_mutex_t lock;       
     pthread_cond_t cond;        
-    Survivor *current_survivor_target; 
+    SurvivorHandle current_survivor_target; // Görevdeki survivor, yoksa SURVIVOR_HANDLE_NONE
 
     time_t last_heartbeat_time; 
     char drone_capabilities[128]; 
 
+    char mission_id[32];        // Aktif görevin ID'si; eski MISSION_COMPLETE'ler ayırt edilir
+    TimerEntry heartbeat_timer; // Periyodik HEARTBEAT gönderimi
+    TimerEntry liveness_timer;  // Sessizlik süresi aşılınca bağlantıyı kapatır
+    TimerEntry mission_timer;   // Görev süresi aşılınca survivor'ı yeniden atanabilir yapar
+
+    int telemetry_udp;          // Handshake'te UDP telemetry anlaşıldı
+    long long telemetry_token;  // Datagramların bu drone'a ait olduğunu doğrular
+    long long telemetry_seq;    // Uygulanan en yeni datagramın sıra numarası
+
+    struct drone *registry_next; // drone_registry kovasındaki sonraki drone
+
+    DroneSessionState session;
+    long long session_token;    // HANDSHAKE_ACK'te verilir, RESUME'da doğrulanır
+    TimerEntry grace_timer;     // Ayrılmış oturumu süre dolunca kapatır
+
+    int simulated;              // Sunucu içinde simüle edilir (virtual_drone.c); conn ve zamanlayıcıları yok
+
 } Drone;
 
 Drone* server_create_drone_instance(int drone_id_numeric, const char* drone_id_string, int socket_fd); // Prototip güncellendi
 void server_cleanup_drone_instance(Drone *d);
+/* drone->lock tutulurken çağrılır: aktif görevi bırakır, survivor AI tarafından tekrar atanabilir */
+void drone_release_mission_locked(Drone *drone, JournalReleaseReason reason);
+/* drone->lock tutulurken çağrılır: görevi kapatır; başarılıysa survivor arşive yazılır ve slotu bırakılır,
+   başarısızsa survivor tekrar atanmak üzere WAITING'e döner */
+void drone_complete_mission_locked(Drone *drone, int success, const char *mission_id, const char *log_prefix);
+
+extern int mission_timeout_ms;  // Sunucu tarafı görev süre sınırı (--mission-timeout)
+extern int session_grace_ms;    // Kopan bağlantılar için RESUME süresi, 0: hemen temizlenir (--session-grace)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef DRONE_MSG_H
+#define DRONE_MSG_H
+
+#include <stddef.h>
+#include "coord.h"
+#include "drone.h"
+
+struct json_object;
+
+typedef enum {
+    DRONE_MSG_OTHER = 0,        /* Hızlı yolun tanımadığı tip; json-c ile işlenmeli */
+    DRONE_MSG_STATUS_UPDATE,
+    DRONE_MSG_HEARTBEAT_RESPONSE
+} DroneMsgType;
+
+/* Drone -> server sık mesajlarının ayrıştırılmış hali */
+typedef struct drone_message {
+    DroneMsgType type;
+    char drone_id[16];
+    int has_drone_id;
+    Coord location;
+    int has_location_x, has_location_y;
+    DroneState status;
+    int has_status;             /* status tanınan bir değer ise 1 */
+    int battery;
+    int has_battery;
+    long long seq;              /* UDP telemetry: gönderici sıra numarası */
+    int has_seq;
+    long long token;            /* UDP telemetry: handshake'te verilen oturum anahtarı */
+    int has_token;
+} DroneMessage;
+
+/*
+ * STATUS_UPDATE ve HEARTBEAT_RESPONSE için tek geçişte, allocation yapmadan ayrıştırma.
+ * Beklenmeyen her şeyde (başka tip, escape'li string, iç içe bilinmeyen alan,
+ * ondalıklı sayı, bozuk JSON) 0 döner; çağıran json-c'ye geri düşmelidir.
+ * Başarıda 1 döner.
+ */
+int drone_msg_parse_fast(const char *json, size_t len, DroneMessage *out);
+
+/* json-c ile ayrıştırılmış bir mesajdan aynı yapıyı doldurur (yavaş yol) */
+void drone_msg_from_json(struct json_object *parsed_json, DroneMessage *out);
+
+/* STATUS_UPDATE içindeki konum/durum alanlarını drone'a yazar; drone->lock tutulurken çağrılır */
+void drone_msg_apply_status(Drone *drone, const DroneMessage *msg);
+
+#endif
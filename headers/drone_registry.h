@@ -0,0 +1,39 @@
+#ifndef DRONE_REGISTRY_H
+#define DRONE_REGISTRY_H
+
+#include "drone.h"
+
+#define DRONE_REGISTRY_BUCKETS 4096   // 2'nin kuvveti; zincirler Drone içine gömülü
+#define DRONE_REGISTRY_STRIPES 64     // Kova grubu başına bir kilit
+
+/*
+ * drone_id -> Drone* eşlemesi. Bağlı her drone handshake'te eklenir, bağlantı
+ * kapanırken çıkarılır; aynı ID ile ikinci bir canlı oturum açılamaz.
+ */
+
+/*
+ * Ekleme sonucu. takeover verilmişse ve session_token eski oturumun token'ı ile
+ * eşleşiyorsa eski oturumun soketi kapatılır ve yerini yeni drone alır; eski handler çıkarken kaydı artık kendisine ait olmadığından dokunmaz.
+ * Bağlantısı kopmuş (RESUME bekleyen) oturumun yerini takeover olmadan da alır ve onu hemen kapatır.
+ */
+typedef enum {
+    DRONE_REGISTRY_INSERTED = 0,
+    DRONE_REGISTRY_DUPLICATE,         /* Aynı ID zaten bağlı, ekleme yapılmadı */
+    DRONE_REGISTRY_TOOK_OVER,
+    DRONE_REGISTRY_TAKEOVER_DENIED,   /* takeover istendi ama token eski oturumunkiyle eşleşmedi */
+    DRONE_REGISTRY_REPLACED_DETACHED,
+} DroneRegistryResult;
+
+DroneRegistryResult drone_registry_insert(Drone *drone, int takeover, long long session_token);
+/* Sadece kayıt hala bu drone'a aitse çıkarır; free'den önce çağrılmalıdır */
+void drone_registry_remove(Drone *drone);
+
+/*
+ * ID'ye sahip drone'u drone->lock tutulmuş olarak döner (yoksa NULL). Kilit tutulduğu
+ * sürece drone serbest bırakılamaz; çağıran PROFILED_UNLOCK(&drone->lock) ile bırakır.
+ */
+Drone *drone_registry_acquire(const char *id_str);
+
+int drone_registry_count();
+
+#endif
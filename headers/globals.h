@@ -10,7 +10,7 @@
 // Global Değişkenlerin extern bildirimleri
 extern Map map;
 extern List *survivors;         // Yardım bekleyen survivor'lar (sunucu yönetir)
-extern List *helpedsurvivors;   // Yardım edilmiş survivor'lar (sunucu yönetir)
+extern List *helpedsurvivors;   // Yardım edilmiş survivor'lar (sadece eski controller; sunucu bunları arşive yazıp serbest bırakır)
 extern List *drones;            // Bağlı olan aktif drone'ların (Drone* tipinde) listesi (sunucu yönetir)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,130 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define JOURNAL_MAGIC "DRNJRNL"                   // Segment başlığının ilk 8 byte'ı (NUL dahil)
+#define JOURNAL_VERSION 1
+#define JOURNAL_SEGMENT_PREFIX "journal-"         // journal-000001.seg, journal-000002.seg, ...
+#define JOURNAL_SEGMENT_SUFFIX ".seg"
+#define JOURNAL_DEFAULT_SEGMENT_MB 64             // Segment bu boyuta ulaşınca yenisine geçilir
+#define JOURNAL_SYNC_INTERVAL_MS 1000             // Yazılmış kayıtlar en geç bu sürede fdatasync ile diske iner
+#define JOURNAL_RING_CAPACITY 65536               // 2'nin kuvveti; doluysa yeni kayıt atılır ve sayılır
+#define JOURNAL_WRITE_BATCH 256                   // Writer'ın tek write() ile yazdığı en fazla kayıt
+
+/*
+ * Durum geçişlerinin ikili denetim kaydı. Üreten thread'ler (AI, timer, drone handler'ları)
+ * kaydı kilitsiz bir halkaya bırakıp hemen döner; dosyaya yazma, fdatasync ve segment
+ * değiştirme ayrı writer thread'inde yapılır. Halka dolarsa sıcak yol beklemez, kayıt kaybolur
+ * (drone_server_journal_records_total{result="dropped"}).
+ *
+ * Dosya biçimi: her segment JournalSegmentHeader ile başlar, ardından sabit boyutlu
+ * JournalRecord'lar gelir. Alanlar host byte sırasıyla yazılır; okuyucu aynı mimaride çalışır.
+ * Çökme sonrası segment sonunda yarım kalmış bir kayıt olabilir, okuyucu onu yok sayar.
+ * Yeni olay türleri sona eklenir; mevcut numaralar değişmez.
+ */
+typedef enum {
+    JOURNAL_NONE = 0,
+    JOURNAL_SURVIVOR_SPAWNED,     /* survivor_id, x/y: konum */
+    JOURNAL_SURVIVOR_ASSIGNED,    /* survivor_id, drone_id, x/y: hedef; sadece ASSIGN_MISSION gönderilince */
+    JOURNAL_SURVIVOR_HELPED,      /* survivor_id, drone_id, x/y: konum */
+    JOURNAL_SURVIVOR_RELEASED,    /* survivor_id, drone_id; arg: JournalReleaseReason */
+    JOURNAL_DRONE_CONNECTED,      /* drone_id, x/y: ilk konum */
+    JOURNAL_DRONE_RESUMED,        /* drone_id */
+    JOURNAL_DRONE_DETACHED,       /* drone_id; arg: grace süresi (ms) */
+    JOURNAL_DRONE_REMOVED,        /* drone_id */
+    JOURNAL_DRONE_STATUS,         /* drone_id, status: yeni DroneStatus, arg: önceki, x/y: konum */
+    JOURNAL_EVENT_TYPES
+} JournalEventType;
+
+typedef enum {
+    JOURNAL_RELEASE_MISSION_TIMEOUT = 0,
+    JOURNAL_RELEASE_SESSION_ENDED,
+    JOURNAL_RELEASE_MISSION_FAILED,   /* Drone MISSION_COMPLETE ile success:false bildirdi */
+} JournalReleaseReason;
+
+typedef struct journal_segment_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t segment_index;
+    uint32_t reserved0;
+    uint64_t created_ns;          /* CLOCK_REALTIME */
+    uint8_t reserved[32];
+} JournalSegmentHeader;
+
+typedef struct journal_record {
+    uint64_t timestamp_ns;        /* CLOCK_REALTIME, olay kuyruğa girdiğinde */
+    uint64_t seq;                 /* Süreç içinde kayıt sırası; atılan kayıtlar numara almaz */
+    uint16_t type;                /* JournalEventType */
+    uint16_t status;
+    int32_t survivor_id;          /* Yoksa -1 */
+    int32_t x, y;
+    int32_t arg;
+    char drone_id[16];            /* Yoksa boş; Drone.id_str ile aynı boyut */
+    uint8_t reserved[12];
+} JournalRecord;
+
+_Static_assert(sizeof(JournalSegmentHeader) == 64, "journal segment header must stay 64 bytes");
+_Static_assert(sizeof(JournalRecord) == 64, "journal record must stay 64 bytes");
+
+/* Dizini (yoksa) oluşturur, yeni bir segment açar ve writer thread'ini başlatır */
+int journal_open(const char *dir, int segment_mb);
+/* Kalan kayıtları yazar, fdatasync yapar ve segmenti kapatır */
+void journal_shutdown();
+int journal_enabled();
+
+/* Kilitsiz; journal kapalıysa hiçbir şey yapmaz. drone_id NULL, survivor_id -1 olabilir */
+void journal_log(JournalEventType type, const char *drone_id, int survivor_id, int x, int y, int status, int arg);
+
+/* Segment dosya adı mı (journal-NNNNNN.seg) */
+static inline int journal_is_segment_name(const char *name) {
+    size_t len = strlen(name);
+    size_t prefix_len = strlen(JOURNAL_SEGMENT_PREFIX);
+    size_t suffix_len = strlen(JOURNAL_SEGMENT_SUFFIX);
+    return len > prefix_len + suffix_len && strncmp(name, JOURNAL_SEGMENT_PREFIX, prefix_len) == 0 &&
+           strcmp(name + len - suffix_len, JOURNAL_SEGMENT_SUFFIX) == 0;
+}
+
+/*
+ * Bellekteki (mmap'lenmiş) segmentin başlığını doğrular ve kayıt dizisini döndürür.
+ * Sondaki yarım kayıt sayılmaz. Geçersiz segmentte NULL döner.
+ */
+static inline const JournalRecord *journal_segment_records(const void *base, size_t size, size_t *count) {
+    const JournalSegmentHeader *hdr = (const JournalSegmentHeader*)base;
+    if (size < sizeof(JournalSegmentHeader) || memcmp(hdr->magic, JOURNAL_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->version != JOURNAL_VERSION || hdr->record_size != sizeof(JournalRecord)) {
+        return NULL;
+    }
+    *count = (size - sizeof(JournalSegmentHeader)) / sizeof(JournalRecord);
+    return (const JournalRecord*)((const char*)base + sizeof(JournalSegmentHeader));
+}
+
+static inline const char *journal_event_name(int type) {
+    static const char *names[JOURNAL_EVENT_TYPES] = {
+        [JOURNAL_NONE] = "NONE",
+        [JOURNAL_SURVIVOR_SPAWNED] = "SURVIVOR_SPAWNED",
+        [JOURNAL_SURVIVOR_ASSIGNED] = "SURVIVOR_ASSIGNED",
+        [JOURNAL_SURVIVOR_HELPED] = "SURVIVOR_HELPED",
+        [JOURNAL_SURVIVOR_RELEASED] = "SURVIVOR_RELEASED",
+        [JOURNAL_DRONE_CONNECTED] = "DRONE_CONNECTED",
+        [JOURNAL_DRONE_RESUMED] = "DRONE_RESUMED",
+        [JOURNAL_DRONE_DETACHED] = "DRONE_DETACHED",
+        [JOURNAL_DRONE_REMOVED] = "DRONE_REMOVED",
+        [JOURNAL_DRONE_STATUS] = "DRONE_STATUS",
+    };
+    return type >= 0 && type < JOURNAL_EVENT_TYPES ? names[type] : "UNKNOWN";
+}
+
+static inline const char *journal_release_reason_name(int reason) {
+    switch (reason) {
+        case JOURNAL_RELEASE_MISSION_TIMEOUT: return "mission_timeout";
+        case JOURNAL_RELEASE_SESSION_ENDED: return "session_ended";
+        case JOURNAL_RELEASE_MISSION_FAILED: return "mission_failed";
+        default: return "unknown";
+    }
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+
+#define JSON_WRITER_MAX_DEPTH 16
+
+/*
+ * Sık gönderilen mesajlar için json-c nesnesi kurmadan doğrudan byte tamponuna
+ * yazan akış tabanlı JSON yazıcı. Çıktı, json_object_to_json_string_ext(...,
+ * JSON_C_TO_STRING_PLAIN) ile byte byte aynıdır (boşluk yok, '/' kaçışlı).
+ *
+ * İki kullanım şekli vardır:
+ *  - json_writer_init_fixed: çağıranın verdiği (ör. stack) tampona yazar, asla
+ *    heap kullanmaz; taşarsa error set edilir.
+ *  - json_writer_init: büyüyebilen heap tamponu; json_writer_reset ile kapasite
+ *    korunarak tekrar kullanılır, böylece kararlı durumda hiç allocation yapılmaz.
+ */
+typedef struct json_writer {
+    char *buf;
+    size_t len;
+    size_t cap;
+    int growable;
+    int error;                                      /* Taşma veya allocation hatası */
+    int depth;
+    unsigned char first[JSON_WRITER_MAX_DEPTH];     /* Bu seviyede henüz eleman yazılmadı */
+    unsigned char after_key;                        /* Az önce bir key yazıldı, virgül gerekmez */
+} JsonWriter;
+
+void json_writer_init(JsonWriter *w, size_t initial_capacity);
+void json_writer_init_fixed(JsonWriter *w, char *storage, size_t capacity);
+/* İçeriği siler, tamponu tekrar kullanmak üzere tutar */
+void json_writer_reset(JsonWriter *w);
+void json_writer_free(JsonWriter *w);
+
+void jw_object_begin(JsonWriter *w);
+void jw_object_end(JsonWriter *w);
+void jw_array_begin(JsonWriter *w);
+void jw_array_end(JsonWriter *w);
+/* Nesne içinde "key": yazar; ardından tam olarak bir değer yazılmalıdır */
+void jw_key(JsonWriter *w, const char *key);
+void jw_string(JsonWriter *w, const char *str);
+void jw_int(JsonWriter *w, long long value);
+void jw_bool(JsonWriter *w, int value);
+/* Mesajı '\n' ile sonlandırır (satır tabanlı protokol) */
+void jw_newline(JsonWriter *w);
+
+/* Sık kullanılan key + değer kısayolları */
+void jw_kv_string(JsonWriter *w, const char *key, const char *str);
+void jw_kv_int(JsonWriter *w, const char *key, long long value);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef LOCK_PROF_H
+#define LOCK_PROF_H
+
+#include <stdio.h>
+#include <pthread.h>
+
+/*
+ * List ve Drone kilitleri için çağrı noktası bazında kilit profili.
+ * `make LOCK_PROFILING=1` ile derlenince her PROFILED_LOCK noktası kendi edinme,
+ * çekişme sayısını ve bekleme/tutma süresi histogramlarını (ns) tutar.
+ * Bayrak yoksa makrolar düz pthread çağrılarıdır ve ek maliyet yoktur.
+ */
+#ifdef LOCK_PROFILING
+
+#include <stdatomic.h>
+#include "metrics.h"
+
+#define LOCK_PROF_MAX_HELD 16   // Thread başına iç içe tutulabilecek profillenen kilit sayısı
+
+typedef struct lock_site {
+    const char *file;
+    int line;
+    const char *expr;               /* Kilitlenen ifade, örn. &survivors->lock */
+    atomic_int registered;
+    struct lock_site *next;         /* Kayıtlı noktaların listesi */
+    MetricCounter acquisitions;
+    MetricCounter contended;        /* trylock başarısız olup beklenen edinmeler */
+    MetricHistogram wait_ns;
+    MetricHistogram hold_ns;
+} LockSite;
+
+void lock_prof_lock(pthread_mutex_t *mutex, LockSite *site);
+void lock_prof_unlock(pthread_mutex_t *mutex);
+/* Koşul beklemesi tutma süresine sayılmaz; uyanınca kilit aynı noktada yeniden tutulmuş sayılır */
+int lock_prof_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+
+#define PROFILED_LOCK(m) do { \
+        static LockSite lock_site_ = {__FILE__, __LINE__, #m}; \
+        lock_prof_lock((m), &lock_site_); \
+    } while (0)
+#define PROFILED_UNLOCK(m) lock_prof_unlock(m)
+#define PROFILED_COND_WAIT(c, m) lock_prof_cond_wait((c), (m))
+
+#else
+
+#define PROFILED_LOCK(m) pthread_mutex_lock(m)
+#define PROFILED_UNLOCK(m) pthread_mutex_unlock(m)
+#define PROFILED_COND_WAIT(c, m) pthread_cond_wait((c), (m))
+
+#endif
+
+/* Noktaları toplam bekleme süresine göre sıralayıp yazar; profil kapalıysa bunu belirtir */
+void lock_prof_dump(FILE *out);
+
+#endif
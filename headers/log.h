@@ -0,0 +1,76 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdatomic.h>
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN  1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_DEBUG 3
+
+// make LOG_LEVEL=1: bu seviyenin üstündeki çağrılar derlenmez (argümanları da hesaplanmaz)
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_INFO
+#define LOG_RING_SLOTS 512            // Thread başına; 2'nin kuvveti, doluysa mesaj atılır ve sayılır
+#define LOG_MSG_MAX 232               // Daha uzun mesajlar kesilir
+#define LOG_MAX_RINGS 256             // Aynı anda log yazan thread sınırı; aşan thread doğrudan yazar
+#define LOG_WRITER_IDLE_MS 10
+
+/*
+ * Asenkron, seviyeli log. Her thread ilk mesajında kendine ait tek üreticili bir halka
+ * alır; mesaj o thread'de biçimlendirilip halkaya kopyalanır ve çağıran hiçbir kilit
+ * beklemeden döner. Arka plandaki writer thread'i halkaları boşaltır, mesajları zaman
+ * damgasına göre sıralar ve stdout'a (INFO/DEBUG) veya stderr'e (WARN/ERROR) toplu
+ * write() ile yazar. Thread çıkınca halkası bir sonraki thread'e devredilir.
+ *
+ * log_init'ten önce ve log_shutdown'dan sonra mesajlar çağıran thread'de doğrudan yazılır.
+ * Mesajlar printf biçimindedir ve satır sonunu kendileri içerir.
+ */
+extern atomic_int log_runtime_level;
+
+/* Writer thread'ini başlatır ve metrikleri kaydeder (metrics_init'ten sonra) */
+int log_init(int level);
+/* Kalan mesajları yazar ve writer'ı durdurur */
+void log_shutdown();
+void log_set_level(int level);
+/* "error", "warn", "info", "debug"; tanınmazsa -1 */
+int log_level_from_name(const char *name);
+void log_write(int level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static inline int log_level_enabled(int level) {
+    return level <= LOG_COMPILE_LEVEL && level <= atomic_load_explicit(&log_runtime_level, memory_order_relaxed);
+}
+
+#define LOG_AT(level, ...) do { if (log_level_enabled(level)) log_write((level), __VA_ARGS__); } while (0)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+/*
+ * Çağrı noktası başına hız sınırı: saniyede en fazla per_sec mesaj geçer, fazlası sayılır
+ * ve bir sonraki geçen mesajdan önce "N similar message(s) suppressed" olarak bildirilir.
+ */
+typedef struct log_rate_limit {
+    atomic_llong window_start_ms;
+    atomic_int passed;
+    atomic_int suppressed;
+} LogRateLimit;
+
+/* 1: mesaj yazılmalı; *suppressed son geçen mesajdan beri atılanların sayısıdır */
+int log_rate_allow(LogRateLimit *rl, int per_sec, int *suppressed);
+
+#define LOG_RATELIMITED(level, per_sec, ...) do {                                          \
+        static LogRateLimit log_rl_;                                                       \
+        int log_suppressed_;                                                               \
+        if (log_level_enabled(level) && log_rate_allow(&log_rl_, (per_sec), &log_suppressed_)) { \
+            if (log_suppressed_ > 0)                                                       \
+                log_write((level), "(%d similar message(s) suppressed)\n", log_suppressed_); \
+            log_write((level), __VA_ARGS__);                                               \
+        }                                                                                  \
+    } while (0)
+
+#endif
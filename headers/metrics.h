@@ -0,0 +1,102 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+
+#define METRICS_MAX_ENTRIES 64
+#define METRICS_HIST_SUB_BITS 2                                     // Oktav başına 4 alt kova (~%25 hassasiyet)
+#define METRICS_HIST_OCTAVES 27                                     // 1 µs .. ~134 s
+#define METRICS_HIST_BUCKETS (METRICS_HIST_OCTAVES << METRICS_HIST_SUB_BITS)
+
+/*
+ * Kilitsiz sayaç, gauge ve log-lineer (HDR tarzı) histogramlar. Sıcak yoldaki
+ * güncellemeler tek bir relaxed atomik işlemdir; okuma sadece /metrics isteğinde yapılır.
+ */
+typedef struct metric_counter {
+    atomic_ullong value;
+} MetricCounter;
+
+typedef struct metric_gauge {
+    atomic_llong value;
+} MetricGauge;
+
+/*
+ * Birimi kaydeden belirler; kayıt defterindeki histogramlar mikrosaniye kaydeder
+ * ve dışarıya saniye olarak verilir.
+ */
+typedef struct metric_histogram {
+    atomic_ullong buckets[METRICS_HIST_BUCKETS + 1];   /* Son eleman: en büyük kovayı aşan değerler */
+    atomic_ullong sum;
+} MetricHistogram;
+
+/* Değeri okunma anında hesaplanan gauge (ör. listedeki survivor sayısı) */
+typedef long long (*metric_gauge_fn)(void *arg);
+
+/* Mesaj tipleri; sayaç dizilerinde indeks olarak kullanılır */
+typedef enum {
+    METRIC_MSG_HANDSHAKE = 0,
+    METRIC_MSG_HANDSHAKE_ACK,
+    METRIC_MSG_STATUS_UPDATE,
+    METRIC_MSG_HEARTBEAT,
+    METRIC_MSG_HEARTBEAT_RESPONSE,
+    METRIC_MSG_ASSIGN_MISSION,
+    METRIC_MSG_MISSION_COMPLETE,
+    METRIC_MSG_ERROR,
+    METRIC_MSG_VIEWER_HANDSHAKE,
+    METRIC_MSG_VIEWER_HANDSHAKE_ACK,
+    METRIC_MSG_VIEWER_RESYNC,
+    METRIC_MSG_VIEWER_SUBSCRIBE,
+    METRIC_MSG_STATE_DELTA,
+    METRIC_MSG_STATE_KEYFRAME,
+    METRIC_MSG_OTHER,
+    METRIC_MSG_TYPES
+} MetricMsgType;
+
+/* Sunucunun sabit metrikleri; metrics_init() hepsini kayıt defterine ekler */
+typedef struct server_metrics {
+    MetricCounter messages_in[METRIC_MSG_TYPES];
+    MetricCounter messages_out[METRIC_MSG_TYPES];
+    MetricCounter bytes_in;
+    MetricCounter bytes_out;
+    MetricCounter viewer_frames_dropped;
+    MetricCounter viewer_stream_raw_bytes;         /* Sıkıştırmalı viewer'lara giden mesajların düz boyu */
+    MetricCounter viewer_stream_compressed_bytes;
+    MetricGauge drones_connected;
+    MetricGauge viewers_connected;
+    MetricHistogram ai_pass_us;
+    MetricHistogram serialize_keyframe_us;
+    MetricHistogram serialize_delta_us;
+} ServerMetrics;
+
+extern ServerMetrics server_metrics;
+
+static inline void metric_counter_add(MetricCounter *c, unsigned long long n) {
+    atomic_fetch_add_explicit(&c->value, n, memory_order_relaxed);
+}
+
+static inline void metric_gauge_add(MetricGauge *g, long long n) {
+    atomic_fetch_add_explicit(&g->value, n, memory_order_relaxed);
+}
+
+static inline void metric_gauge_set(MetricGauge *g, long long v) {
+    atomic_store_explicit(&g->value, v, memory_order_relaxed);
+}
+
+void metric_histogram_record(MetricHistogram *h, unsigned long long value);
+/* q (0..1) yüzdelik dilimini içeren kovanın üst sınırı; boş histogramda 0 */
+unsigned long long metric_histogram_quantile(MetricHistogram *h, double q);
+/* Süre ölçümleri için monoton saat (mikrosaniye) */
+long long metrics_now_us();
+
+/* Kayıt defteri: name aynı olan kayıtlar art arda eklenmelidir (HELP/TYPE bir kez yazılır) */
+void metrics_init();
+int metrics_register_counter(MetricCounter *c, const char *name, const char *labels, const char *help);
+int metrics_register_gauge(MetricGauge *g, const char *name, const char *labels, const char *help);
+int metrics_register_gauge_fn(metric_gauge_fn fn, void *arg, const char *name, const char *labels, const char *help);
+int metrics_register_histogram(MetricHistogram *h, const char *name, const char *labels, const char *help);
+
+/* Tüm kayıtları Prometheus text formatında (0.0.4) out'a yazar */
+void metrics_write_prometheus(FILE *out);
+
+#endif
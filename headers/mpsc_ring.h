@@ -0,0 +1,65 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/*
+ * Sınırlı çok üreticili, tek tüketicili halka (Vyukov): her yuvanın sıra numarası yuvanın
+ * kimin sırası olduğunu söyler. Üretici enqueue_pos'u CAS ile alıp kaydı yuvaya yazar ve
+ * yayınlar; tek tüketici dequeue_pos'u kilitsiz ilerletir. Kayıtlar sabit boyutludur.
+ * Halka doluysa üretici beklemez, kaydı atar. journal.c ve archive.c'nin ortak altyapısı.
+ */
+typedef struct mpsc_ring {
+    unsigned char *slots;
+    size_t record_size;
+    size_t slot_size;                 /* Sıra numarası + kayıt, 8 byte'a hizalı */
+    unsigned long long capacity;      /* 2'nin kuvveti */
+    atomic_ullong enqueue_pos;
+    unsigned long long dequeue_pos;   /* Sadece tüketici */
+} MpscRing;
+
+int mpsc_ring_init(MpscRing *ring, unsigned long long capacity, size_t record_size);
+/*
+ * Kilitsiz; kaydın yazılacağı yeri döner, halka doluysa (tüketici bir tur geride) NULL.
+ * pos kaydın halkadaki sıra numarasıdır. Kayıt yazılınca mpsc_ring_publish ile yayınlanır.
+ */
+void *mpsc_ring_reserve(MpscRing *ring, unsigned long long *pos);
+void mpsc_ring_publish(MpscRing *ring, void *record, unsigned long long pos);
+/* Tek tüketici: yayınlanmış en fazla max kaydı sırayla out'a kopyalar, kopyalanan sayıyı döner */
+int mpsc_ring_pop_batch(MpscRing *ring, void *out, int max);
+
+/*
+ * Halkayı boşaltan writer thread'i: kayıtları en fazla batch_max'lık gruplar halinde
+ * write_batch'e verir, son yazımdan sonra sync_interval_ms içinde sync'i çağırır ve
+ * boşken idle_wait_ms uyur. Durdurulunca halka boşalana kadar yazar, sonra finish'i çağırır.
+ */
+typedef struct mpsc_writer_ops {
+    const char *thread_name;
+    int batch_max;
+    int sync_interval_ms;
+    int idle_wait_ms;
+    /* 0: kayıtlar yazıldı (sync bekliyor); aksi halde kayıtlar atılmış sayılır */
+    int (*write_batch)(const void *records, int count);
+    void (*sync)();
+    void (*finish)();                 /* Son sync dahil kapanış işleri; NULL olabilir */
+} MpscWriterOps;
+
+typedef struct mpsc_writer {
+    MpscRing *ring;
+    const MpscWriterOps *ops;
+    void *batch;
+    volatile int running;
+    pthread_t thread;
+} MpscWriter;
+
+int mpsc_writer_start(MpscWriter *writer, MpscRing *ring, const MpscWriterOps *ops);
+/* Kalan kayıtlar yazılana kadar bekler. Halka serbest bırakılmaz: kapanıştan hemen önce
+   kayıt ayırmış bir üretici hâlâ yazıyor olabilir */
+void mpsc_writer_stop(MpscWriter *writer);
+
+/* EINTR ve kısa yazımlarda devam eder; 0 veya -1 (errno) döner */
+int mpsc_write_all(int fd, const void *buf, size_t len);
+
+#endif
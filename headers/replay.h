@@ -0,0 +1,17 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+/*
+ * Kaydedilmiş bir journal'ın dış olaylarını (survivor üretimi, drone bağlanma/ayrılma)
+ * sanal saatte aynı anlarda yeniden üretir. Atama, hareket ve kurtarma kararları
+ * kayıttan okunmaz, sunucu tarafından yeniden hesaplanır; böylece aynı girdiyle
+ * sunucu davranışı ve performansı yeniden incelenebilir. Drone'lar simüle drone
+ * olarak (virtual_drone.c) bağlanır.
+ */
+/* Dizindeki segmentleri okur; first_ns/last_ns ilk ve son olayın zamanıdır */
+int replay_open(const char *dir, long long *first_ns, long long *last_ns);
+/* TICK_PHASE_SPAWN: zamanı gelmiş kayıtları uygular (rastgele survivor üretiminin yerine) */
+void replay_tick(unsigned long long tick);
+void replay_close();
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef SHM_WORLD_H
+#define SHM_WORLD_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define SHM_WORLD_NAME "/drone_world"      // shm_open adı
+#define SHM_WORLD_MAGIC 0x444E5753u        // "SWND"
+#define SHM_WORLD_LAYOUT_VERSION 1         // Yapı değişirse artırılmalı
+#define SHM_WORLD_MAX_DRONES 1024
+#define SHM_WORLD_MAX_SURVIVORS 4096
+
+/*
+ * Aynı makinedeki viewer'lar için paylaşımlı bellekte tutulan binary dünya kopyası.
+ * Tek yazar (broadcaster) seqlock kullanır: yazarken seq tek sayıdır, bitince çift.
+ * Okuyucular kilit almaz; okuma sırasında seq değiştiyse kopyayı tekrar alır.
+ * Sunucu tarafında bağlı viewer sayısından bağımsız olarak tick başına bir kopya maliyeti vardır.
+ */
+typedef struct shm_drone {
+    char id_str[16];
+    int32_t x, y;
+    int32_t target_x, target_y;
+    int32_t status;                 /* DroneState */
+} ShmDrone;
+
+typedef struct shm_survivor {
+    int32_t id;
+    int32_t x, y;
+    int32_t status;                 /* SurvivorState */
+} ShmSurvivor;
+
+/* seq dışındaki her şey seqlock ile korunan yük */
+typedef struct shm_world_state {
+    uint64_t version;               /* Viewer akışındaki durum versiyonu ile aynı */
+    int64_t timestamp;
+    int32_t map_width, map_height;
+    int32_t num_drones, num_survivors;
+    int32_t truncated;              /* Sınırlara sığmayan kayıt olduysa 1 */
+    ShmDrone drones[SHM_WORLD_MAX_DRONES];
+    ShmSurvivor survivors[SHM_WORLD_MAX_SURVIVORS];
+} ShmWorldState;
+
+typedef struct shm_world {
+    uint32_t magic;
+    uint32_t layout_version;
+    atomic_uint seq;
+    atomic_int server_running;      /* Sunucu kapanırken 0 yapılır */
+    ShmWorldState state;
+} ShmWorld;
+
+struct world_snapshot;
+
+/* Sunucu: bölgeyi oluşturur ve yazmak için map'ler. Hata durumunda 1 döner */
+int shm_world_create();
+/* Sunucu: yeni bir durum versiyonunu yayınlar (sadece broadcaster thread'inden) */
+void shm_world_publish(const struct world_snapshot *snap, unsigned long version, long long timestamp);
+/* Sunucu: okuyuculara kapanışı bildirir ve bölgeyi siler */
+void shm_world_destroy();
+
+/* Viewer: mevcut bölgeyi salt okunur map'ler; yoksa veya uyumsuzsa NULL */
+const ShmWorld *shm_world_open_readonly();
+void shm_world_close(const ShmWorld *world);
+/*
+ * Tutarlı bir kopyayı out'a alır. Yazar o an yazıyorsa kısa süre tekrar dener.
+ * Başarıda 1, denemeler tükenirse 0 döner.
+ */
+int shm_world_read(const ShmWorld *world, ShmWorldState *out);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <time.h>
+
+#define SIMCLOCK_VIRTUAL_EPOCH 1735689600LL   // 2025-01-01 00:00:00 UTC: --replay olmadan sanal saatin başlangıcı
+#define SIM_RAND_MAX 0x7fffffff
+#define SIM_RAND_STREAM_TICK 0                // Tick scheduler thread'inin sabit PRNG akışı
+
+/*
+ * Simülasyon saati ve PRNG. Gerçek modda saat CLOCK_MONOTONIC/CLOCK_REALTIME'dır.
+ * Sanal modda (--speed veya --replay) zaman sadece tick scheduler her tick'te bir
+ * periyot ilerlettiğinde akar: tick'ler gerçek zamanın `speed` katı hızda (0: bekleme
+ * yok) koşar ve aynı tohumla aynı tick dizisi aynı survivor, atama ve zaman damgalarını
+ * üretir.
+ *
+ * PRNG thread başınadır (splitmix64). Her thread'in akışı tohum ile akış numarasından
+ * türetilir; tick thread'i SIM_RAND_STREAM_TICK'i kullanır, böylece simülasyon kararları
+ * diğer thread'lerin ne zaman rastgele sayı çektiğinden etkilenmez.
+ */
+int simclock_init(int virtual_clock, double speed, unsigned long long seed, long long start_epoch_ns);
+int simclock_virtual();
+double simclock_speed();
+unsigned long long simclock_seed();
+/* Sadece tick scheduler, sanal modda her tick başında çağırır */
+void simclock_advance_ns(long long ns);
+
+/* Başlangıçtan beri geçen (sanal) süre */
+long long sim_monotonic_ms();
+/* Unix epoch'tan beri (sanal) zaman; time(NULL) yerine */
+long long sim_realtime_ns();
+time_t sim_time();
+/* Sanal modda sanal süre kadar bekler */
+void sim_sleep_ms(int ms);
+
+/* Çağıran thread'in akışını sabitler; çağrılmazsa ilk sim_rand()'da sıradaki akış atanır */
+void sim_rand_seed_thread(unsigned long long stream);
+/* 0..SIM_RAND_MAX */
+int sim_rand();
+
+#endif
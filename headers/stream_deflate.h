@@ -0,0 +1,30 @@
+#ifndef STREAM_DEFLATE_H
+#define STREAM_DEFLATE_H
+
+#define STREAM_COMPRESSION_DEFLATE "deflate"   // VIEWER_HANDSHAKE "compression" listesindeki ad
+#define STREAM_DEFLATE_WINDOW_BITS (-15)       // Raw deflate (RFC 1951), zlib başlığı yok
+#define STREAM_DEFLATE_LEVEL 6
+#define STREAM_DEFLATE_MEM_LEVEL 8
+
+/*
+ * Sunucu -> viewer yönündeki sıkıştırılmış akış, bağlantı boyunca tek bir deflate
+ * akışıdır: her gönderim Z_SYNC_FLUSH ile byte sınırına hizalanır, pencere (son 32 KB)
+ * mesajlar arasında korunur. İlk keyframe'in de kısalması için iki taraf da akışı
+ * aşağıdaki ön sözlükle başlatır. Sözlük değişirse eski viewer'lar açamaz; yeni bir
+ * ad ("deflate2" gibi) ile müzakere edilmelidir.
+ *
+ * En sık kullanılan parçalar sona yakın durur (deflate yakın mesafeleri daha ucuza kodlar).
+ */
+#define STREAM_DEFLATE_DICTIONARY \
+    "{\"type\":\"VIEWER_HANDSHAKE_ACK\",\"message\":\"\",\"delta\":true,\"initial_map_dimensions\":{\"width\":,\"height\":}}\n" \
+    "{\"type\":\"ERROR\",\"error_msg\":\"\",\"error_type\":}\n" \
+    "\"viewport\":{\"x_min\":,\"y_min\":,\"x_max\":,\"y_max\":,\"zoom\":1},\"outside\":{\"drones\":,\"survivors\":}}\n" \
+    "{\"type\":\"SIMULATION_STATE_UPDATE\",\"version\":,\"timestamp\":,\"map_dimensions\":{\"width\":,\"height\":},\"drones\":[],\"survivors\":[]}\n" \
+    "{\"type\":\"SIMULATION_STATE_DELTA\",\"version\":,\"base_version\":,\"timestamp\":,\"drones\":{\"upsert\":[],\"remove\":[]},\"survivors\":{\"upsert\":[],\"remove\":[]}}\n" \
+    "{\"id_str\":\"D\",\"coord\":{\"x\":,\"y\":},\"target\":{\"x\":,\"y\":},\"status\":\"ON_MISSION\"}," \
+    "{\"id_str\":\"D\",\"coord\":{\"x\":,\"y\":},\"target\":{\"x\":,\"y\":},\"status\":\"IDLE\"}," \
+    "{\"id\":,\"info\":\"SURV-\",\"coord\":{\"x\":,\"y\":},\"status\":\"HELPED\"}," \
+    "{\"id\":,\"info\":\"SURV-\",\"coord\":{\"x\":,\"y\":},\"status\":\"ASSIGNED\"}," \
+    "{\"id\":,\"info\":\"SURV-\",\"coord\":{\"x\":,\"y\":},\"status\":\"WAITING\"},"
+
+#endif
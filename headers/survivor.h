@@ -3,17 +3,40 @@
 
 #include "coord.h"
 #include <time.h>
+#include <stdint.h>
 // #include "list.h" // List.h survivor.h içinde include edilmemeli, circular dependency olabilir.
                      // Eğer Survivor içinde List* yoksa gerek yok.
                      // Globals.h zaten List.h'ı içerecek.
 
 typedef enum { WAITING = 0, ASSIGNED = 1, HELPED = 2 } SurvivorState;
 
+#define SURVIVOR_MAX_ACTIVE 100   // Tablo ve survivors listesi kapasitesi; tablo doluysa yeni survivor üretilmez
+
+/*
+ * Survivor'lar sabit boyutlu bir tabloda (slab) tutulur ve her yerde işaretçi yerine
+ * index + generation handle'ı ile gösterilir (survivors ve hücre listeleri, Drone görevi).
+ * Slot serbest bırakılınca generation artar; eski handle'la survivor_get NULL döner ve
+ * sayılır, böylece yeniden kullanılan slota yanlışlıkla erişilmez. Ayırma ve bırakma
+ * malloc'suz, sabit zamanlıdır.
+ */
+typedef struct survivor_handle {
+    uint32_t index;
+    uint32_t generation;      // 0: boş handle
+} SurvivorHandle;
+
+#define SURVIVOR_HANDLE_NONE ((SurvivorHandle){0, 0})
+
+static inline int survivor_handle_is_none(SurvivorHandle h) {
+    return h.generation == 0;
+}
+
 typedef struct survivor {
+    int id;                   // Sunucu ömrü boyunca tekil, viewer delta'ları bu ID ile eşlenir
     SurvivorState status;
     Coord coord;
-    struct tm discovery_time; // tm struct'ı zaten time.h ile gelir.
-    struct tm helped_time;
+    SurvivorHandle handle;    // Kendi slotu; listelerden çıkarırken eşleştirilir
+    int64_t discovery_time;   // Unix epoch saniye (sim_time)
+    int64_t helped_time;      // Kurtarılmadıysa 0
     char info[25];
 } Survivor;
 
@@ -23,8 +46,23 @@ typedef struct survivor {
 // Bu extern'leri globals.h'ye taşıyacağız.
 
 // Functions
-Survivor* create_survivor(Coord *coord, char *info, struct tm *discovery_time);
+/* Tabloyu ayırır ve metriklerini kaydeder (metrics_init'ten sonra) */
+int survivor_table_init(int capacity);
+void survivor_table_destroy();
+/* Boş slota yeni survivor yerleştirir (WAITING, yeni ID); tablo doluysa SURVIVOR_HANDLE_NONE */
+SurvivorHandle survivor_create(Coord coord, const char *info, int64_t discovery_time);
+/* Handle'ın survivor'ı; boş veya eski (serbest bırakılmış slot) handle'da NULL */
+Survivor *survivor_get(SurvivorHandle h);
+/* Slotu serbest bırakır; survivor önce tüm listelerden çıkarılmış olmalıdır */
+void survivor_free(SurvivorHandle h);
 void *survivor_generator(void *args);
+/* Tick scheduler'ın survivor üretim fazı (sunucu survivor_generator thread'i yerine bunu kullanır) */
+void survivor_spawn_tick(unsigned long long tick);
+/* Verilen hücreye survivor ekler (journal replay'i konumları kayıttan alır) */
+int survivor_spawn_at(Coord coord, const char *info);
+/* Bir sonraki survivor'a verilecek ID; checkpoint'ten açılışta ID'ler kaldığı yerden devam eder */
+int survivor_next_id();
+void survivor_set_next_id(int id);
 // void survivor_cleanup(Survivor *s); // Prototipi güncelleyebilir veya kaldırabiliriz.
 
 #endif
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#define TELEMETRY_MAX_DATAGRAM 512   // Tek STATUS_UPDATE datagramı için yeterli
+
+/*
+ * Opsiyonel UDP telemetry kanalı. Handshake'te "telemetry": "udp" isteyen drone'lar
+ * STATUS_UPDATE'leri TCP yerine buraya, "seq" ve "token" alanlarıyla gönderir.
+ * Sadece en yeni sıra numaralı konum uygulanır; kontrol mesajları TCP'de kalır.
+ */
+int telemetry_start(int port);
+void telemetry_shutdown();
+/* UDP kanalı çalışıyorsa port numarası, çalışmıyorsa 0 */
+int telemetry_port();
+
+#endif
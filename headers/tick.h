@@ -0,0 +1,47 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include <stdio.h>
+
+#define TICK_DEFAULT_RATE_HZ 25      // 40 ms; broadcast aralığıyla aynı
+#define TICK_MAX_RATE_HZ 1000
+
+/*
+ * Simülasyon fazları her tick'te bu sırayla çalışır. Hepsi tek scheduler thread'inde
+ * koştuğu için bir tick içindeki sıra sabittir: yeni survivor'lar aynı tick'te
+ * atanabilir, atamalar ve zaman aşımları aynı tick'in yayınına girer.
+ */
+typedef enum {
+    TICK_PHASE_SPAWN = 0,     /* Survivor üretimi */
+    TICK_PHASE_DISPATCH,      /* AI görev ataması */
+    TICK_PHASE_DRONES,        /* Simüle drone'ların hareketi (--virtual-drones, --replay) */
+    TICK_PHASE_TIMEOUTS,      /* Timer wheel: heartbeat, canlılık, görev ve oturum süreleri */
+    TICK_PHASE_BROADCAST,     /* Dünya kopyası, delta/keyframe yayını */
+    TICK_PHASES
+} TickPhase;
+
+/* tick: scheduler başladığından beri çalışan tick sayısı (atlananlar dahil) */
+typedef void (*tick_phase_fn)(unsigned long long tick);
+
+int tick_scheduler_init(int rate_hz);
+/*
+ * Fazı her period_ms'de bir (en az her tick) çalışacak şekilde kaydeder; thread başlamadan çağrılır.
+ * Faz ilk tick'te ve sonra son çalıştığı tick'ten period kadar sonra koşar; tick atlansa da kaçırılmaz.
+ */
+void tick_scheduler_add(TickPhase phase, const char *name, tick_phase_fn fn, int period_ms);
+void *tick_scheduler_thread(void *args);
+void tick_scheduler_shutdown();
+/* Thread'i bu kadar tick sonra kendiliğinden durdurur (--duration); 0 sınırsız */
+void tick_scheduler_stop_after(unsigned long long ticks);
+int tick_scheduler_done();
+
+int tick_rate_hz();
+/* Geride kalındığı için atlanan toplam tick sayısı (yük göstergesi) */
+unsigned long long tick_skipped_total();
+/* ms süreyi tick sayısına yuvarlar (en az 1) */
+unsigned long long tick_from_ms(int ms);
+
+/* Tick süresi, aşım ve atlanan tick özetini yazar */
+void tick_stats_dump(FILE *out);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#define TIMER_WHEEL_TICK_MS 100   // Zamanlayıcı çözünürlüğü
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6   // Seviye başına 64 slot: 64^4 tick ≃ 19 gün
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+
+struct timer_entry;
+typedef void (*timer_callback)(struct timer_entry *timer, void *arg);
+
+/*
+ * Sahibinin yapısına gömülen (intrusive) zamanlayıcı. Kurma ve iptal O(1)'dir;
+ * callback'ler tick scheduler thread'inde, tekerlek kilidi bırakılmış halde çalışır.
+ */
+typedef struct timer_entry {
+    struct timer_entry *next;
+    struct timer_entry **pprev;   /* Önceki kaydın next alanı veya slot başı; O(1) silme için */
+    unsigned long long expires;   /* Tick cinsinden mutlak son zaman */
+    timer_callback callback;
+    void *arg;
+    int pending;                  /* Tekerlekte bekliyor */
+} TimerEntry;
+
+int timer_wheel_init();
+/* TICK_PHASE_TIMEOUTS: son çağrıdan beri geçen tekerlek tick'lerini işler ve süresi dolan callback'leri çalıştırır */
+void timer_wheel_tick(unsigned long long sim_tick);
+void timer_wheel_shutdown();
+
+void timer_entry_init(TimerEntry *timer, timer_callback callback, void *arg);
+/* delay_ms sonra çalışacak şekilde kurar; zaten kuruluysa yeniden kurar */
+void timer_schedule(TimerEntry *timer, int delay_ms);
+void timer_cancel(TimerEntry *timer);
+/* İptal eder ve callback o anda çalışıyorsa bitmesini bekler (sahibi free edilmeden önce) */
+void timer_cancel_sync(TimerEntry *timer);
+int timer_pending(TimerEntry *timer);
+
+#endif
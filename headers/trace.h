@@ -0,0 +1,34 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+
+#define TRACE_RING_CAPACITY 4096      // Thread başına tutulan en yeni span sayısı
+#define TRACE_MAX_THREADS 512         // Aynı anda iz tutabilecek thread sayısı
+#define TRACE_THREAD_NAME_MAX 48
+#define TRACE_DEFAULT_DUMP_PATH "drone_server_trace.json"
+
+/*
+ * Thread başına halka tamponlara yazılan başlangıç/bitiş span'leri. Yazan thread
+ * kilit almaz; döküm Chrome trace_event JSON'udur (chrome://tracing, Perfetto).
+ * Örnekleme 1/N: her span bağımsız olarak N'de bir kaydedilir, 0 izlemeyi kapatır.
+ *
+ *     long long t = trace_begin();
+ *     ...
+ *     trace_end("ai_pass", t);
+ */
+void trace_init(int sample_every);
+int trace_enabled();
+
+/* Thread'in zaman çizelgesindeki adı; thread başında bir kez çağrılır */
+void trace_set_thread_name(const char *name);
+
+/* Örneklenmeyen span için 0 döner; trace_end 0'ı yok sayar */
+long long trace_begin();
+/* name statik ömürlü olmalıdır (döküme kadar saklanır) */
+void trace_end(const char *name, long long start_ns);
+
+void trace_dump(FILE *out);
+int trace_dump_file(const char *path);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef VIRTUAL_DRONE_H
+#define VIRTUAL_DRONE_H
+
+#include "coord.h"
+
+#define VIRTUAL_DRONE_MOVE_INTERVAL_MS 200   // drone_client'ın MOVE_INTERVAL_MS'i: her adımda bir hücre
+#define VIRTUAL_DRONE_ID_PREFIX "V"
+
+/*
+ * Sunucu içinde simüle edilen drone'lar. Soketleri ve handler thread'leri yoktur;
+ * AI onlara normal drone'lar gibi görev atar, tick thread'i her adımda hedefe bir
+ * hücre yaklaştırır ve varınca görevi başarıyla kapatır. Hepsi tick thread'inde
+ * değiştiği için aynı tohumla aynı hareketleri yaparlar (--speed ile hızlandırılmış
+ * veya --replay ile tekrar oynatılan senaryolar).
+ */
+int virtual_drones_init(int count);
+/* TICK_PHASE_DRONES: bekleyen drone'ları oluşturur ve görevdekileri bir adım yürütür */
+void virtual_drones_tick(unsigned long long tick);
+/* Sadece tick thread'i; replay kayıtlarındaki bağlanma/ayrılma olayları için */
+int virtual_drone_add(const char *id_str, Coord coord);
+void virtual_drone_remove(const char *id_str);
+/* Tick thread durduktan sonra kalan simüle drone'ları temizler */
+void virtual_drones_shutdown();
+
+#endif
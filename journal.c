@@ -0,0 +1,210 @@
+/*
+ * journal.c
+ * Durum geçişleri için eklemeli ikili olay kaydı: üreticiler kilitsiz halkaya yazar,
+ * tek writer thread'i kayıtları segment dosyalarına toplu yazar ve periyodik fdatasync yapar.
+ */
+#include "headers/journal.h"
+#include "headers/metrics.h"
+#include "headers/mpsc_ring.h"
+#include "headers/simclock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define JOURNAL_IDLE_WAIT_MS 5
+
+static MpscRing ring;
+static MpscWriter writer;
+static atomic_int enabled = 0;
+
+static char journal_dir[256];
+static long long segment_limit_bytes = 0;
+static unsigned int segment_index = 0;
+static int segment_fd = -1;
+static long long segment_bytes = 0;
+
+static MetricCounter records_written;
+static MetricCounter records_dropped;
+static MetricCounter write_errors;
+static MetricHistogram fsync_us;
+
+/* Dizindeki en büyük segment numarası; yeni çalıştırma eskilerin üzerine yazmaz */
+static unsigned int last_segment_index(const char *dir) {
+    unsigned int last = 0;
+    DIR *d = opendir(dir);
+    if (!d) return 0;
+    struct dirent *ent;
+    size_t prefix_len = strlen(JOURNAL_SEGMENT_PREFIX);
+    while ((ent = readdir(d)) != NULL) {
+        if (!journal_is_segment_name(ent->d_name)) continue;
+        unsigned int idx = (unsigned int)strtoul(ent->d_name + prefix_len, NULL, 10);
+        if (idx > last) last = idx;
+    }
+    closedir(d);
+    return last;
+}
+
+static void sync_segment() {
+    if (segment_fd < 0) return;
+    long long start = metrics_now_us();
+    if (fdatasync(segment_fd) != 0) {
+        perror("Journal fdatasync failed");
+        metric_counter_add(&write_errors, 1);
+    }
+    metric_histogram_record(&fsync_us, metrics_now_us() - start);
+}
+
+static void close_segment() {
+    if (segment_fd < 0) return;
+    sync_segment();
+    close(segment_fd);
+    segment_fd = -1;
+}
+
+static int open_next_segment() {
+    char path[320];
+    segment_index++;
+    snprintf(path, sizeof(path), "%s/%s%06u%s", journal_dir, JOURNAL_SEGMENT_PREFIX, segment_index,
+             JOURNAL_SEGMENT_SUFFIX);
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Journal: cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    JournalSegmentHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, JOURNAL_MAGIC, sizeof(hdr.magic));
+    hdr.version = JOURNAL_VERSION;
+    hdr.record_size = sizeof(JournalRecord);
+    hdr.segment_index = segment_index;
+    hdr.created_ns = (uint64_t)sim_realtime_ns();
+    if (mpsc_write_all(fd, &hdr, sizeof(hdr)) != 0) {
+        fprintf(stderr, "Journal: cannot write header of %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    segment_fd = fd;
+    segment_bytes = sizeof(hdr);
+    printf("Journal: writing %s\n", path);
+    return 0;
+}
+
+static int write_batch(const void *batch, int count) {
+    size_t len = (size_t)count * sizeof(JournalRecord);
+    if (segment_fd >= 0 && segment_bytes + (long long)len > segment_limit_bytes) {
+        close_segment();
+        open_next_segment();
+    }
+    if (segment_fd < 0 && open_next_segment() != 0) {
+        metric_counter_add(&write_errors, 1);
+        metric_counter_add(&records_dropped, (unsigned long long)count);
+        return 1;
+    }
+    if (mpsc_write_all(segment_fd, batch, len) != 0) {
+        perror("Journal write failed");
+        metric_counter_add(&write_errors, 1);
+        metric_counter_add(&records_dropped, (unsigned long long)count);
+        // Yarım yazılmış kayıt okuyucu için segment sonu demektir; sonraki yazımlar yeni segmente gider
+        close_segment();
+        return 1;
+    }
+    segment_bytes += (long long)len;
+    metric_counter_add(&records_written, (unsigned long long)count);
+    return 0;
+}
+
+static void finish_writer() {
+    close_segment();
+    printf("Journal writer thread exiting.\n");
+}
+
+static const MpscWriterOps writer_ops = {
+    .thread_name = "journal writer",
+    .batch_max = JOURNAL_WRITE_BATCH,
+    .sync_interval_ms = JOURNAL_SYNC_INTERVAL_MS,
+    .idle_wait_ms = JOURNAL_IDLE_WAIT_MS,
+    .write_batch = write_batch,
+    .sync = sync_segment,
+    .finish = finish_writer,
+};
+
+int journal_open(const char *dir, int segment_mb) {
+    if (segment_mb < 1) {
+        fprintf(stderr, "Journal segment size must be at least 1 MB.\n");
+        return 1;
+    }
+    if (strlen(dir) >= sizeof(journal_dir)) {
+        fprintf(stderr, "Journal directory path is too long.\n");
+        return 1;
+    }
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Journal: cannot create directory %s: %s\n", dir, strerror(errno));
+        return 1;
+    }
+    strcpy(journal_dir, dir);
+    segment_limit_bytes = (long long)segment_mb * 1024 * 1024;
+    segment_index = last_segment_index(dir);
+
+    if (mpsc_ring_init(&ring, JOURNAL_RING_CAPACITY, sizeof(JournalRecord)) != 0) return 1;
+    if (open_next_segment() != 0) {
+        free(ring.slots);
+        ring.slots = NULL;
+        return 1;
+    }
+
+    metrics_register_counter(&records_written, "drone_server_journal_records_total", "result=\"written\"",
+                             "State transition records handed to the journal.");
+    metrics_register_counter(&records_dropped, "drone_server_journal_records_total", "result=\"dropped\"",
+                             "State transition records handed to the journal.");
+    metrics_register_counter(&write_errors, "drone_server_journal_write_errors_total", NULL,
+                             "Failed journal segment writes and syncs.");
+    metrics_register_histogram(&fsync_us, "drone_server_journal_fsync_duration_seconds", NULL,
+                               "Time spent in fdatasync on the active journal segment.");
+
+    if (mpsc_writer_start(&writer, &ring, &writer_ops) != 0) {
+        close_segment();
+        free(ring.slots);
+        ring.slots = NULL;
+        return 1;
+    }
+    atomic_store(&enabled, 1);
+    return 0;
+}
+
+void journal_shutdown() {
+    if (!atomic_exchange(&enabled, 0)) return;
+    mpsc_writer_stop(&writer);
+}
+
+int journal_enabled() {
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+void journal_log(JournalEventType type, const char *drone_id, int survivor_id, int x, int y, int status, int arg) {
+    if (!atomic_load_explicit(&enabled, memory_order_relaxed)) return;
+
+    unsigned long long pos;
+    JournalRecord *rec = mpsc_ring_reserve(&ring, &pos);
+    if (!rec) {
+        // Writer bir tur geride: beklemek yerine kayıt atılır
+        metric_counter_add(&records_dropped, 1);
+        return;
+    }
+    memset(rec, 0, sizeof(*rec));
+    rec->timestamp_ns = (uint64_t)sim_realtime_ns();
+    rec->seq = pos;
+    rec->type = (uint16_t)type;
+    rec->status = (uint16_t)status;
+    rec->survivor_id = survivor_id;
+    rec->x = x;
+    rec->y = y;
+    rec->arg = arg;
+    if (drone_id) strncpy(rec->drone_id, drone_id, sizeof(rec->drone_id) - 1);
+    mpsc_ring_publish(&ring, rec, pos);
+}
@@ -0,0 +1,251 @@
+/*
+ * journal_reader.c
+ * Sunucunun --journal segmentlerini mmap ile tarar; türe, drone'a, survivor'a ve zamana
+ * göre süzüp olayları satır satır veya tür başına sayı olarak yazar.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "headers/journal.h"
+#include "headers/drone.h"     // DroneState adları için
+#include "headers/survivor.h"  // SurvivorState adları için
+
+typedef struct journal_filter {
+    unsigned int type_mask;    /* 0: tüm türler */
+    const char *drone_id;
+    int survivor_id;           /* -1: hepsi */
+    unsigned long long since_ns, until_ns;
+    int count_only;
+} JournalFilter;
+
+static unsigned long long type_counts[JOURNAL_EVENT_TYPES];
+static unsigned long long total_matched = 0;
+static unsigned long long total_scanned = 0;
+
+static int event_type_from_name(const char *name) {
+    for (int t = 1; t < JOURNAL_EVENT_TYPES; t++) {
+        if (strcasecmp(name, journal_event_name(t)) == 0) return t;
+    }
+    return -1;
+}
+
+static const char *drone_state_name(int status) {
+    return status == ON_MISSION ? "ON_MISSION" : status == IDLE ? "IDLE" : "?";
+}
+
+static const char *survivor_state_name(int status) {
+    switch (status) {
+        case WAITING: return "WAITING";
+        case ASSIGNED: return "ASSIGNED";
+        case HELPED: return "HELPED";
+        default: return "?";
+    }
+}
+
+static int record_matches(const JournalRecord *r, const JournalFilter *f) {
+    if (r->type == JOURNAL_NONE || r->type >= JOURNAL_EVENT_TYPES) return 0;
+    if (f->type_mask && !(f->type_mask & (1u << r->type))) return 0;
+    if (f->survivor_id >= 0 && r->survivor_id != f->survivor_id) return 0;
+    if (f->since_ns && r->timestamp_ns < f->since_ns) return 0;
+    if (f->until_ns && r->timestamp_ns >= f->until_ns) return 0;
+    if (f->drone_id && strncmp(r->drone_id, f->drone_id, sizeof(r->drone_id)) != 0) return 0;
+    return 1;
+}
+
+static void print_record(const JournalRecord *r) {
+    char when[32];
+    time_t secs = (time_t)(r->timestamp_ns / 1000000000ULL);
+    struct tm tm_local;
+    localtime_r(&secs, &tm_local);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm_local);
+    char drone_id[sizeof(r->drone_id) + 1];
+    memcpy(drone_id, r->drone_id, sizeof(r->drone_id));
+    drone_id[sizeof(r->drone_id)] = '\0';
+
+    printf("%s.%06llu #%llu %-17s", when, (unsigned long long)(r->timestamp_ns % 1000000000ULL) / 1000,
+           (unsigned long long)r->seq, journal_event_name(r->type));
+    if (drone_id[0]) printf(" drone=%s", drone_id);
+    if (r->survivor_id >= 0) printf(" survivor=%d", r->survivor_id);
+    switch (r->type) {
+        case JOURNAL_SURVIVOR_SPAWNED:
+        case JOURNAL_SURVIVOR_ASSIGNED:
+        case JOURNAL_SURVIVOR_HELPED:
+            printf(" at=(%d,%d) state=%s", r->x, r->y, survivor_state_name(r->status));
+            break;
+        case JOURNAL_SURVIVOR_RELEASED:
+            printf(" at=(%d,%d) reason=%s", r->x, r->y, journal_release_reason_name(r->arg));
+            break;
+        case JOURNAL_DRONE_DETACHED:
+            printf(" grace_ms=%d", r->arg);
+            break;
+        case JOURNAL_DRONE_STATUS:
+            printf(" at=(%d,%d) status=%s->%s", r->x, r->y, drone_state_name(r->arg), drone_state_name(r->status));
+            break;
+        default:
+            printf(" at=(%d,%d) status=%s", r->x, r->y, drone_state_name(r->status));
+            break;
+    }
+    putchar('\n');
+}
+
+/**
+ * @brief Maps one segment read-only and scans its records in file order.
+ * @return 0 on success, 1 if the file is not a readable journal segment.
+ */
+static int scan_segment(const char *path, const JournalFilter *f) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(JournalSegmentHeader)) {
+        fprintf(stderr, "%s: too short for a journal segment\n", path);
+        close(fd);
+        return 1;
+    }
+    size_t size = (size_t)st.st_size;
+    const char *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "%s: mmap failed: %s\n", path, strerror(errno));
+        return 1;
+    }
+    madvise((void*)base, size, MADV_SEQUENTIAL);
+
+    // Sonda yarım kalmış kayıt varsa (yazım sırasında çökme) tam kayıtlar okunur
+    size_t count;
+    const JournalRecord *records = journal_segment_records(base, size, &count);
+    if (!records) {
+        fprintf(stderr, "%s: not a version %d journal segment\n", path, JOURNAL_VERSION);
+        munmap((void*)base, size);
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const JournalRecord *r = &records[i];
+        if (!record_matches(r, f)) continue;
+        type_counts[r->type]++;
+        total_matched++;
+        if (!f->count_only) print_record(r);
+    }
+    total_scanned += count;
+    munmap((void*)base, size);
+    return 0;
+}
+
+static int is_segment_name(const struct dirent *ent) {
+    return journal_is_segment_name(ent->d_name);
+}
+
+/* Segment numaraları sıfırla doldurulduğu için ad sırası yazım sırasıdır */
+static int scan_path(const char *path, const JournalFilter *f) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    if (!S_ISDIR(st.st_mode)) return scan_segment(path, f);
+
+    struct dirent **names;
+    int n = scandir(path, &names, is_segment_name, alphasort);
+    if (n < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    int failed = 0;
+    char seg_path[4096];
+    for (int i = 0; i < n; i++) {
+        snprintf(seg_path, sizeof(seg_path), "%s/%s", path, names[i]->d_name);
+        failed |= scan_segment(seg_path, f);
+        free(names[i]);
+    }
+    free(names);
+    return failed;
+}
+
+static void print_reader_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] <journal dir | segment>...\n"
+            "  -t, --type <name>        Only this event type, may be repeated (e.g. SURVIVOR_HELPED)\n"
+            "  -d, --drone <id>         Only events of this drone (e.g. D3)\n"
+            "  -s, --survivor <id>      Only events of this survivor\n"
+            "      --since <epoch sec>  Only events at or after this time\n"
+            "      --until <epoch sec>  Only events before this time\n"
+            "  -c, --count              Print the number of matching events per type instead of the events\n"
+            "  -h, --help               Show this help\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    static const struct option long_options[] = {
+        {"type", required_argument, NULL, 't'},
+        {"drone", required_argument, NULL, 'd'},
+        {"survivor", required_argument, NULL, 's'},
+        {"since", required_argument, NULL, 'S'},
+        {"until", required_argument, NULL, 'U'},
+        {"count", no_argument, NULL, 'c'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    JournalFilter filter = {0, NULL, -1, 0, 0, 0};
+    int opt_c;
+    while ((opt_c = getopt_long(argc, argv, "t:d:s:ch", long_options, NULL)) != -1) {
+        switch (opt_c) {
+            case 't': {
+                int type = event_type_from_name(optarg);
+                if (type < 0) {
+                    fprintf(stderr, "Unknown event type: %s\n", optarg);
+                    return 1;
+                }
+                filter.type_mask |= 1u << type;
+                break;
+            }
+            case 'd':
+                filter.drone_id = optarg;
+                break;
+            case 's':
+                filter.survivor_id = atoi(optarg);
+                break;
+            case 'S':
+                filter.since_ns = strtoull(optarg, NULL, 10) * 1000000000ULL;
+                break;
+            case 'U':
+                filter.until_ns = strtoull(optarg, NULL, 10) * 1000000000ULL;
+                break;
+            case 'c':
+                filter.count_only = 1;
+                break;
+            case 'h':
+                print_reader_usage(argv[0]);
+                return 0;
+            default:
+                print_reader_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        print_reader_usage(argv[0]);
+        return 1;
+    }
+
+    int failed = 0;
+    for (int i = optind; i < argc; i++) failed |= scan_path(argv[i], &filter);
+
+    if (filter.count_only) {
+        for (int t = 1; t < JOURNAL_EVENT_TYPES; t++) {
+            if (type_counts[t]) printf("%-17s %llu\n", journal_event_name(t), type_counts[t]);
+        }
+    }
+    fprintf(stderr, "%llu of %llu records matched.\n", total_matched, total_scanned);
+    return failed;
+}
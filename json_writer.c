@@ -0,0 +1,185 @@
+/*
+ * json_writer.c
+ * json-c PLAIN çıktısıyla birebir aynı, allocation yapmayan JSON yazıcı.
+ */
+#include "headers/json_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void json_writer_init(JsonWriter *w, size_t initial_capacity) {
+    memset(w, 0, sizeof(*w));
+    w->growable = 1;
+    if (initial_capacity > 0) {
+        w->buf = malloc(initial_capacity);
+        if (!w->buf) {
+            perror("Failed to allocate JSON writer buffer");
+            w->error = 1;
+            return;
+        }
+        w->cap = initial_capacity;
+    }
+}
+
+void json_writer_init_fixed(JsonWriter *w, char *storage, size_t capacity) {
+    memset(w, 0, sizeof(*w));
+    w->buf = storage;
+    w->cap = capacity;
+}
+
+void json_writer_reset(JsonWriter *w) {
+    w->len = 0;
+    w->error = 0;
+    w->depth = 0;
+    w->after_key = 0;
+}
+
+void json_writer_free(JsonWriter *w) {
+    if (w->growable) free(w->buf);
+    w->buf = NULL;
+    w->len = w->cap = 0;
+}
+
+/* En az extra byte'lık yer açar; 0 başarılı */
+static int reserve(JsonWriter *w, size_t extra) {
+    if (w->error) return 1;
+    if (w->len + extra <= w->cap) return 0;
+    if (!w->growable) {
+        w->error = 1;
+        return 1;
+    }
+    size_t new_cap = w->cap ? w->cap : 256;
+    while (new_cap < w->len + extra) new_cap *= 2;
+    char *grown = realloc(w->buf, new_cap);
+    if (!grown) {
+        perror("Failed to grow JSON writer buffer");
+        w->error = 1;
+        return 1;
+    }
+    w->buf = grown;
+    w->cap = new_cap;
+    return 0;
+}
+
+static void put_raw(JsonWriter *w, const char *data, size_t n) {
+    if (reserve(w, n) != 0) return;
+    memcpy(w->buf + w->len, data, n);
+    w->len += n;
+}
+
+static void put_char(JsonWriter *w, char c) {
+    if (reserve(w, 1) != 0) return;
+    w->buf[w->len++] = c;
+}
+
+/* Dizi elemanları arasına virgül koyar; key'den sonra gelen değer için koymaz */
+static void before_value(JsonWriter *w) {
+    if (w->after_key) {
+        w->after_key = 0;
+        return;
+    }
+    if (w->depth > 0) {
+        if (!w->first[w->depth - 1]) put_char(w, ',');
+        w->first[w->depth - 1] = 0;
+    }
+}
+
+static void open_scope(JsonWriter *w, char c) {
+    before_value(w);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH) {
+        w->error = 1;
+        return;
+    }
+    w->first[w->depth++] = 1;
+    put_char(w, c);
+}
+
+static void close_scope(JsonWriter *w, char c) {
+    if (w->depth > 0) w->depth--;
+    put_char(w, c);
+}
+
+void jw_object_begin(JsonWriter *w) { open_scope(w, '{'); }
+void jw_object_end(JsonWriter *w) { close_scope(w, '}'); }
+void jw_array_begin(JsonWriter *w) { open_scope(w, '['); }
+void jw_array_end(JsonWriter *w) { close_scope(w, ']'); }
+
+/* json-c'nin json_escape_str'ı ile aynı kurallar: " \ / ve kontrol karakterleri kaçışlanır */
+static void put_escaped(JsonWriter *w, const char *str) {
+    static const char hex[] = "0123456789abcdef";
+    put_char(w, '"');
+    const unsigned char *p = (const unsigned char *)str;
+    const unsigned char *run = p;
+    for (; *p; p++) {
+        unsigned char c = *p;
+        if (c >= 0x20 && c != '"' && c != '\\' && c != '/') continue;
+        // Kaçış gerektirmeyen kısmı tek seferde kopyala
+        if (p > run) put_raw(w, (const char *)run, p - run);
+        run = p + 1;
+        switch (c) {
+            case '"':  put_raw(w, "\\\"", 2); break;
+            case '\\': put_raw(w, "\\\\", 2); break;
+            case '/':  put_raw(w, "\\/", 2); break;
+            case '\b': put_raw(w, "\\b", 2); break;
+            case '\f': put_raw(w, "\\f", 2); break;
+            case '\n': put_raw(w, "\\n", 2); break;
+            case '\r': put_raw(w, "\\r", 2); break;
+            case '\t': put_raw(w, "\\t", 2); break;
+            default: {
+                char u[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                put_raw(w, u, sizeof(u));
+                break;
+            }
+        }
+    }
+    if (p > run) put_raw(w, (const char *)run, p - run);
+    put_char(w, '"');
+}
+
+void jw_key(JsonWriter *w, const char *key) {
+    before_value(w);
+    put_escaped(w, key);
+    put_char(w, ':');
+    w->after_key = 1;
+}
+
+void jw_string(JsonWriter *w, const char *str) {
+    before_value(w);
+    put_escaped(w, str ? str : "");
+}
+
+void jw_int(JsonWriter *w, long long value) {
+    before_value(w);
+    char digits[24];
+    int n = 0;
+    // LLONG_MIN'de taşmamak için negatif tarafta çalış
+    int negative = value < 0;
+    if (!negative) value = -value;
+    do {
+        digits[n++] = (char)('0' - (value % 10));
+        value /= 10;
+    } while (value != 0);
+    if (reserve(w, n + negative) != 0) return;
+    if (negative) w->buf[w->len++] = '-';
+    while (n > 0) w->buf[w->len++] = digits[--n];
+}
+
+void jw_bool(JsonWriter *w, int value) {
+    before_value(w);
+    if (value) put_raw(w, "true", 4);
+    else put_raw(w, "false", 5);
+}
+
+void jw_newline(JsonWriter *w) {
+    put_char(w, '\n');
+}
+
+void jw_kv_string(JsonWriter *w, const char *key, const char *str) {
+    jw_key(w, key);
+    jw_string(w, str);
+}
+
+void jw_kv_int(JsonWriter *w, const char *key, long long value) {
+    jw_key(w, key);
+    jw_int(w, value);
+}
@@ -3,6 +3,7 @@
  * Thread-safe doubly-linked list in a contiguous memory array with a free list.
  */
 #include "headers/list.h"
+#include "headers/lock_prof.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -147,21 +148,21 @@ static void return_node_to_freelist(List *list, Node *node) {
 Node *add(List *list, void *data) {
     if (!list || !data) return NULL; // Temel kontrol
 
-    pthread_mutex_lock(&list->lock);
+    PROFILED_LOCK(&list->lock);
 
     /* Wait if list is full */
     while (list->number_of_elements >= list->capacity) {
         // printf("List is full. Waiting...\n"); // Debug
-        if (pthread_cond_wait(&list->not_full, &list->lock) != 0) {
+        if (PROFILED_COND_WAIT(&list->not_full, &list->lock) != 0) {
             perror("pthread_cond_wait for not_full failed");
-            pthread_mutex_unlock(&list->lock);
+            PROFILED_UNLOCK(&list->lock);
             return NULL; // Hata durumu
         }
     }
 
     Node *node = get_node_from_freelist(list);
     if (!node) { // Teorik olarak olmamalı (yukarıdaki while döngüsü sayesinde)
-        pthread_mutex_unlock(&list->lock);
+        PROFILED_UNLOCK(&list->lock);
         fprintf(stderr, "Failed to get node from freelist even after waiting.\n");
         return NULL;
     }
@@ -184,7 +185,7 @@ Node *add(List *list, void *data) {
     /* Signal that list is not empty anymore */
     pthread_cond_signal(&list->not_empty);
 
-    pthread_mutex_unlock(&list->lock);
+    PROFILED_UNLOCK(&list->lock);
     return node; // Eklenen node'u döndür
 }
 
@@ -198,7 +199,7 @@ Node *add(List *list, void *data) {
 int removedata(List *list, void *data_to_match) {
     if (!list || !data_to_match) return 1;
 
-    pthread_mutex_lock(&list->lock);
+    PROFILED_LOCK(&list->lock);
 
     Node *current = list->head;
     while (current != NULL) {
@@ -221,13 +222,13 @@ int removedata(List *list, void *data_to_match) {
 
             /* Signal that list is not full anymore */
             pthread_cond_signal(&list->not_full);
-            pthread_mutex_unlock(&list->lock);
+            PROFILED_UNLOCK(&list->lock);
             return 0; // Başarılı
         }
         current = current->next;
     }
 
-    pthread_mutex_unlock(&list->lock);
+    PROFILED_UNLOCK(&list->lock);
     return 1; // Veri bulunamadı
 }
 
@@ -238,7 +239,7 @@ int removedata(List *list, void *data_to_match) {
 int removenode(List *list, Node *node_to_remove) {
     if (!list || !node_to_remove) return 1;
 
-    pthread_mutex_lock(&list->lock);
+    PROFILED_LOCK(&list->lock);
 
     // Node'un listede olup olmadığını kontrol etmek maliyetli olabilir.
     // Bu fonksiyon genellikle node'a zaten sahip olunduğunda çağrılır.
@@ -261,7 +262,7 @@ int removenode(List *list, Node *node_to_remove) {
 
     /* Signal that list is not full anymore */
     pthread_cond_signal(&list->not_full);
-    pthread_mutex_unlock(&list->lock);
+    PROFILED_UNLOCK(&list->lock);
     return 0; // Başarılı
 }
 
@@ -278,14 +279,14 @@ int removenode(List *list, Node *node_to_remove) {
 void *pop(List *list, void *dest) {
     if (!list) return NULL;
 
-    pthread_mutex_lock(&list->lock);
+    PROFILED_LOCK(&list->lock);
 
     /* Wait if list is empty */
     while (list->number_of_elements == 0) {
         // printf("List is empty. Waiting for pop...\n"); // Debug
-        if (pthread_cond_wait(&list->not_empty, &list->lock) != 0) {
+        if (PROFILED_COND_WAIT(&list->not_empty, &list->lock) != 0) {
             perror("pthread_cond_wait for not_empty failed");
-            pthread_mutex_unlock(&list->lock);
+            PROFILED_UNLOCK(&list->lock);
             return NULL; // Hata durumu
         }
     }
@@ -310,7 +311,7 @@ void *pop(List *list, void *dest) {
 
     /* Signal that list is not full anymore */
     pthread_cond_signal(&list->not_full);
-    pthread_mutex_unlock(&list->lock);
+    PROFILED_UNLOCK(&list->lock);
 
     return dest ? dest : (void*)1; // dest NULL ise, sadece başarılı olduğunu belirtmek için non-NULL bir şey döndür.
 }
@@ -325,14 +326,14 @@ void *pop(List *list, void *dest) {
 void *peek(List *list) {
     if (!list) return NULL;
 
-    pthread_mutex_lock(&list->lock);
+    PROFILED_LOCK(&list->lock);
 
     /* Wait if list is empty */
     while (list->number_of_elements == 0) {
         // printf("List is empty. Waiting for peek...\n"); // Debug
-        if (pthread_cond_wait(&list->not_empty, &list->lock) != 0) {
+        if (PROFILED_COND_WAIT(&list->not_empty, &list->lock) != 0) {
             perror("pthread_cond_wait for not_empty failed");
-            pthread_mutex_unlock(&list->lock);
+            PROFILED_UNLOCK(&list->lock);
             return NULL; // Hata durumu
         }
     }
@@ -342,14 +343,14 @@ void *peek(List *list) {
         data_ptr = list->head->data;
     }
 
-    pthread_mutex_unlock(&list->lock);
+    PROFILED_UNLOCK(&list->lock);
     return data_ptr; // list->head->data'yı döndürür.
 }
 
 void printlist(List *list, void (*print_data_func)(void *)) {
     if (!list || !print_data_func) return;
 
-    pthread_mutex_lock(&list->lock);
+    PROFILED_LOCK(&list->lock);
     printf("List (H->T): ");
     Node *temp = list->head;
     while (temp) {
@@ -358,13 +359,13 @@ void printlist(List *list, void (*print_data_func)(void *)) {
         temp = temp->next;
     }
     printf(" (Elements: %d)\n", list->number_of_elements);
-    pthread_mutex_unlock(&list->lock);
+    PROFILED_UNLOCK(&list->lock);
 }
 
 void printlistfromtail(List *list, void (*print_data_func)(void *)) {
     if (!list || !print_data_func) return;
 
-    pthread_mutex_lock(&list->lock);
+    PROFILED_LOCK(&list->lock);
     printf("List (T->H): ");
     Node *temp = list->tail;
     while (temp) {
@@ -373,5 +374,5 @@ void printlistfromtail(List *list, void (*print_data_func)(void *)) {
         temp = temp->prev;
     }
     printf(" (Elements: %d)\n", list->number_of_elements);
-    pthread_mutex_unlock(&list->lock);
+    PROFILED_UNLOCK(&list->lock);
 }
\ No newline at end of file
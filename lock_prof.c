@@ -0,0 +1,169 @@
+/*
+ * lock_prof.c
+ * Kilit çekişmesi profili: çağrı noktası başına bekleme/tutma histogramları ve sıralı döküm.
+ */
+#include "headers/lock_prof.h"
+
+#ifdef LOCK_PROFILING
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct held_lock {
+    pthread_mutex_t *mutex;
+    LockSite *site;
+    long long acquired_ns;
+} HeldLock;
+
+static _Atomic(LockSite*) sites_head = NULL;
+static atomic_int num_sites = 0;
+
+// Her thread tuttuğu profillenen kilitleri bilir; bırakırken tutma süresi doğru noktaya yazılır
+static __thread HeldLock held[LOCK_PROF_MAX_HELD];
+static __thread int held_count = 0;
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void register_site(LockSite *site) {
+    int expected = 0;
+    if (!atomic_compare_exchange_strong(&site->registered, &expected, 1)) return;
+    LockSite *head = atomic_load(&sites_head);
+    do {
+        site->next = head;
+    } while (!atomic_compare_exchange_weak(&sites_head, &head, site));
+    atomic_fetch_add(&num_sites, 1);
+}
+
+static void push_held(pthread_mutex_t *mutex, LockSite *site, long long acquired_ns) {
+    if (held_count >= LOCK_PROF_MAX_HELD) return;   // Tutma süresi kaydedilmez, kilit yine alınmıştır
+    held[held_count].mutex = mutex;
+    held[held_count].site = site;
+    held[held_count].acquired_ns = acquired_ns;
+    held_count++;
+}
+
+/* Kilidin kaydını çıkarır ve edinen noktayı döner; kilitler sırasız bırakılabilir */
+static LockSite *pop_held(pthread_mutex_t *mutex, long long *acquired_ns) {
+    for (int i = held_count - 1; i >= 0; i--) {
+        if (held[i].mutex != mutex) continue;
+        LockSite *site = held[i].site;
+        *acquired_ns = held[i].acquired_ns;
+        memmove(&held[i], &held[i + 1], (held_count - i - 1) * sizeof(HeldLock));
+        held_count--;
+        return site;
+    }
+    return NULL;
+}
+
+void lock_prof_lock(pthread_mutex_t *mutex, LockSite *site) {
+    if (!atomic_load_explicit(&site->registered, memory_order_relaxed)) register_site(site);
+
+    long long wait = 0;
+    long long acquired;
+    if (pthread_mutex_trylock(mutex) == 0) {
+        acquired = now_ns();
+    } else {
+        long long start = now_ns();
+        pthread_mutex_lock(mutex);
+        acquired = now_ns();
+        wait = acquired - start;
+        metric_counter_add(&site->contended, 1);
+    }
+    metric_counter_add(&site->acquisitions, 1);
+    metric_histogram_record(&site->wait_ns, (unsigned long long)wait);
+    push_held(mutex, site, acquired);
+}
+
+static void record_release(pthread_mutex_t *mutex) {
+    long long acquired;
+    LockSite *site = pop_held(mutex, &acquired);
+    if (site) metric_histogram_record(&site->hold_ns, (unsigned long long)(now_ns() - acquired));
+}
+
+void lock_prof_unlock(pthread_mutex_t *mutex) {
+    record_release(mutex);
+    pthread_mutex_unlock(mutex);
+}
+
+int lock_prof_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+    LockSite *site = NULL;
+    for (int i = held_count - 1; i >= 0; i--) {
+        if (held[i].mutex == mutex) {
+            site = held[i].site;
+            break;
+        }
+    }
+    record_release(mutex);
+    int rc = pthread_cond_wait(cond, mutex);
+    if (site) push_held(mutex, site, now_ns());
+    return rc;
+}
+
+/* Kova sınırlarını okunur birimle yazar */
+static const char *format_ns(char *buf, size_t size, unsigned long long ns) {
+    if (ns < 1000) snprintf(buf, size, "%lluns", ns);
+    else if (ns < 1000000) snprintf(buf, size, "%.1fus", ns / 1e3);
+    else snprintf(buf, size, "%.1fms", ns / 1e6);
+    return buf;
+}
+
+static double total_wait_ns(LockSite *site) {
+    return (double)atomic_load_explicit(&site->wait_ns.sum, memory_order_relaxed);
+}
+
+/* Toplam beklemeye göre azalan; eşitlikte (çekişmesiz noktalar) edinme sayısına göre */
+static int compare_by_wait(const void *a, const void *b) {
+    LockSite *sa = *(LockSite* const*)a, *sb = *(LockSite* const*)b;
+    double wa = total_wait_ns(sa), wb = total_wait_ns(sb);
+    if (wa != wb) return (wa < wb) - (wa > wb);
+    unsigned long long na = atomic_load_explicit(&sa->acquisitions.value, memory_order_relaxed);
+    unsigned long long nb = atomic_load_explicit(&sb->acquisitions.value, memory_order_relaxed);
+    return (na < nb) - (na > nb);
+}
+
+void lock_prof_dump(FILE *out) {
+    int capacity = atomic_load(&num_sites);
+    LockSite **sorted = malloc((capacity > 0 ? capacity : 1) * sizeof(LockSite*));
+    if (!sorted) {
+        perror("Failed to allocate lock profile dump");
+        return;
+    }
+    int n = 0;
+    for (LockSite *s = atomic_load(&sites_head); s != NULL && n < capacity; s = s->next) {
+        sorted[n++] = s;
+    }
+    qsort(sorted, n, sizeof(LockSite*), compare_by_wait);
+
+    fprintf(out, "Lock contention by site (%d sites, sorted by total wait):\n", n);
+    fprintf(out, "%-32s %-28s %10s %8s %11s %9s %9s %9s %9s\n", "site", "lock", "acquired", "contend%",
+            "wait_ms", "wait_p99", "wait_max", "hold_p50", "hold_p99");
+    for (int i = 0; i < n; i++) {
+        LockSite *s = sorted[i];
+        unsigned long long acquisitions = atomic_load_explicit(&s->acquisitions.value, memory_order_relaxed);
+        unsigned long long contended = atomic_load_explicit(&s->contended.value, memory_order_relaxed);
+        char where[64], w99[16], wmax[16], h50[16], h99[16];
+        snprintf(where, sizeof(where), "%s:%d", s->file, s->line);
+        fprintf(out, "%-32s %-28s %10llu %7.2f%% %11.3f %9s %9s %9s %9s\n", where, s->expr,
+                acquisitions, acquisitions ? 100.0 * contended / acquisitions : 0.0, total_wait_ns(s) / 1e6,
+                format_ns(w99, sizeof(w99), metric_histogram_quantile(&s->wait_ns, 0.99)),
+                format_ns(wmax, sizeof(wmax), metric_histogram_quantile(&s->wait_ns, 1.0)),
+                format_ns(h50, sizeof(h50), metric_histogram_quantile(&s->hold_ns, 0.50)),
+                format_ns(h99, sizeof(h99), metric_histogram_quantile(&s->hold_ns, 0.99)));
+    }
+    fflush(out);
+    free(sorted);
+}
+
+#else
+
+void lock_prof_dump(FILE *out) {
+    fprintf(out, "Lock profiling is not compiled in (rebuild with `make LOCK_PROFILING=1`).\n");
+    fflush(out);
+}
+
+#endif
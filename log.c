@@ -0,0 +1,271 @@
+/*
+ * log.c
+ * Thread başına kilitsiz halkalara yazılan, tek writer thread'inin toplu olarak boşalttığı seviyeli log.
+ */
+#include "headers/log.h"
+#include "headers/metrics.h"
+#include "headers/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_RING_MASK (LOG_RING_SLOTS - 1)
+#define LOG_WRITE_BATCH 1024   // Writer'ın bir turda topladığı en fazla mesaj
+
+_Static_assert((LOG_RING_SLOTS & LOG_RING_MASK) == 0, "log ring size must be a power of two");
+
+typedef struct log_entry {
+    long long ts_ns;           /* CLOCK_MONOTONIC; halkalar arası sıralama için */
+    unsigned short len;
+    unsigned char level;
+    char text[LOG_MSG_MAX];
+} LogEntry;
+
+/* Tek üretici (sahibi olan thread), tek tüketici (writer) */
+typedef struct log_ring {
+    atomic_int owned;
+    atomic_ullong head;
+    atomic_ullong tail;
+    _Atomic(LogEntry *) slots; /* İlk sahibi ayırır, halka devredilince tekrar kullanılır */
+} LogRing;
+
+atomic_int log_runtime_level = LOG_DEFAULT_LEVEL;
+
+static LogRing rings[LOG_MAX_RINGS];
+static atomic_int rings_used = 0;          /* Writer sadece bu sınırın altındaki halkalara bakar */
+static __thread LogRing *thread_ring = NULL;
+static pthread_key_t ring_key;
+static atomic_int writer_active = 0;
+static volatile int writer_running = 0;
+static pthread_t writer_thread;
+
+static LogEntry batch[LOG_WRITE_BATCH];   /* Sadece writer thread'i */
+static char out_buf[LOG_WRITE_BATCH * LOG_MSG_MAX];
+
+static MetricCounter msgs_written;
+static MetricCounter msgs_dropped;
+static MetricCounter msgs_suppressed;
+
+static long long monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int level_fd(int level) {
+    return level <= LOG_LEVEL_WARN ? STDERR_FILENO : STDOUT_FILENO;
+}
+
+static void write_all(int fd, const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+/* Thread çıkarken halkası serbest kalır; kalan mesajları writer yine boşaltır */
+static void release_ring(void *arg) {
+    LogRing *r = (LogRing*)arg;
+    atomic_store_explicit(&r->owned, 0, memory_order_release);
+}
+
+static LogRing *acquire_ring() {
+    for (int i = 0; i < LOG_MAX_RINGS; i++) {
+        LogRing *r = &rings[i];
+        int expected = 0;
+        if (atomic_load_explicit(&r->owned, memory_order_relaxed) ||
+            !atomic_compare_exchange_strong(&r->owned, &expected, 1)) continue;
+        if (!atomic_load(&r->slots)) {
+            LogEntry *slots = calloc(LOG_RING_SLOTS, sizeof(LogEntry));
+            if (!slots) {
+                atomic_store(&r->owned, 0);
+                return NULL;
+            }
+            atomic_store(&r->slots, slots);
+        }
+        int used = atomic_load(&rings_used);
+        while (used < i + 1 && !atomic_compare_exchange_weak(&rings_used, &used, i + 1)) {}
+        pthread_setspecific(ring_key, r);
+        return r;
+    }
+    return NULL;
+}
+
+/* Halka yoksa (writer kapalı veya LOG_MAX_RINGS dolu) mesaj çağıran thread'de yazılır */
+static void write_direct(int level, const char *fmt, va_list ap) {
+    char buf[LOG_MSG_MAX];
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    if (n < 0) return;
+    if (n >= (int)sizeof(buf)) {
+        n = sizeof(buf) - 1;
+        buf[n - 1] = '\n';
+    }
+    write_all(level_fd(level), buf, (size_t)n);
+}
+
+void log_write(int level, const char *fmt, ...) {
+    va_list ap;
+    LogRing *r = NULL;
+    if (atomic_load_explicit(&writer_active, memory_order_acquire)) {
+        if (!thread_ring) thread_ring = acquire_ring();
+        r = thread_ring;
+    }
+    if (!r) {
+        va_start(ap, fmt);
+        write_direct(level, fmt, ap);
+        va_end(ap);
+        return;
+    }
+
+    unsigned long long head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned long long tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail >= LOG_RING_SLOTS) {
+        // Writer yetişemiyor: çağıran beklemez, mesaj atılır
+        metric_counter_add(&msgs_dropped, 1);
+        return;
+    }
+    LogEntry *e = &atomic_load_explicit(&r->slots, memory_order_relaxed)[head & LOG_RING_MASK];
+    e->ts_ns = monotonic_ns();
+    e->level = (unsigned char)level;
+    va_start(ap, fmt);
+    int n = vsnprintf(e->text, sizeof(e->text), fmt, ap);
+    va_end(ap);
+    if (n < 0) n = 0;
+    if (n >= (int)sizeof(e->text)) {
+        n = sizeof(e->text) - 1;
+        e->text[n - 1] = '\n';
+    }
+    e->len = (unsigned short)n;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+static int compare_entries(const void *a, const void *b) {
+    const LogEntry *x = a, *y = b;
+    return x->ts_ns < y->ts_ns ? -1 : x->ts_ns > y->ts_ns;
+}
+
+/* Halkalardan en fazla LOG_WRITE_BATCH mesaj toplar, zamana göre sıralayıp yazar */
+static int drain_once() {
+    int n = 0;
+    int used = atomic_load(&rings_used);
+    for (int i = 0; i < used && n < LOG_WRITE_BATCH; i++) {
+        LogRing *r = &rings[i];
+        LogEntry *slots = atomic_load(&r->slots);
+        if (!slots) continue;
+        unsigned long long tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+        unsigned long long head = atomic_load_explicit(&r->head, memory_order_acquire);
+        while (tail != head && n < LOG_WRITE_BATCH) {
+            const LogEntry *e = &slots[tail & LOG_RING_MASK];
+            batch[n].ts_ns = e->ts_ns;
+            batch[n].level = e->level;
+            batch[n].len = e->len;
+            memcpy(batch[n].text, e->text, e->len);
+            n++;
+            tail++;
+        }
+        atomic_store_explicit(&r->tail, tail, memory_order_release);
+    }
+    if (n == 0) return 0;
+
+    qsort(batch, n, sizeof(LogEntry), compare_entries);
+    // Her akış tek write() ile: önce stdout, sonra stderr
+    for (int pass = 0; pass < 2; pass++) {
+        int fd = pass == 0 ? STDOUT_FILENO : STDERR_FILENO;
+        size_t len = 0;
+        for (int i = 0; i < n; i++) {
+            if (level_fd(batch[i].level) != fd) continue;
+            memcpy(out_buf + len, batch[i].text, batch[i].len);
+            len += batch[i].len;
+        }
+        if (len > 0) write_all(fd, out_buf, len);
+    }
+    metric_counter_add(&msgs_written, (unsigned long long)n);
+    return n;
+}
+
+static void *log_writer(void *arg) {
+    (void)arg;
+    trace_set_thread_name("log writer");
+    for (;;) {
+        int running = writer_running;
+        int n = drain_once();
+        if (n == 0) {
+            if (!running) break;
+            struct timespec ts = {0, LOG_WRITER_IDLE_MS * 1000000L};
+            nanosleep(&ts, NULL);
+        }
+    }
+    return NULL;
+}
+
+int log_init(int level) {
+    log_set_level(level);
+    if (pthread_key_create(&ring_key, release_ring) != 0) {
+        perror("Failed to create log thread key");
+        return 1;
+    }
+    metrics_register_counter(&msgs_written, "drone_server_log_messages_total", "result=\"written\"",
+                             "Log messages by outcome.");
+    metrics_register_counter(&msgs_dropped, "drone_server_log_messages_total", "result=\"dropped\"",
+                             "Log messages by outcome.");
+    metrics_register_counter(&msgs_suppressed, "drone_server_log_messages_total", "result=\"rate_limited\"",
+                             "Log messages by outcome.");
+    // Halkaya uğramayan printf'ler (başlangıç, özetler) satır satır çıksın ki sıra korunsun
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    writer_running = 1;
+    if (pthread_create(&writer_thread, NULL, log_writer, NULL) != 0) {
+        perror("Failed to create log writer thread");
+        writer_running = 0;
+        return 1;
+    }
+    atomic_store_explicit(&writer_active, 1, memory_order_release);
+    return 0;
+}
+
+void log_shutdown() {
+    if (!atomic_exchange(&writer_active, 0)) return;
+    writer_running = 0;
+    pthread_join(writer_thread, NULL);
+    // Halkalar serbest bırakılmaz: writer_active'i kapanıştan hemen önce görmüş bir thread hâlâ yazıyor olabilir
+}
+
+void log_set_level(int level) {
+    if (level < LOG_LEVEL_ERROR) level = LOG_LEVEL_ERROR;
+    if (level > LOG_LEVEL_DEBUG) level = LOG_LEVEL_DEBUG;
+    atomic_store(&log_runtime_level, level);
+}
+
+int log_level_from_name(const char *name) {
+    static const char *names[] = {"error", "warn", "info", "debug"};
+    for (int i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+        if (strcasecmp(name, names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int log_rate_allow(LogRateLimit *rl, int per_sec, int *suppressed) {
+    long long now_ms = monotonic_ns() / 1000000;
+    long long start = atomic_load_explicit(&rl->window_start_ms, memory_order_relaxed);
+    if (now_ms - start >= 1000 && atomic_compare_exchange_strong(&rl->window_start_ms, &start, now_ms)) {
+        atomic_store(&rl->passed, 0);
+    }
+    if (atomic_fetch_add(&rl->passed, 1) >= per_sec) {
+        atomic_fetch_add(&rl->suppressed, 1);
+        metric_counter_add(&msgs_suppressed, 1);
+        return 0;
+    }
+    *suppressed = atomic_exchange(&rl->suppressed, 0);
+    return 1;
+}
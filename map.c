@@ -30,7 +30,7 @@ void init_map(int height, int width) {
             map.cells[i][j].coord.x = i;
             map.cells[i][j].coord.y = j;
             // Create a survivor list for this cell (capacity 10)
-            map.cells[i][j].survivors = create_list(sizeof(Survivor*), 100);
+            map.cells[i][j].survivors = create_list(sizeof(SurvivorHandle), SURVIVOR_MAX_ACTIVE);
         }
     }
 
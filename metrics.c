@@ -0,0 +1,233 @@
+/*
+ * metrics.c
+ * Metrik kayıt defteri, HDR tarzı histogram kovaları ve Prometheus text çıktısı.
+ */
+#include "headers/metrics.h"
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+typedef enum { METRIC_COUNTER, METRIC_GAUGE, METRIC_GAUGE_FN, METRIC_HISTOGRAM } MetricKind;
+
+typedef struct metric_entry {
+    MetricKind kind;
+    const char *name;
+    const char *labels;      /* Örn. type="STATUS_UPDATE"; etiketsizse NULL */
+    const char *help;
+    void *metric;
+    metric_gauge_fn fn;      /* Sadece METRIC_GAUGE_FN */
+} MetricEntry;
+
+ServerMetrics server_metrics;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static MetricEntry registry[METRICS_MAX_ENTRIES];
+static int registry_count = 0;
+
+/* Mesaj tipi adı ve hangi yönde sayıldığı (1: drone/viewer -> server, 0: server -> istemci) */
+static const struct {
+    const char *label;
+    int inbound;
+} msg_types[METRIC_MSG_TYPES] = {
+    [METRIC_MSG_HANDSHAKE] = {"type=\"HANDSHAKE\"", 1},
+    [METRIC_MSG_HANDSHAKE_ACK] = {"type=\"HANDSHAKE_ACK\"", 0},
+    [METRIC_MSG_STATUS_UPDATE] = {"type=\"STATUS_UPDATE\"", 1},
+    [METRIC_MSG_HEARTBEAT] = {"type=\"HEARTBEAT\"", 0},
+    [METRIC_MSG_HEARTBEAT_RESPONSE] = {"type=\"HEARTBEAT_RESPONSE\"", 1},
+    [METRIC_MSG_ASSIGN_MISSION] = {"type=\"ASSIGN_MISSION\"", 0},
+    [METRIC_MSG_MISSION_COMPLETE] = {"type=\"MISSION_COMPLETE\"", 1},
+    [METRIC_MSG_ERROR] = {"type=\"ERROR\"", 0},
+    [METRIC_MSG_VIEWER_HANDSHAKE] = {"type=\"VIEWER_HANDSHAKE\"", 1},
+    [METRIC_MSG_VIEWER_HANDSHAKE_ACK] = {"type=\"VIEWER_HANDSHAKE_ACK\"", 0},
+    [METRIC_MSG_VIEWER_RESYNC] = {"type=\"VIEWER_RESYNC\"", 1},
+    [METRIC_MSG_VIEWER_SUBSCRIBE] = {"type=\"VIEWER_SUBSCRIBE\"", 1},
+    [METRIC_MSG_STATE_DELTA] = {"type=\"SIMULATION_STATE_DELTA\"", 0},
+    [METRIC_MSG_STATE_KEYFRAME] = {"type=\"SIMULATION_STATE_UPDATE\"", 0},
+    [METRIC_MSG_OTHER] = {"type=\"OTHER\"", 1},
+};
+
+long long metrics_now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+ * Küçük değerler (< 2^SUB_BITS) birebir, büyükler en anlamlı bit (oktav) ve
+ * altındaki SUB_BITS bit ile kovalanır: her oktav eşit genişlikte alt kovalara bölünür.
+ */
+static int histogram_bucket_index(unsigned long long v) {
+    const unsigned long long sub_count = 1ULL << METRICS_HIST_SUB_BITS;
+    if (v < sub_count) return (int)v;
+    int msb = 63 - __builtin_clzll(v);
+    int octave = msb - METRICS_HIST_SUB_BITS + 1;
+    int sub = (int)((v >> (msb - METRICS_HIST_SUB_BITS)) & (sub_count - 1));
+    int index = (octave << METRICS_HIST_SUB_BITS) + sub;
+    return index < METRICS_HIST_BUCKETS ? index : METRICS_HIST_BUCKETS;
+}
+
+/* Kovanın kapsadığı en büyük değer (dahil) */
+static unsigned long long histogram_bucket_upper(int index) {
+    const unsigned long long sub_count = 1ULL << METRICS_HIST_SUB_BITS;
+    if (index < (int)sub_count) return (unsigned long long)index;
+    int octave = index >> METRICS_HIST_SUB_BITS;
+    int sub = index & (int)(sub_count - 1);
+    int shift = octave - 1;
+    unsigned long long lower = (sub_count + sub) << shift;
+    return lower + (1ULL << shift) - 1;
+}
+
+void metric_histogram_record(MetricHistogram *h, unsigned long long value) {
+    atomic_fetch_add_explicit(&h->buckets[histogram_bucket_index(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+}
+
+unsigned long long metric_histogram_quantile(MetricHistogram *h, double q) {
+    unsigned long long counts[METRICS_HIST_BUCKETS + 1];
+    unsigned long long total = 0;
+    for (int i = 0; i <= METRICS_HIST_BUCKETS; i++) {
+        counts[i] = atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return 0;
+    unsigned long long rank = (unsigned long long)(q * (double)total + 0.5);
+    if (rank < 1) rank = 1;
+    unsigned long long cumulative = 0;
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        cumulative += counts[i];
+        if (cumulative >= rank) return histogram_bucket_upper(i);
+    }
+    // Taşma kovası: en büyük sınırla doyurulur
+    return histogram_bucket_upper(METRICS_HIST_BUCKETS - 1);
+}
+
+static int register_entry(MetricKind kind, void *metric, metric_gauge_fn fn,
+                          const char *name, const char *labels, const char *help) {
+    pthread_mutex_lock(&registry_lock);
+    if (registry_count >= METRICS_MAX_ENTRIES) {
+        pthread_mutex_unlock(&registry_lock);
+        fprintf(stderr, "Metrics registry full, %s not registered.\n", name);
+        return 1;
+    }
+    MetricEntry *e = &registry[registry_count++];
+    e->kind = kind;
+    e->name = name;
+    e->labels = labels;
+    e->help = help;
+    e->metric = metric;
+    e->fn = fn;
+    pthread_mutex_unlock(&registry_lock);
+    return 0;
+}
+
+int metrics_register_counter(MetricCounter *c, const char *name, const char *labels, const char *help) {
+    return register_entry(METRIC_COUNTER, c, NULL, name, labels, help);
+}
+
+int metrics_register_gauge(MetricGauge *g, const char *name, const char *labels, const char *help) {
+    return register_entry(METRIC_GAUGE, g, NULL, name, labels, help);
+}
+
+int metrics_register_gauge_fn(metric_gauge_fn fn, void *arg, const char *name, const char *labels, const char *help) {
+    return register_entry(METRIC_GAUGE_FN, arg, fn, name, labels, help);
+}
+
+int metrics_register_histogram(MetricHistogram *h, const char *name, const char *labels, const char *help) {
+    return register_entry(METRIC_HISTOGRAM, h, NULL, name, labels, help);
+}
+
+void metrics_init() {
+    memset(&server_metrics, 0, sizeof(server_metrics));
+    for (int i = 0; i < METRIC_MSG_TYPES; i++) {
+        if (msg_types[i].inbound) {
+            metrics_register_counter(&server_metrics.messages_in[i], "drone_server_messages_received_total",
+                                     msg_types[i].label, "Messages received from drones and viewers, by type.");
+        }
+    }
+    for (int i = 0; i < METRIC_MSG_TYPES; i++) {
+        if (!msg_types[i].inbound) {
+            metrics_register_counter(&server_metrics.messages_out[i], "drone_server_messages_sent_total",
+                                     msg_types[i].label, "Messages queued to drones and viewers, by type.");
+        }
+    }
+    metrics_register_counter(&server_metrics.bytes_in, "drone_server_received_bytes_total", NULL,
+                             "Bytes read from client sockets and telemetry datagrams.");
+    metrics_register_counter(&server_metrics.bytes_out, "drone_server_sent_bytes_total", NULL,
+                             "Bytes written to client sockets.");
+    metrics_register_counter(&server_metrics.viewer_frames_dropped, "drone_server_viewer_frames_dropped_total", NULL,
+                             "State frames replaced before a slow viewer could read them.");
+    metrics_register_counter(&server_metrics.viewer_stream_raw_bytes, "drone_server_viewer_compression_bytes_total",
+                             "stage=\"input\"", "Bytes passed through per-viewer deflate streams.");
+    metrics_register_counter(&server_metrics.viewer_stream_compressed_bytes, "drone_server_viewer_compression_bytes_total",
+                             "stage=\"output\"", "Bytes passed through per-viewer deflate streams.");
+    metrics_register_gauge(&server_metrics.drones_connected, "drone_server_connected_drones", NULL,
+                           "Drones with an open connection.");
+    metrics_register_gauge(&server_metrics.viewers_connected, "drone_server_connected_viewers", NULL,
+                           "Viewers with an open connection.");
+    metrics_register_histogram(&server_metrics.ai_pass_us, "drone_server_ai_pass_duration_seconds", NULL,
+                               "Time spent in one AI assignment pass.");
+    metrics_register_histogram(&server_metrics.serialize_keyframe_us, "drone_server_serialize_duration_seconds",
+                               "kind=\"keyframe\"", "Time spent serializing one viewer state frame.");
+    metrics_register_histogram(&server_metrics.serialize_delta_us, "drone_server_serialize_duration_seconds",
+                               "kind=\"delta\"", "Time spent serializing one viewer state frame.");
+}
+
+/* name{labels} veya name{labels,extra} yazar */
+static void write_series(FILE *out, const char *name, const char *suffix, const char *labels, const char *extra) {
+    fprintf(out, "%s%s", name, suffix);
+    if (labels || extra) {
+        fprintf(out, "{%s%s%s}", labels ? labels : "", labels && extra ? "," : "", extra ? extra : "");
+    }
+    fputc(' ', out);
+}
+
+static void write_histogram(FILE *out, const MetricEntry *e) {
+    MetricHistogram *h = (MetricHistogram*)e->metric;
+    // Kovalar ayrı ayrı okunur; kümülatif toplam ile count tutarlı olsun diye count kovalardan hesaplanır
+    unsigned long long cumulative = 0;
+    char le[48];
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        cumulative += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        snprintf(le, sizeof(le), "le=\"%.6f\"", (double)histogram_bucket_upper(i) / 1e6);
+        write_series(out, e->name, "_bucket", e->labels, le);
+        fprintf(out, "%llu\n", cumulative);
+    }
+    cumulative += atomic_load_explicit(&h->buckets[METRICS_HIST_BUCKETS], memory_order_relaxed);
+    write_series(out, e->name, "_bucket", e->labels, "le=\"+Inf\"");
+    fprintf(out, "%llu\n", cumulative);
+    write_series(out, e->name, "_sum", e->labels, NULL);
+    fprintf(out, "%.6f\n", (double)atomic_load_explicit(&h->sum, memory_order_relaxed) / 1e6);
+    write_series(out, e->name, "_count", e->labels, NULL);
+    fprintf(out, "%llu\n", cumulative);
+}
+
+void metrics_write_prometheus(FILE *out) {
+    static const char *type_names[] = {"counter", "gauge", "gauge", "histogram"};
+    pthread_mutex_lock(&registry_lock);
+    const char *previous_name = NULL;
+    for (int i = 0; i < registry_count; i++) {
+        const MetricEntry *e = &registry[i];
+        if (!previous_name || strcmp(previous_name, e->name) != 0) {
+            fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", e->name, e->help, e->name, type_names[e->kind]);
+            previous_name = e->name;
+        }
+        switch (e->kind) {
+            case METRIC_COUNTER:
+                write_series(out, e->name, "", e->labels, NULL);
+                fprintf(out, "%llu\n", atomic_load_explicit(&((MetricCounter*)e->metric)->value, memory_order_relaxed));
+                break;
+            case METRIC_GAUGE:
+                write_series(out, e->name, "", e->labels, NULL);
+                fprintf(out, "%lld\n", atomic_load_explicit(&((MetricGauge*)e->metric)->value, memory_order_relaxed));
+                break;
+            case METRIC_GAUGE_FN:
+                write_series(out, e->name, "", e->labels, NULL);
+                fprintf(out, "%lld\n", e->fn(e->metric));
+                break;
+            case METRIC_HISTOGRAM:
+                write_histogram(out, e);
+                break;
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
@@ -0,0 +1,153 @@
+/*
+ * mpsc_ring.c
+ * Kilitsiz çok üreticili halka ve onu toplu yazımla dosyaya boşaltan writer thread'i.
+ */
+#include "headers/mpsc_ring.h"
+#include "headers/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SLOT_HEADER_SIZE sizeof(atomic_ullong)
+
+static atomic_ullong *slot_seq(MpscRing *ring, unsigned long long pos) {
+    return (atomic_ullong*)(ring->slots + (pos & (ring->capacity - 1)) * ring->slot_size);
+}
+
+int mpsc_ring_init(MpscRing *ring, unsigned long long capacity, size_t record_size) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        fprintf(stderr, "Ring capacity must be a power of two.\n");
+        return 1;
+    }
+    ring->record_size = record_size;
+    ring->slot_size = (SLOT_HEADER_SIZE + record_size + 7) & ~(size_t)7;
+    ring->capacity = capacity;
+    ring->slots = calloc(capacity, ring->slot_size);
+    if (!ring->slots) {
+        perror("Failed to allocate ring");
+        return 1;
+    }
+    for (unsigned long long i = 0; i < capacity; i++) atomic_init(slot_seq(ring, i), i);
+    atomic_init(&ring->enqueue_pos, 0);
+    ring->dequeue_pos = 0;
+    return 0;
+}
+
+void *mpsc_ring_reserve(MpscRing *ring, unsigned long long *pos_out) {
+    unsigned long long pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    atomic_ullong *seq_ptr;
+    for (;;) {
+        seq_ptr = slot_seq(ring, pos);
+        unsigned long long seq = atomic_load_explicit(seq_ptr, memory_order_acquire);
+        long long diff = (long long)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // Tüketici bir tur geride: beklemek yerine kayıt atılır
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    *pos_out = pos;
+    return (unsigned char*)seq_ptr + SLOT_HEADER_SIZE;
+}
+
+void mpsc_ring_publish(MpscRing *ring, void *record, unsigned long long pos) {
+    atomic_ullong *seq_ptr = (atomic_ullong*)((unsigned char*)record - SLOT_HEADER_SIZE);
+    (void)ring;
+    atomic_store_explicit(seq_ptr, pos + 1, memory_order_release);
+}
+
+int mpsc_ring_pop_batch(MpscRing *ring, void *out, int max) {
+    unsigned char *dst = out;
+    int n = 0;
+    while (n < max) {
+        atomic_ullong *seq_ptr = slot_seq(ring, ring->dequeue_pos);
+        if (atomic_load_explicit(seq_ptr, memory_order_acquire) != ring->dequeue_pos + 1) break;
+        memcpy(dst + (size_t)n * ring->record_size, (unsigned char*)seq_ptr + SLOT_HEADER_SIZE, ring->record_size);
+        n++;
+        // Yuva halkanın bir sonraki turundaki üreticiye açılır
+        atomic_store_explicit(seq_ptr, ring->dequeue_pos + ring->capacity, memory_order_release);
+        ring->dequeue_pos++;
+    }
+    return n;
+}
+
+static long long monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void *writer_main(void *arg) {
+    MpscWriter *writer = arg;
+    const MpscWriterOps *ops = writer->ops;
+    trace_set_thread_name(ops->thread_name);
+    long long last_sync_ms = monotonic_ms();
+    int dirty = 0;
+
+    for (;;) {
+        // Kapanışta halka boşalana kadar yazmaya devam edilir
+        int running = writer->running;
+        int n = mpsc_ring_pop_batch(writer->ring, writer->batch, ops->batch_max);
+        if (n > 0 && ops->write_batch(writer->batch, n) == 0) dirty = 1;
+        long long now_ms = monotonic_ms();
+        if (dirty && now_ms - last_sync_ms >= ops->sync_interval_ms) {
+            ops->sync();
+            dirty = 0;
+            last_sync_ms = now_ms;
+        }
+        if (n == 0) {
+            if (!running) break;
+            struct timespec ts = {0, ops->idle_wait_ms * 1000000L};
+            nanosleep(&ts, NULL);
+        }
+    }
+    if (ops->finish) ops->finish();
+    return NULL;
+}
+
+int mpsc_writer_start(MpscWriter *writer, MpscRing *ring, const MpscWriterOps *ops) {
+    writer->ring = ring;
+    writer->ops = ops;
+    writer->batch = malloc((size_t)ops->batch_max * ring->record_size);
+    if (!writer->batch) {
+        perror("Failed to allocate writer batch");
+        return 1;
+    }
+    writer->running = 1;
+    if (pthread_create(&writer->thread, NULL, writer_main, writer) != 0) {
+        perror("Failed to create writer thread");
+        writer->running = 0;
+        free(writer->batch);
+        writer->batch = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+void mpsc_writer_stop(MpscWriter *writer) {
+    writer->running = 0;
+    pthread_join(writer->thread, NULL);
+    free(writer->batch);
+    writer->batch = NULL;
+}
+
+int mpsc_write_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * replay.c
+ * Journal segmentlerindeki survivor ve drone olaylarını sanal saatte tekrar oynatır.
+ */
+#include "headers/replay.h"
+#include "headers/journal.h"
+#include "headers/survivor.h"
+#include "headers/virtual_drone.h"
+#include "headers/simclock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static JournalRecord *events = NULL;   /* Sadece tekrar oynatılan türler, zamana göre sıralı */
+static size_t event_count = 0;
+static size_t event_capacity = 0;
+static size_t next_event = 0;
+static int finished = 0;
+
+static int replayed_type(int type) {
+    return type == JOURNAL_SURVIVOR_SPAWNED || type == JOURNAL_DRONE_CONNECTED || type == JOURNAL_DRONE_REMOVED;
+}
+
+static int append_event(const JournalRecord *r) {
+    if (event_count == event_capacity) {
+        size_t cap = event_capacity ? event_capacity * 2 : 1024;
+        JournalRecord *grown = realloc(events, cap * sizeof(JournalRecord));
+        if (!grown) {
+            perror("Failed to grow replay event table");
+            return 1;
+        }
+        events = grown;
+        event_capacity = cap;
+    }
+    events[event_count++] = *r;
+    return 0;
+}
+
+static int load_segment(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Replay: %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Replay: mmap %s failed: %s\n", path, strerror(errno));
+        return 1;
+    }
+    size_t count;
+    const JournalRecord *records = journal_segment_records(base, size, &count);
+    int failed = 0;
+    if (!records) {
+        fprintf(stderr, "Replay: %s is not a version %d journal segment\n", path, JOURNAL_VERSION);
+        failed = 1;
+    }
+    for (size_t i = 0; records && i < count && !failed; i++) {
+        if (replayed_type(records[i].type)) failed = append_event(&records[i]);
+    }
+    munmap(base, size);
+    return failed;
+}
+
+/* Eşzamanlı üreticilerin zaman damgaları sıra numarasıyla tam örtüşmeyebilir */
+static int compare_events(const void *a, const void *b) {
+    const JournalRecord *x = a, *y = b;
+    if (x->timestamp_ns != y->timestamp_ns) return x->timestamp_ns < y->timestamp_ns ? -1 : 1;
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+static int segment_filter(const struct dirent *ent) {
+    return journal_is_segment_name(ent->d_name);
+}
+
+int replay_open(const char *dir, long long *first_ns, long long *last_ns) {
+    struct dirent **names;
+    int n = scandir(dir, &names, segment_filter, alphasort);
+    if (n < 0) {
+        fprintf(stderr, "Replay: cannot read %s: %s\n", dir, strerror(errno));
+        return 1;
+    }
+    int failed = 0;
+    char path[4096];
+    for (int i = 0; i < n; i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]->d_name);
+        if (!failed) failed = load_segment(path);
+        free(names[i]);
+    }
+    free(names);
+    if (failed) return 1;
+    if (event_count == 0) {
+        fprintf(stderr, "Replay: no survivor or drone events in %s.\n", dir);
+        return 1;
+    }
+    qsort(events, event_count, sizeof(JournalRecord), compare_events);
+    *first_ns = (long long)events[0].timestamp_ns;
+    *last_ns = (long long)events[event_count - 1].timestamp_ns;
+    printf("Replay: %zu events from %d segment(s) spanning %.1f s.\n", event_count, n,
+           (double)(*last_ns - *first_ns) / 1e9);
+    return 0;
+}
+
+static void apply_event(const JournalRecord *r) {
+    char drone_id[sizeof(r->drone_id) + 1];
+    memcpy(drone_id, r->drone_id, sizeof(r->drone_id));
+    drone_id[sizeof(r->drone_id)] = '\0';
+    switch (r->type) {
+        case JOURNAL_SURVIVOR_SPAWNED: {
+            char info[25];
+            snprintf(info, sizeof(info), "SURV-%04d", r->survivor_id % 10000);
+            survivor_spawn_at((Coord){r->x, r->y}, info);
+            break;
+        }
+        case JOURNAL_DRONE_CONNECTED:
+            virtual_drone_add(drone_id, (Coord){r->x, r->y});
+            break;
+        case JOURNAL_DRONE_REMOVED:
+            virtual_drone_remove(drone_id);
+            break;
+    }
+}
+
+void replay_tick(unsigned long long tick) {
+    (void)tick;
+    long long now = sim_realtime_ns();
+    while (next_event < event_count && (long long)events[next_event].timestamp_ns <= now) {
+        apply_event(&events[next_event++]);
+    }
+    if (next_event == event_count && !finished) {
+        printf("Replay: all %zu events applied.\n", event_count);
+        finished = 1;
+    }
+}
+
+void replay_close() {
+    free(events);
+    events = NULL;
+    event_count = event_capacity = next_event = 0;
+}
@@ -1,11 +1,34 @@
 // server.c
 #include "headers/globals.h"
 #include "headers/list.h"
+#include "headers/lock_prof.h"
 #include "headers/drone.h"
+#include "headers/drone_registry.h"
 #include "headers/survivor.h"
 #include "headers/ai.h"
 #include "headers/map.h"
 #include "headers/connection_handling.h"
+#include "headers/broadcast.h"
+#include "headers/client_conn.h"
+#include "headers/json_writer.h"
+#include "headers/drone_msg.h"
+#include "headers/acceptor.h"
+#include "headers/timer_wheel.h"
+#include "headers/tick.h"
+#include "headers/stream_deflate.h"
+#include "headers/admission.h"
+#include "headers/journal.h"
+#include "headers/simclock.h"
+#include "headers/virtual_drone.h"
+#include "headers/replay.h"
+#include "headers/checkpoint.h"
+#include "headers/archive.h"
+#include "headers/telemetry.h"
+#include "headers/shm_world.h"
+#include "headers/metrics.h"
+#include "headers/admin_http.h"
+#include "headers/trace.h"
+#include "headers/log.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,154 +41,327 @@
 #include <time.h>
 #include <json.h>
 #include <errno.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <sys/random.h>
 
 #define SERVER_PORT 8080
-#define MAX_PENDING_CONNECTIONS 15
 #define BUFFER_SIZE 1024
 #define RECV_AGGREGATE_BUFFER_SIZE (BUFFER_SIZE * 4)
-#define VIEWER_UPDATE_INTERVAL_MS 40 // 25 fps ≃ 40 ms
+#define DRONE_HANDLER_POLL_MS 500               // Handler bu aralıkla server_running'i kontrol eder
+#define HANDLER_SHUTDOWN_WAIT_MS 5000           // Kapanışta handler thread'lerinin çıkması için en fazla bekleme
 
 // --- Global Değişkenler ---
 List *viewers_list = NULL;
 pthread_mutex_t viewers_list_lock;
 
 // Sinyal işleyici ve ana döngü tarafından kullanılan global değişkenler
-int server_socket_fd = -1;
 volatile sig_atomic_t server_running = 1;
+// SIGUSR1: kilit profili dökümü ana döngüde yazılır (sinyal işleyicide stdio güvenli değil)
+volatile sig_atomic_t lock_dump_requested = 0;
+// SIGUSR2: span halkaları Chrome trace dosyasına yazılır
+volatile sig_atomic_t trace_dump_requested = 0;
+// Çalışan drone/viewer handler thread'leri; ana thread global yapıları bunlar bitmeden serbest bırakmaz
+static atomic_int client_handlers_active = 0;
 
 // --- Fonksiyon Prototipleri ---
 void* handle_viewer_connection(void* arg);
 void* handle_drone_connection(void* arg);
 void server_signal_handler(int signum);
-void send_json_to_client_socket(int sock_fd, struct json_object *json_obj, const char* log_prefix);
-struct json_object* create_simulation_state_update_json();
+void send_json_to_client(ClientConn *conn, struct json_object *json_obj, const char* log_prefix);
 // Hata mesajı göndermek için yardımcı fonksiyon
-typedef enum { ERROR_NONE, ERROR_HANDSHAKE, ERROR_JSON, ERROR_TIMEOUT, ERROR_MISSION } ErrorType;
-void send_error_to_client(int sock_fd, const char* error_msg, ErrorType err_type) {
+typedef enum { ERROR_NONE, ERROR_HANDSHAKE, ERROR_JSON, ERROR_TIMEOUT, ERROR_MISSION, ERROR_OVERLOADED } ErrorType;
+void send_error_to_client(ClientConn *conn, const char* error_msg, ErrorType err_type) {
     struct json_object *err_json = json_object_new_object();
     json_object_object_add(err_json, "type", json_object_new_string("ERROR"));
     json_object_object_add(err_json, "error_msg", json_object_new_string(error_msg));
     json_object_object_add(err_json, "error_type", json_object_new_int(err_type));
-    const char *json_str_raw = json_object_to_json_string_ext(err_json, JSON_C_TO_STRING_PLAIN);
-    char message_with_newline[strlen(json_str_raw) + 2];
-    sprintf(message_with_newline, "%s\n", json_str_raw);
-    send(sock_fd, message_with_newline, strlen(message_with_newline), 0);
+    if (conn_send_json(conn, err_json) == 0) metric_counter_add(&server_metrics.messages_out[METRIC_MSG_ERROR], 1);
     json_object_put(err_json);
 }
 
-void send_json_to_client_socket(int sock_fd, struct json_object *json_obj, const char* log_prefix) {
-    if (!json_obj) return;
-    const char *json_str_raw = json_object_to_json_string_ext(json_obj, JSON_C_TO_STRING_PLAIN);
-    if (!json_str_raw) {
-        fprintf(stderr, "%s: Failed to stringify JSON object for socket %d.\n", log_prefix, sock_fd);
+/* Kabul reddi veya viewer atılması: istemci retry_after_ms sonra yeniden denemelidir */
+static void send_overloaded_to_client(ClientConn *conn, const char *error_msg, AdmissionResult result) {
+    struct json_object *err_json = json_object_new_object();
+    json_object_object_add(err_json, "type", json_object_new_string("ERROR"));
+    json_object_object_add(err_json, "error_msg", json_object_new_string(error_msg));
+    json_object_object_add(err_json, "error_type", json_object_new_int(ERROR_OVERLOADED));
+    json_object_object_add(err_json, "reason", json_object_new_string(admission_reason(result)));
+    json_object_object_add(err_json, "retry_after_ms", json_object_new_int(admission_retry_after_ms(result)));
+    if (conn_send_json(conn, err_json) == 0) metric_counter_add(&server_metrics.messages_out[METRIC_MSG_ERROR], 1);
+    json_object_put(err_json);
+}
+
+void send_json_to_client(ClientConn *conn, struct json_object *json_obj, const char* log_prefix) {
+    if (!json_obj || !conn) return;
+    if (conn_send_json(conn, json_obj) < 0) {
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "%s: Failed to send JSON to socket %d\n", log_prefix, conn->fd);
+    }
+}
+
+/* Handler thread'lerinin çıkışta kalan kuyruğu boşaltması için kısa süreli bekleme */
+static void drain_client_conn(ClientConn *conn, int timeout_ms) {
+    while (timeout_ms > 0 && conn_pending_bytes(conn) > 0) {
+        fd_set write_fds;
+        FD_ZERO(&write_fds);
+        FD_SET(conn->fd, &write_fds);
+        struct timeval tv = {0, 50000};
+        if (select(conn->fd + 1, NULL, &write_fds, NULL, &tv) < 0 && errno != EINTR) break;
+        if (conn_flush(conn) < 0) break;
+        timeout_ms -= 50;
+    }
+}
+
+/**
+ * @brief Applies a STATUS_UPDATE / HEARTBEAT_RESPONSE to the drone, regardless of
+ *        whether it came through the fast parser or the json-c fallback.
+ */
+static void handle_drone_message(Drone *drone, const DroneMessage *msg, const char *log_prefix) {
+    if (msg->type != DRONE_MSG_STATUS_UPDATE) {
+        // HEARTBEAT_RESPONSE: sadece sessizlik bozulsun diye; zaman damgası recv'de güncellendi
         return;
     }
+    if (!msg->has_drone_id || strcmp(msg->drone_id, drone->id_str) != 0) {
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 5, "%s: STATUS_UPDATE mismatched ID. Expected %s, got %s\n",
+                        log_prefix, drone->id_str, msg->has_drone_id ? msg->drone_id : "N/A");
+        return;
+    }
+    PROFILED_LOCK(&drone->lock);
+    drone_msg_apply_status(drone, msg);
+    PROFILED_UNLOCK(&drone->lock);
+}
+
+static void drone_heartbeat_timer(TimerEntry *timer, void *arg) {
+    Drone *drone = (Drone*)arg;
+    char hb_storage[64];
+    JsonWriter hb_msg;
+    json_writer_init_fixed(&hb_msg, hb_storage, sizeof(hb_storage));
+    jw_object_begin(&hb_msg);
+    jw_kv_string(&hb_msg, "type", "HEARTBEAT");
+    jw_kv_int(&hb_msg, "timestamp", (long long)sim_time());
+    jw_object_end(&hb_msg);
+    jw_newline(&hb_msg);
+    if (hb_msg.error || conn_send_control(drone->conn, hb_msg.buf, hb_msg.len) < 0) {
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 5, "[Timer] Failed to send HEARTBEAT to drone %s\n", drone->id_str);
+    } else {
+        metric_counter_add(&server_metrics.messages_out[METRIC_MSG_HEARTBEAT], 1);
+    }
+    timer_schedule(timer, DRONE_HEARTBEAT_INTERVAL_MS);
+}
 
-    char message_with_newline[strlen(json_str_raw) + 2];
-    sprintf(message_with_newline, "%s\n", json_str_raw);
+/* Her mesajda yeniden kurmak yerine süre dolunca son aktivite zamanına bakılır */
+static void drone_liveness_timer(TimerEntry *timer, void *arg) {
+    Drone *drone = (Drone*)arg;
+    PROFILED_LOCK(&drone->lock);
+    time_t last_activity = drone->last_heartbeat_time;
+    PROFILED_UNLOCK(&drone->lock);
+
+    long silent_ms = (long)(sim_time() - last_activity) * 1000;
+    if (silent_ms >= DRONE_LIVENESS_TIMEOUT_MS) {
+        LOG_WARN("[Timer] Drone %s timed out (no client activity/heartbeat).\n", drone->id_str);
+        // Handler thread'i recv'den 0 alıp bağlantıyı kendisi kapatır
+        shutdown(drone->socket_fd, SHUT_RDWR);
+        return;
+    }
+    timer_schedule(timer, DRONE_LIVENESS_TIMEOUT_MS - silent_ms);
+}
 
-    if (send(sock_fd, message_with_newline, strlen(message_with_newline), 0) < 0) {
-        fprintf(stderr, "%s: Failed to send JSON to socket %d\n", log_prefix, sock_fd);
+static void drone_mission_timer(TimerEntry *timer, void *arg) {
+    Drone *drone = (Drone*)arg;
+    PROFILED_LOCK(&drone->lock);
+    // Kilit beklenirken görev tamamlanmış veya yeni görev kurulmuş olabilir
+    Survivor *target = survivor_get(drone->current_survivor_target);
+    if (timer_pending(timer) || drone->status != ON_MISSION || !target) {
+        PROFILED_UNLOCK(&drone->lock);
+        return;
     }
+    LOG_WARN("[Timer] Drone %s mission %s timed out, survivor %s returned for reassignment.\n",
+             drone->id_str, drone->mission_id, target->info);
+    drone_release_mission_locked(drone, JOURNAL_RELEASE_MISSION_TIMEOUT);
+    // Oturum ayrılmışsa conn NULL'dur; handler conn'u sadece bu kilit altında değiştirir
+    if (drone->conn) send_error_to_client(drone->conn, "Mission timed out", ERROR_MISSION);
+    PROFILED_UNLOCK(&drone->lock);
 }
 
-struct json_object* create_simulation_state_update_json() {
-    struct json_object *state_update_msg = json_object_new_object();
-    if (!state_update_msg) return NULL;
-
-    json_object_object_add(state_update_msg, "type", json_object_new_string("SIMULATION_STATE_UPDATE"));
-    json_object_object_add(state_update_msg, "timestamp", json_object_new_int64(time(NULL)));
-
-    // Map boyutu
-    struct json_object *map_dim_obj = json_object_new_object();
-    if(map_dim_obj) {
-        json_object_object_add(map_dim_obj, "width", json_object_new_int(map.width));
-        json_object_object_add(map_dim_obj, "height", json_object_new_int(map.height));
-        json_object_object_add(state_update_msg, "map_dimensions", map_dim_obj);
-    }
-
-    // Droneları ekle
-    struct json_object *drones_json_array = json_object_new_array();
-    if (drones && drones_json_array) {
-        pthread_mutex_lock(&drones->lock);
-        Node *d_node = drones->head;
-        while (d_node != NULL) {
-            Drone *d = *(Drone**)d_node->data;
-            if (d) {
-                pthread_mutex_lock(&d->lock);
-                struct json_object *d_json = json_object_new_object();
-                if (d_json) {
-                    json_object_object_add(d_json, "id_str", json_object_new_string(d->id_str));
-                    struct json_object *coord_json = json_object_new_object();
-                    if (coord_json) {
-                        json_object_object_add(coord_json, "x", json_object_new_int(d->coord.x));
-                        json_object_object_add(coord_json, "y", json_object_new_int(d->coord.y));
-                        json_object_object_add(d_json, "coord", coord_json);
-                    }
-                    struct json_object *target_json = json_object_new_object();
-                    if (target_json) {
-                        json_object_object_add(target_json, "x", json_object_new_int(d->target.x));
-                        json_object_object_add(target_json, "y", json_object_new_int(d->target.y));
-                        json_object_object_add(d_json, "target", target_json);
-                    }
-                    json_object_object_add(d_json, "status", json_object_new_string(d->status == IDLE ? "IDLE" : "ON_MISSION"));
-                    json_object_array_add(drones_json_array, d_json);
-                }
-                pthread_mutex_unlock(&d->lock);
-            }
-            d_node = d_node->next;
-        }
-        pthread_mutex_unlock(&drones->lock);
-    }
-    json_object_object_add(state_update_msg, "drones", drones_json_array);
-
-    // Survivorları ekle
-    struct json_object *survivors_json_array = json_object_new_array();
-    if (survivors && survivors_json_array) {
-        pthread_mutex_lock(&survivors->lock);
-        Node *s_node = survivors->head;
-        while (s_node != NULL) {
-            Survivor *s = *(Survivor**)s_node->data;
-            if (s) {
-                struct json_object *s_json = json_object_new_object();
-                if (s_json) {
-                    json_object_object_add(s_json, "info", json_object_new_string(s->info));
-                    struct json_object *coord_json_s = json_object_new_object();
-                    if (coord_json_s) {
-                        json_object_object_add(coord_json_s, "x", json_object_new_int(s->coord.x));
-                        json_object_object_add(coord_json_s, "y", json_object_new_int(s->coord.y));
-                        json_object_object_add(s_json, "coord", coord_json_s);
-                    }
+/*
+ * Drone'u kayıttan ve listeden çıkarıp serbest bırakır. drone->lock tutulmadan çağrılır;
+ * heartbeat/liveness zamanlayıcıları çağırandan önce durdurulmuş olmalıdır.
+ */
+static void finish_drone_session(Drone *drone, const char *log_prefix) {
+    // Önce kayıttan çıkarılır: drone_registry_acquire ile kilidi tutan varsa aşağıdaki kilit onu bekler
+    drone_registry_remove(drone);
+    // CLOSED drone'a AI görev vermez ve mission_timer'ı kurmaz
+    PROFILED_LOCK(&drone->lock);
+    drone->session = DRONE_SESSION_CLOSED;
+    PROFILED_UNLOCK(&drone->lock);
+    if (drones->removedata(drones, &drone) == 0) {
+        LOG_INFO("%s: Removed from list. Total: %d\n", log_prefix, drones->number_of_elements);
+    }
+    // Listeden çıktıktan sonra yeni görev gelemez; CLOSED'dan önce verilmiş görev burada bırakılır
+    PROFILED_LOCK(&drone->lock);
+    if (!survivor_handle_is_none(drone->current_survivor_target)) {
+        LOG_INFO("%s: Session ended during mission, survivor returned for reassignment.\n", log_prefix);
+        drone_release_mission_locked(drone, JOURNAL_RELEASE_SESSION_ENDED);
+    }
+    PROFILED_UNLOCK(&drone->lock);
+    journal_log(JOURNAL_DRONE_REMOVED, drone->id_str, -1, drone->coord.x, drone->coord.y, drone->status, 0);
+    timer_cancel_sync(&drone->mission_timer);
+    server_cleanup_drone_instance(drone);
+    admission_release_drone();
+}
+
+/* Grace süresi içinde RESUME gelmedi: görev bırakılır ve drone temizlenir */
+static void drone_session_grace_timer(TimerEntry *timer, void *arg) {
+    Drone *drone = (Drone*)arg;
+    PROFILED_LOCK(&drone->lock);
+    // Kilit beklenirken RESUME ile yeniden bağlanmış olabilir
+    if (timer_pending(timer) || drone->session != DRONE_SESSION_DETACHED) {
+        PROFILED_UNLOCK(&drone->lock);
+        return;
+    }
+    drone->session = DRONE_SESSION_CLOSED;
+    PROFILED_UNLOCK(&drone->lock);
 
-                    const char *status_str;
-                    if (s->status == WAITING) status_str = "WAITING";
-                    else if (s->status == ASSIGNED) status_str = "ASSIGNED";
-                    else if (s->status == HELPED) status_str = "HELPED";
-                    else status_str = "UNKNOWN";
+    char log_prefix[48];
+    snprintf(log_prefix, sizeof(log_prefix), "[Timer] Drone %s", drone->id_str);
+    LOG_INFO("%s: Session expired without RESUME.\n", log_prefix);
+    finish_drone_session(drone, log_prefix);
+}
 
-                    json_object_object_add(s_json, "status", json_object_new_string(status_str));
-                    // Always include survivors; viewer handles HELPED drawing
-                    json_object_array_add(survivors_json_array, s_json);
-                }
-            }
-            s_node = s_node->next;
+/*
+ * Oturum ve telemetri token'ları çekirdeğin CSPRNG'sinden alınır; sim_rand'dan
+ * türetilmez ki tahmin edilemesin ve deterministik tekrar oynatmanın dizisini bozmasın.
+ * Sonuç her zaman pozitif ve sıfırdan farklıdır (0, "token yok" anlamına gelir). 53 bit
+ * tutulur: drone_msg hızlı yolu 18 haneyi aşmaz, double ile okuyan JSON istemcileri de kesin okur.
+ */
+static long long random_session_token() {
+    uint64_t value = 0;
+    ssize_t got = getrandom(&value, sizeof(value), 0);
+    if (got != (ssize_t)sizeof(value)) {
+        int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        got = fd >= 0 ? read(fd, &value, sizeof(value)) : -1;
+        if (fd >= 0) close(fd);
+        if (got != (ssize_t)sizeof(value)) {
+            LOG_ERROR("[DroneH ?] No kernel randomness for session token: %s\n", strerror(errno));
+            return 0;
         }
-        pthread_mutex_unlock(&survivors->lock);
     }
-    json_object_object_add(state_update_msg, "survivors", survivors_json_array);
+    value &= (1ULL << 53) - 1;
+    return value ? (long long)value : 1;
+}
+
+/*
+ * checkpoint_restore: kaydedilmiş oturum ayrılmış olarak kurulur; drone grace süresi içinde
+ * eski token'ıyla RESUME gönderirse görevine kaldığı yerden devam eder, gelmezse temizlenir.
+ */
+static int restore_drone_session(const CheckpointDrone *rec, Survivor *target) {
+    if (session_grace_ms <= 0) {
+        LOG_WARN("[Checkpoint] Session grace is disabled, drone %s not restored.\n", rec->id_str);
+        return 1;
+    }
+    if (admission_admit_drone() != ADMISSION_OK) {
+        LOG_WARN("[Checkpoint] Fleet full, drone %s not restored.\n", rec->id_str);
+        return 1;
+    }
+    Drone *d = server_create_drone_instance(rec->id, rec->id_str, -1);
+    if (!d) {
+        admission_release_drone();
+        return 1;
+    }
+    if (rec->x >= 0 && rec->x < map.height && rec->y >= 0 && rec->y < map.width) {
+        d->coord = (Coord){rec->x, rec->y};
+    }
+    d->session = DRONE_SESSION_DETACHED;
+    d->session_token = rec->session_token;
+    d->telemetry_udp = rec->telemetry_udp;
+    d->telemetry_token = rec->telemetry_token;
+    if (target) {
+        d->status = ON_MISSION;
+        d->current_survivor_target = target->handle;
+        d->target = target->coord;
+        memcpy(d->mission_id, rec->mission_id, sizeof(d->mission_id));
+        d->mission_id[sizeof(d->mission_id) - 1] = '\0';
+    } else {
+        d->target = d->coord;
+    }
+    timer_entry_init(&d->heartbeat_timer, drone_heartbeat_timer, d);
+    timer_entry_init(&d->liveness_timer, drone_liveness_timer, d);
+    timer_entry_init(&d->mission_timer, drone_mission_timer, d);
+    timer_entry_init(&d->grace_timer, drone_session_grace_timer, d);
+    if (drone_registry_insert(d, 0, 0) == DRONE_REGISTRY_DUPLICATE) {
+        LOG_WARN("[Checkpoint] Duplicate drone %s in checkpoint, skipped.\n", rec->id_str);
+        server_cleanup_drone_instance(d);
+        admission_release_drone();
+        return 1;
+    }
+    drones->add(drones, &d);
+    timer_schedule(&d->grace_timer, session_grace_ms);
+    // Görevin başlangıç zamanı kaydedilmez; süre sınırı açılıştan itibaren yeniden sayılır
+    if (target) timer_schedule(&d->mission_timer, mission_timeout_ms);
+    journal_log(JOURNAL_DRONE_DETACHED, d->id_str, -1, d->coord.x, d->coord.y, d->status, session_grace_ms);
+    return 0;
+}
 
-    return state_update_msg;
+#define DRONE_RESUME_ATTACH_RETRIES 20
+#define DRONE_RESUME_ATTACH_WAIT_MS 50
+
+/**
+ * @brief Reattaches a new connection to a detached drone session.
+ * @return 1 resumed, 0 no session for this ID (caller registers a new drone), -1 token mismatch.
+ */
+static int resume_drone_session(const char *id_str, long long token, ClientConn *conn, int socket_fd, Drone **out) {
+    for (int attempt = 0; attempt < DRONE_RESUME_ATTACH_RETRIES; attempt++) {
+        Drone *d = drone_registry_acquire(id_str);
+        if (!d) return 0;
+        if (d->session_token != token) {
+            PROFILED_UNLOCK(&d->lock);
+            return -1;
+        }
+        if (d->session == DRONE_SESSION_DETACHED) {
+            timer_cancel(&d->grace_timer);
+            d->session = DRONE_SESSION_ATTACHED;
+            d->conn = conn;
+            d->socket_fd = socket_fd;
+            d->telemetry_seq = -1;   // İstemci yeni bağlantıda sırayı baştan sayar
+            d->last_heartbeat_time = sim_time();
+            PROFILED_UNLOCK(&d->lock);
+            *out = d;
+            return 1;
+        }
+        if (d->session == DRONE_SESSION_CLOSED) {
+            PROFILED_UNLOCK(&d->lock);
+            return 0;
+        }
+        // Eski bağlantı sunucu tarafında henüz kopmamış (yarı açık TCP): kapatılır, handler'ın ayırması beklenir
+        shutdown(d->socket_fd, SHUT_RDWR);
+        PROFILED_UNLOCK(&d->lock);
+        struct timespec ts = {0, DRONE_RESUME_ATTACH_WAIT_MS * 1000000L};
+        nanosleep(&ts, NULL);
+    }
+    return -1;
 }
-void* handle_drone_connection(void* arg) {
-    struct handler_args *args = (struct handler_args*)arg;
+
+static void drone_connection_main(struct handler_args *args) {
     int client_socket_fd = args->client_fd;
     // Parse handshake from main thread
-    char *hs_str = args->initial_msg;
+    char hs_str[sizeof(args->initial_msg)];
+    memcpy(hs_str, args->initial_msg, sizeof(hs_str));
+    // Acceptor'ın handshake ile birlikte okuduğu mesajlar kaybolmasın
+    char leftover[sizeof(args->leftover)];
+    int leftover_len = args->leftover_len;
+    memcpy(leftover, args->leftover, leftover_len);
     free(args);
+    ClientConn *conn = conn_create(client_socket_fd);
+    if (!conn) {
+        close(client_socket_fd); return;
+    }
     struct json_object *handshake_json = json_tokener_parse(hs_str);
     if (!handshake_json) {
-        fprintf(stderr, "[DroneH ?] Invalid HANDSHAKE JSON: %s\n", hs_str);
-        close(client_socket_fd); return NULL;
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "[DroneH ?] Invalid HANDSHAKE JSON: %s\n", hs_str);
+        conn_destroy(conn);
+        close(client_socket_fd); return;
     }
     struct json_object *type_obj_hs, *id_obj_hs;
     json_object_object_get_ex(handshake_json, "type", &type_obj_hs);
@@ -174,35 +370,152 @@ void* handle_drone_connection(void* arg) {
     const char *drone_id_str = json_object_get_string(id_obj_hs);
     int parsed_id = -1;
     if (drone_id_str && (drone_id_str[0]=='D'||drone_id_str[0]=='d')) parsed_id = atoi(drone_id_str+1);
-    if (!msg_type_hs || strcmp(msg_type_hs,"HANDSHAKE")!=0 || parsed_id<=0) {
-        fprintf(stderr, "[DroneH ?] Invalid HANDSHAKE format.\n");
+    int resume_requested = msg_type_hs && strcmp(msg_type_hs, "RESUME") == 0;
+    if (!msg_type_hs || (!resume_requested && strcmp(msg_type_hs,"HANDSHAKE")!=0) || parsed_id<=0) {
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "[DroneH ?] Invalid HANDSHAKE format.\n");
         json_object_put(handshake_json);
-        close(client_socket_fd); return NULL;
+        conn_destroy(conn);
+        close(client_socket_fd); return;
     }
-    Drone *this_drone_ptr = server_create_drone_instance(parsed_id, drone_id_str, client_socket_fd);
-    if (!this_drone_ptr) {
-        send_error_to_client(client_socket_fd, "Failed to create drone", ERROR_HANDSHAKE);
-        json_object_put(handshake_json);
-        close(client_socket_fd); return NULL;
+    metric_counter_add(&server_metrics.messages_in[METRIC_MSG_HANDSHAKE], 1);
+
+    // RESUME: kopan bağlantının drone'u ve görevi grace süresi içinde yeni sokete bağlanır
+    Drone *this_drone_ptr = NULL;
+    int resumed = 0;
+    if (resume_requested) {
+        struct json_object *token_obj_hs;
+        long long token = json_object_object_get_ex(handshake_json, "session_token", &token_obj_hs) ?
+                          json_object_get_int64(token_obj_hs) : 0;
+        int rc = resume_drone_session(drone_id_str, token, conn, client_socket_fd, &this_drone_ptr);
+        if (rc < 0) {
+            LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "[DroneH ?] RESUME for %s rejected (invalid session token).\n", drone_id_str);
+            send_error_to_client(conn, "Invalid session token", ERROR_HANDSHAKE);
+            json_object_put(handshake_json);
+            drain_client_conn(conn, 500);
+            conn_destroy(conn);
+            close(client_socket_fd); return;
+        }
+        resumed = rc;
+        if (resumed) {
+            LOG_INFO("[DroneH ?] Drone %s resumed its session.\n", drone_id_str);
+            journal_log(JOURNAL_DRONE_RESUMED, drone_id_str, -1, this_drone_ptr->coord.x, this_drone_ptr->coord.y,
+                        this_drone_ptr->status, 0);
+        }
     }
-    drones->add(drones, &this_drone_ptr);
+
+    if (!resumed) {
+        // Filo doluysa drones listesine eklemeye çalışmadan hemen reddedilir (liste kapasitesi = --max-drones)
+        AdmissionResult admitted = admission_admit_drone();
+        if (admitted != ADMISSION_OK) {
+            LOG_RATELIMITED(LOG_LEVEL_WARN, 5, "[DroneH ?] Fleet full (%d drones), rejecting %s.\n", admission_max_drones(), drone_id_str);
+            send_overloaded_to_client(conn, "Server is at its drone capacity", admitted);
+            json_object_put(handshake_json);
+            drain_client_conn(conn, 500);
+            conn_destroy(conn);
+            close(client_socket_fd); return;
+        }
+        this_drone_ptr = server_create_drone_instance(parsed_id, drone_id_str, client_socket_fd);
+        if (!this_drone_ptr) {
+            admission_release_drone();
+            send_error_to_client(conn, "Failed to create drone", ERROR_HANDSHAKE);
+            json_object_put(handshake_json);
+            drain_client_conn(conn, 500);
+            conn_destroy(conn);
+            close(client_socket_fd); return;
+        }
+        this_drone_ptr->conn = conn;
+        // Drone konum güncellemelerini UDP'den göndermek isteyebilir
+        struct json_object *telemetry_obj_hs;
+        if (telemetry_port() > 0 && json_object_object_get_ex(handshake_json, "telemetry", &telemetry_obj_hs) &&
+            json_object_get_string(telemetry_obj_hs) && strcmp(json_object_get_string(telemetry_obj_hs), "udp") == 0) {
+            this_drone_ptr->telemetry_udp = 1;
+            this_drone_ptr->telemetry_token = random_session_token();
+            if (this_drone_ptr->telemetry_token == 0) this_drone_ptr->telemetry_udp = 0;
+        }
+        timer_entry_init(&this_drone_ptr->heartbeat_timer, drone_heartbeat_timer, this_drone_ptr);
+        timer_entry_init(&this_drone_ptr->liveness_timer, drone_liveness_timer, this_drone_ptr);
+        timer_entry_init(&this_drone_ptr->mission_timer, drone_mission_timer, this_drone_ptr);
+        timer_entry_init(&this_drone_ptr->grace_timer, drone_session_grace_timer, this_drone_ptr);
+        // RESUME bu token ile doğrulanır; ACK dışında hiçbir yerde gönderilmez
+        this_drone_ptr->session_token = random_session_token();
+        if (this_drone_ptr->session_token == 0) {
+            send_error_to_client(conn, "Failed to create drone", ERROR_HANDSHAKE);
+            json_object_put(handshake_json);
+            drain_client_conn(conn, 500);
+            server_cleanup_drone_instance(this_drone_ptr);
+            admission_release_drone();
+            conn_destroy(conn);
+            close(client_socket_fd); return;
+        }
+        // Aynı ID ile canlı bir oturum varsa handshake reddedilir; "takeover": true yalnızca
+        // eski oturumun session_token'ı ile birlikte gelirse eski oturumu kapatır
+        struct json_object *takeover_obj_hs, *takeover_token_obj_hs;
+        int takeover = json_object_object_get_ex(handshake_json, "takeover", &takeover_obj_hs) &&
+                       json_object_get_boolean(takeover_obj_hs);
+        long long takeover_token = takeover && json_object_object_get_ex(handshake_json, "session_token", &takeover_token_obj_hs) ?
+                                   json_object_get_int64(takeover_token_obj_hs) : 0;
+        DroneRegistryResult registered = drone_registry_insert(this_drone_ptr, takeover, takeover_token);
+        if (registered == DRONE_REGISTRY_DUPLICATE || registered == DRONE_REGISTRY_TAKEOVER_DENIED) {
+            int denied = registered == DRONE_REGISTRY_TAKEOVER_DENIED;
+            if (denied)
+                LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "[DroneH ?] Takeover of %s rejected (invalid session token).\n", this_drone_ptr->id_str);
+            else
+                LOG_WARN("[DroneH ?] Drone %s is already connected, rejecting handshake.\n", this_drone_ptr->id_str);
+            send_error_to_client(conn, denied ? "Invalid session token" : "Drone ID already connected", ERROR_HANDSHAKE);
+            json_object_put(handshake_json);
+            drain_client_conn(conn, 500);
+            server_cleanup_drone_instance(this_drone_ptr);
+            admission_release_drone();
+            conn_destroy(conn);
+            close(client_socket_fd); return;
+        }
+        if (registered == DRONE_REGISTRY_TOOK_OVER) {
+            LOG_INFO("[DroneH ?] Drone %s took over its previous connection.\n", this_drone_ptr->id_str);
+        }
+        drones->add(drones, &this_drone_ptr);
+        journal_log(JOURNAL_DRONE_CONNECTED, this_drone_ptr->id_str, -1, this_drone_ptr->coord.x,
+                    this_drone_ptr->coord.y, this_drone_ptr->status, 0);
+    }
+    metric_gauge_add(&server_metrics.drones_connected, 1);
     // send ACK
     struct json_object *ack_msg = json_object_new_object();
     json_object_object_add(ack_msg, "type", json_object_new_string("HANDSHAKE_ACK"));
     struct json_object *config_obj = json_object_new_object();
     json_object_object_add(config_obj, "status_update_interval", json_object_new_int(0));
     json_object_object_add(config_obj, "heartbeat_interval", json_object_new_int(10));
+    if (this_drone_ptr->telemetry_udp && telemetry_port() > 0) {
+        struct json_object *telemetry_cfg = json_object_new_object();
+        json_object_object_add(telemetry_cfg, "transport", json_object_new_string("udp"));
+        json_object_object_add(telemetry_cfg, "port", json_object_new_int(telemetry_port()));
+        json_object_object_add(telemetry_cfg, "token", json_object_new_int64(this_drone_ptr->telemetry_token));
+        json_object_object_add(config_obj, "telemetry", telemetry_cfg);
+    }
+    struct json_object *session_cfg = json_object_new_object();
+    json_object_object_add(session_cfg, "token", json_object_new_int64(this_drone_ptr->session_token));
+    json_object_object_add(session_cfg, "grace_period", json_object_new_int(session_grace_ms / 1000));
+    json_object_object_add(session_cfg, "resumed", json_object_new_boolean(resumed));
+    PROFILED_LOCK(&this_drone_ptr->lock);
+    // Devam eden görev korunduysa drone aynı mission_id ile sürdürür
+    if (resumed && this_drone_ptr->mission_id[0]) {
+        json_object_object_add(session_cfg, "mission_id", json_object_new_string(this_drone_ptr->mission_id));
+    }
+    PROFILED_UNLOCK(&this_drone_ptr->lock);
+    json_object_object_add(config_obj, "session", session_cfg);
     json_object_object_add(ack_msg, "config", config_obj);
-    send_json_to_client_socket(client_socket_fd, ack_msg, "[Drone]");
+    send_json_to_client(conn, ack_msg, "[Drone]");
+    metric_counter_add(&server_metrics.messages_out[METRIC_MSG_HANDSHAKE_ACK], 1);
     json_object_put(ack_msg);
     json_object_put(handshake_json);
 
     char client_ip_str[INET_ADDRSTRLEN];
 
-    struct sockaddr_in peer_addr;
+    struct sockaddr_storage peer_addr;
     socklen_t peer_addr_len = sizeof(peer_addr);
-    if (getpeername(client_socket_fd, (struct sockaddr*)&peer_addr, &peer_addr_len) == 0) {
-        inet_ntop(AF_INET, &peer_addr.sin_addr, client_ip_str, sizeof(client_ip_str));
+    peer_addr.ss_family = AF_UNSPEC;
+    if (getpeername(client_socket_fd, (struct sockaddr*)&peer_addr, &peer_addr_len) == 0 && peer_addr.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &((struct sockaddr_in*)&peer_addr)->sin_addr, client_ip_str, sizeof(client_ip_str));
+    } else if (peer_addr.ss_family == AF_UNIX) {
+        strcpy(client_ip_str, "unix");
     } else {
         strncpy(client_ip_str, "UNKNOWN_IP", sizeof(client_ip_str) - 1);
         client_ip_str[sizeof(client_ip_str) - 1] = '\0';
@@ -210,98 +523,113 @@ void* handle_drone_connection(void* arg) {
 
     char log_prefix_drone[64];
     snprintf(log_prefix_drone, sizeof(log_prefix_drone), "[DroneH %s(S%d)]", client_ip_str, client_socket_fd);
-    printf("%s: Thread started.\n", log_prefix_drone);
+    LOG_DEBUG("%s: Thread started.\n", log_prefix_drone);
+    trace_set_thread_name(log_prefix_drone);
 
     char aggregate_buffer[RECV_AGGREGATE_BUFFER_SIZE];
     memset(aggregate_buffer, 0, sizeof(aggregate_buffer));
-    int aggregate_len = 0;
+    int aggregate_len = leftover_len;
+    memcpy(aggregate_buffer, leftover, leftover_len);
     ssize_t bytes_received;
 
-    time_t last_server_heartbeat_sent = time(NULL);
-    int server_heartbeat_interval = 10;
+    PROFILED_LOCK(&this_drone_ptr->lock);
+    this_drone_ptr->last_heartbeat_time = sim_time();
+    PROFILED_UNLOCK(&this_drone_ptr->lock);
 
-    pthread_mutex_lock(&this_drone_ptr->lock);
-    this_drone_ptr->last_heartbeat_time = time(NULL);
-    pthread_mutex_unlock(&this_drone_ptr->lock);
+    // Heartbeat ve canlılık kontrolü timer wheel'de; bu thread sadece soket olaylarında uyanır
+    timer_schedule(&this_drone_ptr->heartbeat_timer, DRONE_HEARTBEAT_INTERVAL_MS);
+    timer_schedule(&this_drone_ptr->liveness_timer, DRONE_LIVENESS_TIMEOUT_MS);
 
     while (server_running) {
         fd_set read_fds;
-        struct timeval tv;
-
+        fd_set write_fds;
         FD_ZERO(&read_fds);
+        FD_ZERO(&write_fds);
         FD_SET(client_socket_fd, &read_fds);
-        tv.tv_sec = 1;
-        tv.tv_usec = 0;
+        // Soket dolduğu için bekleyen mesaj varsa yazılabilir olmasını da bekle
+        int has_pending_output = conn_pending_bytes(conn) > 0;
+        if (has_pending_output) FD_SET(client_socket_fd, &write_fds);
 
-        int activity = select(client_socket_fd + 1, &read_fds, NULL, NULL, &tv);
+        // Sessiz drone'u liveness timer'ı kapatır; kısa timeout sadece kapanışın fark edilmesi için
+        struct timeval poll_tv = {0, DRONE_HANDLER_POLL_MS * 1000};
+        int activity = select(client_socket_fd + 1, &read_fds, &write_fds, NULL, &poll_tv);
         if (!server_running) break;
         if (activity < 0 && errno != EINTR) {
             perror(log_prefix_drone);
             break;
         }
 
-        time_t current_time = time(NULL);
+        time_t current_time = sim_time();
+
+        if (activity > 0 && FD_ISSET(client_socket_fd, &write_fds)) {
+            if (conn_flush(conn) < 0) {
+                LOG_WARN("%s: Write error, closing connection.\n", log_prefix_drone);
+                break;
+            }
+        }
 
-        if (FD_ISSET(client_socket_fd, &read_fds)) {
+        if (activity > 0 && FD_ISSET(client_socket_fd, &read_fds)) {
             if (aggregate_len >= RECV_AGGREGATE_BUFFER_SIZE - 1) break;
 
             bytes_received = recv(client_socket_fd, aggregate_buffer + aggregate_len, RECV_AGGREGATE_BUFFER_SIZE - aggregate_len - 1, 0);
+            if (bytes_received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
             if (bytes_received <= 0) break;
+            metric_counter_add(&server_metrics.bytes_in, (unsigned long long)bytes_received);
 
             aggregate_len += bytes_received;
             aggregate_buffer[aggregate_len] = '\0';
 
-            pthread_mutex_lock(&this_drone_ptr->lock);
+            PROFILED_LOCK(&this_drone_ptr->lock);
             this_drone_ptr->last_heartbeat_time = current_time;
-            pthread_mutex_unlock(&this_drone_ptr->lock);
+            PROFILED_UNLOCK(&this_drone_ptr->lock);
 
+            // Tüm tam satırlar yerinde işlenir, kalan kısım en sonda tek memmove ile başa alınır
+            char *line_start = aggregate_buffer;
             char *newline_pos_loop;
-            while ((newline_pos_loop = strchr(aggregate_buffer, '\n')) != NULL) {
+            while ((newline_pos_loop = memchr(line_start, '\n', aggregate_buffer + aggregate_len - line_start)) != NULL) {
                 *newline_pos_loop = '\0';
-                char single_json_str_loop[BUFFER_SIZE];
-                strncpy(single_json_str_loop, aggregate_buffer, sizeof(single_json_str_loop) - 1);
-                single_json_str_loop[sizeof(single_json_str_loop) - 1] = '\0';
-
-                memmove(aggregate_buffer, newline_pos_loop + 1, aggregate_len - (newline_pos_loop - aggregate_buffer + 1));
-                aggregate_len -= (newline_pos_loop - aggregate_buffer + 1);
+                char *single_json_str_loop = line_start;
+                size_t line_len = newline_pos_loop - line_start;
+                line_start = newline_pos_loop + 1;
+
+                // Sık gelen STATUS_UPDATE / HEARTBEAT_RESPONSE json-c'ye uğramadan işlenir
+                DroneMessage fast_msg;
+                long long parse_span = trace_begin();
+                int fast_parsed = drone_msg_parse_fast(single_json_str_loop, line_len, &fast_msg);
+                trace_end("drone_msg_parse_fast", parse_span);
+                if (fast_parsed) {
+                    metric_counter_add(&server_metrics.messages_in[fast_msg.type == DRONE_MSG_STATUS_UPDATE ?
+                                       METRIC_MSG_STATUS_UPDATE : METRIC_MSG_HEARTBEAT_RESPONSE], 1);
+                    long long handle_span = trace_begin();
+                    handle_drone_message(this_drone_ptr, &fast_msg, log_prefix_drone);
+                    trace_end("drone_msg_handle", handle_span);
+                    continue;
+                }
 
+                parse_span = trace_begin();
                 struct json_object *parsed_json = json_tokener_parse(single_json_str_loop);
+                trace_end("drone_msg_parse_json", parse_span);
                 if (!parsed_json) {
-                    fprintf(stderr, "%s: Invalid JSON in loop: %s\n", log_prefix_drone, single_json_str_loop);
+                    LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "%s: Invalid JSON in loop: %s\n", log_prefix_drone, single_json_str_loop);
                     continue;
                 }
+                long long handle_span = trace_begin();
 
                 struct json_object *msg_type_obj_loop;
-                if (json_object_object_get_ex(parsed_json, "type", &msg_type_obj_loop)) {
+                if (json_object_object_get_ex(parsed_json, "type", &msg_type_obj_loop) &&
+                    json_object_is_type(msg_type_obj_loop, json_type_string)) {
                     const char *msg_type = json_object_get_string(msg_type_obj_loop);
 
-                    if (strcmp(msg_type, "STATUS_UPDATE") == 0) {
-                        struct json_object *loc_obj, *status_str_obj, *id_confirm_obj;
-                        const char *id_confirm_str = NULL;
-
-                        if (json_object_object_get_ex(parsed_json, "drone_id", &id_confirm_obj))
-                            id_confirm_str = json_object_get_string(id_confirm_obj);
-
-                        if (!id_confirm_str || strcmp(id_confirm_str, this_drone_ptr->id_str) != 0) {
-                            fprintf(stderr, "%s: STATUS_UPDATE mismatched ID. Expected %s, got %s\n",
-                                    log_prefix_drone, this_drone_ptr->id_str, id_confirm_str ? id_confirm_str : "N/A");
-                        } else {
-                            pthread_mutex_lock(&this_drone_ptr->lock);
-                            if (json_object_object_get_ex(parsed_json, "location", &loc_obj)) {
-                                struct json_object *x_obj, *y_obj;
-                                if (json_object_object_get_ex(loc_obj, "x", &x_obj)) this_drone_ptr->coord.x = json_object_get_int(x_obj);
-                                if (json_object_object_get_ex(loc_obj, "y", &y_obj)) this_drone_ptr->coord.y = json_object_get_int(y_obj);
-                            }
-                            if (json_object_object_get_ex(parsed_json, "status", &status_str_obj)) {
-                                const char *status_str = json_object_get_string(status_str_obj);
-                                if (strcmp(status_str, "idle") == 0) this_drone_ptr->status = IDLE;
-                                else if (strcmp(status_str, "busy") == 0 || strcmp(status_str, "on_mission") == 0) this_drone_ptr->status = ON_MISSION;
-                            }
-                            pthread_mutex_unlock(&this_drone_ptr->lock);
-                        }
+                    if (strcmp(msg_type, "STATUS_UPDATE") == 0 || strcmp(msg_type, "HEARTBEAT_RESPONSE") == 0) {
+                        DroneMessage slow_msg;
+                        drone_msg_from_json(parsed_json, &slow_msg);
+                        metric_counter_add(&server_metrics.messages_in[slow_msg.type == DRONE_MSG_STATUS_UPDATE ?
+                                           METRIC_MSG_STATUS_UPDATE : METRIC_MSG_HEARTBEAT_RESPONSE], 1);
+                        handle_drone_message(this_drone_ptr, &slow_msg, log_prefix_drone);
 
                     } else if (strcmp(msg_type, "MISSION_COMPLETE") == 0) {
-                        printf("%s: MISSION_COMPLETE received.\n", log_prefix_drone);
+                        LOG_DEBUG("%s: MISSION_COMPLETE received.\n", log_prefix_drone);
+                        metric_counter_add(&server_metrics.messages_in[METRIC_MSG_MISSION_COMPLETE], 1);
                         struct json_object *success_obj, *mission_id_obj;
                         const char *mission_id_str = NULL;
                         int mission_success = 0;
@@ -311,85 +639,151 @@ void* handle_drone_connection(void* arg) {
                         if (json_object_object_get_ex(parsed_json, "success", &success_obj))
                             mission_success = json_object_get_boolean(success_obj);
 
-                        pthread_mutex_lock(&this_drone_ptr->lock);
-                        if (this_drone_ptr->current_survivor_target && mission_success) {
-                            Survivor *helped_survivor = this_drone_ptr->current_survivor_target;
-                            if (helped_survivor->status != HELPED) {
-                                helped_survivor->status = HELPED;
-                                time_t now; time(&now);
-                                localtime_r(&now, &helped_survivor->helped_time);
-                                printf("%s: Survivor %s helped. Mission: %s\n", log_prefix_drone,
-                                       helped_survivor->info, mission_id_str ? mission_id_str : "N/A");
-
-                                // Remove survivor immediately once helped
-                                survivors->removedata(survivors, &helped_survivor);
-                                Coord sc = helped_survivor->coord;
-                                if (sc.x >= 0 && sc.x < map.height && sc.y >= 0 && sc.y < map.width) {
-                                    if (map.cells[sc.x][sc.y].survivors)
-                                        map.cells[sc.x][sc.y].survivors->removedata(map.cells[sc.x][sc.y].survivors, &helped_survivor);
-                                }
-                                helpedsurvivors->add(helpedsurvivors, &helped_survivor);
-                            }
+                        PROFILED_LOCK(&this_drone_ptr->lock);
+                        // Süresi dolup yeniden atanmış eski bir görevin tamamlanması mevcut görevi etkilemez
+                        if (mission_id_str && this_drone_ptr->mission_id[0] &&
+                            strcmp(mission_id_str, this_drone_ptr->mission_id) != 0) {
+                            LOG_INFO("%s: Ignoring MISSION_COMPLETE for stale mission %s (current %s).\n",
+                                     log_prefix_drone, mission_id_str, this_drone_ptr->mission_id);
+                            PROFILED_UNLOCK(&this_drone_ptr->lock);
+                            json_object_put(parsed_json);
+                            trace_end("drone_msg_handle", handle_span);
+                            continue;
                         }
-                        this_drone_ptr->status = IDLE;
-                        this_drone_ptr->current_survivor_target = NULL;
-                        pthread_mutex_unlock(&this_drone_ptr->lock);
-
-                    } else if (strcmp(msg_type, "HEARTBEAT_RESPONSE") == 0) {
-                        // sadece sessizlik bozulsun diye loglanabilir
-                        // printf("%s: HEARTBEAT_RESPONSE\n", log_prefix_drone);
+                        timer_cancel(&this_drone_ptr->mission_timer);
+                        drone_complete_mission_locked(this_drone_ptr, mission_success, mission_id_str, log_prefix_drone);
+                        PROFILED_UNLOCK(&this_drone_ptr->lock);
+                    } else {
+                        metric_counter_add(&server_metrics.messages_in[METRIC_MSG_OTHER], 1);
                     }
                 }
                 json_object_put(parsed_json);
+                trace_end("drone_msg_handle", handle_span);
             }
 
-            if (strlen(aggregate_buffer) == 0) aggregate_len = 0;
-        }
-
-        if (current_time - last_server_heartbeat_sent >= server_heartbeat_interval) {
-            struct json_object *hb_msg = json_object_new_object();
-            if (hb_msg) {
-                json_object_object_add(hb_msg, "type", json_object_new_string("HEARTBEAT"));
-                json_object_object_add(hb_msg, "timestamp", json_object_new_int64(current_time));
-                send_json_to_client_socket(client_socket_fd, hb_msg, log_prefix_drone);
-                json_object_put(hb_msg);
+            size_t consumed = line_start - aggregate_buffer;
+            if (consumed > 0) {
+                memmove(aggregate_buffer, line_start, aggregate_len - consumed);
+                aggregate_len -= consumed;
+                aggregate_buffer[aggregate_len] = '\0';
             }
-            last_server_heartbeat_sent = current_time;
         }
 
-        pthread_mutex_lock(&this_drone_ptr->lock);
-        time_t last_hb_from_drone = this_drone_ptr->last_heartbeat_time;
-        pthread_mutex_unlock(&this_drone_ptr->lock);
-
-        if (current_time - last_hb_from_drone > 30) {
-            fprintf(stderr, "%s: Drone timed out (no client activity/heartbeat).\n", log_prefix_drone);
-            break;
-        }
     }
 
     if (this_drone_ptr) {
-        if (drones->removedata(drones, &this_drone_ptr) == 0) {
-            printf("%s: Removed from list. Total: %d\n", log_prefix_drone, drones->number_of_elements);
+        // Bu bağlantıya ait zamanlayıcılar kapatılır; callback'ler conn'a dokunmasın
+        timer_cancel_sync(&this_drone_ptr->heartbeat_timer);
+        timer_cancel_sync(&this_drone_ptr->liveness_timer);
+        metric_gauge_add(&server_metrics.drones_connected, -1);
+
+        // Bağlantı koptu ama oturum açık: drone ve görevi grace süresi boyunca RESUME için saklanır
+        int detached = 0;
+        PROFILED_LOCK(&this_drone_ptr->lock);
+        if (server_running && session_grace_ms > 0 && this_drone_ptr->session == DRONE_SESSION_ATTACHED) {
+            this_drone_ptr->session = DRONE_SESSION_DETACHED;
+            this_drone_ptr->conn = NULL;
+            this_drone_ptr->socket_fd = -1;
+            timer_schedule(&this_drone_ptr->grace_timer, session_grace_ms);
+            detached = 1;
+        } else if (!server_running && checkpoint_enabled() && this_drone_ptr->session == DRONE_SESSION_ATTACHED) {
+            // Kapanışta oturum ve görev bırakılmaz: son checkpoint onları yeniden başlatmaya taşır
+            this_drone_ptr->session = DRONE_SESSION_DETACHED;
+            this_drone_ptr->conn = NULL;
+            this_drone_ptr->socket_fd = -1;
+            PROFILED_UNLOCK(&this_drone_ptr->lock);
+            conn_destroy(conn);
+            close(client_socket_fd);
+            LOG_INFO("%s: Server shutting down, session kept for the checkpoint.\n", log_prefix_drone);
+            return;
+        }
+        PROFILED_UNLOCK(&this_drone_ptr->lock);
+
+        if (detached) {
+            LOG_INFO("%s: Disconnected, session kept for %d ms awaiting RESUME.\n", log_prefix_drone, session_grace_ms);
+            journal_log(JOURNAL_DRONE_DETACHED, this_drone_ptr->id_str, -1, -1, -1, 0, session_grace_ms);
+        } else {
+            timer_cancel_sync(&this_drone_ptr->grace_timer);
+            finish_drone_session(this_drone_ptr, log_prefix_drone);
         }
-        server_cleanup_drone_instance(this_drone_ptr);
         this_drone_ptr = NULL;
     }
 
+    conn_destroy(conn);
     close(client_socket_fd);
-    printf("%s: Connection closed and thread exiting.\n", log_prefix_drone);
-    pthread_exit(NULL);
-    return NULL;
+    LOG_INFO("%s: Connection closed and thread exiting.\n", log_prefix_drone);
 }
-void* handle_viewer_connection(void* arg) {
-    struct handler_args *args = (struct handler_args*)arg;
+/**
+ * @brief Reads {"viewport": {x_min, y_min, x_max, y_max}, "zoom": z} and clamps it to the map.
+ * @return 0 on success, 1 if the message has no usable viewport.
+ */
+static int parse_viewport(struct json_object *msg, Viewport *out) {
+    struct json_object *vp_obj, *field_obj;
+    if (!json_object_object_get_ex(msg, "viewport", &vp_obj) || !json_object_is_type(vp_obj, json_type_object)) return 1;
+    static const char *keys[4] = {"x_min", "y_min", "x_max", "y_max"};
+    int values[4];
+    for (int i = 0; i < 4; i++) {
+        if (!json_object_object_get_ex(vp_obj, keys[i], &field_obj)) return 1;
+        values[i] = json_object_get_int(field_obj);
+    }
+    // Coord.x satır (map.height), Coord.y sütun (map.width) ekseninde
+    out->x_min = values[0] < 0 ? 0 : values[0];
+    out->y_min = values[1] < 0 ? 0 : values[1];
+    out->x_max = values[2] >= map.height ? map.height - 1 : values[2];
+    out->y_max = values[3] >= map.width ? map.width - 1 : values[3];
+    if (out->x_min > out->x_max || out->y_min > out->y_max) return 1;
+    out->zoom = json_object_object_get_ex(msg, "zoom", &field_obj) ? json_object_get_int(field_obj) : 1;
+    if (out->zoom < 1) out->zoom = 1;
+    return 0;
+}
+
+static void viewer_connection_main(struct handler_args *args) {
     int viewer_socket_fd = args->client_fd;
+    // Viewer delta akışını destekliyorsa handshake'te "delta": true gönderir
+    int delta_capable = 0;
+    // Handshake'te veya sonradan VIEWER_SUBSCRIBE ile verilen viewport: sadece içindeki varlıklar gönderilir
+    int viewport_active = 0;
+    // "compression": ["deflate"] ile istenirse ACK'ten sonraki her şey deflate akışıyla gider
+    int compress = 0;
+    Viewport requested_view;
+    ViewportStream vstream;
+    struct json_object *viewer_hs_json = json_tokener_parse(args->initial_msg);
+    if (viewer_hs_json) {
+        struct json_object *delta_obj, *compression_obj;
+        if (json_object_object_get_ex(viewer_hs_json, "delta", &delta_obj))
+            delta_capable = json_object_get_boolean(delta_obj);
+        if (json_object_object_get_ex(viewer_hs_json, "compression", &compression_obj) &&
+            json_object_is_type(compression_obj, json_type_array)) {
+            for (size_t i = 0; i < json_object_array_length(compression_obj); i++) {
+                const char *method = json_object_get_string(json_object_array_get_idx(compression_obj, i));
+                if (method && strcmp(method, STREAM_COMPRESSION_DEFLATE) == 0) compress = 1;
+            }
+        }
+        if (parse_viewport(viewer_hs_json, &requested_view) == 0) {
+            viewport_stream_init(&vstream, &requested_view);
+            viewport_active = 1;
+        }
+        json_object_put(viewer_hs_json);
+    }
+    char viewer_aggregate[BUFFER_SIZE];
+    int viewer_aggregate_len = args->leftover_len < (int)sizeof(viewer_aggregate) ? args->leftover_len : 0;
+    memcpy(viewer_aggregate, args->leftover, viewer_aggregate_len);
     free(args);
+    ClientConn *conn = conn_create(viewer_socket_fd);
+    if (!conn) {
+        close(viewer_socket_fd);
+        return;
+    }
+    metric_counter_add(&server_metrics.messages_in[METRIC_MSG_VIEWER_HANDSHAKE], 1);
 
     char client_ip_str_v[INET_ADDRSTRLEN];
-    struct sockaddr_in peer_addr_v;
+    struct sockaddr_storage peer_addr_v;
     socklen_t peer_addr_len_v = sizeof(peer_addr_v);
-    if (getpeername(viewer_socket_fd, (struct sockaddr*)&peer_addr_v, &peer_addr_len_v) == 0) {
-        inet_ntop(AF_INET, &peer_addr_v.sin_addr, client_ip_str_v, sizeof(client_ip_str_v));
+    peer_addr_v.ss_family = AF_UNSPEC;
+    if (getpeername(viewer_socket_fd, (struct sockaddr*)&peer_addr_v, &peer_addr_len_v) == 0 && peer_addr_v.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &((struct sockaddr_in*)&peer_addr_v)->sin_addr, client_ip_str_v, sizeof(client_ip_str_v));
+    } else if (peer_addr_v.ss_family == AF_UNIX) {
+        strcpy(client_ip_str_v, "unix");
     } else {
         strncpy(client_ip_str_v, "UNKN_VIEWER_IP", sizeof(client_ip_str_v)-1);
         client_ip_str_v[sizeof(client_ip_str_v)-1] = '\0';
@@ -397,84 +791,301 @@ void* handle_viewer_connection(void* arg) {
 
     char log_prefix_viewer[64];
     snprintf(log_prefix_viewer, sizeof(log_prefix_viewer), "[ViewerH %s(S%d)]", client_ip_str_v, viewer_socket_fd);
-    printf("%s: Connection established.\n", log_prefix_viewer);
+    LOG_INFO("%s: Connection established.\n", log_prefix_viewer);
+    trace_set_thread_name(log_prefix_viewer);
+
+    // Viewer'lar drone'lardan önce gözden çıkarılır: sayı sınırında veya CPU baskısında hemen reddedilir
+    AdmissionTicket admission_ticket;
+    AdmissionResult admitted = admission_admit_viewer(&admission_ticket);
+    if (admitted != ADMISSION_OK) {
+        LOG_INFO("%s: Rejected (%s).\n", log_prefix_viewer, admission_reason(admitted));
+        send_overloaded_to_client(conn, "Server is not accepting viewers right now", admitted);
+        drain_client_conn(conn, 500);
+        if (viewport_active) viewport_stream_free(&vstream);
+        conn_destroy(conn);
+        close(viewer_socket_fd);
+        return;
+    }
 
     // Handshake ACK gönder
     struct json_object *ack_msg_v = json_object_new_object();
     if (ack_msg_v) {
         json_object_object_add(ack_msg_v, "type", json_object_new_string("VIEWER_HANDSHAKE_ACK"));
         json_object_object_add(ack_msg_v, "message", json_object_new_string("Viewer connection accepted."));
+        json_object_object_add(ack_msg_v, "delta", json_object_new_boolean(delta_capable));
+        json_object_object_add(ack_msg_v, "compression", json_object_new_string(compress ? STREAM_COMPRESSION_DEFLATE : "none"));
         struct json_object *map_dim_obj_v = json_object_new_object();
         if (map_dim_obj_v) {
             json_object_object_add(map_dim_obj_v, "width", json_object_new_int(map.width));
             json_object_object_add(map_dim_obj_v, "height", json_object_new_int(map.height));
             json_object_object_add(ack_msg_v, "initial_map_dimensions", map_dim_obj_v);
         }
-        send_json_to_client_socket(viewer_socket_fd, ack_msg_v, log_prefix_viewer);
+        send_json_to_client(conn, ack_msg_v, log_prefix_viewer);
+        metric_counter_add(&server_metrics.messages_out[METRIC_MSG_VIEWER_HANDSHAKE_ACK], 1);
         json_object_put(ack_msg_v);
     }
+    // ACK düz gider; viewer ACK'i okuduktan sonra gelen byte'ları inflate eder
+    if (compress && conn_enable_deflate(conn) != 0) {
+        LOG_ERROR("%s: Failed to start compressed stream.\n", log_prefix_viewer);
+        admission_release_viewer(&admission_ticket);
+        if (viewport_active) viewport_stream_free(&vstream);
+        conn_destroy(conn);
+        close(viewer_socket_fd);
+        return;
+    }
 
     // viewers_list'e ekle
     int *fd_ptr_for_list = malloc(sizeof(int));
     if (!fd_ptr_for_list) {
         perror("malloc for viewer fd");
+        admission_release_viewer(&admission_ticket);
+        if (viewport_active) viewport_stream_free(&vstream);
+        conn_destroy(conn);
         close(viewer_socket_fd);
-        pthread_exit(NULL);
+        return;
     }
     *fd_ptr_for_list = viewer_socket_fd;
 
     pthread_mutex_lock(&viewers_list_lock);
     viewers_list->add(viewers_list, &fd_ptr_for_list);
     pthread_mutex_unlock(&viewers_list_lock);
+    metric_gauge_add(&server_metrics.viewers_connected, 1);
+
+    // Durum broadcaster tarafından tick başına bir kez serialize edilir; burada sadece paylaşılan frame gönderilir.
+    // Delta destekleyen viewer'a, en son gönderilen versiyon üzerine kurulu delta'lar gider;
+    // zincir koptuğunda (katılım, RESYNC) bir sonraki keyframe beklenir.
+    unsigned long last_seen_version = 0;
+    unsigned long last_sent_version = 0;
+    int need_keyframe = 1;
+    if (delta_capable) broadcaster_request_keyframe();
+    else broadcaster_full_frame_subscribers(1);
+    if (viewport_active) broadcaster_viewport_subscribers(1);
 
     while (server_running) {
-        struct json_object *state_update = create_simulation_state_update_json();
-        if (state_update) {
-            send_json_to_client_socket(viewer_socket_fd, state_update, log_prefix_viewer);
-            json_object_put(state_update);
-        } else {
-            fprintf(stderr, "%s: Failed to create state update JSON.\n", log_prefix_viewer);
+        if (admission_viewer_shed(&admission_ticket)) {
+            LOG_INFO("%s: Shed to relieve CPU pressure.\n", log_prefix_viewer);
+            send_overloaded_to_client(conn, "Viewer disconnected to relieve server load", ADMISSION_CPU_PRESSURE);
+            drain_client_conn(conn, 500);
+            break;
+        }
+        BroadcastFrame frame;
+        if (broadcaster_wait_frame(last_seen_version, BROADCAST_INTERVAL_MS * 4, &frame)) {
+            last_seen_version = frame.version;
+            // Kuyruk yüksek su seviyesini aştıysa delta eklemek yerine bekleyen frame'ler keyframe ile değiştirilir
+            if (conn_pending_bytes(conn) > CONN_HIGH_WATER_MARK) need_keyframe = 1;
+            int synced = !need_keyframe && last_sent_version + 1 == frame.version;
+            SharedBuffer *to_send = NULL;
+            SharedBuffer *viewport_frame = NULL;   // Bu viewer'a özel, gönderimden sonra bırakılır
+            int sent_keyframe = 0;
+            if (viewport_active) {
+                // Dünya kopyası abonelikten sonraki ilk tick'ten itibaren gelir
+                if (frame.world) {
+                    sent_keyframe = need_keyframe || !delta_capable || vstream.sent_version == 0;
+                    int built = viewport_stream_build(&vstream, &frame.world->snap, frame.version, sent_keyframe,
+                                                      (long long)sim_time(), &viewport_frame);
+                    if (built < 0) {
+                        LOG_RATELIMITED(LOG_LEVEL_ERROR, 5, "%s: Failed to build viewport frame.\n", log_prefix_viewer);
+                        need_keyframe = 1;
+                    } else if (built > 0) {
+                        to_send = viewport_frame;
+                        if (sent_keyframe) need_keyframe = 0;
+                    }
+                }
+            } else if (delta_capable && synced && !(frame.periodic_keyframe && frame.keyframe)) {
+                to_send = frame.delta;
+            } else if (frame.keyframe) {
+                to_send = frame.keyframe;
+                sent_keyframe = 1;
+                need_keyframe = 0;
+            } else {
+                need_keyframe = 1;
+                broadcaster_request_keyframe();
+            }
+            int send_failed = 0;
+            if (to_send) {
+                long long send_span = trace_begin();
+                int dropped = conn_send_frame(conn, to_send);
+                trace_end("viewer_send_frame", send_span);
+                if (dropped < 0) {
+                    LOG_RATELIMITED(LOG_LEVEL_WARN, 10, "%s: Failed to send state frame to socket %d\n", log_prefix_viewer, viewer_socket_fd);
+                    send_failed = 1;
+                } else {
+                    metric_counter_add(&server_metrics.messages_out[sent_keyframe ?
+                                       METRIC_MSG_STATE_KEYFRAME : METRIC_MSG_STATE_DELTA], 1);
+                    if (dropped > 0) {
+                        metric_counter_add(&server_metrics.viewer_frames_dropped, (unsigned long long)dropped);
+                        LOG_RATELIMITED(LOG_LEVEL_INFO, 5, "%s: Slow viewer, replaced %d stale frame(s).\n", log_prefix_viewer, dropped);
+                        // Atılan delta'lar zinciri kopardı: bu frame keyframe değilse viewer'ın durumu ayrışır
+                        if (!sent_keyframe) {
+                            need_keyframe = 1;
+                            if (!viewport_active) broadcaster_request_keyframe();
+                        }
+                    }
+                }
+                last_sent_version = frame.version;
+            }
+            shared_buffer_release(viewport_frame);
+            broadcast_frame_release(&frame);
+            if (send_failed) break;
         }
+        if (!server_running) break;
 
-        fd_set readfds_viewer_loop;
+        fd_set readfds_viewer_loop, writefds_viewer_loop;
         FD_ZERO(&readfds_viewer_loop);
+        FD_ZERO(&writefds_viewer_loop);
         FD_SET(viewer_socket_fd, &readfds_viewer_loop);
+        if (conn_pending_bytes(conn) > 0) FD_SET(viewer_socket_fd, &writefds_viewer_loop);
         struct timeval tv_viewer_check_loop;
         tv_viewer_check_loop.tv_sec = 0;
-        tv_viewer_check_loop.tv_usec = 10000;
+        tv_viewer_check_loop.tv_usec = 0;
 
-        int activity_v = select(viewer_socket_fd + 1, &readfds_viewer_loop, NULL, NULL, &tv_viewer_check_loop);
+        int activity_v = select(viewer_socket_fd + 1, &readfds_viewer_loop, &writefds_viewer_loop, NULL, &tv_viewer_check_loop);
         if (!server_running) break;
 
+        if (activity_v > 0 && FD_ISSET(viewer_socket_fd, &writefds_viewer_loop)) {
+            long long flush_span = trace_begin();
+            int flushed = conn_flush(conn);
+            trace_end("viewer_flush", flush_span);
+            if (flushed < 0) {
+                LOG_INFO("%s: Viewer write error.\n", log_prefix_viewer);
+                break;
+            }
+        }
+
         if (activity_v > 0 && FD_ISSET(viewer_socket_fd, &readfds_viewer_loop)) {
-            char temp_buf[16];
-            if (recv(viewer_socket_fd, temp_buf, sizeof(temp_buf) - 1, 0) <= 0) {
-                printf("%s: Viewer client disconnected.\n", log_prefix_viewer);
+            if (viewer_aggregate_len >= (int)sizeof(viewer_aggregate) - 1) viewer_aggregate_len = 0;
+            ssize_t n = recv(viewer_socket_fd, viewer_aggregate + viewer_aggregate_len,
+                             sizeof(viewer_aggregate) - viewer_aggregate_len - 1, 0);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+            if (n <= 0) {
+                LOG_INFO("%s: Viewer client disconnected.\n", log_prefix_viewer);
                 break;
             }
+            metric_counter_add(&server_metrics.bytes_in, (unsigned long long)n);
+            viewer_aggregate_len += n;
+            viewer_aggregate[viewer_aggregate_len] = '\0';
+
+            char *line_start = viewer_aggregate, *nl;
+            while ((nl = strchr(line_start, '\n')) != NULL) {
+                *nl = '\0';
+                struct json_object *viewer_msg = json_tokener_parse(line_start);
+                struct json_object *vtype_obj;
+                const char *vtype = NULL;
+                if (viewer_msg && json_object_object_get_ex(viewer_msg, "type", &vtype_obj) &&
+                    json_object_is_type(vtype_obj, json_type_string)) {
+                    vtype = json_object_get_string(vtype_obj);
+                }
+                if (vtype && strcmp(vtype, "VIEWER_RESYNC") == 0) {
+                    // Viewer delta zincirinde boşluk gördü; bir sonraki tick'te keyframe gönder
+                    metric_counter_add(&server_metrics.messages_in[METRIC_MSG_VIEWER_RESYNC], 1);
+                    need_keyframe = 1;
+                    broadcaster_request_keyframe();
+                } else if (vtype && strcmp(vtype, "VIEWER_SUBSCRIBE") == 0) {
+                    metric_counter_add(&server_metrics.messages_in[METRIC_MSG_VIEWER_SUBSCRIBE], 1);
+                    if (parse_viewport(viewer_msg, &requested_view) != 0) {
+                        send_error_to_client(conn, "Invalid viewport", ERROR_JSON);
+                    } else if (viewport_active) {
+                        // Pan/zoom: giren ve çıkan varlıklar bir sonraki delta'da gider
+                        viewport_stream_set_view(&vstream, &requested_view);
+                    } else {
+                        viewport_stream_init(&vstream, &requested_view);
+                        viewport_active = 1;
+                        broadcaster_viewport_subscribers(1);
+                    }
+                } else {
+                    metric_counter_add(&server_metrics.messages_in[METRIC_MSG_OTHER], 1);
+                }
+                if (viewer_msg) json_object_put(viewer_msg);
+                line_start = nl + 1;
+            }
+            viewer_aggregate_len -= (line_start - viewer_aggregate);
+            memmove(viewer_aggregate, line_start, viewer_aggregate_len + 1);
         } else if (activity_v < 0 && errno != EINTR) {
             perror("Viewer handler select error");
             break;
         }
+    }
 
-        struct timespec ts = {0, VIEWER_UPDATE_INTERVAL_MS * 1000000L};
-        nanosleep(&ts, NULL);
+    admission_release_viewer(&admission_ticket);
+    if (!delta_capable) broadcaster_full_frame_subscribers(-1);
+    if (viewport_active) {
+        broadcaster_viewport_subscribers(-1);
+        viewport_stream_free(&vstream);
     }
+    metric_gauge_add(&server_metrics.viewers_connected, -1);
 
     pthread_mutex_lock(&viewers_list_lock);
     if (viewers_list->removedata(viewers_list, &fd_ptr_for_list) == 0) {
-        printf("%s: Removed from active viewers list.\n", log_prefix_viewer);
+        LOG_INFO("%s: Removed from active viewers list.\n", log_prefix_viewer);
     } else {
-        fprintf(stderr, "%s: Failed to remove from active viewers list.\n", log_prefix_viewer);
+        LOG_ERROR("%s: Failed to remove from active viewers list.\n", log_prefix_viewer);
     }
     pthread_mutex_unlock(&viewers_list_lock);
 
     free(fd_ptr_for_list);
+    conn_destroy(conn);
     close(viewer_socket_fd);
-    printf("%s: Connection closed and thread exiting.\n", log_prefix_viewer);
-    pthread_exit(NULL);
+    LOG_INFO("%s: Connection closed and thread exiting.\n", log_prefix_viewer);
+}
+
+/* Handler sayacına girer; kapanış beklemesinden sonra başlayan thread global yapılara dokunmadan çıkar */
+static int handler_enter(struct handler_args *args) {
+    atomic_fetch_add(&client_handlers_active, 1);
+    if (server_running) return 1;
+    close(args->client_fd);
+    free(args);
+    atomic_fetch_sub(&client_handlers_active, 1);
+    return 0;
+}
+
+void* handle_drone_connection(void* arg) {
+    if (!handler_enter((struct handler_args*)arg)) return NULL;
+    drone_connection_main((struct handler_args*)arg);
+    atomic_fetch_sub(&client_handlers_active, 1);
+    return NULL;
+}
+
+void* handle_viewer_connection(void* arg) {
+    if (!handler_enter((struct handler_args*)arg)) return NULL;
+    viewer_connection_main((struct handler_args*)arg);
+    atomic_fetch_sub(&client_handlers_active, 1);
     return NULL;
 }
+
+/**
+ * @brief Wakes every drone and viewer handler by shutting its socket down and waits for them to exit.
+ *        Called after the acceptors have stopped, while timers and the tick thread still run.
+ * @return 0 if all handlers exited, 1 if some are still running after HANDLER_SHUTDOWN_WAIT_MS.
+ */
+static int stop_client_handlers() {
+    PROFILED_LOCK(&drones->lock);
+    for (Node *node = drones->head; node != NULL; node = node->next) {
+        Drone *d = *(Drone**)node->data;
+        if (!d) continue;
+        PROFILED_LOCK(&d->lock);
+        if (d->socket_fd >= 0) shutdown(d->socket_fd, SHUT_RDWR);
+        PROFILED_UNLOCK(&d->lock);
+    }
+    PROFILED_UNLOCK(&drones->lock);
+    pthread_mutex_lock(&viewers_list_lock);
+    for (Node *node = viewers_list->head; node != NULL; node = node->next) {
+        int *fd = *(int**)node->data;
+        if (fd) shutdown(*fd, SHUT_RDWR);
+    }
+    pthread_mutex_unlock(&viewers_list_lock);
+
+    for (int waited_ms = 0; atomic_load(&client_handlers_active) > 0; waited_ms += 50) {
+        if (waited_ms >= HANDLER_SHUTDOWN_WAIT_MS) {
+            fprintf(stderr, "%d client handler thread(s) did not exit; shared state is not freed.\n",
+                    atomic_load(&client_handlers_active));
+            return 1;
+        }
+        struct timespec ts = {0, 50000000L};
+        nanosleep(&ts, NULL);
+    }
+    return 0;
+}
+
 void server_signal_handler(int signum) {
     if (signum == SIGINT || signum == SIGTERM) {
         if (!server_running) {
@@ -483,17 +1094,292 @@ void server_signal_handler(int signum) {
         }
         printf("\nSignal %d received, server shutting down gracefully...\n", signum);
         server_running = 0;
+    } else if (signum == SIGUSR1) {
+        lock_dump_requested = 1;
+    } else if (signum == SIGUSR2) {
+        trace_dump_requested = 1;
+    }
+}
 
-        if (server_socket_fd != -1) {
-            close(server_socket_fd);
-            server_socket_fd = -1;
-        }
+/* /metrics okunurken survivor listelerinden hesaplanan gauge */
+static long long survivors_in_state(void *arg) {
+    SurvivorState state = (SurvivorState)(intptr_t)arg;
+    long long count = 0;
+    if (state == HELPED) return archive_helped_total();
+    PROFILED_LOCK(&survivors->lock);
+    for (Node *node = survivors->head; node != NULL; node = node->next) {
+        Survivor *s = survivor_get(*(SurvivorHandle*)node->data);
+        if (s && s->status == state) count++;
     }
+    PROFILED_UNLOCK(&survivors->lock);
+    return count;
+}
+
+static int serve_metrics(FILE *out, const char *query) {
+    (void)query;
+    metrics_write_prometheus(out);
+    return 200;
+}
+
+/* GET /drones?id=D1: kayıttan tek drone'un anlık durumu */
+static int serve_drone(FILE *out, const char *query) {
+    if (strncmp(query, "id=", 3) != 0 || query[3] == '\0') {
+        fprintf(out, "{\"error\":\"usage: /drones?id=<drone_id>\"}\n");
+        return 400;
+    }
+    char id_str[sizeof(((Drone*)0)->id_str)];
+    snprintf(id_str, sizeof(id_str), "%.*s", (int)strcspn(query + 3, "&"), query + 3);
+    Drone *d = drone_registry_acquire(id_str);
+    if (!d) {
+        fprintf(out, "{\"error\":\"drone not connected\"}\n");
+        return 404;
+    }
+    fprintf(out, "{\"id_str\":\"%s\",\"status\":\"%s\",\"coord\":{\"x\":%d,\"y\":%d},"
+                 "\"target\":{\"x\":%d,\"y\":%d},\"mission_id\":\"%s\",\"telemetry\":\"%s\",\"session\":\"%s\"}\n",
+            d->id_str, d->status == IDLE ? "IDLE" : "ON_MISSION", d->coord.x, d->coord.y,
+            d->target.x, d->target.y, d->mission_id, d->telemetry_udp ? "udp" : "tcp",
+            d->session == DRONE_SESSION_ATTACHED ? "attached" :
+            d->session == DRONE_SESSION_DETACHED ? "detached" : "closed");
+    PROFILED_UNLOCK(&d->lock);
+    return 200;
+}
+
+static int serve_lock_profile(FILE *out, const char *query) {
+    (void)query;
+    lock_prof_dump(out);
+    return 200;
+}
+
+static int serve_trace(FILE *out, const char *query) {
+    (void)query;
+    if (!trace_enabled()) {
+        fprintf(out, "{\"error\":\"tracing is disabled, start the server with --trace-sample <n>\"}\n");
+        return 404;
+    }
+    trace_dump(out);
+    return 200;
+}
+
+static int serve_tick_stats(FILE *out, const char *query) {
+    (void)query;
+    tick_stats_dump(out);
+    return 200;
+}
+
+/* GET /checkpoint: dünyayı hemen diske yazar */
+static int serve_checkpoint(FILE *out, const char *query) {
+    (void)query;
+    if (!checkpoint_enabled()) {
+        fprintf(out, "{\"error\":\"checkpoints are disabled, start the server with --checkpoint <file>\"}\n");
+        return 404;
+    }
+    CheckpointStats stats;
+    if (checkpoint_write(&stats) != 0) {
+        fprintf(out, "{\"error\":\"checkpoint write failed\"}\n");
+        return 500;
+    }
+    fprintf(out, "{\"survivors\":%d,\"helped\":%d,\"drones\":%d,\"bytes\":%lld,\"duration_us\":%lld}\n",
+            stats.survivors, stats.helped, stats.drones, stats.bytes, stats.duration_us);
+    return 200;
+}
+
+static void print_server_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -k, --keyframe-interval <ticks>  Full viewer keyframe every N broadcast ticks (default %d)\n"
+            "  -a, --acceptors <n>              Acceptor threads, each on its own SO_REUSEPORT socket (default 1)\n"
+            "  -t, --handshake-timeout <ms>     Close connections that do not handshake in time (default %d)\n"
+            "  -m, --mission-timeout <sec>      Reassign a survivor if its mission is not completed in time (default %d)\n"
+            "  -g, --session-grace <sec>        Keep a disconnected drone's session and mission for RESUME, 0 disables (default %d)\n"
+            "  -U, --no-udp-telemetry           Do not offer the UDP STATUS_UPDATE channel to drones\n"
+            "  -s, --unix-socket <path>         Also listen on this Unix domain socket (default %s)\n"
+            "  -S, --no-unix-socket             Listen on TCP only\n"
+            "  -M, --no-shm                     Do not publish the shared-memory world snapshot for local viewers\n"
+            "  -p, --admin-port <port>          Local HTTP port for /metrics, 0 disables (default %d)\n"
+            "  -T, --trace-sample <n>           Record 1 in n spans for /debug/trace and SIGUSR2 dumps, 0 disables (default 0)\n"
+            "  -r, --tick-rate <hz>             Simulation ticks per second for spawn, dispatch, timeouts and broadcast (default %d)\n"
+            "  -D, --max-drones <n>             Drone sessions admitted at once; extra handshakes get ERROR_OVERLOADED (default %d)\n"
+            "  -V, --max-viewers <n>            Viewers admitted at once (default %d)\n"
+            "  -C, --shed-cpu <percent>         Refuse and shed viewers above this process CPU use, 0 disables (default %d)\n"
+            "  -j, --journal <dir>              Append state transitions to binary journal segments in this directory\n"
+            "  -J, --journal-segment-mb <n>     Start a new journal segment after this many MB (default %d)\n"
+            "  -e, --seed <n>                   Seed for the per-thread random streams (default: time and pid)\n"
+            "  -x, --speed <factor>             Virtual clock running this many times real time, 0 as fast as possible\n"
+            "  -d, --duration <sec>             Stop after this much simulated time\n"
+            "  -v, --virtual-drones <n>         Simulate n drones inside the server (V1..Vn)\n"
+            "  -R, --replay <dir>               Replay survivor and drone events of a recorded journal on the virtual clock\n"
+            "  -c, --checkpoint <file>          Restore the world from this file at startup and checkpoint it while running\n"
+            "  -I, --checkpoint-interval <sec>  Seconds between periodic checkpoints, 0 only on /checkpoint and shutdown (default %d)\n"
+            "  -A, --archive <file>             Append helped survivors to this archive file (memory is freed either way)\n"
+            "  -L, --log-level <level>          error, warn, info or debug (default info)\n"
+            "  -h, --help                       Show this help\n",
+            prog, BROADCAST_DEFAULT_KEYFRAME_INTERVAL, ACCEPTOR_DEFAULT_HANDSHAKE_TIMEOUT_MS,
+            DRONE_DEFAULT_MISSION_TIMEOUT_MS / 1000, DRONE_DEFAULT_SESSION_GRACE_MS / 1000, ACCEPTOR_DEFAULT_UNIX_PATH, ADMIN_HTTP_DEFAULT_PORT,
+            TICK_DEFAULT_RATE_HZ, ADMISSION_DEFAULT_MAX_DRONES, ADMISSION_DEFAULT_MAX_VIEWERS, ADMISSION_DEFAULT_SHED_CPU_PERCENT,
+            JOURNAL_DEFAULT_SEGMENT_MB, CHECKPOINT_DEFAULT_INTERVAL_SEC);
 }
 
 int main(int argc, char *argv[]) {
-    (void)argc; (void)argv;
-    srand(time(NULL));
+    static const struct option long_options[] = {
+        {"keyframe-interval", required_argument, NULL, 'k'},
+        {"acceptors", required_argument, NULL, 'a'},
+        {"handshake-timeout", required_argument, NULL, 't'},
+        {"mission-timeout", required_argument, NULL, 'm'},
+        {"session-grace", required_argument, NULL, 'g'},
+        {"no-udp-telemetry", no_argument, NULL, 'U'},
+        {"unix-socket", required_argument, NULL, 's'},
+        {"no-unix-socket", no_argument, NULL, 'S'},
+        {"no-shm", no_argument, NULL, 'M'},
+        {"admin-port", required_argument, NULL, 'p'},
+        {"trace-sample", required_argument, NULL, 'T'},
+        {"tick-rate", required_argument, NULL, 'r'},
+        {"max-drones", required_argument, NULL, 'D'},
+        {"max-viewers", required_argument, NULL, 'V'},
+        {"shed-cpu", required_argument, NULL, 'C'},
+        {"journal", required_argument, NULL, 'j'},
+        {"journal-segment-mb", required_argument, NULL, 'J'},
+        {"seed", required_argument, NULL, 'e'},
+        {"speed", required_argument, NULL, 'x'},
+        {"duration", required_argument, NULL, 'd'},
+        {"virtual-drones", required_argument, NULL, 'v'},
+        {"replay", required_argument, NULL, 'R'},
+        {"checkpoint", required_argument, NULL, 'c'},
+        {"checkpoint-interval", required_argument, NULL, 'I'},
+        {"archive", required_argument, NULL, 'A'},
+        {"log-level", required_argument, NULL, 'L'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    int num_acceptor_threads = 1;
+    int handshake_timeout_ms = ACCEPTOR_DEFAULT_HANDSHAKE_TIMEOUT_MS;
+    int udp_telemetry = 1;
+    const char *unix_socket_path = ACCEPTOR_DEFAULT_UNIX_PATH;
+    int shm_snapshot = 1;
+    int admin_port = ADMIN_HTTP_DEFAULT_PORT;
+    int trace_sample = 0;
+    int tick_rate = TICK_DEFAULT_RATE_HZ;
+    int max_drones = ADMISSION_DEFAULT_MAX_DRONES;
+    int max_viewers = ADMISSION_DEFAULT_MAX_VIEWERS;
+    int shed_cpu_percent = ADMISSION_DEFAULT_SHED_CPU_PERCENT;
+    const char *journal_dir = NULL;
+    int journal_segment_mb = JOURNAL_DEFAULT_SEGMENT_MB;
+    unsigned long long seed = ((unsigned long long)time(NULL) << 16) ^ (unsigned long long)getpid();
+    int virtual_clock = 0;
+    double speed = 1.0;
+    long long duration_sec = 0;
+    int virtual_drones = 0;
+    const char *replay_dir = NULL;
+    const char *checkpoint_file = NULL;
+    int checkpoint_interval_sec = CHECKPOINT_DEFAULT_INTERVAL_SEC;
+    const char *archive_file = NULL;
+    int log_level = LOG_DEFAULT_LEVEL;
+    int opt_c;
+    while ((opt_c = getopt_long(argc, argv, "k:a:t:m:g:Us:SMp:T:r:D:V:C:j:J:e:x:d:v:R:c:I:A:L:h", long_options, NULL)) != -1) {
+        switch (opt_c) {
+            case 'k':
+                broadcaster_set_keyframe_interval(atoi(optarg));
+                break;
+            case 'a':
+                num_acceptor_threads = atoi(optarg);
+                if (num_acceptor_threads < 1 || num_acceptor_threads > ACCEPTOR_MAX_THREADS) {
+                    fprintf(stderr, "Acceptor count must be between 1 and %d.\n", ACCEPTOR_MAX_THREADS);
+                    return 1;
+                }
+                break;
+            case 't':
+                handshake_timeout_ms = atoi(optarg);
+                break;
+            case 'm':
+                if (atoi(optarg) > 0) mission_timeout_ms = atoi(optarg) * 1000;
+                break;
+            case 'g':
+                if (atoi(optarg) >= 0) session_grace_ms = atoi(optarg) * 1000;
+                break;
+            case 'U':
+                udp_telemetry = 0;
+                break;
+            case 's':
+                unix_socket_path = optarg;
+                break;
+            case 'S':
+                unix_socket_path = NULL;
+                break;
+            case 'M':
+                shm_snapshot = 0;
+                break;
+            case 'p':
+                admin_port = atoi(optarg);
+                break;
+            case 'T':
+                trace_sample = atoi(optarg);
+                break;
+            case 'r':
+                tick_rate = atoi(optarg);
+                break;
+            case 'D':
+                max_drones = atoi(optarg);
+                break;
+            case 'V':
+                max_viewers = atoi(optarg);
+                break;
+            case 'C':
+                shed_cpu_percent = atoi(optarg);
+                break;
+            case 'j':
+                journal_dir = optarg;
+                break;
+            case 'J':
+                journal_segment_mb = atoi(optarg);
+                break;
+            case 'e':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'x':
+                virtual_clock = 1;
+                speed = atof(optarg);
+                break;
+            case 'd':
+                duration_sec = atoll(optarg);
+                break;
+            case 'v':
+                virtual_drones = atoi(optarg);
+                break;
+            case 'R':
+                replay_dir = optarg;
+                virtual_clock = 1;
+                break;
+            case 'c':
+                checkpoint_file = optarg;
+                break;
+            case 'I':
+                checkpoint_interval_sec = atoi(optarg);
+                break;
+            case 'A':
+                archive_file = optarg;
+                break;
+            case 'L':
+                log_level = log_level_from_name(optarg);
+                if (log_level < 0) {
+                    fprintf(stderr, "Unknown log level '%s' (error, warn, info, debug).\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'h':
+                print_server_usage(argv[0]);
+                return 0;
+            default:
+                print_server_usage(argv[0]);
+                return 1;
+        }
+    }
+    // Sanal saat tekrar oynatılan kaydın ilk olayından başlar
+    long long replay_first_ns = 0, replay_last_ns = 0;
+    if (replay_dir && replay_open(replay_dir, &replay_first_ns, &replay_last_ns) != 0) {
+        return 1;
+    }
+    if (simclock_init(virtual_clock, speed, seed, replay_first_ns) != 0) {
+        return 1;
+    }
 
     struct sigaction sa;
     sa.sa_handler = server_signal_handler;
@@ -501,14 +1387,19 @@ int main(int argc, char *argv[]) {
     sa.sa_flags = 0;
     sigaction(SIGINT, &sa, NULL);
     sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
+    sigaction(SIGUSR2, &sa, NULL);
 
     printf("Server starting on port %d...\n", SERVER_PORT);
 
-    survivors = create_list(sizeof(Survivor*), 100);
-    helpedsurvivors = create_list(sizeof(Survivor*), 500);
-    drones = create_list(sizeof(Drone*), 50);
-    viewers_list = create_list(sizeof(int*), 10);
-    if (!survivors || !helpedsurvivors || !drones || !viewers_list) {
+    survivors = create_list(sizeof(SurvivorHandle), SURVIVOR_MAX_ACTIVE);
+    // Liste kapasiteleri kabul sınırlarıyla aynı: add() hiçbir zaman dolu listede beklemez
+    if (admission_init(max_drones, max_viewers, shed_cpu_percent) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    drones = create_list(sizeof(Drone*), max_drones);
+    viewers_list = create_list(sizeof(int*), max_viewers > 0 ? max_viewers : 1);
+    if (!survivors || !drones || !viewers_list) {
         exit(EXIT_FAILURE);
     }
 
@@ -522,110 +1413,149 @@ int main(int argc, char *argv[]) {
     printf("Map initialized: %dx%d\n", map.width, map.height);
     printf("Map initialized for server.\n");
 
-    server_socket_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_socket_fd < 0) {
-        perror("socket");
+    metrics_init();
+    if (log_init(log_level) != 0) {
         exit(EXIT_FAILURE);
     }
+    trace_init(trace_sample);
+    if (survivor_table_init(SURVIVOR_MAX_ACTIVE) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    metrics_register_gauge_fn(survivors_in_state, (void*)(intptr_t)WAITING, "drone_server_survivors",
+                              "state=\"waiting\"", "Survivors by state.");
+    metrics_register_gauge_fn(survivors_in_state, (void*)(intptr_t)ASSIGNED, "drone_server_survivors",
+                              "state=\"assigned\"", "Survivors by state.");
+    metrics_register_gauge_fn(survivors_in_state, (void*)(intptr_t)HELPED, "drone_server_survivors",
+                              "state=\"helped\"", "Survivors by state.");
+    admin_http_register("/metrics", "text/plain; version=0.0.4", serve_metrics);
+    admin_http_register("/drones", "application/json", serve_drone);
+    admin_http_register("/debug/locks", "text/plain", serve_lock_profile);
+    admin_http_register("/debug/trace", "application/json", serve_trace);
+    if (checkpoint_file && checkpoint_init(checkpoint_file, checkpoint_interval_sec) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    admin_http_register("/checkpoint", "application/json", serve_checkpoint);
 
-    int opt = 1;
-    setsockopt(server_socket_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (broadcaster_init() != 0) {
+        exit(EXIT_FAILURE);
+    }
+    // Paylaşımlı bellek açılamazsa sadece --shm viewer'ları etkilenir
+    if (shm_snapshot && shm_world_create() != 0) {
+        fprintf(stderr, "Shared-memory world snapshot disabled.\n");
+    }
 
-    struct sockaddr_in server_address;
-    memset(&server_address, 0, sizeof(server_address));
-    server_address.sin_family = AF_INET;
-    server_address.sin_addr.s_addr = htonl(INADDR_ANY);
-    server_address.sin_port = htons(SERVER_PORT);
+    timer_wheel_init();
 
-    if (bind(server_socket_fd, (struct sockaddr*)&server_address, sizeof(server_address)) < 0) {
-        perror("bind");
-        close(server_socket_fd);
+    // Journal açılamıyorsa sunucu başlamaz: istenen denetim kaydı sessizce eksik kalmasın
+    if (journal_dir && journal_open(journal_dir, journal_segment_mb) != 0) {
+        exit(EXIT_FAILURE);
+    }
+    if (archive_file && archive_open(archive_file) != 0) {
         exit(EXIT_FAILURE);
     }
 
-    if (listen(server_socket_fd, MAX_PENDING_CONNECTIONS) < 0) {
-        perror("listen");
-        close(server_socket_fd);
+    // Survivor üretimi, görev ataması, zaman aşımları ve yayın tek thread'de, sabit hızda sırayla çalışır
+    if (tick_scheduler_init(tick_rate) != 0) {
         exit(EXIT_FAILURE);
     }
+    if (replay_dir) tick_scheduler_add(TICK_PHASE_SPAWN, "replay", replay_tick, 0);
+    else tick_scheduler_add(TICK_PHASE_SPAWN, "spawn", survivor_spawn_tick, 0);
+    tick_scheduler_add(TICK_PHASE_DISPATCH, "dispatch", ai_dispatch_tick, AI_DISPATCH_INTERVAL_MS);
+    if (virtual_drones > 0 || replay_dir) {
+        if (virtual_drones_init(virtual_drones) != 0) {
+            exit(EXIT_FAILURE);
+        }
+        tick_scheduler_add(TICK_PHASE_DRONES, "drones", virtual_drones_tick, VIRTUAL_DRONE_MOVE_INTERVAL_MS);
+    }
+    tick_scheduler_add(TICK_PHASE_TIMEOUTS, "timeouts", timer_wheel_tick, 0);
+    tick_scheduler_add(TICK_PHASE_BROADCAST, "broadcast", broadcaster_tick, BROADCAST_INTERVAL_MS);
+    admin_http_register("/debug/ticks", "text/plain", serve_tick_stats);
+    // Süre verilmeden tekrar oynatma kaydın son olayında biter
+    if (duration_sec <= 0 && replay_dir) {
+        duration_sec = (replay_last_ns - replay_first_ns) / 1000000000LL + 1;
+    }
+    if (duration_sec > 0) tick_scheduler_stop_after((unsigned long long)duration_sec * (unsigned long long)tick_rate);
 
-    printf("Server listening on port %d.\n", SERVER_PORT);
+    // Önceki çalıştırmanın dünyası tick thread'i ve bağlantılar başlamadan yüklenir
+    if (checkpoint_restore(restore_drone_session) != 0) {
+        fprintf(stderr, "Refusing to start over an unreadable checkpoint; move it away to start empty.\n");
+        exit(EXIT_FAILURE);
+    }
 
-    pthread_t survivor_thread, ai_thread;
-    pthread_create(&survivor_thread, NULL, survivor_generator, NULL);
-    pthread_create(&ai_thread, NULL, ai_controller, NULL);
-    printf("Survivor generator and AI controller threads started for server.\n");
+    pthread_t tick_thread;
+    if (pthread_create(&tick_thread, NULL, tick_scheduler_thread, NULL) != 0) {
+        perror("Failed to create tick scheduler thread");
+        exit(EXIT_FAILURE);
+    }
+
+    if (admin_port > 0 && admin_http_start(admin_port) != 0) {
+        fprintf(stderr, "Admin HTTP endpoint disabled.\n");
+    }
 
-    printf("Server entering main accept loop...\n");
+    // UDP kanalı açılamazsa drone'lar TCP üzerinden devam eder
+    if (udp_telemetry && telemetry_start(SERVER_PORT) != 0) {
+        fprintf(stderr, "UDP telemetry disabled.\n");
+    }
+
+    if (acceptor_start(SERVER_PORT, unix_socket_path, num_acceptor_threads, handshake_timeout_ms) != 0) {
+        server_running = 0;
+    }
 
+    // Bağlantıları acceptor thread'leri kabul eder; ana thread kapanış sinyalini bekler
     while (server_running) {
-        int *client_fd_ptr = malloc(sizeof(int));
-        if (!client_fd_ptr) continue;
-        struct sockaddr_in client_addr;
-        socklen_t addr_len = sizeof(client_addr);
-        *client_fd_ptr = accept(server_socket_fd, (struct sockaddr*)&client_addr, &addr_len);
-        if (*client_fd_ptr < 0) {
-            free(client_fd_ptr);
-            if (errno == EINTR) continue;
-            perror("accept");
-            continue;
-        }
-        // Read initial handshake message
-        char buffer[BUFFER_SIZE];
-        ssize_t bytes = recv(*client_fd_ptr, buffer, sizeof(buffer) - 1, MSG_PEEK);
-        if (bytes <= 0) {
-            close(*client_fd_ptr);
-            free(client_fd_ptr);
-            continue;
+        struct timespec ts = {0, 200000000L};
+        nanosleep(&ts, NULL);
+        admission_update();
+        checkpoint_periodic();
+        if (tick_scheduler_done()) {
+            printf("Simulation finished after %lld s of simulated time.\n", sim_monotonic_ms() / 1000);
+            server_running = 0;
         }
-        buffer[bytes] = '\0';
-        char *newline = strchr(buffer, '\n'); if (newline) *newline = '\0';
-        struct json_object *initial_json = json_tokener_parse(buffer);
-        if (!initial_json) {
-            close(*client_fd_ptr);
-            free(client_fd_ptr);
-            continue;
+        if (lock_dump_requested) {
+            lock_dump_requested = 0;
+            lock_prof_dump(stderr);
         }
-        struct json_object *type_obj;
-        pthread_t handler_thread;
-        int dispatched = 0;
-        if (json_object_object_get_ex(initial_json, "type", &type_obj)) {
-            const char *type = json_object_get_string(type_obj);
-            struct handler_args *args = malloc(sizeof(*args));
-            args->client_fd = *client_fd_ptr;
-            strncpy(args->initial_msg, buffer, sizeof(args->initial_msg)-1);
-            args->initial_msg[sizeof(args->initial_msg)-1] = '\0';
-            if (strcmp(type, "HANDSHAKE") == 0) {
-                dispatched = (pthread_create(&handler_thread, NULL, handle_drone_connection, args) == 0);
-                if (dispatched) pthread_detach(handler_thread), printf("Server: Dispatched drone handler for socket %d.\n", *client_fd_ptr);
-            } else if (strcmp(type, "VIEWER_HANDSHAKE") == 0) {
-                dispatched = (pthread_create(&handler_thread, NULL, handle_viewer_connection, args) == 0);
-                if (dispatched) pthread_detach(handler_thread), printf("Server: Dispatched viewer handler for socket %d.\n", *client_fd_ptr);
-            }
-            if (!dispatched) {
-                free(args);
-                close(*client_fd_ptr);
-            }
+        if (trace_dump_requested) {
+            trace_dump_requested = 0;
+            if (trace_enabled()) trace_dump_file(TRACE_DEFAULT_DUMP_PATH);
+            else fprintf(stderr, "Tracing is disabled (start with --trace-sample <n>).\n");
         }
-        json_object_put(initial_json);
-        free(client_fd_ptr);
     }
 
-    close(server_socket_fd);
-    server_socket_fd = -1;
-
-    pthread_cancel(survivor_thread);
-    pthread_cancel(ai_thread);
-    pthread_join(survivor_thread, NULL);
-    pthread_join(ai_thread, NULL);
-
-    if (viewers_list) viewers_list->destroy(viewers_list);
-    if (helpedsurvivors) helpedsurvivors->destroy(helpedsurvivors);
-    if (survivors) survivors->destroy(survivors);
-    if (drones) drones->destroy(drones);
-    pthread_mutex_destroy(&viewers_list_lock);
-    freemap();
+    acceptor_shutdown();
+    // Handler'lar drone/survivor listelerini ve zamanlayıcıları kullanır; hepsi çıkmadan hiçbiri kapatılmaz
+    int handlers_stopped = stop_client_handlers() == 0;
+    telemetry_shutdown();
+    admin_http_shutdown();
+
+    tick_scheduler_shutdown();
+    pthread_join(tick_thread, NULL);
+    // Son checkpoint simüle drone'lar ve oturumlar temizlenmeden önce alınır
+    if (checkpoint_enabled()) checkpoint_write(NULL);
+    if (virtual_drones > 0 || replay_dir) virtual_drones_shutdown();
+    replay_close();
+    broadcaster_shutdown();
+    shm_world_destroy();
+    timer_wheel_shutdown();
+    // Bekleyen log mesajları özetlerden önce yazılsın; bundan sonrası doğrudan yazılır
+    log_shutdown();
+    tick_stats_dump(stdout);
+    journal_shutdown();
+    archive_shutdown();
+
+    // Takılı kalan handler varsa paylaşılan yapılar serbest bırakılmaz; süreç zaten çıkıyor
+    if (handlers_stopped) {
+        if (viewers_list) viewers_list->destroy(viewers_list);
+        if (survivors) survivors->destroy(survivors);
+        if (drones) drones->destroy(drones);
+        pthread_mutex_destroy(&viewers_list_lock);
+        freemap();
+        survivor_table_destroy();
+    }
 
+#ifdef LOCK_PROFILING
+    lock_prof_dump(stderr);
+#endif
     printf("Server shutdown complete.\n");
     return 0;
 }
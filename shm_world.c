@@ -0,0 +1,172 @@
+/*
+ * shm_world.c
+ * Broadcaster'ın her yeni durum versiyonunu paylaşımlı belleğe seqlock ile yazması
+ * ve aynı makinedeki viewer'ların bunu kilitsiz okuması.
+ */
+#include "headers/shm_world.h"
+#include "headers/broadcast.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHM_WORLD_READ_RETRIES 1000
+
+static ShmWorld *world_rw = NULL;
+
+int shm_world_create() {
+    int fd = shm_open(SHM_WORLD_NAME, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        return 1;
+    }
+    if (ftruncate(fd, sizeof(ShmWorld)) < 0) {
+        perror("ftruncate shared world");
+        close(fd);
+        shm_unlink(SHM_WORLD_NAME);
+        return 1;
+    }
+    void *addr = mmap(NULL, sizeof(ShmWorld), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        perror("mmap shared world");
+        shm_unlink(SHM_WORLD_NAME);
+        return 1;
+    }
+    world_rw = (ShmWorld*)addr;
+
+    // Önceki bir çalışmadan kalan bölge olabilir; yazım gibi tek sayılı seq altında sıfırlanır
+    atomic_store(&world_rw->server_running, 0);
+    unsigned seq = atomic_load(&world_rw->seq) | 1;
+    atomic_store(&world_rw->seq, seq);
+    memset(&world_rw->state, 0, sizeof(world_rw->state));
+    world_rw->magic = SHM_WORLD_MAGIC;
+    world_rw->layout_version = SHM_WORLD_LAYOUT_VERSION;
+    atomic_store_explicit(&world_rw->seq, seq + 1, memory_order_release);
+    atomic_store(&world_rw->server_running, 1);
+    printf("Shared-memory world snapshot at %s (%zu bytes).\n", SHM_WORLD_NAME, sizeof(ShmWorld));
+    return 0;
+}
+
+void shm_world_publish(const WorldSnapshot *snap, unsigned long version, long long timestamp) {
+    if (!world_rw) return;
+    ShmWorldState *st = &world_rw->state;
+
+    // Tek sayı: okuyucular bu arada aldıkları kopyayı atar
+    unsigned seq = atomic_load_explicit(&world_rw->seq, memory_order_relaxed);
+    atomic_store_explicit(&world_rw->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    st->version = version;
+    st->timestamp = timestamp;
+    st->map_width = snap->map_width;
+    st->map_height = snap->map_height;
+    st->truncated = 0;
+
+    int nd = snap->num_drones;
+    if (nd > SHM_WORLD_MAX_DRONES) {
+        nd = SHM_WORLD_MAX_DRONES;
+        st->truncated = 1;
+    }
+    for (int i = 0; i < nd; i++) {
+        const DroneSnapshot *d = &snap->drones[i];
+        ShmDrone *out = &st->drones[i];
+        memcpy(out->id_str, d->id_str, sizeof(out->id_str));
+        out->x = d->coord.x;
+        out->y = d->coord.y;
+        out->target_x = d->target.x;
+        out->target_y = d->target.y;
+        out->status = d->status;
+    }
+    st->num_drones = nd;
+
+    int ns = snap->num_survivors;
+    if (ns > SHM_WORLD_MAX_SURVIVORS) {
+        ns = SHM_WORLD_MAX_SURVIVORS;
+        st->truncated = 1;
+    }
+    for (int i = 0; i < ns; i++) {
+        const SurvivorSnapshot *s = &snap->survivors[i];
+        ShmSurvivor *out = &st->survivors[i];
+        out->id = s->id;
+        out->x = s->coord.x;
+        out->y = s->coord.y;
+        out->status = s->status;
+    }
+    st->num_survivors = ns;
+
+    atomic_store_explicit(&world_rw->seq, seq + 2, memory_order_release);
+}
+
+void shm_world_destroy() {
+    if (!world_rw) return;
+    atomic_store(&world_rw->server_running, 0);
+    munmap(world_rw, sizeof(ShmWorld));
+    world_rw = NULL;
+    // Map'li okuyucular bölgeyi kendileri kapatana kadar görmeye devam eder
+    shm_unlink(SHM_WORLD_NAME);
+}
+
+const ShmWorld *shm_world_open_readonly() {
+    int fd = shm_open(SHM_WORLD_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        perror("shm_open (is the server running on this host?)");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(ShmWorld)) {
+        fprintf(stderr, "Shared world region has unexpected size.\n");
+        close(fd);
+        return NULL;
+    }
+    void *addr = mmap(NULL, sizeof(ShmWorld), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        perror("mmap shared world");
+        return NULL;
+    }
+    const ShmWorld *world = (const ShmWorld*)addr;
+    if (world->magic != SHM_WORLD_MAGIC || world->layout_version != SHM_WORLD_LAYOUT_VERSION) {
+        fprintf(stderr, "Shared world region has an incompatible layout.\n");
+        munmap(addr, sizeof(ShmWorld));
+        return NULL;
+    }
+    return world;
+}
+
+void shm_world_close(const ShmWorld *world) {
+    if (world) munmap((void*)world, sizeof(ShmWorld));
+}
+
+int shm_world_read(const ShmWorld *world, ShmWorldState *out) {
+    ShmWorld *w = (ShmWorld*)world;   // atomic_load const olmayan işaretçi ister; sadece okunur
+    const ShmWorldState *st = &world->state;
+    for (int attempt = 0; attempt < SHM_WORLD_READ_RETRIES; attempt++) {
+        unsigned before = atomic_load_explicit(&w->seq, memory_order_acquire);
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+
+        out->version = st->version;
+        out->timestamp = st->timestamp;
+        out->map_width = st->map_width;
+        out->map_height = st->map_height;
+        out->truncated = st->truncated;
+        // Sayaçlar yazım ortasında okunmuş olabilir; kopya seq ile doğrulanana kadar sınırla
+        int nd = st->num_drones, ns = st->num_survivors;
+        if (nd < 0 || nd > SHM_WORLD_MAX_DRONES) nd = 0;
+        if (ns < 0 || ns > SHM_WORLD_MAX_SURVIVORS) ns = 0;
+        memcpy(out->drones, st->drones, nd * sizeof(ShmDrone));
+        memcpy(out->survivors, st->survivors, ns * sizeof(ShmSurvivor));
+        out->num_drones = nd;
+        out->num_survivors = ns;
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&w->seq, memory_order_relaxed) == before) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * simclock.c
+ * Gerçek veya tick ile ilerleyen sanal simülasyon saati ve thread başına tohumlu PRNG.
+ */
+#include "headers/simclock.h"
+#include <stdio.h>
+#include <stdatomic.h>
+
+#define SIM_RAND_FIRST_AUTO_STREAM 1000   // Açıkça seçilen akışlar bunun altında kalır
+
+static int virtual_mode = 0;
+static double clock_speed = 1.0;
+static unsigned long long rng_seed = 0;
+static long long start_epoch = 0;          /* ns; sanal modda sim_realtime_ns'in başlangıcı */
+static long long start_monotonic = 0;      /* ns; gerçek modda sim_monotonic_ms'in başlangıcı */
+static atomic_llong virtual_elapsed_ns = 0;
+static atomic_ullong next_auto_stream = SIM_RAND_FIRST_AUTO_STREAM;
+
+static _Thread_local unsigned long long rng_state;
+static _Thread_local int rng_seeded = 0;
+
+static long long clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static unsigned long long splitmix64(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+int simclock_init(int virtual_clock, double speed, unsigned long long seed, long long start_epoch_ns) {
+    if (speed < 0) {
+        fprintf(stderr, "Simulation speed must be 0 (as fast as possible) or a positive factor.\n");
+        return 1;
+    }
+    virtual_mode = virtual_clock;
+    clock_speed = speed;
+    rng_seed = seed;
+    start_monotonic = clock_ns(CLOCK_MONOTONIC);
+    start_epoch = start_epoch_ns > 0 ? start_epoch_ns : SIMCLOCK_VIRTUAL_EPOCH * 1000000000LL;
+    atomic_store(&virtual_elapsed_ns, 0);
+    if (virtual_mode) {
+        if (speed > 0) printf("Simulation clock: virtual, %.1fx real time, seed %llu.\n", speed, seed);
+        else printf("Simulation clock: virtual, as fast as possible, seed %llu.\n", seed);
+    }
+    return 0;
+}
+
+int simclock_virtual() {
+    return virtual_mode;
+}
+
+double simclock_speed() {
+    return clock_speed;
+}
+
+unsigned long long simclock_seed() {
+    return rng_seed;
+}
+
+void simclock_advance_ns(long long ns) {
+    atomic_fetch_add_explicit(&virtual_elapsed_ns, ns, memory_order_release);
+}
+
+long long sim_monotonic_ms() {
+    if (virtual_mode) return atomic_load_explicit(&virtual_elapsed_ns, memory_order_acquire) / 1000000;
+    return (clock_ns(CLOCK_MONOTONIC) - start_monotonic) / 1000000;
+}
+
+long long sim_realtime_ns() {
+    if (virtual_mode) return start_epoch + atomic_load_explicit(&virtual_elapsed_ns, memory_order_acquire);
+    return clock_ns(CLOCK_REALTIME);
+}
+
+time_t sim_time() {
+    if (virtual_mode) return (time_t)(sim_realtime_ns() / 1000000000LL);
+    return time(NULL);
+}
+
+void sim_sleep_ms(int ms) {
+    if (!virtual_mode) {
+        struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+        nanosleep(&ts, NULL);
+        return;
+    }
+    // Sanal zaman tick thread'i ilerlettikçe akar; kısa aralıklarla yoklanır
+    long long until = sim_monotonic_ms() + ms;
+    while (sim_monotonic_ms() < until) {
+        struct timespec ts = {0, 1000000L};
+        nanosleep(&ts, NULL);
+    }
+}
+
+void sim_rand_seed_thread(unsigned long long stream) {
+    unsigned long long mix = rng_seed ^ (stream * 0xd1b54a32d192ed03ULL);
+    rng_state = splitmix64(&mix);
+    rng_seeded = 1;
+}
+
+int sim_rand() {
+    if (!rng_seeded) sim_rand_seed_thread(atomic_fetch_add(&next_auto_stream, 1));
+    return (int)(splitmix64(&rng_state) >> 33);
+}
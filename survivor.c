@@ -7,125 +7,215 @@
 #include <unistd.h>
 #include "headers/globals.h" // map, survivors listeleri için
 #include "headers/map.h"     // map için (dolaylı yoldan globals.h'den de gelebilir ama açıkça eklemek iyi)
+#include "headers/trace.h"
+#include "headers/tick.h"
+#include "headers/journal.h"
+#include "headers/simclock.h"
+#include "headers/log.h"
+#include "headers/metrics.h"
+#include <stdatomic.h>
 // list.h globals.h içinde olduğundan tekrar include etmeye gerek yok.
 
+static atomic_int next_survivor_id = 1;
+
+/* Slot dizisi hiç yeniden ayrılmaz: survivor_get'in döndürdüğü işaretçi slot serbest kalana kadar geçerlidir */
+static Survivor *slots = NULL;
+static atomic_uint *generations = NULL;   // Slotun şu anki generation'ı; canlı handle'ınkiyle eşit
+static uint32_t *free_stack = NULL;       // Boş slot indeksleri
+static int free_top = 0;
+static int table_capacity = 0;
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static MetricCounter stale_handles;
+
+static long long live_survivors(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&table_lock);
+    long long live = table_capacity - free_top;
+    pthread_mutex_unlock(&table_lock);
+    return live;
+}
+
+int survivor_table_init(int capacity) {
+    if (capacity < 1) {
+        fprintf(stderr, "Survivor table capacity must be at least 1.\n");
+        return 1;
+    }
+    slots = calloc(capacity, sizeof(Survivor));
+    generations = calloc(capacity, sizeof(atomic_uint));
+    free_stack = malloc(capacity * sizeof(uint32_t));
+    if (!slots || !generations || !free_stack) {
+        perror("Failed to allocate survivor table");
+        survivor_table_destroy();
+        return 1;
+    }
+    table_capacity = capacity;
+    // İlk ayırmalar düşük indekslerden başlasın
+    for (int i = 0; i < capacity; i++) {
+        atomic_init(&generations[i], 1);
+        free_stack[i] = (uint32_t)(capacity - 1 - i);
+    }
+    free_top = capacity;
+
+    metrics_register_gauge_fn(live_survivors, NULL, "drone_server_survivor_slots_used", NULL,
+                              "Occupied slots in the survivor table.");
+    metrics_register_counter(&stale_handles, "drone_server_survivor_stale_handles_total", NULL,
+                             "Lookups with a handle whose survivor slot was already freed.");
+    return 0;
+}
+
+void survivor_table_destroy() {
+    free(slots);
+    free(generations);
+    free(free_stack);
+    slots = NULL;
+    generations = NULL;
+    free_stack = NULL;
+    table_capacity = free_top = 0;
+}
+
 /**
- * @brief Creates a new survivor object.
+ * @brief Places a new survivor into a free table slot.
  * @param coord Coordinates of the survivor.
  * @param info Information about the survivor.
- * @param discovery_time Time of discovery.
- * @return Pointer to the newly created Survivor object, or NULL on failure.
+ * @param discovery_time Time of discovery (Unix epoch seconds).
+ * @return Handle of the new survivor, or SURVIVOR_HANDLE_NONE if the table is full.
  */
-Survivor *create_survivor(Coord *coord, char *info, struct tm *discovery_time) {
-    Survivor *s = malloc(sizeof(Survivor));
-    if (!s) {
-        perror("Failed to allocate memory for Survivor");
+SurvivorHandle survivor_create(Coord coord, const char *info, int64_t discovery_time) {
+    pthread_mutex_lock(&table_lock);
+    if (free_top == 0) {
+        pthread_mutex_unlock(&table_lock);
+        return SURVIVOR_HANDLE_NONE;
+    }
+    uint32_t index = free_stack[--free_top];
+    pthread_mutex_unlock(&table_lock);
+
+    Survivor *s = &slots[index];
+    memset(s, 0, sizeof(*s));
+    s->id = atomic_fetch_add(&next_survivor_id, 1);
+    s->status = WAITING;
+    s->coord = coord;
+    s->handle.index = index;
+    s->handle.generation = atomic_load_explicit(&generations[index], memory_order_relaxed);
+    s->discovery_time = discovery_time;
+    strncpy(s->info, info, sizeof(s->info) - 1);
+    return s->handle;
+}
+
+Survivor *survivor_get(SurvivorHandle h) {
+    if (survivor_handle_is_none(h) || h.index >= (uint32_t)table_capacity) return NULL;
+    if (atomic_load_explicit(&generations[h.index], memory_order_acquire) != h.generation) {
+        metric_counter_add(&stale_handles, 1);
         return NULL;
     }
-    // memset(s, 0, sizeof(Survivor)); // Gerekli değil, tüm alanlar atanacak.
-
-    s->coord = *coord;
-    if (discovery_time) { // Null check
-        memcpy(&s->discovery_time, discovery_time, sizeof(struct tm));
-    } else {
-        // discovery_time NULL ise, mevcut zamanı ata veya bir hata logla
-        time_t t_now;
-        time(&t_now);
-        localtime_r(&t_now, &s->discovery_time);
+    return &slots[h.index];
+}
+
+void survivor_free(SurvivorHandle h) {
+    if (!survivor_get(h)) return;
+    // Eski handle'lar bundan sonra geçersiz; 0 boş handle'a ayrıldığı için atlanır
+    uint32_t next = h.generation + 1;
+    if (next == 0) next = 1;
+    atomic_store_explicit(&generations[h.index], next, memory_order_release);
+    pthread_mutex_lock(&table_lock);
+    free_stack[free_top++] = h.index;
+    pthread_mutex_unlock(&table_lock);
+}
+
+int survivor_next_id() {
+    return atomic_load(&next_survivor_id);
+}
+
+void survivor_set_next_id(int id) {
+    atomic_store(&next_survivor_id, id);
+}
+
+/**
+ * @brief Creates one survivor at the given cell and adds it to the global and map cell lists.
+ * @return 0 on success, 1 if nothing was added.
+ */
+int survivor_spawn_at(Coord coord, const char *info) {
+    if (coord.x < 0 || coord.x >= map.height || coord.y < 0 || coord.y >= map.width ||
+        !map.cells[coord.x][coord.y].survivors) {
+        LOG_ERROR("Error: Map cell or cell survivor list not available for coord (%d,%d).\n", coord.x, coord.y);
+        return 1;
     }
-    memset(&s->helped_time, 0, sizeof(struct tm)); // Başlangıçta helped_time boş.
 
-    strncpy(s->info, info, sizeof(s->info) - 1);
-    s->info[sizeof(s->info)-1] = '\0'; // Null terminate
-    
-    s->status = WAITING; // Initial status
+    // Tablo survivors listesiyle aynı kapasitede: slot varsa listeye ekleme beklemez
+    SurvivorHandle handle = survivor_create(coord, info, (int64_t)sim_time());
+    if (survivor_handle_is_none(handle)) {
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 1, "Survivor table full (%d active), spawn skipped.\n", table_capacity);
+        return 1;
+    }
+    Survivor *new_survivor = survivor_get(handle);
+
+    // Listeler handle'ın kopyasını tutar
+    long long add_span = trace_begin();
+    Node *added = survivors->add(survivors, &handle);
+    trace_end("survivor_add", add_span);
+    if (added == NULL) {
+        LOG_ERROR("Failed to add new survivor to main 'survivors' list.\n");
+        survivor_free(handle);
+        return 1;
+    }
+
+    List *cell_list = map.cells[coord.x][coord.y].survivors;
+    if (cell_list->add(cell_list, &handle) == NULL) {
+        LOG_ERROR("Failed to add new survivor to map cell list at (%d,%d).\n", coord.x, coord.y);
+        if (survivors->removedata(survivors, &handle) != 0) {
+            LOG_ERROR("Survivor %s could not be removed from main list after map cell add failure.\n", new_survivor->info);
+        }
+        survivor_free(handle);
+        return 1;
+    }
+     
+    journal_log(JOURNAL_SURVIVOR_SPAWNED, NULL, new_survivor->id, coord.x, coord.y, WAITING, 0);
+    LOG_DEBUG("[Survivor Gen] New survivor: %s at (%d,%d). Total in main list: %d\n",
+              new_survivor->info, coord.x, coord.y, survivors->number_of_elements);
     
-    return s;
+    // Eski log: printf("New survivor at (%d,%d): %s\n", coord.x, coord.y, info);
+    // Bu, üsttekiyle aynı bilgiyi veriyor, kaldırılabilir.
+    return 0;
 }
 
 /**
- * @brief Thread function to periodically generate survivors.
+ * @brief Creates one survivor at a random cell.
+ * @return 0 on success, 1 if nothing was added.
  */
-void *survivor_generator(void *args) {
-    (void)args; // Unused parameter
-    time_t t;
-    struct tm current_discovery_time;
+static int spawn_survivor() {
+    // sim_rand thread başına tohumlu akıştır; sunucuda bu fonksiyon sadece tick thread'inde çağrılır
+    // Harita boyutlarını globals.h üzerinden map nesnesinden alıyoruz.
+    // map.height ve map.width'in initialize edildiğinden emin olmalıyız.
+    if (map.height <= 0 || map.width <= 0) {
+        fprintf(stderr, "Error: Map dimensions are not initialized in survivor_generator.\n");
+        return 1;
+    }
+    Coord coord = { sim_rand() % map.height, sim_rand() % map.width };
 
-    // srand(time(NULL)); // srand bir kere main'de çağrılmalı, her thread'de değil.
-                         // Eğer main'de çağrılmıyorsa, buraya eklenebilir ama bir kerelik olmalı.
-                         // En iyisi controller.c (main) içinde çağırmak.
+    char info[25];
+    snprintf(info, sizeof(info), "SURV-%04d", sim_rand() % 10000);
+    return survivor_spawn_at(coord, info);
+}
+
+/* Sunucu: TICK_PHASE_SPAWN. Survivor'lar 1-2 saniye aralıklarla, tick sınırında üretilir */
+void survivor_spawn_tick(unsigned long long tick) {
+    static unsigned long long next_spawn_tick = 0;
+    if (tick < next_spawn_tick) return;
+    spawn_survivor();
+    next_spawn_tick = tick + tick_from_ms((sim_rand() % 2 + 1) * 1000);
+}
 
+/**
+ * @brief Thread function to periodically generate survivors (standalone simulator).
+ */
+void *survivor_generator(void *args) {
+    (void)args; // Unused parameter
     printf("Survivor generator thread started.\n");
+    trace_set_thread_name("survivor generator");
 
     while (1) {
-        // Harita boyutlarını globals.h üzerinden map nesnesinden alıyoruz.
-        // map.height ve map.width'in initialize edildiğinden emin olmalıyız.
-        if (map.height <= 0 || map.width <= 0) {
-            fprintf(stderr, "Error: Map dimensions are not initialized in survivor_generator.\n");
-            sleep(5); // Hata durumunda bekleyip tekrar dene.
-            continue;
-        }
-        Coord coord = { rand() % map.height, rand() % map.width };
-        
-        char info[25];
-        snprintf(info, sizeof(info), "SURV-%04d", rand() % 10000);
-        
-        time(&t);
-        localtime_r(&t, &current_discovery_time);
-
-        // Survivor nesnesini oluştur (heap'te)
-        Survivor *new_survivor = create_survivor(&coord, info, &current_discovery_time);
-        if (!new_survivor) {
-            fprintf(stderr, "Survivor creation failed in generator. Skipping.\n");
-            continue; // malloc başarısız olursa atla
-        }
-
-        // Listeye Survivor* adresini ekle.
-        // list->add fonksiyonu, verilen adresteki veriyi (Survivor*) kendi içine kopyalar (memcpy ile).
-        // Bu yüzden &new_survivor (Survivor**) gönderiyoruz.
-        // `survivors` listesi global olduğu için doğrudan erişilebilir.
-        if (survivors->add(survivors, &new_survivor) == NULL) {
-            fprintf(stderr, "Failed to add new survivor to main 'survivors' list.\n");
-            free(new_survivor); // Eklenemeyen survivor'ı free etmeliyiz.
-            continue;
-        }
-        
-        // Harita hücresindeki listeye de aynı Survivor* pointer'ını ekle.
-        // map.cells[coord.x][coord.y].survivors listesinin var olduğundan emin olmalıyız.
-        if (coord.x < map.height && coord.y < map.width && map.cells[coord.x][coord.y].survivors) {
-            if (map.cells[coord.x][coord.y].survivors->add(
-                map.cells[coord.x][coord.y].survivors, &new_survivor) == NULL) {
-                fprintf(stderr, "Failed to add new survivor to map cell list at (%d,%d).\n", coord.x, coord.y);
-                // Hata durumu: Ana listeden de çıkarmak gerekebilir, bu durum tutarsızlığa yol açabilir.
-                // Şimdilik, ana listeden çıkarmayı deneyelim. Bu işlem atomik olmalı normalde.
-                // Basitlik adına, eğer map listesine eklenemezse, ana listeden çıkarıp free edelim.
-                // Bu, removedata'nın doğru implementasyonuna bağlıdır.
-                if (survivors->removedata(survivors, &new_survivor) == 0) {
-                     // Ana listeden başarıyla çıkarıldıysa logla.
-                    printf("Survivor %s removed from main list due to map cell add failure.\n", new_survivor->info);
-                } else {
-                    // Ana listeden çıkarılamadıysa (zaten yoksa veya hata olduysa) logla.
-                    fprintf(stderr, "Survivor %s could not be removed from main list after map cell add failure.\n", new_survivor->info);
-                }
-                free(new_survivor); // Her durumda free et.
-                continue;
-            }
-        } else {
-            fprintf(stderr, "Error: Map cell or cell survivor list not available for coord (%d,%d).\n", coord.x, coord.y);
-            // Ana listeden çıkar ve free et.
-            survivors->removedata(survivors, &new_survivor); // Sonucu kontrol etmesek de olur, zaten free edilecek.
-            free(new_survivor);
-            continue;
-        }
-         
-        printf("[Survivor Gen] New survivor: %s at (%d,%d). Total in main list: %d\n",
-               new_survivor->info, coord.x, coord.y, survivors->number_of_elements);
-        fflush(stdout); // Buffer'ı hemen yazdır.
-        
-        // Eski log: printf("New survivor at (%d,%d): %s\n", coord.x, coord.y, info);
-        // Bu, üsttekiyle aynı bilgiyi veriyor, kaldırılabilir.
-        
-        sleep(rand() % 2 + 1); // Rastgele 2-4 saniye bekle
+        spawn_survivor();
+        sim_sleep_ms((sim_rand() % 2 + 1) * 1000); // Rastgele 1-2 saniye bekle
     }
     return NULL;
 }
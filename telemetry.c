@@ -0,0 +1,146 @@
+/*
+ * telemetry.c
+ * Drone konum güncellemeleri için UDP alıcısı. Kaybolan veya sırası bozulan
+ * datagramlar önemsizdir: her drone için sadece en yeni sıra numarası uygulanır.
+ */
+#include "headers/telemetry.h"
+#include "headers/lock_prof.h"
+#include "headers/drone.h"
+#include "headers/drone_registry.h"
+#include "headers/drone_msg.h"
+#include "headers/metrics.h"
+#include "headers/simclock.h"
+#include "headers/log.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#define TELEMETRY_POLL_INTERVAL_MS 250
+
+static int udp_fd = -1;
+static int udp_port = 0;
+static pthread_t telemetry_thread;
+static volatile int telemetry_running = 0;
+
+/* İstatistikler sadece telemetry thread'i tarafından yazılır */
+static unsigned long applied_count = 0;
+static unsigned long stale_count = 0;
+static unsigned long rejected_count = 0;
+
+/**
+ * @brief Applies one datagram to its drone if the token matches and the sequence is newer.
+ * @return 1 applied, 0 stale, -1 rejected (unknown drone, bad token, malformed).
+ */
+static int apply_datagram(const DroneMessage *msg) {
+    if (msg->type != DRONE_MSG_STATUS_UPDATE || !msg->has_drone_id || !msg->has_seq || !msg->has_token) {
+        return -1;
+    }
+
+    Drone *d = drone_registry_acquire(msg->drone_id);
+    if (!d) return -1;
+
+    int result;
+    if (!d->telemetry_udp || d->telemetry_token != msg->token) {
+        result = -1;
+    } else if (msg->seq <= d->telemetry_seq) {
+        result = 0;
+    } else {
+        d->telemetry_seq = msg->seq;
+        drone_msg_apply_status(d, msg);
+        d->last_heartbeat_time = sim_time();
+        result = 1;
+    }
+    PROFILED_UNLOCK(&d->lock);
+    return result;
+}
+
+static void *telemetry_receiver(void *args) {
+    (void)args;
+    char datagram[TELEMETRY_MAX_DATAGRAM];
+    struct pollfd pfd = {udp_fd, POLLIN, 0};
+
+    while (telemetry_running) {
+        int ready = poll(&pfd, 1, TELEMETRY_POLL_INTERVAL_MS);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("telemetry poll");
+            break;
+        }
+        if (ready == 0) continue;
+
+        // Kuyrukta bekleyen tüm datagramları tek uyanışta işle
+        for (;;) {
+            ssize_t n = recv(udp_fd, datagram, sizeof(datagram), MSG_DONTWAIT);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    LOG_RATELIMITED(LOG_LEVEL_ERROR, 5, "telemetry recv: %s\n", strerror(errno));
+                break;
+            }
+            metric_counter_add(&server_metrics.bytes_in, (unsigned long long)n);
+            DroneMessage msg;
+            if (!drone_msg_parse_fast(datagram, (size_t)n, &msg)) {
+                rejected_count++;
+                continue;
+            }
+            if (msg.type == DRONE_MSG_STATUS_UPDATE) {
+                metric_counter_add(&server_metrics.messages_in[METRIC_MSG_STATUS_UPDATE], 1);
+            }
+            int rc = apply_datagram(&msg);
+            if (rc > 0) applied_count++;
+            else if (rc == 0) stale_count++;
+            else rejected_count++;
+        }
+    }
+    return NULL;
+}
+
+int telemetry_start(int port) {
+    udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (udp_fd < 0) {
+        perror("telemetry socket");
+        return 1;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(udp_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("telemetry bind");
+        close(udp_fd);
+        udp_fd = -1;
+        return 1;
+    }
+
+    telemetry_running = 1;
+    if (pthread_create(&telemetry_thread, NULL, telemetry_receiver, NULL) != 0) {
+        perror("Failed to create telemetry thread");
+        telemetry_running = 0;
+        close(udp_fd);
+        udp_fd = -1;
+        return 1;
+    }
+    udp_port = port;
+    printf("UDP telemetry listening on port %d.\n", port);
+    return 0;
+}
+
+void telemetry_shutdown() {
+    if (!telemetry_running) return;
+    telemetry_running = 0;
+    pthread_join(telemetry_thread, NULL);
+    close(udp_fd);
+    udp_fd = -1;
+    udp_port = 0;
+    printf("UDP telemetry: %lu applied, %lu stale, %lu rejected.\n", applied_count, stale_count, rejected_count);
+}
+
+int telemetry_port() {
+    return udp_port;
+}
@@ -0,0 +1,146 @@
+/*yerini yeni bağlantıya bırakmış drone listeden çıkana kadar
+delta'ların çift ID üretmediğini ve bağlı drone'u silmediğini kontrol eder*/
+
+#include "../headers/broadcast.h"
+#include "../headers/globals.h"
+#include "../headers/journal.h"
+#include <json.h>
+#include <stdio.h>
+#include <string.h>
+
+/* map.c'nin yanında globals.c bağlanmaz (ikisi de map'i tanımlar); listeler burada */
+List *survivors = NULL;
+List *helpedsurvivors = NULL;
+List *drones = NULL;
+
+/* survivor.c'nin bağımlılığı; bu testte journal yazılmaz */
+void journal_log(JournalEventType type, const char *drone_id, int survivor_id, int x, int y, int status, int arg) {
+    (void)type; (void)drone_id; (void)survivor_id; (void)x; (void)y; (void)status; (void)arg;
+}
+
+static int failures = 0;
+
+static void check(int ok, const char *name) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+    if (!ok) failures++;
+}
+
+static DroneSnapshot drone(const char *id, int x, int y, DroneSessionState session) {
+    DroneSnapshot d;
+    memset(&d, 0, sizeof(d));
+    snprintf(d.id_str, sizeof(d.id_str), "%s", id);
+    d.coord = (Coord){x, y};
+    d.target = d.coord;
+    d.status = IDLE;
+    d.session = session;
+    return d;
+}
+
+/* Dünya kopyasını capture'daki gibi sıralar ve viewport akışından bir frame üretir */
+static struct json_object *build(ViewportStream *vs, DroneSnapshot *list, int n, unsigned long version, int *rc) {
+    WorldSnapshot world;
+    memset(&world, 0, sizeof(world));
+    world.map_width = 30;
+    world.map_height = 20;
+    world.drones = list;
+    world.num_drones = n;
+    world_snapshot_sort(&world);
+    SharedBuffer *out = NULL;
+    *rc = viewport_stream_build(vs, &world, version, 0, 0, &out);
+    if (*rc != 1) return NULL;
+    struct json_object *msg = json_tokener_parse(out->data);
+    shared_buffer_release(out);
+    return msg;
+}
+
+static struct json_object *drone_field(struct json_object *msg, const char *field) {
+    struct json_object *drones_obj, *arr;
+    if (!msg || !json_object_object_get_ex(msg, "drones", &drones_obj) ||
+        !json_object_object_get_ex(drones_obj, field, &arr)) return NULL;
+    return arr;
+}
+
+static int upsert_at(struct json_object *msg, const char *id, int x, int y) {
+    struct json_object *arr = drone_field(msg, "upsert");
+    int found = 0;
+    for (size_t i = 0; arr && i < json_object_array_length(arr); i++) {
+        struct json_object *d = json_object_array_get_idx(arr, i), *v, *coord, *cx, *cy;
+        if (!json_object_object_get_ex(d, "id_str", &v) || strcmp(json_object_get_string(v), id) != 0) continue;
+        found++;
+        if (!json_object_object_get_ex(d, "coord", &coord) || !json_object_object_get_ex(coord, "x", &cx) ||
+            !json_object_object_get_ex(coord, "y", &cy) || json_object_get_int(cx) != x || json_object_get_int(cy) != y)
+            return 0;
+    }
+    return found == 1;
+}
+
+static int count(struct json_object *msg, const char *field) {
+    struct json_object *arr = drone_field(msg, field);
+    return arr ? (int)json_object_array_length(arr) : -1;
+}
+
+static void test_sort_collapses_duplicates() {
+    DroneSnapshot list[] = {
+        drone("D2", 1, 1, DRONE_SESSION_ATTACHED),
+        drone("D1", 3, 3, DRONE_SESSION_CLOSED),
+        drone("D1", 4, 4, DRONE_SESSION_ATTACHED),
+        drone("D3", 5, 5, DRONE_SESSION_DETACHED),
+        drone("D1", 6, 6, DRONE_SESSION_DETACHED),
+    };
+    WorldSnapshot world;
+    memset(&world, 0, sizeof(world));
+    world.drones = list;
+    world.num_drones = 5;
+    world_snapshot_sort(&world);
+    check(world.num_drones == 3 && strcmp(world.drones[0].id_str, "D1") == 0 && world.drones[0].coord.x == 4 &&
+          strcmp(world.drones[1].id_str, "D2") == 0 && strcmp(world.drones[2].id_str, "D3") == 0,
+          "sort keeps one attached drone per id");
+}
+
+/* Eski (ayrılmış veya takeover ile kapanmış) oturum yeni drone eklendikten sonra da listede kalır */
+static void test_replace(DroneSessionState old_session, const char *name) {
+    Viewport view = {0, 0, 19, 29, 1};
+    ViewportStream vs;
+    viewport_stream_init(&vs, &view);
+    char label[96];
+    int rc;
+
+    DroneSnapshot before[] = { drone("D1", 2, 2, DRONE_SESSION_ATTACHED), drone("D2", 9, 9, DRONE_SESSION_ATTACHED) };
+    struct json_object *msg = build(&vs, before, 2, 1, &rc);
+    json_object_put(msg);
+
+    // Eski oturum DETACHED/CLOSED olur, yeni drone aynı ID ile başka bir konumda eklenir
+    DroneSnapshot overlap[] = {
+        drone("D1", 2, 2, old_session), drone("D2", 9, 9, DRONE_SESSION_ATTACHED), drone("D1", 7, 8, DRONE_SESSION_ATTACHED),
+    };
+    msg = build(&vs, overlap, 3, 2, &rc);
+    snprintf(label, sizeof(label), "%s: delta carries the new drone once", name);
+    check(rc == 1 && upsert_at(msg, "D1", 7, 8) && count(msg, "upsert") == 1 && count(msg, "remove") == 0, label);
+    json_object_put(msg);
+
+    // Aynı durum tekrar gelince değişen bir şey yok
+    DroneSnapshot again[] = {
+        drone("D1", 7, 8, DRONE_SESSION_ATTACHED), drone("D1", 2, 2, old_session), drone("D2", 9, 9, DRONE_SESSION_ATTACHED),
+    };
+    msg = build(&vs, again, 3, 3, &rc);
+    snprintf(label, sizeof(label), "%s: stable while both are listed", name);
+    check(rc == 0, label);
+    json_object_put(msg);
+
+    // Eski drone listeden çıkınca bağlı drone silinmemeli
+    DroneSnapshot after[] = { drone("D2", 9, 9, DRONE_SESSION_ATTACHED), drone("D1", 7, 8, DRONE_SESSION_ATTACHED) };
+    msg = build(&vs, after, 2, 4, &rc);
+    snprintf(label, sizeof(label), "%s: old drone leaving removes nothing", name);
+    check(rc == 0, label);
+    json_object_put(msg);
+
+    viewport_stream_free(&vs);
+}
+
+int main() {
+    test_sort_collapses_duplicates();
+    test_replace(DRONE_SESSION_DETACHED, "replaced detached session");
+    test_replace(DRONE_SESSION_CLOSED, "takeover");
+    printf("%s\n", failures ? "FAILED" : "all passed");
+    return failures != 0;
+}
@@ -0,0 +1,322 @@
+/*checkpoint dosyasının yazılıp geri okunduğunu, sürüm 1 dosyaların hâlâ açıldığını
+ve bozuk, yarım kalmış veya uyumsuz dosyaların reddedildiğini kontrol eder*/
+
+#include "../headers/checkpoint.h"
+#include "../headers/archive.h"
+#include "../headers/globals.h"
+#include "../headers/journal.h"
+#include "../headers/metrics.h"
+#include "../headers/simclock.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define TEST_MAP_HEIGHT 20
+#define TEST_MAP_WIDTH 30
+
+/* map.c'nin yanında globals.c bağlanmaz (ikisi de map'i tanımlar); listeler burada */
+List *survivors = NULL;
+List *helpedsurvivors = NULL;
+List *drones = NULL;
+
+/* survivor.c'nin bağımlılığı; bu testte journal yazılmaz */
+void journal_log(JournalEventType type, const char *drone_id, int survivor_id, int x, int y, int status, int arg) {
+    (void)type; (void)drone_id; (void)survivor_id; (void)x; (void)y; (void)status; (void)arg;
+}
+
+/* Arşiv sadece kurtarılan sayısını taşır */
+static long long helped_total = 0;
+long long archive_helped_total() { return helped_total; }
+void archive_set_helped_total(long long total) { helped_total = total; }
+
+static int failures = 0;
+static char path[64];
+
+static void check(int ok, const char *name) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+    if (!ok) failures++;
+}
+
+/* restore_drone geri çağrısının gördükleri */
+static CheckpointDrone seen_drones[4];
+static int seen_targets[4];
+static int seen_count = 0;
+static int accept_drones = 1;
+
+static int record_drone(const CheckpointDrone *rec, Survivor *target) {
+    if (seen_count < 4) {
+        seen_drones[seen_count] = *rec;
+        seen_targets[seen_count] = target ? target->id : -1;
+    }
+    seen_count++;
+    return accept_drones ? 0 : 1;
+}
+
+static Survivor *find_survivor(int id) {
+    for (Node *node = survivors->head; node != NULL; node = node->next) {
+        Survivor *s = survivor_get(*(SurvivorHandle*)node->data);
+        if (s && s->id == id) return s;
+    }
+    return NULL;
+}
+
+/* Dünyayı boşaltır: survivor'lar listelerden çıkarılıp slotları bırakılır */
+static void clear_world() {
+    SurvivorHandle h;
+    while (survivors->number_of_elements > 0) {
+        survivors->pop(survivors, &h);
+        Survivor *s = survivor_get(h);
+        if (s) {
+            List *cell = map.cells[s->coord.x][s->coord.y].survivors;
+            cell->removedata(cell, &h);
+            survivor_free(h);
+        }
+    }
+    Drone *d;
+    while (drones->number_of_elements > 0) drones->pop(drones, &d);
+    survivor_set_next_id(1);
+    helped_total = 0;
+    seen_count = 0;
+}
+
+static int restore() {
+    seen_count = 0;
+    return checkpoint_restore(record_drone);
+}
+
+static int read_file(char **data, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return 1;
+    fseek(f, 0, SEEK_END);
+    *len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    *data = malloc(*len);
+    int failed = fread(*data, 1, *len, f) != *len;
+    fclose(f);
+    return failed;
+}
+
+static void write_file(const void *data, size_t len) {
+    FILE *f = fopen(path, "wb");
+    fwrite(data, 1, len, f);
+    fclose(f);
+}
+
+static void test_round_trip() {
+    survivor_spawn_at((Coord){1, 2}, "SURV-0001");
+    survivor_spawn_at((Coord){5, 7}, "SURV-0002");
+    survivor_spawn_at((Coord){19, 29}, "SURV-0003");
+    Survivor *assigned = find_survivor(2);
+    assigned->status = ASSIGNED;
+    helped_total = 17;
+
+    Drone drone;
+    memset(&drone, 0, sizeof(drone));
+    pthread_mutex_init(&drone.lock, NULL);
+    drone.id = 4;
+    strcpy(drone.id_str, "D4");
+    drone.status = ON_MISSION;
+    drone.coord = (Coord){3, 4};
+    drone.target = assigned->coord;
+    drone.current_survivor_target = assigned->handle;
+    drone.session = DRONE_SESSION_ATTACHED;
+    drone.session_token = 4442497307822589LL;
+    drone.telemetry_udp = 1;
+    drone.telemetry_token = 123456789LL;
+    strcpy(drone.mission_id, "M4-12S");
+    Drone *drone_ptr = &drone;
+    drones->add(drones, &drone_ptr);
+
+    // Kapanmış oturum kaydedilmez
+    Drone closed;
+    memset(&closed, 0, sizeof(closed));
+    pthread_mutex_init(&closed.lock, NULL);
+    strcpy(closed.id_str, "D9");
+    closed.session = DRONE_SESSION_CLOSED;
+    Drone *closed_ptr = &closed;
+    drones->add(drones, &closed_ptr);
+
+    int next_id = survivor_next_id();
+    CheckpointStats stats;
+    check(checkpoint_write(&stats) == 0, "write succeeds");
+    check(stats.survivors == 3 && stats.drones == 1 && stats.helped == 17 &&
+          stats.bytes == (long long)(sizeof(CheckpointHeader) + 3 * sizeof(CheckpointSurvivor) + sizeof(CheckpointDrone)),
+          "write stats match the world");
+    char tmp_path[sizeof(path) + sizeof(CHECKPOINT_TMP_SUFFIX)];
+    snprintf(tmp_path, sizeof(tmp_path), "%s%s", path, CHECKPOINT_TMP_SUFFIX);
+    check(access(path, F_OK) == 0 && access(tmp_path, F_OK) != 0, "temporary file renamed into place");
+
+    clear_world();
+    check(restore() == 0, "restore succeeds");
+    Survivor *s1 = find_survivor(1), *s2 = find_survivor(2), *s3 = find_survivor(3);
+    check(survivors->number_of_elements == 3 && s1 && s2 && s3, "survivors restored");
+    check(s1 && s1->coord.x == 1 && s1->coord.y == 2 && s1->status == WAITING && strcmp(s1->info, "SURV-0001") == 0,
+          "survivor fields preserved");
+    check(s3 && map.cells[19][29].survivors->number_of_elements == 1, "survivor put back in its map cell");
+    check(s2 && s2->status == ASSIGNED, "assigned survivor stays with its drone");
+    check(helped_total == 17 && survivor_next_id() == next_id, "helped total and next id restored");
+    check(seen_count == 1 && strcmp(seen_drones[0].id_str, "D4") == 0 && seen_drones[0].status == ON_MISSION &&
+          seen_drones[0].x == 3 && seen_drones[0].y == 4 && seen_drones[0].session_token == drone.session_token &&
+          seen_drones[0].telemetry_token == drone.telemetry_token && seen_drones[0].telemetry_udp == 1 &&
+          strcmp(seen_drones[0].mission_id, "M4-12S") == 0 && seen_targets[0] == 2,
+          "drone session restored with its mission");
+
+    // Oturumu geri kurulamayan drone'un survivor'ı tekrar atanabilir olur
+    clear_world();
+    accept_drones = 0;
+    check(restore() == 0 && find_survivor(2) && find_survivor(2)->status == WAITING,
+          "survivor of a dropped session goes back to waiting");
+    accept_drones = 1;
+    clear_world();
+    pthread_mutex_destroy(&drone.lock);
+    pthread_mutex_destroy(&closed.lock);
+}
+
+/* Sürüm 1: bekleyenlerden sonra helped_total kadar kurtarılmış kaydı vardır */
+static void test_version1() {
+    struct {
+        CheckpointHeader hdr;
+        CheckpointSurvivor waiting;
+        CheckpointSurvivor helped[2];
+    } file;
+    memset(&file, 0, sizeof(file));
+    memcpy(file.hdr.magic, CHECKPOINT_MAGIC, sizeof(file.hdr.magic));
+    file.hdr.version = 1;
+    file.hdr.header_size = sizeof(CheckpointHeader);
+    file.hdr.survivor_record_size = sizeof(CheckpointSurvivor);
+    file.hdr.drone_record_size = sizeof(CheckpointDrone);
+    file.hdr.map_height = TEST_MAP_HEIGHT;
+    file.hdr.map_width = TEST_MAP_WIDTH;
+    file.hdr.next_survivor_id = 10;
+    file.hdr.survivor_count = 1;
+    file.hdr.helped_total = 2;
+    file.waiting = (CheckpointSurvivor){ .id = 7, .status = WAITING, .x = 4, .y = 5, .discovery_time = 1700000000 };
+    strcpy(file.waiting.info, "SURV-0007");
+    for (int i = 0; i < 2; i++) {
+        file.helped[i] = (CheckpointSurvivor){ .id = 40 + i, .status = HELPED, .x = 1, .y = 1, .helped_time = 1700000100 };
+    }
+    file.hdr.payload_crc32 = (uint32_t)crc32(crc32(0L, Z_NULL, 0), (const Bytef*)&file.waiting,
+                                             sizeof(file) - sizeof(file.hdr));
+    write_file(&file, sizeof(file));
+
+    check(restore() == 0, "version 1 file restores");
+    Survivor *s = find_survivor(7);
+    check(survivors->number_of_elements == 1 && s && s->discovery_time == 1700000000 &&
+          strcmp(s->info, "SURV-0007") == 0, "version 1 waiting survivor restored");
+    check(helped_total == 2 && survivor_next_id() == 42, "version 1 helped records skipped but counted");
+    clear_world();
+}
+
+/* Dosya bozulmuşsa restore 1 döner ve dünyaya hiçbir şey eklenmez */
+static void expect_rejected(const char *name, const void *data, size_t len) {
+    write_file(data, len);
+    int rc = restore();
+    check(rc == 1 && survivors->number_of_elements == 0 && seen_count == 0, name);
+    clear_world();
+}
+
+static void test_rejects() {
+    survivor_spawn_at((Coord){2, 3}, "SURV-0001");
+    survivor_spawn_at((Coord){4, 5}, "SURV-0002");
+    check(checkpoint_write(NULL) == 0, "reference checkpoint written");
+    clear_world();
+    char *good;
+    size_t len;
+    if (read_file(&good, &len) != 0) {
+        check(0, "reference checkpoint readable");
+        return;
+    }
+    char *bad = malloc(len);
+
+    memcpy(bad, good, len);
+    bad[len - 5] ^= 0x40;
+    expect_rejected("payload bit flip fails the crc", bad, len);
+
+    memcpy(bad, good, len);
+    ((CheckpointHeader*)bad)->payload_crc32 ^= 1;
+    expect_rejected("stored crc mismatch", bad, len);
+
+    expect_rejected("torn write inside a record", good, len - 10);
+    expect_rejected("torn write after the header", good, sizeof(CheckpointHeader));
+    expect_rejected("torn write inside the header", good, sizeof(CheckpointHeader) / 2);
+    expect_rejected("empty file", good, 0);
+
+    memcpy(bad, good, len);
+    bad[0] = 'X';
+    expect_rejected("wrong magic", bad, len);
+
+    memcpy(bad, good, len);
+    ((CheckpointHeader*)bad)->version = CHECKPOINT_VERSION + 1;
+    expect_rejected("unknown version", bad, len);
+
+    memcpy(bad, good, len);
+    ((CheckpointHeader*)bad)->survivor_count = 1000000;
+    expect_rejected("record count beyond the file", bad, len);
+
+    // Sürüm 1'de survivor_count + helped_total uint32'de sarıp 0 olursa boyut sadece drone kaydını sayar
+    struct {
+        CheckpointHeader hdr;
+        CheckpointDrone drone;
+    } wrapped;
+    memset(&wrapped, 0, sizeof(wrapped));
+    memcpy(&wrapped.hdr, good, sizeof(wrapped.hdr));
+    wrapped.hdr.version = 1;
+    wrapped.hdr.survivor_count = 0xFFFFFFFFu;
+    wrapped.hdr.helped_total = 1;
+    wrapped.hdr.drone_count = 1;
+    strcpy(wrapped.drone.id_str, "D1");
+    wrapped.hdr.payload_crc32 = (uint32_t)crc32(crc32(0L, Z_NULL, 0), (const Bytef*)&wrapped.drone, sizeof(wrapped.drone));
+    expect_rejected("record counts that wrap when added", &wrapped, sizeof(wrapped));
+
+    // Küçük survivor_count'la tablo ayrılabilir; sarma kaçarsa helped döngüsü mmap'in dışını okur
+    struct {
+        CheckpointHeader hdr;
+        CheckpointSurvivor survivor;
+    } wrapped_helped;
+    memset(&wrapped_helped, 0, sizeof(wrapped_helped));
+    memcpy(&wrapped_helped.hdr, good, sizeof(wrapped_helped.hdr));
+    wrapped_helped.hdr.version = 1;
+    wrapped_helped.hdr.survivor_count = 2;
+    wrapped_helped.hdr.helped_total = 0xFFFFFFFFu;
+    wrapped_helped.hdr.drone_count = 0;
+    wrapped_helped.survivor = (CheckpointSurvivor){ .id = 1, .status = WAITING, .x = 1, .y = 1 };
+    wrapped_helped.hdr.payload_crc32 = (uint32_t)crc32(crc32(0L, Z_NULL, 0), (const Bytef*)&wrapped_helped.survivor,
+                                                       sizeof(wrapped_helped.survivor));
+    expect_rejected("helped count that wraps the survivor count", &wrapped_helped, sizeof(wrapped_helped));
+
+    memcpy(bad, good, len);
+    ((CheckpointHeader*)bad)->map_width = TEST_MAP_WIDTH + 1;
+    expect_rejected("different map size", bad, len);
+
+    // Bozuk dosya yerine geçmiş yazımın sağlam dosyası geri yüklenebilir
+    write_file(good, len);
+    check(restore() == 0 && survivors->number_of_elements == 2, "intact copy still restores");
+    clear_world();
+
+    unlink(path);
+    check(restore() == 0 && survivors->number_of_elements == 0, "missing file starts an empty world");
+    free(bad);
+    free(good);
+}
+
+int main() {
+    simclock_init(0, 0, 1, 0);
+    metrics_init();
+    survivors = create_list(sizeof(SurvivorHandle), SURVIVOR_MAX_ACTIVE);
+    drones = create_list(sizeof(Drone*), 8);
+    init_map(TEST_MAP_HEIGHT, TEST_MAP_WIDTH);
+    survivor_table_init(SURVIVOR_MAX_ACTIVE);
+    snprintf(path, sizeof(path), "/tmp/checkpointtest-%d.bin", (int)getpid());
+    checkpoint_init(path, 0);
+
+    test_round_trip();
+    test_version1();
+    test_rejects();
+
+    unlink(path);
+    printf("%s\n", failures ? "FAILED" : "all passed");
+    return failures != 0;
+}
@@ -0,0 +1,99 @@
+/*drone_msg hızlı ayrıştırıcısının json-c yolu ile
+aynı sonucu verdiğini ve beklenmeyen girdide geri düştüğünü kontrol eder*/
+
+#include "../headers/drone_msg.h"
+#include "../headers/journal.h"
+#include <json.h>
+#include <stdio.h>
+#include <string.h>
+
+/* drone_msg_apply_status'un bağımlılığı; bu testte çağrılmaz */
+void journal_log(JournalEventType type, const char *drone_id, int survivor_id, int x, int y, int status, int arg) {
+    (void)type; (void)drone_id; (void)survivor_id; (void)x; (void)y; (void)status; (void)arg;
+}
+
+static int failures = 0;
+
+static void print_msg(const char *label, const DroneMessage *m) {
+    printf("  %s: type %d id %s(%d) loc (%d,%d)(%d,%d) status %d(%d) battery %d(%d) seq %lld(%d) token %lld(%d)\n",
+           label, m->type, m->drone_id, m->has_drone_id, m->location.x, m->location.y, m->has_location_x,
+           m->has_location_y, m->status, m->has_status, m->battery, m->has_battery, m->seq, m->has_seq,
+           m->token, m->has_token);
+}
+
+/* Hızlı yol kabul etmeli ve sonucu json-c yolununkiyle aynı olmalı */
+static void expect_fast(const char *json) {
+    DroneMessage fast, slow;
+    int ok = drone_msg_parse_fast(json, strlen(json), &fast);
+    struct json_object *parsed = json_tokener_parse(json);
+    if (!parsed) {
+        printf("FAIL json-c rejected %s\n", json);
+        failures++;
+        return;
+    }
+    drone_msg_from_json(parsed, &slow);
+    json_object_put(parsed);
+    if (!ok || memcmp(&fast, &slow, sizeof(fast)) != 0) {
+        printf("FAIL fast %s: %s\n", ok ? "differs" : "rejected", json);
+        print_msg("fast", &fast);
+        print_msg("slow", &slow);
+        failures++;
+    } else {
+        printf("ok   fast   %s\n", json);
+    }
+}
+
+/* Hızlı yol 0 dönmeli; çağıran json-c'ye düşer */
+static void expect_fallback(const char *json) {
+    DroneMessage fast;
+    if (drone_msg_parse_fast(json, strlen(json), &fast) != 0) {
+        printf("FAIL fast accepted %s\n", json);
+        failures++;
+    } else {
+        printf("ok   reject %s\n", json);
+    }
+}
+
+int main() {
+    expect_fast("{\"type\":\"STATUS_UPDATE\",\"drone_id\":\"D1\",\"location\":{\"x\":5,\"y\":7},\"status\":\"idle\",\"battery\":88}");
+    expect_fast("{ \"type\" : \"STATUS_UPDATE\" , \"drone_id\" : \"D12\", \"location\" : { \"y\" : -3 , \"x\" : 0 } , \"status\" : \"busy\" }");
+    expect_fast("{\"type\":\"STATUS_UPDATE\",\"drone_id\":\"D2\",\"status\":\"on_mission\",\"seq\":123456789012,\"token\":-42}");
+    expect_fast("{\"type\":\"STATUS_UPDATE\",\"drone_id\":\"D3\",\"status\":\"charging\",\"location\":{}}");
+    expect_fast("{\"type\":\"HEARTBEAT_RESPONSE\",\"drone_id\":\"D4\",\"timestamp\":1735689600}");
+    expect_fast("{\"drone_id\":\"D5\",\"extra\":\"a\\\"b\",\"flag\":true,\"none\":null,\"f\":1.5e3,\"type\":\"HEARTBEAT_RESPONSE\"}");
+    expect_fast("{\"type\":\"STATUS_UPDATE\",\"drone_id\":\"D6\",\"location\":{\"x\":2147483647,\"y\":-2147483648,\"z\":9}}\r\n");
+
+    expect_fallback("");
+    expect_fallback("{}");
+    expect_fallback("{\"type\":\"MISSION_COMPLETE\",\"drone_id\":\"D1\",\"success\":true}");
+    expect_fallback("{\"type\":\"STATUS_UPDATE\",\"drone_id\":\"D\\u0031\"}");
+    expect_fallback("{\"type\":\"STATUS_UPDATE\",\"location\":{\"x\":1.5,\"y\":2}}");
+    expect_fallback("{\"type\":\"STATUS_UPDATE\",\"location\":{\"x\":2147483648,\"y\":2}}");
+    expect_fallback("{\"type\":\"STATUS_UPDATE\",\"seq\":1234567890123456789}");
+    expect_fallback("{\"type\":\"STATUS_UPDATE\",\"drone_id\":\"D1234567890123456\"}");
+    expect_fallback("{\"type\":\"STATUS_UPDATE\",\"caps\":[1,2]}");
+    expect_fallback("{\"type\":\"STATUS_UPDATE\",\"drone_id\":\"D1\"");
+    expect_fallback("{\"type\":\"STATUS_UPDATE\"} trailing");
+    expect_fallback("{\"type\":null,\"drone_id\":\"D1\"}");
+    expect_fallback("{\"drone_id\":\"D1\",\"status\":\"idle\"}");
+
+    // Yavaş yol: escape'li ID çözülür, string olmayan tip OTHER kalır
+    const char *slow_cases[] = {"{\"type\":\"STATUS_UPDATE\",\"drone_id\":\"D\\u0031\"}", "{\"type\":null}", "{\"type\":7}"};
+    const DroneMsgType slow_types[] = {DRONE_MSG_STATUS_UPDATE, DRONE_MSG_OTHER, DRONE_MSG_OTHER};
+    for (int i = 0; i < 3; i++) {
+        DroneMessage slow;
+        struct json_object *parsed = json_tokener_parse(slow_cases[i]);
+        drone_msg_from_json(parsed, &slow);
+        json_object_put(parsed);
+        if (slow.type != slow_types[i] || (i == 0 && strcmp(slow.drone_id, "D1") != 0)) {
+            printf("FAIL slow   %s\n", slow_cases[i]);
+            print_msg("slow", &slow);
+            failures++;
+        } else {
+            printf("ok   slow   %s\n", slow_cases[i]);
+        }
+    }
+
+    printf("%s\n", failures ? "FAILED" : "all passed");
+    return failures != 0;
+}
@@ -0,0 +1,147 @@
+/*json_writer çıktısının json-c PLAIN çıktısıyla
+byte byte aynı olduğunu kontrol eder*/
+
+#include "../headers/json_writer.h"
+#include <json.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+static void expect_same(const char *name, JsonWriter *w, struct json_object *ref) {
+    const char *expected = json_object_to_json_string_ext(ref, JSON_C_TO_STRING_PLAIN);
+    if (w->error || w->len != strlen(expected) || memcmp(w->buf, expected, w->len) != 0) {
+        printf("FAIL %s\n  json-c: %s\n  writer: %.*s%s\n", name, expected, (int)w->len, w->buf,
+               w->error ? " (error)" : "");
+        failures++;
+    } else {
+        printf("ok   %s\n", name);
+    }
+}
+
+static void test_escapes() {
+    const char *samples[] = {
+        "plain", "", "quote\"back\\slash", "a/b/c", "\b\f\n\r\t", "\x01\x1f\x7f",
+        "SURV-0042", "t\xc3\xbcrk\xc3\xa7" "e",   // UTF-8 olduğu gibi geçer
+    };
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        JsonWriter w;
+        json_writer_init(&w, 0);
+        jw_object_begin(&w);
+        jw_kv_string(&w, samples[i], samples[i]);
+        jw_object_end(&w);
+
+        struct json_object *ref = json_object_new_object();
+        json_object_object_add(ref, samples[i], json_object_new_string(samples[i]));
+        char name[32];
+        snprintf(name, sizeof(name), "escape #%zu", i);
+        expect_same(name, &w, ref);
+        json_object_put(ref);
+        json_writer_free(&w);
+    }
+}
+
+static void test_int64_edges() {
+    long long values[] = { 0, 1, -1, 9, 10, -10, INT_MAX, INT_MIN, 1LL << 53, LLONG_MAX, LLONG_MIN, LLONG_MIN + 1 };
+    JsonWriter w;
+    json_writer_init(&w, 16);   // Büyüme yolu da denensin
+    jw_array_begin(&w);
+    struct json_object *ref = json_object_new_array();
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        jw_int(&w, values[i]);
+        json_object_array_add(ref, json_object_new_int64(values[i]));
+    }
+    jw_array_end(&w);
+    expect_same("int64 edges", &w, ref);
+    json_object_put(ref);
+    json_writer_free(&w);
+}
+
+/* Sunucunun gönderdiği mesaj şekline benzer iç içe yapı */
+static void test_nested() {
+    JsonWriter w;
+    json_writer_init(&w, 0);
+    jw_object_begin(&w);
+    jw_kv_string(&w, "type", "SIMULATION_STATE_DELTA");
+    jw_kv_int(&w, "version", 18);
+    jw_key(&w, "drones");
+    jw_object_begin(&w);
+    jw_key(&w, "upsert");
+    jw_array_begin(&w);
+    jw_object_begin(&w);
+    jw_kv_string(&w, "id_str", "D2");
+    jw_key(&w, "coord");
+    jw_object_begin(&w);
+    jw_kv_int(&w, "x", 19);
+    jw_kv_int(&w, "y", -2);
+    jw_object_end(&w);
+    jw_key(&w, "ok");
+    jw_bool(&w, 1);
+    jw_object_end(&w);
+    jw_array_end(&w);
+    jw_key(&w, "remove");
+    jw_array_begin(&w);
+    jw_array_end(&w);
+    jw_object_end(&w);
+    jw_key(&w, "empty");
+    jw_object_begin(&w);
+    jw_object_end(&w);
+    jw_key(&w, "flag");
+    jw_bool(&w, 0);
+    jw_object_end(&w);
+
+    struct json_object *ref = json_object_new_object();
+    json_object_object_add(ref, "type", json_object_new_string("SIMULATION_STATE_DELTA"));
+    json_object_object_add(ref, "version", json_object_new_int(18));
+    struct json_object *drones = json_object_new_object();
+    struct json_object *upsert = json_object_new_array();
+    struct json_object *d = json_object_new_object();
+    json_object_object_add(d, "id_str", json_object_new_string("D2"));
+    struct json_object *coord = json_object_new_object();
+    json_object_object_add(coord, "x", json_object_new_int(19));
+    json_object_object_add(coord, "y", json_object_new_int(-2));
+    json_object_object_add(d, "coord", coord);
+    json_object_object_add(d, "ok", json_object_new_boolean(1));
+    json_object_array_add(upsert, d);
+    json_object_object_add(drones, "upsert", upsert);
+    json_object_object_add(drones, "remove", json_object_new_array());
+    json_object_object_add(ref, "drones", drones);
+    json_object_object_add(ref, "empty", json_object_new_object());
+    json_object_object_add(ref, "flag", json_object_new_boolean(0));
+    expect_same("nested message", &w, ref);
+    json_object_put(ref);
+    json_writer_free(&w);
+}
+
+static void test_fixed_overflow() {
+    char storage[8];
+    JsonWriter w;
+    json_writer_init_fixed(&w, storage, sizeof(storage));
+    jw_object_begin(&w);
+    jw_kv_string(&w, "type", "HEARTBEAT");
+    jw_object_end(&w);
+    if (!w.error || w.len > sizeof(storage)) {
+        printf("FAIL fixed buffer overflow not reported (len %zu)\n", w.len);
+        failures++;
+    } else {
+        printf("ok   fixed buffer overflow\n");
+    }
+    json_writer_reset(&w);
+    jw_int(&w, -42);
+    if (w.error || w.len != 3 || memcmp(w.buf, "-42", 3) != 0) {
+        printf("FAIL reset after overflow\n");
+        failures++;
+    } else {
+        printf("ok   reset after overflow\n");
+    }
+}
+
+int main() {
+    test_escapes();
+    test_int64_edges();
+    test_nested();
+    test_fixed_overflow();
+    printf("%s\n", failures ? "FAILED" : "all passed");
+    return failures != 0;
+}
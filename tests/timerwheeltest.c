@@ -0,0 +1,201 @@
+/*timer_wheel'in sanal saatle doğru tick'te çalıştığını,
+seviyeler arası cascade'i ve iptal yollarını kontrol eder*/
+
+#include "../headers/timer_wheel.h"
+#include "../headers/simclock.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MANY_TIMERS 500
+
+static int failures = 0;
+
+static void check(int ok, const char *name) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+    if (!ok) failures++;
+}
+
+/* Sanal saati ms kadar, her seferinde bir tekerlek tick'i ilerletir */
+static void advance_ms(long long ms) {
+    for (long long done = 0; done < ms; done += TIMER_WHEEL_TICK_MS) {
+        simclock_advance_ns((long long)TIMER_WHEEL_TICK_MS * 1000000LL);
+        timer_wheel_tick(0);
+    }
+}
+
+typedef struct {
+    TimerEntry timer;
+    int fired;
+    long long fired_at_ms;
+    long long due_ms;
+    int repeat;            /* Kalan yeniden kurma sayısı */
+} Probe;
+
+static void probe_callback(TimerEntry *timer, void *arg) {
+    Probe *p = arg;
+    p->fired++;
+    p->fired_at_ms = sim_monotonic_ms();
+    if (p->repeat > 0) {
+        p->repeat--;
+        timer_schedule(timer, 200);
+    }
+}
+
+static void probe_init(Probe *p) {
+    memset(p, 0, sizeof(*p));
+    timer_entry_init(&p->timer, probe_callback, p);
+}
+
+static void test_fires_on_time() {
+    Probe p;
+    probe_init(&p);
+    long long start = sim_monotonic_ms();
+    timer_schedule(&p.timer, 250);   // Tick'e yukarı yuvarlanır: 300 ms
+    advance_ms(200);
+    check(p.fired == 0 && timer_pending(&p.timer), "not fired before deadline");
+    advance_ms(100);
+    check(p.fired == 1 && p.fired_at_ms - start == 300 && !timer_pending(&p.timer), "fired at rounded deadline");
+    advance_ms(1000);
+    check(p.fired == 1, "fired only once");
+
+    probe_init(&p);
+    start = sim_monotonic_ms();
+    timer_schedule(&p.timer, 0);     // En az bir tick sonra
+    advance_ms(100);
+    check(p.fired == 1 && p.fired_at_ms - start == 100, "zero delay fires on next tick");
+}
+
+static void test_cascade() {
+    // 64 tick üstü seviye 1'e, 64*64 tick üstü seviye 2'ye düşer; aşağı inerken tick kaymamalı
+    long long delays[] = { 6400, 6500, 30000, 409600, 420000, 500100 };
+    int n = sizeof(delays) / sizeof(delays[0]);
+    Probe probes[6];
+    long long start = sim_monotonic_ms();
+    for (int i = 0; i < n; i++) {
+        probe_init(&probes[i]);
+        probes[i].due_ms = delays[i];
+        timer_schedule(&probes[i].timer, (int)delays[i]);
+    }
+    advance_ms(delays[n - 1] + 1000);
+    int ok = 1;
+    for (int i = 0; i < n; i++) {
+        if (probes[i].fired != 1 || probes[i].fired_at_ms - start != probes[i].due_ms) {
+            printf("  timer %lld ms fired %d time(s) at +%lld ms\n", delays[i], probes[i].fired,
+                   probes[i].fired_at_ms - start);
+            ok = 0;
+        }
+    }
+    check(ok, "cascade keeps exact deadlines across levels");
+}
+
+static void test_cancel_and_reschedule() {
+    Probe a, b, c;
+    probe_init(&a);
+    probe_init(&b);
+    probe_init(&c);
+    long long start = sim_monotonic_ms();
+    timer_schedule(&a.timer, 500);
+    timer_schedule(&b.timer, 20000);       // Seviye 1
+    timer_schedule(&c.timer, 5000);
+    timer_cancel(&a.timer);
+    advance_ms(10000);                     // b bu sırada cascade ile aşağı inmiş olabilir
+    timer_cancel(&b.timer);
+    timer_schedule(&c.timer, 300);         // Çalışmış zamanlayıcı yeniden kurulabilir
+    advance_ms(30000);
+    check(a.fired == 0 && b.fired == 0, "cancelled timers never fire");
+    check(!timer_pending(&a.timer) && !timer_pending(&b.timer), "cancelled timers are not pending");
+    check(c.fired == 2 && c.fired_at_ms - start == 10300, "rescheduled timer fires again");
+
+    Probe d;
+    probe_init(&d);
+    start = sim_monotonic_ms();
+    timer_schedule(&d.timer, 5000);
+    timer_schedule(&d.timer, 300);         // Kuruluyken yeniden kurmak eskisinin yerini alır
+    advance_ms(10000);
+    check(d.fired == 1 && d.fired_at_ms - start == 300, "reschedule replaces pending deadline");
+
+    Probe e;
+    probe_init(&e);
+    e.repeat = 3;
+    timer_schedule(&e.timer, 200);
+    advance_ms(2000);
+    check(e.fired == 4, "callback can reschedule itself");
+}
+
+static void test_many_random() {
+    static Probe probes[MANY_TIMERS];
+    srand(7);
+    long long start = sim_monotonic_ms();
+    long long last = 0;
+    for (int i = 0; i < MANY_TIMERS; i++) {
+        probe_init(&probes[i]);
+        long long delay = (rand() % 5000 + 1) * (long long)TIMER_WHEEL_TICK_MS;
+        probes[i].due_ms = delay;
+        if (delay > last) last = delay;
+        timer_schedule(&probes[i].timer, (int)delay);
+    }
+    // Yarısı yolda iptal edilir
+    advance_ms(last / 2);
+    for (int i = 0; i < MANY_TIMERS; i += 2) timer_cancel(&probes[i].timer);
+    long long cut = sim_monotonic_ms() - start;
+    advance_ms(last - cut + 1000);
+    int ok = 1;
+    for (int i = 0; i < MANY_TIMERS; i++) {
+        int expect_fire = i % 2 == 1 || probes[i].due_ms <= cut;
+        if (probes[i].fired != expect_fire || (expect_fire && probes[i].fired_at_ms - start != probes[i].due_ms)) {
+            if (ok) printf("  timer %d due +%lld fired %d at +%lld\n", i, probes[i].due_ms, probes[i].fired,
+                           probes[i].fired_at_ms - start);
+            ok = 0;
+        }
+    }
+    check(ok, "random deadlines with cancellation");
+}
+
+/* timer_cancel_sync, çalışmakta olan callback bitmeden dönmemeli */
+static volatile int slow_started = 0;
+static volatile int slow_finished = 0;
+
+static void slow_callback(TimerEntry *timer, void *arg) {
+    (void)timer; (void)arg;
+    slow_started = 1;
+    struct timespec ts = {0, 200000000L};
+    nanosleep(&ts, NULL);
+    slow_finished = 1;
+}
+
+static void *tick_thread(void *arg) {
+    (void)arg;
+    advance_ms(TIMER_WHEEL_TICK_MS);
+    return NULL;
+}
+
+static void test_cancel_sync_waits() {
+    TimerEntry slow;
+    timer_entry_init(&slow, slow_callback, NULL);
+    timer_schedule(&slow, 100);
+    pthread_t t;
+    pthread_create(&t, NULL, tick_thread, NULL);
+    while (!slow_started) {
+        struct timespec ts = {0, 1000000L};
+        nanosleep(&ts, NULL);
+    }
+    timer_cancel_sync(&slow);
+    check(slow_finished == 1, "cancel_sync waits for a running callback");
+    pthread_join(t, NULL);
+}
+
+int main() {
+    simclock_init(1, 0, 1, 0);
+    timer_wheel_init();
+    test_fires_on_time();
+    test_cascade();
+    test_cancel_and_reschedule();
+    test_many_random();
+    test_cancel_sync_waits();
+    timer_wheel_shutdown();
+    printf("%s\n", failures ? "FAILED" : "all passed");
+    return failures != 0;
+}
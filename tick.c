@@ -0,0 +1,182 @@
+/*
+ * tick.c
+ * Sabit hızlı simülasyon zamanlayıcısı: survivor üretimi, görev ataması, zaman
+ * aşımları ve yayın tek thread'de, her tick'te tanımlı sırayla çalışır.
+ */
+#include "headers/tick.h"
+#include "headers/metrics.h"
+#include "headers/trace.h"
+#include "headers/simclock.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct tick_phase_entry {
+    const char *name;
+    tick_phase_fn fn;
+    unsigned long long period_ticks;
+    unsigned long long next_run_tick;   /* Atlanan tick'ler periyodu bölmesin diye mutlak sıradaki tick */
+    MetricHistogram duration_us;
+} TickPhaseEntry;
+
+static TickPhaseEntry phases[TICK_PHASES];
+static int rate_hz = TICK_DEFAULT_RATE_HZ;
+static long long period_ns = 1000000000LL / TICK_DEFAULT_RATE_HZ;
+static volatile int scheduler_running = 0;
+static unsigned long long tick_limit = 0;       /* 0: sınırsız */
+static volatile int scheduler_done = 0;
+
+static MetricHistogram tick_duration_us;
+static MetricCounter ticks_run;
+static MetricCounter tick_overruns;    /* İşi periyodu aşan tick'ler */
+static MetricCounter ticks_skipped;    /* Gecikme yüzünden hiç çalışmayan tick'ler */
+
+// Kayıt defteri etiketleri statik ömürlü olmalı
+static const char *phase_labels[TICK_PHASES] = {
+    [TICK_PHASE_SPAWN] = "phase=\"spawn\"",
+    [TICK_PHASE_DISPATCH] = "phase=\"dispatch\"",
+    [TICK_PHASE_DRONES] = "phase=\"drones\"",
+    [TICK_PHASE_TIMEOUTS] = "phase=\"timeouts\"",
+    [TICK_PHASE_BROADCAST] = "phase=\"broadcast\"",
+};
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int tick_scheduler_init(int hz) {
+    if (hz < 1 || hz > TICK_MAX_RATE_HZ) {
+        fprintf(stderr, "Tick rate must be between 1 and %d Hz.\n", TICK_MAX_RATE_HZ);
+        return 1;
+    }
+    rate_hz = hz;
+    period_ns = 1000000000LL / hz;
+    memset(phases, 0, sizeof(phases));
+    scheduler_running = 1;
+
+    metrics_register_histogram(&tick_duration_us, "drone_server_tick_duration_seconds", NULL,
+                               "Time spent running all phases of one simulation tick.");
+    for (int i = 0; i < TICK_PHASES; i++) {
+        metrics_register_histogram(&phases[i].duration_us, "drone_server_tick_phase_duration_seconds",
+                                   phase_labels[i], "Time spent in one simulation phase per run.");
+    }
+    metrics_register_counter(&ticks_run, "drone_server_ticks_total", NULL, "Simulation ticks executed.");
+    metrics_register_counter(&tick_overruns, "drone_server_tick_overruns_total", NULL,
+                             "Ticks whose phases took longer than the tick period.");
+    metrics_register_counter(&ticks_skipped, "drone_server_ticks_skipped_total", NULL,
+                             "Ticks dropped to catch up after an overrun.");
+    return 0;
+}
+
+void tick_scheduler_add(TickPhase phase, const char *name, tick_phase_fn fn, int period_ms) {
+    if (phase < 0 || phase >= TICK_PHASES) return;
+    phases[phase].name = name;
+    phases[phase].fn = fn;
+    phases[phase].period_ticks = tick_from_ms(period_ms);
+    phases[phase].next_run_tick = 0;
+}
+
+int tick_rate_hz() {
+    return rate_hz;
+}
+
+unsigned long long tick_skipped_total() {
+    return atomic_load(&ticks_skipped.value);
+}
+
+unsigned long long tick_from_ms(int ms) {
+    unsigned long long ticks = ((long long)ms * 1000000LL + period_ns - 1) / period_ns;
+    return ticks > 0 ? ticks : 1;
+}
+
+void tick_scheduler_stop_after(unsigned long long ticks) {
+    tick_limit = ticks;
+}
+
+int tick_scheduler_done() {
+    return scheduler_done;
+}
+
+void *tick_scheduler_thread(void *args) {
+    (void)args;
+    printf("Tick scheduler thread started (%d Hz).\n", rate_hz);
+    trace_set_thread_name("tick scheduler");
+    // Survivor konumları ve benzeri kararlar diğer thread'lerden bağımsız, tohumla belirlenir
+    sim_rand_seed_thread(SIM_RAND_STREAM_TICK);
+
+    // Sanal modda bir tick'in gerçek süresi period/speed'dir; speed 0 ise hiç beklenmez
+    int virtual_clock = simclock_virtual();
+    long long wall_period_ns = period_ns;
+    if (virtual_clock) wall_period_ns = simclock_speed() > 0 ? (long long)(period_ns / simclock_speed()) : 0;
+
+    unsigned long long tick = 0;
+    long long next_ns = now_ns();
+    while (scheduler_running) {
+        if (tick_limit && tick >= tick_limit) {
+            printf("Tick scheduler: reached the %llu-tick limit.\n", tick_limit);
+            break;
+        }
+        // Sanal saat tick başında ilerler: tick n'nin fazları n * periyot anında çalışır
+        if (virtual_clock && tick > 0) simclock_advance_ns(period_ns);
+        long long tick_start = now_ns();
+        for (int i = 0; i < TICK_PHASES && scheduler_running; i++) {
+            TickPhaseEntry *p = &phases[i];
+            // Geride kalınıp tick atlandıysa vadesi geçen faz ilk çalışan tick'te koşar
+            if (!p->fn || tick < p->next_run_tick) continue;
+            p->next_run_tick = tick + p->period_ticks;
+            long long phase_start = metrics_now_us();
+            p->fn(tick);
+            metric_histogram_record(&p->duration_us, metrics_now_us() - phase_start);
+        }
+        long long tick_end = now_ns();
+        metric_histogram_record(&tick_duration_us, (unsigned long long)((tick_end - tick_start) / 1000));
+        metric_counter_add(&ticks_run, 1);
+
+        tick++;
+        next_ns += wall_period_ns;
+        if (tick_end - tick_start > wall_period_ns && wall_period_ns > 0) metric_counter_add(&tick_overruns, 1);
+        if (virtual_clock) {
+            // Sanal zamanda tick atlanmaz; geride kalınırsa simülasyon sadece yavaşlar
+            if (tick_end > next_ns) next_ns = tick_end;
+        } else if (tick_end > next_ns) {
+            // Geride kalındıysa kaçırılan tick'ler art arda koşturulmaz; sıradaki sınıra atlanır
+            long long missed = (tick_end - next_ns) / period_ns;
+            if (missed > 0) {
+                tick += (unsigned long long)missed;
+                next_ns += missed * period_ns;
+                metric_counter_add(&ticks_skipped, (unsigned long long)missed);
+            }
+        }
+
+        long long sleep_ns = next_ns - now_ns();
+        if (sleep_ns > 0) {
+            struct timespec ts = {sleep_ns / 1000000000LL, sleep_ns % 1000000000LL};
+            nanosleep(&ts, NULL);
+        }
+    }
+    scheduler_done = 1;
+    printf("Tick scheduler thread exiting.\n");
+    return NULL;
+}
+
+void tick_scheduler_shutdown() {
+    scheduler_running = 0;
+}
+
+void tick_stats_dump(FILE *out) {
+    unsigned long long run = atomic_load(&ticks_run.value);
+    unsigned long long over = atomic_load(&tick_overruns.value);
+    fprintf(out, "Tick scheduler: %llu ticks at %d Hz, %llu overruns (%.2f%%), %llu skipped, tick p50 %lluus p99 %lluus max %lluus\n",
+            run, rate_hz, over, run ? 100.0 * over / run : 0.0, atomic_load(&ticks_skipped.value),
+            metric_histogram_quantile(&tick_duration_us, 0.50), metric_histogram_quantile(&tick_duration_us, 0.99),
+            metric_histogram_quantile(&tick_duration_us, 1.0));
+    for (int i = 0; i < TICK_PHASES; i++) {
+        if (!phases[i].fn) continue;
+        fprintf(out, "  %-10s every %llu tick(s): p50 %lluus p99 %lluus\n", phases[i].name, phases[i].period_ticks,
+                metric_histogram_quantile(&phases[i].duration_us, 0.50),
+                metric_histogram_quantile(&phases[i].duration_us, 0.99));
+    }
+    fflush(out);
+}
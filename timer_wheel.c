@@ -0,0 +1,149 @@
+/*
+ * timer_wheel.c
+ * Hiyerarşik zamanlayıcı tekerleği: heartbeat gönderimi, bağlantı canlılığı ve
+ * görev süre aşımları tick scheduler'ın zaman aşımı fazında, bağlantı sayısından
+ * bağımsız maliyetle yürütülür.
+ */
+#include "headers/timer_wheel.h"
+#include "headers/simclock.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+static pthread_mutex_t wheel_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t callback_done = PTHREAD_COND_INITIALIZER;
+static TimerEntry *wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static unsigned long long current_tick = 0;
+static TimerEntry *running_timer = NULL;   /* Callback'i şu an çalışan zamanlayıcı */
+static volatile int wheel_running = 0;
+static long long wheel_start_ms = 0;
+
+/* wheel_lock tutulurken çağrılır; son zamana göre uygun seviye ve slota ekler */
+static void wheel_insert(TimerEntry *t) {
+    unsigned long long delta = t->expires > current_tick ? t->expires - current_tick : 0;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (1ULL << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    unsigned long long max_delta = (1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    if (delta > max_delta) t->expires = current_tick + max_delta;
+    // Cascade sırasında tam bu tick'e düşenler aynı tick'te, geçmiş olanlar bir sonrakinde çalışır
+    unsigned long long when = t->expires >= current_tick ? t->expires : current_tick + 1;
+    int slot = (int)((when >> (TIMER_WHEEL_SLOT_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+
+    TimerEntry **head = &wheel[level][slot];
+    t->next = *head;
+    if (*head) (*head)->pprev = &t->next;
+    t->pprev = head;
+    *head = t;
+    t->pending = 1;
+}
+
+/* wheel_lock tutulurken çağrılır */
+static void wheel_remove(TimerEntry *t) {
+    if (!t->pending) return;
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->next = NULL;
+    t->pprev = NULL;
+    t->pending = 0;
+}
+
+/* Üst seviyedeki bir slotu boşaltıp kayıtları alt seviyelere yeniden dağıtır */
+static void cascade(int level) {
+    int slot = (int)((current_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+    TimerEntry *t = wheel[level][slot];
+    wheel[level][slot] = NULL;
+    while (t) {
+        TimerEntry *next = t->next;
+        t->pending = 0;
+        wheel_insert(t);
+        t = next;
+    }
+}
+
+/* wheel_lock tutulurken bir tick ilerler ve süresi dolanları çalıştırır */
+static void advance_one_tick() {
+    current_tick++;
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        // Alt seviye tam tur attıysa bir üst seviyenin sıradaki slotu aşağı iner
+        if ((current_tick & ((1ULL << (TIMER_WHEEL_SLOT_BITS * level)) - 1)) != 0) break;
+        cascade(level);
+    }
+
+    int slot = (int)(current_tick & (TIMER_WHEEL_SLOTS - 1));
+    TimerEntry *t;
+    while ((t = wheel[0][slot]) != NULL) {
+        wheel_remove(t);
+
+        running_timer = t;
+        timer_callback cb = t->callback;
+        void *arg = t->arg;
+        pthread_mutex_unlock(&wheel_lock);
+        cb(t, arg);
+        pthread_mutex_lock(&wheel_lock);
+        running_timer = NULL;
+        pthread_cond_broadcast(&callback_done);
+    }
+}
+
+int timer_wheel_init() {
+    memset(wheel, 0, sizeof(wheel));
+    current_tick = 0;
+    wheel_start_ms = sim_monotonic_ms();
+    wheel_running = 1;
+    return 0;
+}
+
+void timer_wheel_shutdown() {
+    wheel_running = 0;
+}
+
+void timer_wheel_tick(unsigned long long sim_tick) {
+    (void)sim_tick;
+    // Simülasyon tick'i tekerlek tick'inden farklı hızda olabilir; geçen (sanal) süre kadar tekerlek tick'i işlenir
+    unsigned long long target_tick = (unsigned long long)((sim_monotonic_ms() - wheel_start_ms) / TIMER_WHEEL_TICK_MS);
+    pthread_mutex_lock(&wheel_lock);
+    while (current_tick < target_tick && wheel_running) advance_one_tick();
+    pthread_mutex_unlock(&wheel_lock);
+}
+
+void timer_entry_init(TimerEntry *timer, timer_callback callback, void *arg) {
+    memset(timer, 0, sizeof(*timer));
+    timer->callback = callback;
+    timer->arg = arg;
+}
+
+void timer_schedule(TimerEntry *timer, int delay_ms) {
+    if (delay_ms < 0) delay_ms = 0;
+    pthread_mutex_lock(&wheel_lock);
+    wheel_remove(timer);
+    unsigned long long ticks = (delay_ms + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+    timer->expires = current_tick + (ticks > 0 ? ticks : 1);
+    wheel_insert(timer);
+    pthread_mutex_unlock(&wheel_lock);
+}
+
+void timer_cancel(TimerEntry *timer) {
+    pthread_mutex_lock(&wheel_lock);
+    wheel_remove(timer);
+    pthread_mutex_unlock(&wheel_lock);
+}
+
+void timer_cancel_sync(TimerEntry *timer) {
+    pthread_mutex_lock(&wheel_lock);
+    wheel_remove(timer);
+    while (running_timer == timer) pthread_cond_wait(&callback_done, &wheel_lock);
+    // Callback kendini yeniden kurmuş olabilir
+    wheel_remove(timer);
+    pthread_mutex_unlock(&wheel_lock);
+}
+
+int timer_pending(TimerEntry *timer) {
+    pthread_mutex_lock(&wheel_lock);
+    int pending = timer->pending;
+    pthread_mutex_unlock(&wheel_lock);
+    return pending;
+}
@@ -0,0 +1,196 @@
+/*
+ * trace.c
+ * Thread başına kilitsiz span halkaları ve Chrome trace_event JSON dökümü.
+ */
+#include "headers/trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef struct trace_event {
+    const char *name;
+    long long start_ns;
+    long long dur_ns;
+} TraceEvent;
+
+typedef struct trace_ring {
+    atomic_ulong head;                   /* Şimdiye kadar yazılan olay sayısı; yuva = head % kapasite */
+    int tid;                             /* Zaman çizelgesindeki satır */
+    int in_use;
+    char name[TRACE_THREAD_NAME_MAX];
+    TraceEvent events[TRACE_RING_CAPACITY];
+} TraceRing;
+
+static atomic_int sample_every = 0;
+static long long trace_epoch_ns = 0;
+
+// Halkalar thread çıkınca bırakılır ve sonraki thread'e sıfırlanarak verilir (bellek eşzamanlı thread sayısıyla sınırlı)
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceRing *rings[TRACE_MAX_THREADS];
+static int num_rings = 0;
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+
+static __thread TraceRing *thread_ring = NULL;
+static __thread int thread_ring_unavailable = 0;
+static __thread unsigned int sample_counter = 0;
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void release_ring(void *arg) {
+    TraceRing *ring = (TraceRing*)arg;
+    pthread_mutex_lock(&rings_lock);
+    ring->in_use = 0;
+    pthread_mutex_unlock(&rings_lock);
+}
+
+static void create_ring_key() {
+    pthread_key_create(&ring_key, release_ring);
+}
+
+static TraceRing *current_ring() {
+    if (thread_ring) return thread_ring;
+    if (thread_ring_unavailable) return NULL;
+    pthread_once(&ring_key_once, create_ring_key);
+
+    pthread_mutex_lock(&rings_lock);
+    TraceRing *ring = NULL;
+    for (int i = 0; i < num_rings; i++) {
+        if (!rings[i]->in_use) {
+            ring = rings[i];
+            break;
+        }
+    }
+    if (!ring && num_rings < TRACE_MAX_THREADS) {
+        ring = calloc(1, sizeof(TraceRing));
+        if (ring) {
+            ring->tid = num_rings + 1;
+            rings[num_rings++] = ring;
+        }
+    }
+    if (!ring) {
+        pthread_mutex_unlock(&rings_lock);
+        thread_ring_unavailable = 1;
+        return NULL;
+    }
+    ring->in_use = 1;
+    atomic_store(&ring->head, 0);
+    snprintf(ring->name, sizeof(ring->name), "thread %d", ring->tid);
+    pthread_mutex_unlock(&rings_lock);
+
+    pthread_setspecific(ring_key, ring);
+    thread_ring = ring;
+    return ring;
+}
+
+void trace_init(int every) {
+    trace_epoch_ns = now_ns();
+    atomic_store(&sample_every, every > 0 ? every : 0);
+    if (every > 0) printf("Tracing enabled, sampling 1 in %d spans.\n", every);
+}
+
+int trace_enabled() {
+    return atomic_load_explicit(&sample_every, memory_order_relaxed) > 0;
+}
+
+void trace_set_thread_name(const char *name) {
+    if (!trace_enabled()) return;
+    TraceRing *ring = current_ring();
+    if (!ring) return;
+    pthread_mutex_lock(&rings_lock);
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+    pthread_mutex_unlock(&rings_lock);
+}
+
+long long trace_begin() {
+    int every = atomic_load_explicit(&sample_every, memory_order_relaxed);
+    if (every <= 0) return 0;
+    if (every > 1 && (++sample_counter % (unsigned int)every) != 0) return 0;
+    return now_ns();
+}
+
+void trace_end(const char *name, long long start_ns) {
+    if (start_ns == 0) return;
+    TraceRing *ring = current_ring();
+    if (!ring) return;
+    unsigned long head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    TraceEvent *e = &ring->events[head % TRACE_RING_CAPACITY];
+    e->name = name;
+    e->start_ns = start_ns;
+    e->dur_ns = now_ns() - start_ns;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/* Thread adları log önekinden gelir; JSON string'i bozacak karakterler değiştirilir */
+static void write_json_name(FILE *out, const char *name) {
+    fputc('"', out);
+    for (const char *p = name; *p; p++) {
+        fputc((*p == '"' || *p == '\\' || (unsigned char)*p < 0x20) ? '_' : *p, out);
+    }
+    fputc('"', out);
+}
+
+void trace_dump(FILE *out) {
+    TraceEvent *copy = malloc(sizeof(TraceEvent) * TRACE_RING_CAPACITY);
+    if (!copy) {
+        perror("Failed to allocate trace dump buffer");
+        return;
+    }
+    int pid = (int)getpid();
+    fprintf(out, "{\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"drone server\"}}", pid);
+
+    pthread_mutex_lock(&rings_lock);
+    for (int i = 0; i < num_rings; i++) {
+        TraceRing *ring = rings[i];
+        fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", pid, ring->tid);
+        write_json_name(out, ring->name);
+        fprintf(out, "}}");
+
+        // Yazan thread durmaz: kopyalarken üzerine yazılmış olabilecek en eski yuvalar atılır
+        unsigned long head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        unsigned long first = head > TRACE_RING_CAPACITY ? head - TRACE_RING_CAPACITY : 0;
+        for (unsigned long k = first; k < head; k++) {
+            copy[k - first] = ring->events[k % TRACE_RING_CAPACITY];
+        }
+        atomic_thread_fence(memory_order_acquire);
+        unsigned long head_after = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        unsigned long valid_from = head_after >= TRACE_RING_CAPACITY ? head_after - TRACE_RING_CAPACITY + 1 : 0;
+
+        for (unsigned long k = first > valid_from ? first : valid_from; k < head; k++) {
+            const TraceEvent *e = &copy[k - first];
+            fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"server\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    e->name, pid, ring->tid, (e->start_ns - trace_epoch_ns) / 1e3, e->dur_ns / 1e3);
+        }
+    }
+    pthread_mutex_unlock(&rings_lock);
+
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fflush(out);
+    free(copy);
+}
+
+int trace_dump_file(const char *path) {
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *out = fopen(tmp_path, "w");
+    if (!out) {
+        perror("Failed to open trace dump file");
+        return 1;
+    }
+    trace_dump(out);
+    if (fclose(out) != 0 || rename(tmp_path, path) != 0) {
+        perror("Failed to write trace dump file");
+        unlink(tmp_path);
+        return 1;
+    }
+    printf("Trace written to %s\n", path);
+    return 0;
+}
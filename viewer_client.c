@@ -5,20 +5,25 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <sys/un.h>
 #include <pthread.h>
 #include <json.h>
 #include <SDL.h>
 #include <errno.h>
 #include <math.h>
+#include <zlib.h>
 
 #include "headers/coord.h"     // Coord tipi için
 #include "headers/drone.h"     // DroneState enum'u için
 #include "headers/survivor.h"  // SurvivorState enum'u için
 // #include "headers/view.h"   // Eğer viewer_sdl.h gibi yeniden adlandırdıysak onu kullan
 #include "headers/view.h"   // Şimdilik eski ismiyle kullanalım.
+#include "headers/shm_world.h" // --shm modu için paylaşımlı dünya kopyası
+#include "headers/stream_deflate.h" // Sunucu akışının sıkıştırma parametreleri ve ön sözlüğü
 
 #define SERVER_IP "127.0.0.1"
 #define SERVER_PORT 8080      // Sunucu ile aynı port
+#define SERVER_UNIX_PATH "/tmp/drone_server.sock" // Sunucunun varsayılan Unix soketi
 #define VIEWER_BUFFER_SIZE 8192 // Daha büyük JSON mesajları için
 #define CELL_SIZE_PX 25       // Harita hücresi boyutu (piksel), reduced to show more cells
 
@@ -28,6 +33,14 @@ SDL_Renderer* g_vc_renderer = NULL;
 int g_vc_map_width_cells = 0;
 int g_vc_map_height_cells = 0;
 
+// --viewport: pencere haritanın sadece bu kadarını gösterir, ok tuşlarıyla kaydırılır.
+// Sunucu VIEWER_SUBSCRIBE ile bildirilen dikdörtgenin dışındaki varlıkları göndermez.
+int g_vc_viewport_enabled = 0;
+int g_vc_view_x = 0, g_vc_view_y = 0;          // Görünen alanın sol üst hücresi (Coord.x satır, Coord.y sütun)
+int g_vc_view_rows = 0, g_vc_view_cols = 0;    // Görünen alanın boyutu (hücre)
+int g_vc_view_zoom = 1;
+int g_vc_view_changed = 0;                     // Kaydırıldı, yeni VIEWER_SUBSCRIBE gönderilmeli
+
 // Renkler (view.h'den extern edilebilir veya burada tanımlanabilir)
 const SDL_Color VC_COLOR_BLACK = {0, 0, 0, 255};
 const SDL_Color VC_COLOR_RED = {255, 0, 0, 255};         
@@ -45,12 +58,15 @@ typedef struct {
     DroneState status;
     Coord displayCoord; // for smooth rendering
     char displayInit;   // flag init displayCoord
+    char seen;          // keyframe uygulanırken silinecekleri işaretlemek için
 } ViewerDroneInfo;
 
 typedef struct {
+    int id;             // Sunucudaki kalıcı survivor ID'si
     char info[25];
     Coord coord;
     SurvivorState status;
+    char seen;
 } ViewerSurvivorInfo;
 
 ViewerDroneInfo viewer_drones_cache[50]; // Maks 50 drone için cache
@@ -58,14 +74,17 @@ int num_viewer_drones = 0;
 ViewerSurvivorInfo viewer_survivors_cache[100]; // Maks 100 survivor için cache
 int num_viewer_survivors = 0;
 pthread_mutex_t cache_lock; // Cache'e erişimi korumak için
+unsigned long viewer_state_version = 0; // Cache'in yansıttığı sunucu durum versiyonu
 
 
 int vc_init_sdl_window(int map_width_cells, int map_height_cells, int cell_size_pixels) {
     g_vc_map_width_cells = map_width_cells;
     g_vc_map_height_cells = map_height_cells;
+    if (!g_vc_viewport_enabled || g_vc_view_rows > map_height_cells) g_vc_view_rows = map_height_cells;
+    if (!g_vc_viewport_enabled || g_vc_view_cols > map_width_cells) g_vc_view_cols = map_width_cells;
 
-    int window_width_px = map_width_cells * cell_size_pixels;
-    int window_height_px = map_height_cells * cell_size_pixels;
+    int window_width_px = g_vc_view_cols * cell_size_pixels;
+    int window_height_px = g_vc_view_rows * cell_size_pixels;
 
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         fprintf(stderr, "Viewer: SDL_Init Error: %s\n", SDL_GetError());
@@ -84,8 +103,9 @@ int vc_init_sdl_window(int map_width_cells, int map_height_cells, int cell_size_
 }
 
 void vc_draw_cell(int map_x, int map_y, int cell_size_pixels, SDL_Color color) {
-    if (!g_vc_renderer || map_x < 0 || map_x >= g_vc_map_height_cells || map_y < 0 || map_y >= g_vc_map_width_cells) return;
-    SDL_Rect cell_rect = { map_y * cell_size_pixels, map_x * cell_size_pixels, cell_size_pixels, cell_size_pixels };
+    int row = map_x - g_vc_view_x, col = map_y - g_vc_view_y;
+    if (!g_vc_renderer || row < 0 || row >= g_vc_view_rows || col < 0 || col >= g_vc_view_cols) return;
+    SDL_Rect cell_rect = { col * cell_size_pixels, row * cell_size_pixels, cell_size_pixels, cell_size_pixels };
     SDL_SetRenderDrawColor(g_vc_renderer, color.r, color.g, color.b, color.a);
     SDL_RenderFillRect(g_vc_renderer, &cell_rect);
 }
@@ -106,7 +126,7 @@ void vc_render_all() {
     SDL_SetRenderDrawColor(g_vc_renderer, VC_COLOR_DARK_GREY.r, VC_COLOR_DARK_GREY.g, VC_COLOR_DARK_GREY.b, 255);
     SDL_RenderClear(g_vc_renderer);
 
-    vc_draw_grid(g_vc_renderer, g_vc_map_width_cells, g_vc_map_height_cells, CELL_SIZE_PX);
+    vc_draw_grid(g_vc_renderer, g_vc_view_cols, g_vc_view_rows, CELL_SIZE_PX);
 
     pthread_mutex_lock(&cache_lock); // Cache'i okurken kilitle
 
@@ -157,10 +177,10 @@ void vc_render_all() {
         // If on mission, draw arrow
         if (d->status == ON_MISSION) {
             SDL_SetRenderDrawColor(g_vc_renderer, VC_COLOR_GREEN.r, VC_COLOR_GREEN.g, VC_COLOR_GREEN.b, 255);
-            int x0 = d->displayCoord.y * CELL_SIZE_PX + CELL_SIZE_PX/2;
-            int y0 = d->displayCoord.x * CELL_SIZE_PX + CELL_SIZE_PX/2;
-            int x1 = d->target.y * CELL_SIZE_PX + CELL_SIZE_PX/2;
-            int y1 = d->target.x * CELL_SIZE_PX + CELL_SIZE_PX/2;
+            int x0 = (d->displayCoord.y - g_vc_view_y) * CELL_SIZE_PX + CELL_SIZE_PX/2;
+            int y0 = (d->displayCoord.x - g_vc_view_x) * CELL_SIZE_PX + CELL_SIZE_PX/2;
+            int x1 = (d->target.y - g_vc_view_y) * CELL_SIZE_PX + CELL_SIZE_PX/2;
+            int y1 = (d->target.x - g_vc_view_x) * CELL_SIZE_PX + CELL_SIZE_PX/2;
             SDL_RenderDrawLine(g_vc_renderer, x0, y0, x1, y1);
             double angle = atan2(y1 - y0, x1 - x0);
             double arr_len = CELL_SIZE_PX;
@@ -178,16 +198,98 @@ void vc_render_all() {
     SDL_RenderPresent(g_vc_renderer);
 }
 
+// Ok tuşları görünen alanı çeyrek pencere kaydırır; harita sınırında durur
+static void vc_pan_view(int d_rows, int d_cols) {
+    int max_x = g_vc_map_height_cells - g_vc_view_rows, max_y = g_vc_map_width_cells - g_vc_view_cols;
+    int x = g_vc_view_x + d_rows, y = g_vc_view_y + d_cols;
+    x = x < 0 ? 0 : (x > max_x ? max_x : x);
+    y = y < 0 ? 0 : (y > max_y ? max_y : y);
+    if (x != g_vc_view_x || y != g_vc_view_y) {
+        g_vc_view_x = x;
+        g_vc_view_y = y;
+        g_vc_view_changed = 1;
+    }
+}
+
 int vc_check_events() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT || (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE)) {
             return 1; // Kapat
         }
+        if (event.type == SDL_KEYDOWN && g_vc_viewport_enabled && g_vc_map_width_cells > 0) {
+            int step_rows = g_vc_view_rows / 4 > 0 ? g_vc_view_rows / 4 : 1;
+            int step_cols = g_vc_view_cols / 4 > 0 ? g_vc_view_cols / 4 : 1;
+            switch (event.key.keysym.sym) {
+                case SDLK_UP: vc_pan_view(-step_rows, 0); break;
+                case SDLK_DOWN: vc_pan_view(step_rows, 0); break;
+                case SDLK_LEFT: vc_pan_view(0, -step_cols); break;
+                case SDLK_RIGHT: vc_pan_view(0, step_cols); break;
+            }
+        }
     }
     return 0; // Devam et
 }
 
+// Görünen dikdörtgeni sunucu mesajına yazar (VIEWER_HANDSHAKE ve VIEWER_SUBSCRIBE'da aynı alanlar)
+static void vc_add_viewport(struct json_object *msg) {
+    struct json_object *vp = json_object_new_object();
+    json_object_object_add(vp, "x_min", json_object_new_int(g_vc_view_x));
+    json_object_object_add(vp, "y_min", json_object_new_int(g_vc_view_y));
+    json_object_object_add(vp, "x_max", json_object_new_int(g_vc_view_x + g_vc_view_rows - 1));
+    json_object_object_add(vp, "y_max", json_object_new_int(g_vc_view_y + g_vc_view_cols - 1));
+    json_object_object_add(msg, "viewport", vp);
+    json_object_object_add(msg, "zoom", json_object_new_int(g_vc_view_zoom));
+}
+
+static int vc_inflate_init(z_stream *zs) {
+    memset(zs, 0, sizeof(*zs));
+    if (inflateInit2(zs, STREAM_DEFLATE_WINDOW_BITS) != Z_OK) return -1;
+    // Raw deflate: sözlük akışın başında, sunucuyla aynı byte'larla verilir
+    static const char dictionary[] = STREAM_DEFLATE_DICTIONARY;
+    if (inflateSetDictionary(zs, (const Bytef*)dictionary, sizeof(dictionary) - 1) != Z_OK) {
+        inflateEnd(zs);
+        return -1;
+    }
+    return 0;
+}
+
+/* in'deki sıkıştırılmış byte'ları out'a açar, tüketileni in'den çıkarır. Açılan byte sayısını, hata durumunda -1 döner */
+static int vc_inflate(z_stream *zs, unsigned char *in, size_t *in_len, char *out, size_t out_cap) {
+    zs->next_in = in;
+    zs->avail_in = (uInt)*in_len;
+    zs->next_out = (Bytef*)out;
+    zs->avail_out = (uInt)out_cap;
+    int rc = inflate(zs, Z_SYNC_FLUSH);
+    if (rc != Z_OK && rc != Z_BUF_ERROR) return -1;
+    memmove(in, zs->next_in, zs->avail_in);
+    *in_len = zs->avail_in;
+    return (int)(out_cap - zs->avail_out);
+}
+
+static void vc_send_subscribe(int sock_fd) {
+    struct json_object *sub_msg = json_object_new_object();
+    json_object_object_add(sub_msg, "type", json_object_new_string("VIEWER_SUBSCRIBE"));
+    vc_add_viewport(sub_msg);
+    const char *str = json_object_to_json_string_ext(sub_msg, JSON_C_TO_STRING_PLAIN);
+    char line[strlen(str) + 2];
+    snprintf(line, sizeof(line), "%s\n", str);
+    send(sock_fd, line, strlen(line), 0);
+    json_object_put(sub_msg);
+}
+
+// Viewport dışında kalan varlık sayıları pencere başlığında gösterilir
+static void vc_show_outside_counts(struct json_object *msg) {
+    struct json_object *outside_obj, *drones_obj, *survivors_obj;
+    if (!g_vc_window || !json_object_object_get_ex(msg, "outside", &outside_obj) ||
+        !json_object_object_get_ex(outside_obj, "drones", &drones_obj) ||
+        !json_object_object_get_ex(outside_obj, "survivors", &survivors_obj)) return;
+    char title[128];
+    snprintf(title, sizeof(title), "Drone Simulation Viewer - view (%d,%d) - outside: %d drones, %d survivors",
+             g_vc_view_x, g_vc_view_y, json_object_get_int(drones_obj), json_object_get_int(survivors_obj));
+    SDL_SetWindowTitle(g_vc_window, title);
+}
+
 void vc_quit_sdl() {
     if (g_vc_renderer) SDL_DestroyRenderer(g_vc_renderer);
     if (g_vc_window) SDL_DestroyWindow(g_vc_window);
@@ -196,11 +298,100 @@ void vc_quit_sdl() {
 }
 
 
-// Sunucudan gelen SIMULATION_STATE_UPDATE mesajını işleyen fonksiyon
-void process_simulation_state(struct json_object *state_json) {
-    struct json_object *map_dim_obj, *drones_array_obj, *survivors_array_obj;
-    
-    // Harita boyutlarını al (ilk mesajda veya her güncellemede)
+static void vc_parse_coord(struct json_object *coord_obj, Coord *out) {
+    struct json_object *x_obj, *y_obj;
+    if (json_object_object_get_ex(coord_obj, "x", &x_obj)) out->x = json_object_get_int(x_obj);
+    if (json_object_object_get_ex(coord_obj, "y", &y_obj)) out->y = json_object_get_int(y_obj);
+}
+
+// Drone'u id_str ile cache'te bulur veya yeni slot açar. Cache doluysa NULL. cache_lock tutulmalı.
+static ViewerDroneInfo *vc_find_or_add_drone(const char *id_str) {
+    for (int i = 0; i < num_viewer_drones; i++) {
+        if (strcmp(viewer_drones_cache[i].id_str, id_str) == 0) return &viewer_drones_cache[i];
+    }
+    if (num_viewer_drones >= 50) return NULL;
+    ViewerDroneInfo *vd = &viewer_drones_cache[num_viewer_drones++];
+    memset(vd, 0, sizeof(*vd));
+    strncpy(vd->id_str, id_str, sizeof(vd->id_str)-1);
+    return vd;
+}
+
+// Drone'u id_str ile cache'te bulur veya yeni slot açar, alanlarını günceller. cache_lock tutulmalı.
+static ViewerDroneInfo *vc_upsert_drone(struct json_object *d_obj) {
+    struct json_object *id_str_obj, *coord_obj, *target_obj, *status_str_obj;
+    if (!json_object_object_get_ex(d_obj, "id_str", &id_str_obj)) return NULL;
+    ViewerDroneInfo *vd = vc_find_or_add_drone(json_object_get_string(id_str_obj));
+    if (!vd) return NULL;
+
+    if (json_object_object_get_ex(d_obj, "coord", &coord_obj)) vc_parse_coord(coord_obj, &vd->coord);
+    if (json_object_object_get_ex(d_obj, "target", &target_obj)) vc_parse_coord(target_obj, &vd->target);
+    if (json_object_object_get_ex(d_obj, "status", &status_str_obj)) {
+        const char *s_str = json_object_get_string(status_str_obj);
+        if(strcmp(s_str, "IDLE")==0) vd->status = IDLE;
+        else if (strcmp(s_str, "ON_MISSION")==0) vd->status = ON_MISSION;
+    }
+    /* Initialize display position for new drones */
+    if (!vd->displayInit) {
+        vd->displayCoord = vd->coord;
+        vd->displayInit = 1;
+    }
+    vd->seen = 1;
+    return vd;
+}
+
+static void vc_remove_drone_at(int idx) {
+    viewer_drones_cache[idx] = viewer_drones_cache[--num_viewer_drones];
+}
+
+static void vc_remove_drone(const char *id_str) {
+    for (int i = 0; i < num_viewer_drones; i++) {
+        if (strcmp(viewer_drones_cache[i].id_str, id_str) == 0) { vc_remove_drone_at(i); return; }
+    }
+}
+
+// Survivor'ı kalıcı id ile cache'te bulur veya yeni slot açar. Cache doluysa NULL. cache_lock tutulmalı.
+static ViewerSurvivorInfo *vc_find_or_add_survivor(int id) {
+    for (int i = 0; i < num_viewer_survivors; i++) {
+        if (viewer_survivors_cache[i].id == id) return &viewer_survivors_cache[i];
+    }
+    if (num_viewer_survivors >= 100) return NULL;
+    ViewerSurvivorInfo *vs = &viewer_survivors_cache[num_viewer_survivors++];
+    memset(vs, 0, sizeof(*vs));
+    vs->id = id;
+    return vs;
+}
+
+// Survivor'ı kalıcı id ile cache'te bulur veya yeni slot açar, alanlarını günceller. cache_lock tutulmalı.
+static ViewerSurvivorInfo *vc_upsert_survivor(struct json_object *s_obj) {
+    struct json_object *id_obj, *info_obj, *coord_obj, *status_str_obj;
+    if (!json_object_object_get_ex(s_obj, "id", &id_obj)) return NULL;
+    ViewerSurvivorInfo *vs = vc_find_or_add_survivor(json_object_get_int(id_obj));
+    if (!vs) return NULL;
+
+    if (json_object_object_get_ex(s_obj, "info", &info_obj)) strncpy(vs->info, json_object_get_string(info_obj), sizeof(vs->info)-1);
+    if (json_object_object_get_ex(s_obj, "coord", &coord_obj)) vc_parse_coord(coord_obj, &vs->coord);
+    if (json_object_object_get_ex(s_obj, "status", &status_str_obj)) {
+        const char *s_str = json_object_get_string(status_str_obj);
+        if(strcmp(s_str, "WAITING")==0) vs->status = WAITING;
+        else if (strcmp(s_str, "ASSIGNED")==0) vs->status = ASSIGNED;
+        else if (strcmp(s_str, "HELPED")==0) vs->status = HELPED; // HELPED de gelebilir
+    }
+    vs->seen = 1;
+    return vs;
+}
+
+static void vc_remove_survivor(int id) {
+    for (int i = 0; i < num_viewer_survivors; i++) {
+        if (viewer_survivors_cache[i].id == id) {
+            viewer_survivors_cache[i] = viewer_survivors_cache[--num_viewer_survivors];
+            return;
+        }
+    }
+}
+
+static void vc_ensure_window(struct json_object *state_json) {
+    struct json_object *map_dim_obj;
+    // Harita boyutlarını al (ilk mesajda)
     if (g_vc_map_width_cells == 0 && json_object_object_get_ex(state_json, "map_dimensions", &map_dim_obj)) {
         struct json_object *width_obj, *height_obj;
         if (json_object_object_get_ex(map_dim_obj, "width", &width_obj) &&
@@ -210,88 +401,203 @@ void process_simulation_state(struct json_object *state_json) {
             if (g_vc_window == NULL) { // SDL henüz başlatılmadıysa
                  if (vc_init_sdl_window(map_w, map_h, CELL_SIZE_PX) != 0) {
                     fprintf(stderr, "Viewer: Failed to init SDL from map dimensions.\n");
-                    // exit?
                  }
             }
         }
     }
+}
+
+static unsigned long vc_json_version(struct json_object *msg, const char *key) {
+    struct json_object *v_obj;
+    return json_object_object_get_ex(msg, key, &v_obj) ? (unsigned long)json_object_get_int64(v_obj) : 0;
+}
+
+// Sunucudan gelen SIMULATION_STATE_UPDATE (keyframe) mesajını işleyen fonksiyon.
+// Cache id bazlı güncellenir; keyframe'de olmayan varlıklar silinir.
+void process_simulation_state(struct json_object *state_json) {
+    struct json_object *drones_array_obj, *survivors_array_obj;
+
+    vc_ensure_window(state_json);
 
     pthread_mutex_lock(&cache_lock); // Cache'i yazarken kilitle
 
-    // Drone'ları parse et ve cache'e yaz
     if (json_object_object_get_ex(state_json, "drones", &drones_array_obj)) {
+        for (int i = 0; i < num_viewer_drones; i++) viewer_drones_cache[i].seen = 0;
         int count = json_object_array_length(drones_array_obj);
-        num_viewer_drones = 0; // Cache'i temizle (veya güncelle)
-        for (int i = 0; i < count && i < 50; i++) {
-            struct json_object *d_obj = json_object_array_get_idx(drones_array_obj, i);
-            ViewerDroneInfo *vd = &viewer_drones_cache[i];
-            
-            struct json_object *id_str_obj, *coord_obj, *target_obj, *status_str_obj;
-            json_object_object_get_ex(d_obj, "id_str", &id_str_obj);
-            json_object_object_get_ex(d_obj, "coord", &coord_obj);
-            json_object_object_get_ex(d_obj, "target", &target_obj);
-            json_object_object_get_ex(d_obj, "status", &status_str_obj);
-
-            if(id_str_obj) strncpy(vd->id_str, json_object_get_string(id_str_obj), sizeof(vd->id_str)-1);
-            if(coord_obj) {
-                json_object_object_get_ex(coord_obj, "x", &id_str_obj); vd->coord.x = json_object_get_int(id_str_obj);
-                json_object_object_get_ex(coord_obj, "y", &id_str_obj); vd->coord.y = json_object_get_int(id_str_obj);
-            }
-            if(target_obj) {
-                json_object_object_get_ex(target_obj, "x", &id_str_obj); vd->target.x = json_object_get_int(id_str_obj);
-                json_object_object_get_ex(target_obj, "y", &id_str_obj); vd->target.y = json_object_get_int(id_str_obj);
-            }
-            if(status_str_obj) {
-                const char *s_str = json_object_get_string(status_str_obj);
-                if(strcmp(s_str, "IDLE")==0) vd->status = IDLE;
-                else if (strcmp(s_str, "ON_MISSION")==0) vd->status = ON_MISSION;
-            }
-            /* Initialize display position for new drones */
-            if (!vd->displayInit) {
-                vd->displayCoord = vd->coord;
-                vd->displayInit = 1;
-            }
-            num_viewer_drones++;
+        for (int i = 0; i < count; i++) {
+            vc_upsert_drone(json_object_array_get_idx(drones_array_obj, i));
+        }
+        for (int i = num_viewer_drones - 1; i >= 0; i--) {
+            if (!viewer_drones_cache[i].seen) vc_remove_drone_at(i);
         }
     }
 
-    // Survivor'ları parse et ve cache'e yaz
     if (json_object_object_get_ex(state_json, "survivors", &survivors_array_obj)) {
+        for (int i = 0; i < num_viewer_survivors; i++) viewer_survivors_cache[i].seen = 0;
         int count = json_object_array_length(survivors_array_obj);
-        num_viewer_survivors = 0; // Cache'i temizle
-        for (int i = 0; i < count && i < 100; i++) {
-            struct json_object *s_obj = json_object_array_get_idx(survivors_array_obj, i);
-            ViewerSurvivorInfo *vs = &viewer_survivors_cache[i];
-
-            struct json_object *info_obj, *coord_obj, *status_str_obj;
-            json_object_object_get_ex(s_obj, "info", &info_obj);
-            json_object_object_get_ex(s_obj, "coord", &coord_obj);
-            json_object_object_get_ex(s_obj, "status", &status_str_obj);
-            
-            if(info_obj) strncpy(vs->info, json_object_get_string(info_obj), sizeof(vs->info)-1);
-            if(coord_obj) {
-                struct json_object *x_obj, *y_obj;
-                json_object_object_get_ex(coord_obj, "x", &x_obj);
-                vs->coord.x = json_object_get_int(x_obj);
-                json_object_object_get_ex(coord_obj, "y", &y_obj);
-                vs->coord.y = json_object_get_int(y_obj);
-            }
-            if(status_str_obj) {
-                const char *s_str = json_object_get_string(status_str_obj);
-                if(strcmp(s_str, "WAITING")==0) vs->status = WAITING;
-                else if (strcmp(s_str, "ASSIGNED")==0) vs->status = ASSIGNED;
-                else if (strcmp(s_str, "HELPED")==0) vs->status = HELPED; // HELPED de gelebilir
+        for (int i = 0; i < count; i++) {
+            vc_upsert_survivor(json_object_array_get_idx(survivors_array_obj, i));
+        }
+        for (int i = num_viewer_survivors - 1; i >= 0; i--) {
+            if (!viewer_survivors_cache[i].seen) {
+                viewer_survivors_cache[i] = viewer_survivors_cache[--num_viewer_survivors];
             }
-            num_viewer_survivors++;
         }
     }
+    viewer_state_version = vc_json_version(state_json, "version");
+    pthread_mutex_unlock(&cache_lock);
+}
+
+// SIMULATION_STATE_DELTA mesajını cache'e uygular.
+// Delta mevcut versiyon üzerine kurulu değilse 1 döner (keyframe istenmeli).
+int process_simulation_delta(struct json_object *delta_json) {
+    struct json_object *group_obj, *arr_obj;
+
+    pthread_mutex_lock(&cache_lock);
+    if (vc_json_version(delta_json, "base_version") != viewer_state_version) {
+        pthread_mutex_unlock(&cache_lock);
+        return 1;
+    }
+
+    if (json_object_object_get_ex(delta_json, "drones", &group_obj)) {
+        if (json_object_object_get_ex(group_obj, "upsert", &arr_obj)) {
+            int count = json_object_array_length(arr_obj);
+            for (int i = 0; i < count; i++) vc_upsert_drone(json_object_array_get_idx(arr_obj, i));
+        }
+        if (json_object_object_get_ex(group_obj, "remove", &arr_obj)) {
+            int count = json_object_array_length(arr_obj);
+            for (int i = 0; i < count; i++) vc_remove_drone(json_object_get_string(json_object_array_get_idx(arr_obj, i)));
+        }
+    }
+    if (json_object_object_get_ex(delta_json, "survivors", &group_obj)) {
+        if (json_object_object_get_ex(group_obj, "upsert", &arr_obj)) {
+            int count = json_object_array_length(arr_obj);
+            for (int i = 0; i < count; i++) vc_upsert_survivor(json_object_array_get_idx(arr_obj, i));
+        }
+        if (json_object_object_get_ex(group_obj, "remove", &arr_obj)) {
+            int count = json_object_array_length(arr_obj);
+            for (int i = 0; i < count; i++) vc_remove_survivor(json_object_get_int(json_object_array_get_idx(arr_obj, i)));
+        }
+    }
+    viewer_state_version = vc_json_version(delta_json, "version");
+    pthread_mutex_unlock(&cache_lock);
+    return 0;
+}
+
+// Paylaşımlı bellekten alınan tutarlı kopyayı cache'e uygular (keyframe ile aynı anlam)
+static void process_shm_state(const ShmWorldState *st) {
+    pthread_mutex_lock(&cache_lock);
+    for (int i = 0; i < num_viewer_drones; i++) viewer_drones_cache[i].seen = 0;
+    for (int i = 0; i < st->num_drones; i++) {
+        const ShmDrone *d = &st->drones[i];
+        char id_str[sizeof(d->id_str) + 1];
+        memcpy(id_str, d->id_str, sizeof(d->id_str));
+        id_str[sizeof(d->id_str)] = '\0';
+        ViewerDroneInfo *vd = vc_find_or_add_drone(id_str);
+        if (!vd) continue;
+        vd->coord = (Coord){d->x, d->y};
+        vd->target = (Coord){d->target_x, d->target_y};
+        vd->status = (DroneState)d->status;
+        if (!vd->displayInit) {
+            vd->displayCoord = vd->coord;
+            vd->displayInit = 1;
+        }
+        vd->seen = 1;
+    }
+    for (int i = num_viewer_drones - 1; i >= 0; i--) {
+        if (!viewer_drones_cache[i].seen) vc_remove_drone_at(i);
+    }
+
+    for (int i = 0; i < num_viewer_survivors; i++) viewer_survivors_cache[i].seen = 0;
+    for (int i = 0; i < st->num_survivors; i++) {
+        const ShmSurvivor *s = &st->survivors[i];
+        ViewerSurvivorInfo *vs = vc_find_or_add_survivor(s->id);
+        if (!vs) continue;
+        vs->coord = (Coord){s->x, s->y};
+        vs->status = (SurvivorState)s->status;
+        vs->seen = 1;
+    }
+    for (int i = num_viewer_survivors - 1; i >= 0; i--) {
+        if (!viewer_survivors_cache[i].seen) {
+            viewer_survivors_cache[i] = viewer_survivors_cache[--num_viewer_survivors];
+        }
+    }
+    viewer_state_version = (unsigned long)st->version;
     pthread_mutex_unlock(&cache_lock);
-    // printf("Viewer: Cache updated. Drones: %d, Survivors: %d\n", num_viewer_drones, num_viewer_survivors);
+}
+
+/*
+ * --shm modu: sunucuya bağlanmadan, broadcaster'ın paylaşımlı belleğe yazdığı dünyayı
+ * her karede okuyup çizer. Sunucu tarafında viewer başına hiçbir maliyet oluşmaz.
+ */
+static int run_shm_viewer() {
+    const ShmWorld *world = shm_world_open_readonly();
+    if (!world) return 1;
+    printf("Viewer: Reading world snapshot from shared memory %s.\n", SHM_WORLD_NAME);
+
+    static ShmWorldState local; // ~100 KB; stack yerine statik
+    int have_state = 0;
+    while (1) {
+        if (!atomic_load(&((ShmWorld*)world)->server_running)) {
+            printf("Viewer: Server stopped publishing.\n");
+            break;
+        }
+        unsigned long shown_version = viewer_state_version;
+        if (shm_world_read(world, &local) && local.version > 0 &&
+            (!have_state || local.version != shown_version)) {
+            if (g_vc_window == NULL && vc_init_sdl_window(local.map_width, local.map_height, CELL_SIZE_PX) != 0) {
+                fprintf(stderr, "Viewer: Failed to init SDL from map dimensions.\n");
+                break;
+            }
+            process_shm_state(&local);
+            have_state = 1;
+        }
+        if (vc_check_events()) break;
+        if (g_vc_renderer) vc_render_all();
+        SDL_Delay(16); // ~60 FPS
+    }
+
+    shm_world_close(world);
+    vc_quit_sdl();
+    return 0;
 }
 
 
 int main(int argc, char *argv[]) {
-    (void)argc; (void)argv;
+    // --unix: aynı makinedeki sunucuya Unix soketinden bağlan
+    // --shm: hiç bağlanmadan paylaşımlı bellekteki dünya kopyasını çiz
+    // --viewport=RxC: RxC hücrelik pencere, sadece görünen alan sunucudan istenir; --zoom=z: z x z blok çözünürlüğü
+    // --compress / --no-compress: sunucudan deflate akışı iste (varsayılan: TCP'de açık, Unix sokette kapalı)
+    const char *unix_path = NULL;
+    int use_shm = 0;
+    int want_compression = -1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--unix") == 0) {
+            unix_path = SERVER_UNIX_PATH;
+        } else if (strncmp(argv[i], "--unix=", 7) == 0) {
+            unix_path = argv[i] + 7;
+        } else if (strcmp(argv[i], "--shm") == 0) {
+            use_shm = 1;
+        } else if (strncmp(argv[i], "--viewport=", 11) == 0 &&
+                   sscanf(argv[i] + 11, "%dx%d", &g_vc_view_rows, &g_vc_view_cols) == 2 &&
+                   g_vc_view_rows > 0 && g_vc_view_cols > 0) {
+            g_vc_viewport_enabled = 1;
+        } else if (strncmp(argv[i], "--zoom=", 7) == 0 && atoi(argv[i] + 7) > 0) {
+            g_vc_view_zoom = atoi(argv[i] + 7);
+        } else if (strcmp(argv[i], "--compress") == 0) {
+            want_compression = 1;
+        } else if (strcmp(argv[i], "--no-compress") == 0) {
+            want_compression = 0;
+        } else {
+            fprintf(stderr, "Usage: %s [--unix[=path] | --shm] [--viewport=<rows>x<cols>] [--zoom=<z>] [--compress | --no-compress]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (want_compression < 0) want_compression = unix_path == NULL;
+    if (use_shm && g_vc_viewport_enabled) {
+        fprintf(stderr, "Viewer: --viewport is not supported with --shm.\n");
+        return 1;
+    }
 
     // Initialize caches to zero for displayCoord flags
     memset(viewer_drones_cache, 0, sizeof(viewer_drones_cache));
@@ -301,20 +607,38 @@ int main(int argc, char *argv[]) {
         perror("Viewer: Failed to init cache_lock"); return 1;
     }
 
-    int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (use_shm) {
+        int rc = run_shm_viewer();
+        pthread_mutex_destroy(&cache_lock);
+        return rc;
+    }
+
+    int sock_fd = socket(unix_path ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
     if (sock_fd < 0) { perror("Viewer: socket creation failed"); return 1; }
 
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(SERVER_PORT);
-    if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
-        perror("Viewer: inet_pton failed"); close(sock_fd); return 1;
-    }
+    if (unix_path) {
+        struct sockaddr_un unix_addr;
+        memset(&unix_addr, 0, sizeof(unix_addr));
+        unix_addr.sun_family = AF_UNIX;
+        strncpy(unix_addr.sun_path, unix_path, sizeof(unix_addr.sun_path) - 1);
+
+        printf("Viewer: Connecting to server at %s...\n", unix_path);
+        if (connect(sock_fd, (struct sockaddr*)&unix_addr, sizeof(unix_addr)) < 0) {
+            perror("Viewer: connect failed"); close(sock_fd); return 1;
+        }
+    } else {
+        struct sockaddr_in server_addr;
+        memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(SERVER_PORT);
+        if (inet_pton(AF_INET, SERVER_IP, &server_addr.sin_addr) <= 0) {
+            perror("Viewer: inet_pton failed"); close(sock_fd); return 1;
+        }
 
-    printf("Viewer: Connecting to server %s:%d...\n", SERVER_IP, SERVER_PORT);
-    if (connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("Viewer: connect failed"); close(sock_fd); return 1;
+        printf("Viewer: Connecting to server %s:%d...\n", SERVER_IP, SERVER_PORT);
+        if (connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            perror("Viewer: connect failed"); close(sock_fd); return 1;
+        }
     }
     printf("Viewer: Connected to server.\n");
 
@@ -322,6 +646,14 @@ int main(int argc, char *argv[]) {
     struct json_object *viewer_handshake = json_object_new_object();
     json_object_object_add(viewer_handshake, "type", json_object_new_string("VIEWER_HANDSHAKE"));
     json_object_object_add(viewer_handshake, "viewer_id", json_object_new_string("ViewerAlpha"));
+    json_object_object_add(viewer_handshake, "delta", json_object_new_boolean(1)); // Delta akışı iste
+    // Sunucu dikdörtgeni harita sınırlarına kırpar; harita boyutu ilk keyframe'de öğrenilir
+    if (g_vc_viewport_enabled) vc_add_viewport(viewer_handshake);
+    if (want_compression) {
+        struct json_object *methods = json_object_new_array();
+        json_object_array_add(methods, json_object_new_string(STREAM_COMPRESSION_DEFLATE));
+        json_object_object_add(viewer_handshake, "compression", methods);
+    }
     // Mesaj sonuna \n ekle
     const char *hs_str_raw = json_object_to_json_string_ext(viewer_handshake, JSON_C_TO_STRING_PLAIN);
     char hs_msg_nl[strlen(hs_str_raw) + 2];
@@ -335,6 +667,12 @@ int main(int argc, char *argv[]) {
     memset(aggregate_buffer_viewer, 0, sizeof(aggregate_buffer_viewer));
     int aggregate_len_viewer = 0;
     int running = 1;
+    int resync_pending = 0; // VIEWER_RESYNC gönderildi, keyframe bekleniyor
+    // ACK "compression":"deflate" derse ACK'ten sonraki byte'lar önce compressed_buf'a alınıp açılır
+    z_stream inflater;
+    int inflating = 0;
+    unsigned char compressed_buf[VIEWER_BUFFER_SIZE];
+    size_t compressed_len = 0;
 
     // İlk harita boyutlarını almak için bir bekleme veya ilk mesajı düzgün işleme
     // SDL penceresi, harita boyutları bilinmeden açılamaz.
@@ -361,45 +699,107 @@ int main(int argc, char *argv[]) {
         if (activity < 0 && errno != EINTR) { perror("Viewer: select error"); break; }
 
         if (FD_ISSET(sock_fd, &read_fds_viewer)) {
-            if (aggregate_len_viewer >= sizeof(aggregate_buffer_viewer) -1) { /* Buffer dolu, hata */ break; }
-            ssize_t bytes_received = recv(sock_fd, aggregate_buffer_viewer + aggregate_len_viewer,
-                                          sizeof(aggregate_buffer_viewer) - aggregate_len_viewer - 1, 0);
+            ssize_t bytes_received;
+            if (inflating) {
+                if (compressed_len >= sizeof(compressed_buf)) { /* Buffer dolu, hata */ break; }
+                bytes_received = recv(sock_fd, compressed_buf + compressed_len, sizeof(compressed_buf) - compressed_len, 0);
+            } else {
+                if (aggregate_len_viewer >= sizeof(aggregate_buffer_viewer) -1) { /* Buffer dolu, hata */ break; }
+                bytes_received = recv(sock_fd, aggregate_buffer_viewer + aggregate_len_viewer,
+                                      sizeof(aggregate_buffer_viewer) - aggregate_len_viewer - 1, 0);
+            }
             if (bytes_received <= 0) { /* Bağlantı kesildi veya hata */ running = 0; break; }
-            
-            aggregate_len_viewer += bytes_received;
-            aggregate_buffer_viewer[aggregate_len_viewer] = '\0';
-
-            char *newline_pos_v;
-            while((newline_pos_v = strchr(aggregate_buffer_viewer, '\n')) != NULL) {
-                *newline_pos_v = '\0';
-                char single_json_str_v[VIEWER_BUFFER_SIZE]; // Her bir JSON mesajı için
-                strncpy(single_json_str_v, aggregate_buffer_viewer, sizeof(single_json_str_v)-1);
-                single_json_str_v[sizeof(single_json_str_v)-1] = '\0';
-                
-                memmove(aggregate_buffer_viewer, newline_pos_v + 1, aggregate_len_viewer - (newline_pos_v - aggregate_buffer_viewer + 1));
-                aggregate_len_viewer -= (newline_pos_v - aggregate_buffer_viewer + 1);
+
+            if (inflating) {
+                compressed_len += bytes_received;
+            } else {
+                aggregate_len_viewer += bytes_received;
                 aggregate_buffer_viewer[aggregate_len_viewer] = '\0';
+            }
 
-                struct json_object *parsed_json = json_tokener_parse(single_json_str_v);
-                if (parsed_json) {
-                    struct json_object *type_obj_v;
-                    if (json_object_object_get_ex(parsed_json, "type", &type_obj_v)) {
-                        const char *type_str = json_object_get_string(type_obj_v);
-                        if (strcmp(type_str, "SIMULATION_STATE_UPDATE") == 0) {
-                            process_simulation_state(parsed_json);
-                        } else if (strcmp(type_str, "VIEWER_HANDSHAKE_ACK") == 0) { // Sunucu viewer'ı onaylarsa
-                            printf("Viewer: VIEWER_HANDSHAKE_ACK received.\n");
-                             // Belki ilk harita boyutları burada gelir.
+            // Açılan veri tampona sığmadıysa satırlar işlendikten sonra kalan kısım tekrar açılır
+            int more_input = 1;
+            while (more_input && running) {
+                more_input = 0;
+                if (inflating && compressed_len > 0) {
+                    int produced = vc_inflate(&inflater, compressed_buf, &compressed_len,
+                                              aggregate_buffer_viewer + aggregate_len_viewer,
+                                              sizeof(aggregate_buffer_viewer) - aggregate_len_viewer - 1);
+                    if (produced < 0) {
+                        fprintf(stderr, "Viewer: Corrupt compressed stream from server.\n");
+                        running = 0;
+                        break;
+                    }
+                    aggregate_len_viewer += produced;
+                    aggregate_buffer_viewer[aggregate_len_viewer] = '\0';
+                    more_input = produced > 0 && compressed_len > 0;
+                }
+
+                char *newline_pos_v;
+                while((newline_pos_v = strchr(aggregate_buffer_viewer, '\n')) != NULL) {
+                    *newline_pos_v = '\0';
+                    char single_json_str_v[VIEWER_BUFFER_SIZE]; // Her bir JSON mesajı için
+                    strncpy(single_json_str_v, aggregate_buffer_viewer, sizeof(single_json_str_v)-1);
+                    single_json_str_v[sizeof(single_json_str_v)-1] = '\0';
+                
+                    memmove(aggregate_buffer_viewer, newline_pos_v + 1, aggregate_len_viewer - (newline_pos_v - aggregate_buffer_viewer + 1));
+                    aggregate_len_viewer -= (newline_pos_v - aggregate_buffer_viewer + 1);
+                    aggregate_buffer_viewer[aggregate_len_viewer] = '\0';
+
+                    struct json_object *parsed_json = json_tokener_parse(single_json_str_v);
+                    if (parsed_json) {
+                        struct json_object *type_obj_v;
+                        if (json_object_object_get_ex(parsed_json, "type", &type_obj_v)) {
+                            const char *type_str = json_object_get_string(type_obj_v);
+                            if (strcmp(type_str, "SIMULATION_STATE_UPDATE") == 0) {
+                                process_simulation_state(parsed_json);
+                                vc_show_outside_counts(parsed_json);
+                                resync_pending = 0;
+                            } else if (strcmp(type_str, "SIMULATION_STATE_DELTA") == 0) {
+                                vc_show_outside_counts(parsed_json);
+                                if (process_simulation_delta(parsed_json) != 0 && !resync_pending) {
+                                    // Zincirde boşluk var; sunucudan keyframe iste
+                                    static const char resync_msg[] = "{\"type\":\"VIEWER_RESYNC\"}\n";
+                                    send(sock_fd, resync_msg, sizeof(resync_msg) - 1, 0);
+                                    resync_pending = 1;
+                                }
+                            } else if (strcmp(type_str, "VIEWER_HANDSHAKE_ACK") == 0) { // Sunucu viewer'ı onaylarsa
+                                printf("Viewer: VIEWER_HANDSHAKE_ACK received.\n");
+                                 // Belki ilk harita boyutları burada gelir.
+                                struct json_object *compression_obj;
+                                if (!inflating && json_object_object_get_ex(parsed_json, "compression", &compression_obj) &&
+                                    strcmp(json_object_get_string(compression_obj), STREAM_COMPRESSION_DEFLATE) == 0) {
+                                    if (vc_inflate_init(&inflater) != 0) {
+                                        fprintf(stderr, "Viewer: Failed to initialize inflate stream.\n");
+                                        running = 0;
+                                    } else {
+                                        // ACK ile aynı recv'de gelen byte'lar zaten sıkıştırılmış akışın başı
+                                        memcpy(compressed_buf, aggregate_buffer_viewer, aggregate_len_viewer);
+                                        compressed_len = aggregate_len_viewer;
+                                        aggregate_len_viewer = 0;
+                                        aggregate_buffer_viewer[0] = '\0';
+                                        inflating = 1;
+                                        more_input = 1;
+                                        printf("Viewer: Server stream is deflate-compressed.\n");
+                                    }
+                                }
+                            }
                         }
+                        json_object_put(parsed_json);
+                    } else {
+                         fprintf(stderr, "Viewer: Failed to parse JSON from server: '%s'\n", single_json_str_v);
                     }
-                    json_object_put(parsed_json);
-                } else {
-                     fprintf(stderr, "Viewer: Failed to parse JSON from server: '%s'\n", single_json_str_v);
+                    if(strlen(aggregate_buffer_viewer) == 0) break;
                 }
-                if(strlen(aggregate_buffer_viewer) == 0) break;
             }
+            if (!running) break;
         }
         
+        if (g_vc_view_changed) {
+            vc_send_subscribe(sock_fd);
+            g_vc_view_changed = 0;
+        }
+
         if (g_vc_renderer) { // Sadece SDL init edilmişse çiz
             vc_render_all();
         }
@@ -407,6 +807,11 @@ int main(int argc, char *argv[]) {
     }
 
     printf("Viewer: Disconnecting.\n");
+    if (inflating) {
+        printf("Viewer: %lu compressed bytes expanded to %lu (%.1fx).\n", inflater.total_in, inflater.total_out,
+               inflater.total_in ? (double)inflater.total_out / inflater.total_in : 0.0);
+        inflateEnd(&inflater);
+    }
     close(sock_fd);
     vc_quit_sdl();
     pthread_mutex_destroy(&cache_lock);
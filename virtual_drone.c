@@ -0,0 +1,126 @@
+/*
+ * virtual_drone.c
+ * Tick thread'inde yürütülen, soketsiz simüle drone'lar: hızlandırılmış ve tekrar
+ * oynatılan senaryolarda gerçek istemcilerin yerini alır.
+ */
+#include "headers/virtual_drone.h"
+#include "headers/globals.h"
+#include "headers/drone.h"
+#include "headers/drone_registry.h"
+#include "headers/admission.h"
+#include "headers/lock_prof.h"
+#include "headers/simclock.h"
+#include "headers/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Drone **sim_drones = NULL;   /* Sadece tick thread'i (kapanışta main) */
+static int sim_count = 0;
+static int sim_capacity = 0;
+static int pending_spawns = 0;      /* --virtual-drones: ilk tick'te oluşturulur */
+
+int virtual_drones_init(int count) {
+    if (count < 0) {
+        fprintf(stderr, "Virtual drone count cannot be negative.\n");
+        return 1;
+    }
+    sim_capacity = admission_max_drones();
+    sim_drones = calloc((size_t)sim_capacity, sizeof(Drone*));
+    if (!sim_drones) {
+        perror("Failed to allocate virtual drone table");
+        return 1;
+    }
+    pending_spawns = count;
+    return 0;
+}
+
+int virtual_drone_add(const char *id_str, Coord coord) {
+    if (sim_count >= sim_capacity || admission_admit_drone() != ADMISSION_OK) {
+        LOG_RATELIMITED(LOG_LEVEL_WARN, 5, "[Sim] Fleet full, virtual drone %s not added.\n", id_str);
+        return 1;
+    }
+    Drone *d = server_create_drone_instance(atoi(id_str + 1), id_str, -1);
+    if (!d) {
+        admission_release_drone();
+        return 1;
+    }
+    d->simulated = 1;
+    if (coord.x >= 0 && coord.x < map.height && coord.y >= 0 && coord.y < map.width) {
+        d->coord = coord;
+        d->target = coord;
+    }
+    // Zamanlayıcılar hiç kurulmaz ama iptal yolları güvenli olsun diye sıfırlanır
+    timer_entry_init(&d->heartbeat_timer, NULL, d);
+    timer_entry_init(&d->liveness_timer, NULL, d);
+    timer_entry_init(&d->mission_timer, NULL, d);
+    timer_entry_init(&d->grace_timer, NULL, d);
+    if (drone_registry_insert(d, 0, 0) == DRONE_REGISTRY_DUPLICATE) {
+        LOG_WARN("[Sim] Drone %s is already connected, virtual drone not added.\n", id_str);
+        server_cleanup_drone_instance(d);
+        admission_release_drone();
+        return 1;
+    }
+    drones->add(drones, &d);
+    sim_drones[sim_count++] = d;
+    journal_log(JOURNAL_DRONE_CONNECTED, d->id_str, -1, d->coord.x, d->coord.y, d->status, 0);
+    return 0;
+}
+
+static void destroy_virtual_drone(Drone *d) {
+    drone_registry_remove(d);
+    PROFILED_LOCK(&d->lock);
+    drone_release_mission_locked(d, JOURNAL_RELEASE_SESSION_ENDED);
+    PROFILED_UNLOCK(&d->lock);
+    journal_log(JOURNAL_DRONE_REMOVED, d->id_str, -1, d->coord.x, d->coord.y, d->status, 0);
+    drones->removedata(drones, &d);
+    server_cleanup_drone_instance(d);
+    admission_release_drone();
+}
+
+void virtual_drone_remove(const char *id_str) {
+    for (int i = 0; i < sim_count; i++) {
+        if (strcmp(sim_drones[i]->id_str, id_str) != 0) continue;
+        destroy_virtual_drone(sim_drones[i]);
+        sim_drones[i] = sim_drones[--sim_count];
+        return;
+    }
+}
+
+/* drone->lock tutulurken; drone_client ile aynı kural: önce x, sonra y ekseninde bir hücre */
+static void step_toward_target(Drone *d) {
+    if (d->coord.x != d->target.x) d->coord.x += d->target.x > d->coord.x ? 1 : -1;
+    else if (d->coord.y != d->target.y) d->coord.y += d->target.y > d->coord.y ? 1 : -1;
+}
+
+void virtual_drones_tick(unsigned long long tick) {
+    (void)tick;
+    while (pending_spawns > 0) {
+        char id_str[16];
+        snprintf(id_str, sizeof(id_str), "%s%d", VIRTUAL_DRONE_ID_PREFIX, sim_count + 1);
+        pending_spawns--;
+        // Konum tick thread'inin PRNG akışından: aynı tohumla aynı başlangıç dağılımı
+        Coord start = { sim_rand() % map.height, sim_rand() % map.width };
+        if (virtual_drone_add(id_str, start) != 0) pending_spawns = 0;
+    }
+
+    char log_prefix[32];
+    for (int i = 0; i < sim_count; i++) {
+        Drone *d = sim_drones[i];
+        PROFILED_LOCK(&d->lock);
+        if (d->status == ON_MISSION && !survivor_handle_is_none(d->current_survivor_target)) {
+            step_toward_target(d);
+            if (d->coord.x == d->target.x && d->coord.y == d->target.y) {
+                snprintf(log_prefix, sizeof(log_prefix), "[Sim %s]", d->id_str);
+                drone_complete_mission_locked(d, 1, d->mission_id, log_prefix);
+            }
+        }
+        PROFILED_UNLOCK(&d->lock);
+    }
+}
+
+void virtual_drones_shutdown() {
+    while (sim_count > 0) destroy_virtual_drone(sim_drones[--sim_count]);
+    free(sim_drones);
+    sim_drones = NULL;
+}